@@ -239,34 +239,44 @@ AlgorithmCiftiCorrelation::AlgorithmCiftiCorrelation(ProgressObject* myProgObj,
                 outRows[i - startrow] = CaretArray<float>(numRows);
             }
         }
-        int curRow = 0;//because we can't trust the order threads hit the critical section
-#pragma omp CARET_PARFOR schedule(dynamic)
-        for (int i = 0; i < numRows; ++i)
+        if (cacheFullInput)
         {
-            float movingRrs;
-            int myrow;
-            const float* movingRow;
-#pragma omp critical
-            {//CiftiFile may explode if we request multiple rows concurrently (needs mutexes), but we should force sequential requests anyway
-                myrow = curRow;//so, manually force it to read sequentially
-                ++curRow;
-                movingRow = getRow(myrow, movingRrs);
+            vector<int> chunkIndices(endrow - startrow);
+            for (int i = startrow; i < endrow; ++i)
+            {
+                chunkIndices[i - startrow] = i;
             }
-            for (int j = startrow; j < endrow; ++j)
+            computeCachedChunk(chunkIndices, outRows, fisherZ);
+        } else {
+            int curRow = 0;//because we can't trust the order threads hit the critical section
+#pragma omp CARET_PARFOR schedule(dynamic)
+            for (int i = 0; i < numRows; ++i)
             {
-                if (myrow >= startrow && myrow < endrow)//check whether we are in the output memory area
+                float movingRrs;
+                int myrow;
+                const float* movingRow;
+#pragma omp critical
+                {//CiftiFile may explode if we request multiple rows concurrently (needs mutexes), but we should force sequential requests anyway
+                    myrow = curRow;//so, manually force it to read sequentially
+                    ++curRow;
+                    movingRow = getRow(myrow, movingRrs);
+                }
+                for (int j = startrow; j < endrow; ++j)
                 {
-                    if (j >= myrow)//if so, only compute one half, and store both places
+                    if (myrow >= startrow && myrow < endrow)//check whether we are in the output memory area
                     {
+                        if (j >= myrow)//if so, only compute one half, and store both places
+                        {
+                            float cacheRrs;
+                            const float* cacheRow = getRow(j, cacheRrs, true);
+                            outRows[j - startrow][myrow] = correlate(movingRow, movingRrs, cacheRow, cacheRrs, fisherZ);
+                            outRows[myrow - startrow][j] = outRows[j - startrow][myrow];
+                        }
+                    } else {
                         float cacheRrs;
                         const float* cacheRow = getRow(j, cacheRrs, true);
                         outRows[j - startrow][myrow] = correlate(movingRow, movingRrs, cacheRow, cacheRrs, fisherZ);
-                        outRows[myrow - startrow][j] = outRows[j - startrow][myrow];
                     }
-                } else {
-                    float cacheRrs;
-                    const float* cacheRow = getRow(j, cacheRrs, true);
-                    outRows[j - startrow][myrow] = correlate(movingRow, movingRrs, cacheRow, cacheRrs, fisherZ);
                 }
             }
         }
@@ -428,33 +438,43 @@ AlgorithmCiftiCorrelation::AlgorithmCiftiCorrelation(ProgressObject* myProgObj,
             }
             indexReverse[ciftiIndexList[i].first] = i;
         }
-#pragma omp CARET_PARFOR schedule(dynamic)
-        for (int i = 0; i < numRows; ++i)
+        if (cacheFullInput)
         {
-            float movingRrs;
-            int myrow;
-            const float* movingRow;
-#pragma omp critical
-            {//CiftiFile may explode if we request multiple rows concurrently (needs mutexes), but we should force sequential requests anyway
-                myrow = curRow;//so, manually force it to read sequentially
-                ++curRow;
-                movingRow = getRow(myrow, movingRrs);
+            vector<int> chunkIndices(endrow - startrow);
+            for (int i = startrow; i < endrow; ++i)
+            {
+                chunkIndices[i - startrow] = ciftiIndexList[i].first;
             }
-            for (int j = startrow; j < endrow; ++j)
+            computeCachedChunk(chunkIndices, outRows, fisherZ);
+        } else {
+#pragma omp CARET_PARFOR schedule(dynamic)
+            for (int i = 0; i < numRows; ++i)
             {
-                if (indexReverse[myrow] != -1)//check if we are on a row that is in the output memory range
+                float movingRrs;
+                int myrow;
+                const float* movingRow;
+#pragma omp critical
+                {//CiftiFile may explode if we request multiple rows concurrently (needs mutexes), but we should force sequential requests anyway
+                    myrow = curRow;//so, manually force it to read sequentially
+                    ++curRow;
+                    movingRow = getRow(myrow, movingRrs);
+                }
+                for (int j = startrow; j < endrow; ++j)
                 {
-                    if (indexReverse[myrow] <= j)//if so, only compute one of the elements, then store it both places
+                    if (indexReverse[myrow] != -1)//check if we are on a row that is in the output memory range
                     {
+                        if (indexReverse[myrow] <= j)//if so, only compute one of the elements, then store it both places
+                        {
+                            float cacheRrs;
+                            const float* cacheRow = getRow(ciftiIndexList[j].first, cacheRrs, true);
+                            outRows[j - startrow][myrow] = correlate(movingRow, movingRrs, cacheRow, cacheRrs, fisherZ);
+                            outRows[indexReverse[myrow] - startrow][ciftiIndexList[j].first] = outRows[j - startrow][myrow];
+                        }
+                    } else {
                         float cacheRrs;
                         const float* cacheRow = getRow(ciftiIndexList[j].first, cacheRrs, true);
                         outRows[j - startrow][myrow] = correlate(movingRow, movingRrs, cacheRow, cacheRrs, fisherZ);
-                        outRows[indexReverse[myrow] - startrow][ciftiIndexList[j].first] = outRows[j - startrow][myrow];
                     }
-                } else {
-                    float cacheRrs;
-                    const float* cacheRow = getRow(ciftiIndexList[j].first, cacheRrs, true);
-                    outRows[j - startrow][myrow] = correlate(movingRow, movingRrs, cacheRow, cacheRrs, fisherZ);
                 }
             }
         }
@@ -519,15 +539,23 @@ AlgorithmCiftiCorrelation::AlgorithmCiftiCorrelation(ProgressObject* myProgObj,
 
 float AlgorithmCiftiCorrelation::correlate(const float* row1, const float& rrs1, const float* row2, const float& rrs2, const bool& fisherZ)
 {
-    double r;
     if (row1 == row2 && !m_covariance)
     {
-        r = 1.0;//short circuit for same row
+        return finishCorrelation(0.0, rrs1, rrs2, true, fisherZ);//short circuit for same row
+    }
+    return finishCorrelation(dsdot(row1, row2, getDotLength()), rrs1, rrs2, false, fisherZ);//these have already had the row means subtracted out, and weights applied
+}
+
+float AlgorithmCiftiCorrelation::finishCorrelation(const double& accum, const float& rrs1, const float& rrs2, const bool& sameRow, const bool& fisherZ)
+{
+    double r;
+    if (sameRow && !m_covariance)
+    {
+        r = 1.0;
     } else {
         if (m_weightedMode)
         {
             int numWeights = (int)m_weightIndexes.size();//because we compacted the data in the row to not include any zero weights
-            double accum = dsdot(row1, row2, numWeights);//these have already had the weighted row means subtracted out, and weights applied
             if (m_covariance)
             {
                 if (m_binaryWeights)
@@ -537,10 +565,9 @@ float AlgorithmCiftiCorrelation::correlate(const float* row1, const float& rrs1,
                     r = accum / rrs1;//NOTE: will equal rrs2 as it only depends on weights, and is not square root
                 }
             } else {
-                r = accum / (rrs1 * rrs2);//as do these
+                r = accum / (rrs1 * rrs2);
             }
         } else {
-            double accum = dsdot(row1, row2, m_numCols);//these have already had the row means subtracted out
             if (m_covariance)
             {
                 r = accum / m_numCols;
@@ -564,6 +591,83 @@ float AlgorithmCiftiCorrelation::correlate(const float* row1, const float& rrs1,
     return r;
 }
 
+int AlgorithmCiftiCorrelation::getDotLength()
+{
+    if (m_weightedMode) return (int)m_weightIndexes.size();
+    return m_numCols;
+}
+
+void AlgorithmCiftiCorrelation::computeCachedChunk(const vector<int>& chunkIndices, vector<CaretArray<float> >& outRows, const bool& fisherZ)
+{//with every input row cached, this is a symmetric rank-k update, so do it in tiles to reuse each loaded element several times
+    const int TILE = 4;//dsdot4x4 computes a 4x4 tile
+    const int PANEL = 64;//cached rows per parallel work unit, kept small enough to stay in L2 while the chunk rows stream past
+    int numRows = (int)m_rowInfo.size();
+    int numChunk = (int)chunkIndices.size();
+    int dotLength = getDotLength();
+    vector<const float*> rowPtrs(numRows);
+    vector<float> rowRrs(numRows);
+    vector<int> chunkReverse(numRows, -1);
+    for (int i = 0; i < numRows; ++i)
+    {
+        rowPtrs[i] = getRow(i, rowRrs[i], true);
+    }
+    for (int i = 0; i < numChunk; ++i)
+    {
+        chunkReverse[chunkIndices[i]] = i;
+    }
+    int numPanels = (numRows + PANEL - 1) / PANEL;
+#pragma omp CARET_PARFOR schedule(dynamic)
+    for (int panel = 0; panel < numPanels; ++panel)
+    {
+        int panelEnd = min(numRows, (panel + 1) * PANEL);
+        const float* tileRows[TILE], * tileCols[TILE];
+        double tileOut[TILE * TILE];
+        for (int rowBase = 0; rowBase < numChunk; rowBase += TILE)
+        {
+            int rowCount = min(TILE, numChunk - rowBase);
+            for (int i = 0; i < TILE; ++i)
+            {//pad partial tiles by repeating the last row, and ignore the extra results
+                tileRows[i] = rowPtrs[chunkIndices[rowBase + min(i, rowCount - 1)]];
+            }
+            for (int colBase = panel * PANEL; colBase < panelEnd; colBase += TILE)
+            {
+                int colCount = min(TILE, panelEnd - colBase);
+                bool needed = false;//elements where both indices are inside the chunk are only computed once, skip tiles with nothing new
+                for (int j = 0; j < colCount && !needed; ++j)
+                {
+                    int reverse = chunkReverse[colBase + j];
+                    if (reverse == -1 || reverse >= rowBase) needed = true;
+                }
+                if (!needed) continue;
+                for (int j = 0; j < TILE; ++j)
+                {
+                    tileCols[j] = rowPtrs[colBase + min(j, colCount - 1)];
+                }
+                dsdot4x4(tileRows, tileCols, dotLength, tileOut);
+                for (int i = 0; i < rowCount; ++i)
+                {
+                    int outRow = rowBase + i;
+                    int rowIndex = chunkIndices[outRow];
+                    for (int j = 0; j < colCount; ++j)
+                    {
+                        int col = colBase + j;
+                        int reverse = chunkReverse[col];
+                        if (reverse != -1 && reverse < outRow) continue;//filled in from the other half below
+                        outRows[outRow][col] = finishCorrelation(tileOut[TILE * i + j], rowRrs[rowIndex], rowRrs[col], rowIndex == col, fisherZ);
+                    }
+                }
+            }
+        }
+    }
+    for (int i = 0; i < numChunk; ++i)
+    {
+        for (int j = 0; j < i; ++j)
+        {
+            outRows[i][chunkIndices[j]] = outRows[j][chunkIndices[i]];
+        }
+    }
+}
+
 void AlgorithmCiftiCorrelation::init(const CiftiFile* input, const vector<float>* weights, const bool& noDemean, const bool& covariance)
 {
     m_noDemean = noDemean;
@@ -23,6 +23,7 @@
 #include "AlgorithmMetricGradient.h"
 #include "MetricSmoothingObject.h"
 #include "AlgorithmVolumeGradient.h"
+#include "CaretCommandGlobalOptions.h"
 #include "CaretLogger.h"
 #include "CaretOMP.h"
 #include "CiftiFile.h"
@@ -503,7 +504,7 @@ void AlgorithmCiftiCorrelationGradient::processSurfaceComponent(StructureEnum::E
     CaretPointer<MetricSmoothingObject> mySmooth;
     if (surfKern > 0.0f)
     {
-        mySmooth.grabNew(new MetricSmoothingObject(mySurf, surfKern, &myRoi, MetricSmoothingObject::GEO_GAUSS_AREA, areaData));//computes the smoothing weights only once per surface
+        mySmooth.grabNew(new MetricSmoothingObject(mySurf, surfKern, &myRoi, MetricSmoothingObject::GEO_GAUSS_AREA, areaData, caret_global_command_options.m_smoothingWeightCacheDirectory));//computes the smoothing weights only once per surface
     }
     for (int startpos = 0; startpos < mapSize; startpos += numCacheRows)
     {
@@ -647,7 +648,7 @@ void AlgorithmCiftiCorrelationGradient::processSurfaceComponent(StructureEnum::E
     CaretPointer<MetricSmoothingObject> mySmooth;
     if (surfKern > 0.0f)
     {
-        mySmooth.grabNew(new MetricSmoothingObject(mySurf, surfKern, &myRoi, MetricSmoothingObject::GEO_GAUSS_AREA, areaData));//computes the smoothing weights only once per surface
+        mySmooth.grabNew(new MetricSmoothingObject(mySurf, surfKern, &myRoi, MetricSmoothingObject::GEO_GAUSS_AREA, areaData, caret_global_command_options.m_smoothingWeightCacheDirectory));//computes the smoothing weights only once per surface
     }
     for (int startpos = 0; startpos < mapSize; startpos += numCacheRows)
     {
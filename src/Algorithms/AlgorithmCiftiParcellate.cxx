@@ -338,7 +338,12 @@ AlgorithmCiftiParcellate::AlgorithmCiftiParcellate(ProgressObject* myProgObj, co
             {
                 parcelData[j].clear();//doesn't change allocation
             }
-            myCiftiIn->getRow(scratchRow.data(), *iter);
+            const float* rowData = myCiftiIn->getRowPointer(*iter);//zero-copy when the input is mapped or in memory
+            if (rowData == NULL)
+            {
+                myCiftiIn->getRow(scratchRow.data(), *iter);
+                rowData = scratchRow.data();
+            }
             for (int64_t j = 0; j < numCols; ++j)
             {
                 int parcel = indexToParcel[j];
@@ -346,9 +351,9 @@ AlgorithmCiftiParcellate::AlgorithmCiftiParcellate(ProgressObject* myProgObj, co
                 {
                     if (isLabel)
                     {
-                        parcelData[parcel].push_back(floor(scratchRow[j] + 0.5f));//round to nearest integer to be safe
+                        parcelData[parcel].push_back(floor(rowData[j] + 0.5f));//round to nearest integer to be safe
                     } else {
-                        parcelData[parcel].push_back(scratchRow[j]);
+                        parcelData[parcel].push_back(rowData[j]);
                     }
                 }
             }
@@ -537,7 +542,12 @@ namespace
                 {
                     parcelData[j].clear();//doesn't change allocation
                 }
-                myCiftiIn->getRow(scratchRow.data(), *iter);
+                const float* rowData = myCiftiIn->getRowPointer(*iter);//zero-copy when the input is mapped or in memory
+                if (rowData == NULL)
+                {
+                    myCiftiIn->getRow(scratchRow.data(), *iter);
+                    rowData = scratchRow.data();
+                }
                 for (int64_t j = 0; j < numCols; ++j)
                 {
                     int parcel = indexToParcel[j];
@@ -545,9 +555,9 @@ namespace
                     {
                         if (isLabel)
                         {
-                            parcelData[parcel].push_back(floor(scratchRow[j] + 0.5f));//round to nearest integer to be safe
+                            parcelData[parcel].push_back(floor(rowData[j] + 0.5f));//round to nearest integer to be safe
                         } else {
-                            parcelData[parcel].push_back(scratchRow[j]);
+                            parcelData[parcel].push_back(rowData[j]);
                         }
                     }
                 }
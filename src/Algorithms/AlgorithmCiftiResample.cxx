@@ -572,6 +572,7 @@ namespace
         vector<CiftiBrainModelsMap::SurfaceMap> inSurfMap, outSurfMap;
         vector<CiftiBrainModelsMap::VolumeMap> inVolMap, outVolMap;
         vector<float> floatScratch1, floatScratch2;
+        vector<float> blockScratch1, blockScratch2;//several rows of floatScratch1/2, for resampling rows in blocks
         vector<int32_t> intScratch1, intScratch2;
         int64_t refOffset[3], inOffset[3];
         VolumeSpace refSpace;
@@ -786,6 +787,24 @@ namespace
         }
     }
     
+    void finishRowSurfaceMetric(ResampleCache& myCache, const float* resampled, vector<float>& outRow, const float& surfdilatemm,
+                                const AlgorithmMetricDilate::Method& surfDilateMethod, const float& surfDilateExponent, const bool surfLegacyCutoff)
+    {
+        int outMapSize = (int)myCache.outSurfMap.size();
+        myCache.tempMetric1.setValuesForColumn(0, resampled);
+        MetricFile* toUse = &(myCache.tempMetric1);
+        if (surfdilatemm > 0.0f)
+        {
+            AlgorithmMetricDilate(NULL, toUse, myCache.newSphere, surfdilatemm, &(myCache.tempMetric2), &(myCache.surfDilateRoi), NULL, 0, surfDilateMethod, surfDilateExponent, NULL, surfLegacyCutoff);
+            toUse = &(myCache.tempMetric2);
+        }
+        const float* outData = toUse->getValuePointerForColumn(0);
+        for (int j = 0; j < outMapSize; ++j)
+        {
+            outRow[myCache.outSurfMap[j].m_ciftiIndex] = outData[myCache.outSurfMap[j].m_surfaceNode];
+        }
+    }
+    
     void processRowSurface(ResampleCache& myCache, const vector<float>& inRow, vector<float>& outRow, const CiftiXML& myInputXML,
                            const float& surfdilatemm, const bool& surfLargest, const int& unassignedLabelKey, const int64_t& row,
                            const AlgorithmMetricDilate::Method& surfDilateMethod, const float& surfDilateExponent, const bool surfLegacyCutoff)
@@ -840,22 +859,53 @@ namespace
                 } else {
                     myCache.surfResamp.resampleNormal(myCache.floatScratch1.data(), myCache.floatScratch2.data());
                 }
-                myCache.tempMetric1.setValuesForColumn(0, myCache.floatScratch2.data());
-                MetricFile* toUse = &(myCache.tempMetric1);
-                if (surfdilatemm > 0.0f)
-                {
-                    AlgorithmMetricDilate(NULL, toUse, myCache.newSphere, surfdilatemm, &(myCache.tempMetric2), &(myCache.surfDilateRoi), NULL, 0, surfDilateMethod, surfDilateExponent, NULL, surfLegacyCutoff);
-                    toUse = &(myCache.tempMetric2);
-                }
-                const float* outData = toUse->getValuePointerForColumn(0);
-                for (int j = 0; j < outMapSize; ++j)
-                {
-                    outRow[myCache.outSurfMap[j].m_ciftiIndex] = outData[myCache.outSurfMap[j].m_surfaceNode];
-                }
+                finishRowSurfaceMetric(myCache, myCache.floatScratch2.data(), outRow, surfdilatemm, surfDilateMethod, surfDilateExponent, surfLegacyCutoff);
             }
         }
     }
     
+    ///resample several rows of non-label data at once, using the interleaved multi-column resampling
+    void processRowBlockSurface(ResampleCache& myCache, const vector<vector<float> >& inRows, vector<vector<float> >& outRows, const int& numRows, const CiftiXML& myInputXML,
+                                const float& surfdilatemm, const bool& surfLargest, const vector<int>& unassignedLabelKey, const int64_t& firstRow,
+                                const AlgorithmMetricDilate::Method& surfDilateMethod, const float& surfDilateExponent, const bool surfLegacyCutoff)
+    {
+        bool labelMode = (myInputXML.getMappingType(CiftiXML::ALONG_COLUMN) == CiftiMappingType::LABELS);
+        if (myCache.copyMode || labelMode || surfLargest)
+        {
+            for (int r = 0; r < numRows; ++r)
+            {
+                int unassignedKey = (labelMode ? unassignedLabelKey[firstRow + r] : 0);
+                processRowSurface(myCache, inRows[r], outRows[r], myInputXML, surfdilatemm, surfLargest, unassignedKey, firstRow + r, surfDilateMethod, surfDilateExponent, surfLegacyCutoff);
+            }
+            return;
+        }
+        int64_t numCurNodes = (int64_t)myCache.floatScratch1.size(), numNewNodes = (int64_t)myCache.floatScratch2.size();
+        int64_t blockCapacity = (int64_t)inRows.size();
+        if ((int64_t)myCache.blockScratch1.size() != numCurNodes * blockCapacity)
+        {//vertices not in the input stay zero, same as floatScratch1
+            myCache.blockScratch1.assign(numCurNodes * blockCapacity, 0.0f);
+            myCache.blockScratch2.resize(numNewNodes * blockCapacity);
+        }
+        int inMapSize = (int)myCache.inSurfMap.size();
+        vector<const float*> inputs(numRows);
+        vector<float*> outputs(numRows);
+        for (int r = 0; r < numRows; ++r)
+        {
+            float* rowScratch = myCache.blockScratch1.data() + r * numCurNodes;
+            for (int j = 0; j < inMapSize; ++j)
+            {
+                rowScratch[myCache.inSurfMap[j].m_surfaceNode] = inRows[r][myCache.inSurfMap[j].m_ciftiIndex];
+            }
+            inputs[r] = rowScratch;
+            outputs[r] = myCache.blockScratch2.data() + r * numNewNodes;
+        }
+        myCache.surfResamp.resampleNormalColumns(inputs.data(), outputs.data(), numRows);
+        for (int r = 0; r < numRows; ++r)
+        {
+            finishRowSurfaceMetric(myCache, outputs[r], outRows[r], surfdilatemm, surfDilateMethod, surfDilateExponent, surfLegacyCutoff);
+        }
+    }
+    
     void processRowVolume(ResampleCache& myCache, const vector<float>& inRow, vector<float>& outRow, const CiftiXML& myInputXML,
                           const float& voldilatemm, const AlgorithmVolumeDilate::Method& volDilateMethod, const float& volDilateExponent, const int& unassignedLabelKey,
                           const XfmStack& myXfms, const VolumeFile::InterpType& myVolMethod, const bool volLegacyCutoff,
@@ -1219,23 +1269,34 @@ AlgorithmCiftiResample::AlgorithmCiftiResample(ProgressObject* myProgObj, const
                            curRightSphere, newRightSphere, curRightAreas, newRightAreas,
                            curCerebSphere, newCerebSphere, curCerebAreas, newCerebAreas);
         int64_t numRows = myInputXML.getDimensionLength(CiftiXML::ALONG_COLUMN);
-        vector<float> inRow(myInputXML.getDimensionLength(CiftiXML::ALONG_ROW)), outRow(myOutXML.getDimensionLength(CiftiXML::ALONG_ROW));
-        for (int64_t row = 0; row < numRows; ++row)
+        const int ROW_BLOCK = 16;//surface resampling is faster on several rows at once
+        int blockCapacity = (int)min((int64_t)ROW_BLOCK, numRows);
+        vector<vector<float> > inRows(blockCapacity, vector<float>(myInputXML.getDimensionLength(CiftiXML::ALONG_ROW))),
+                               outRows(blockCapacity, vector<float>(myOutXML.getDimensionLength(CiftiXML::ALONG_ROW)));
+        for (int64_t blockStart = 0; blockStart < numRows; blockStart += ROW_BLOCK)
         {
-            myCiftiIn->getRow(inRow.data(), row);
+            int blockSize = (int)min((int64_t)ROW_BLOCK, numRows - blockStart);
+            for (int r = 0; r < blockSize; ++r)
+            {
+                myCiftiIn->getRow(inRows[r].data(), blockStart + r);
+            }
             for (int i = 0; i < numSurfStructs; ++i)
             {
                 map<StructureEnum::Enum, ResampleCache>::iterator iter = surfCache.find(surfList[i]);
                 CaretAssert(iter != surfCache.end());
-                processRowSurface(iter->second, inRow, outRow, myInputXML, surfdilatemm, surfLargest, unassignedLabelKey[row], row, surfDilateMethod, surfDilateExponent, surfLegacyCutoff);
+                processRowBlockSurface(iter->second, inRows, outRows, blockSize, myInputXML, surfdilatemm, surfLargest, unassignedLabelKey, blockStart, surfDilateMethod, surfDilateExponent, surfLegacyCutoff);
             }
-            for (int i = 0; i < numVolStructs; ++i)
+            for (int r = 0; r < blockSize; ++r)
             {
-                map<StructureEnum::Enum, ResampleCache>::iterator iter = volCache.find(volList[i]);
-                CaretAssert(iter != volCache.end());
-                processRowVolume(iter->second, inRow, outRow, myInputXML, voldilatemm, volDilateMethod, volDilateExponent, unassignedLabelKey[row], myXfms, myVolMethod, volLegacyCutoff, volLabelResample, volLabelSmooth);
+                int64_t row = blockStart + r;
+                for (int i = 0; i < numVolStructs; ++i)
+                {
+                    map<StructureEnum::Enum, ResampleCache>::iterator iter = volCache.find(volList[i]);
+                    CaretAssert(iter != volCache.end());
+                    processRowVolume(iter->second, inRows[r], outRows[r], myInputXML, voldilatemm, volDilateMethod, volDilateExponent, (labelMode ? unassignedLabelKey[row] : 0), myXfms, myVolMethod, volLegacyCutoff, volLabelResample, volLabelSmooth);
+                }
+                myCiftiOut->setRow(outRows[r].data(), row);
             }
-            myCiftiOut->setRow(outRow.data(), row);
         }
     }
 }
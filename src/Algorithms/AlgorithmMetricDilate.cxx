@@ -279,7 +279,7 @@ namespace
                     int closestNode = myGeoHelp->getClosestNodeInRoi(i, charRoi.data(), distance, closestDist);
                     if (closestNode == -1)//check neighbors, to ensure we dilate by at least one node everywhere
                     {
-                        const vector<int32_t>& nodeList = myTopoHelp->getNodeNeighbors(i);
+                        const CaretSpan<int32_t> nodeList = myTopoHelp->getNodeNeighbors(i);
                         vector<float> distList;
                         myGeoHelp->getGeoToTheseNodes(i, nodeList, distList);//ok, its a little silly to do this
                         const int numInRange = (int)nodeList.size();
@@ -497,7 +497,7 @@ namespace
                     int closestNode = myGeoHelp->getClosestNodeInRoi(i, charRoi.data(), distance, closestDist);
                     if (closestNode == -1)//check neighbors, to ensure we dilate by at least one node everywhere
                     {
-                        const vector<int32_t>& nodeList = myTopoHelp->getNodeNeighbors(i);
+                        const CaretSpan<int32_t> nodeList = myTopoHelp->getNodeNeighbors(i);
                         vector<float> distList;
                         myGeoHelp->getGeoToTheseNodes(i, nodeList, distList);//ok, its a little silly to do this
                         const int numInRange = (int)nodeList.size();
@@ -612,7 +612,7 @@ namespace
                     int closestNode = myGeoHelp->getClosestNodeInRoi(i, charRoi.data(), distance, closestDist);
                     if (closestNode == -1)//check neighbors, to ensure we dilate by at least one node everywhere
                     {
-                        const vector<int32_t>& nodeList = myTopoHelp->getNodeNeighbors(i);
+                        const CaretSpan<int32_t> nodeList = myTopoHelp->getNodeNeighbors(i);
                         vector<float> distList;
                         myGeoHelp->getGeoToTheseNodes(i, nodeList, distList);//ok, its a little silly to do this
                         const int numInRange = (int)nodeList.size();
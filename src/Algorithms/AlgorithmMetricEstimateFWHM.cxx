@@ -156,7 +156,7 @@ float AlgorithmMetricEstimateFWHM::estimateFWHM(const SurfaceFile* mySurf, const
             float center = inCol[i];
             float tempf = center - globalMean;
             globalAccum += tempf * tempf;//don't need to recalculate count
-            const vector<int32_t>& neighbors = myHelp->getNodeNeighbors(i);
+            const CaretSpan<int32_t> neighbors = myHelp->getNodeNeighbors(i);
             for (int j = 0; j < (int)neighbors.size(); ++j)
             {
                 if (neighbors[j] > i && (roi == NULL || roiCol[neighbors[j]] > 0.0f))//collect lopsided to get correct degrees of freedom (if n-1 denom is desired), mean is assumed zero so it works out
@@ -268,7 +268,7 @@ float AlgorithmMetricEstimateFWHM::estimateFWHMAllColumns(const SurfaceFile* myS
                 float center = inCol[i];
                 float tempf = center - globalMean;
                 globalAccum += tempf * tempf;//don't need to recalculate count
-                const vector<int32_t>& neighbors = myHelp->getNodeNeighbors(i);
+                const CaretSpan<int32_t> neighbors = myHelp->getNodeNeighbors(i);
                 for (int j = 0; j < (int)neighbors.size(); ++j)
                 {
                     if (neighbors[j] > i && (roi == NULL || roiCol[neighbors[j]] > 0.0f))//collect lopsided to get correct degrees of freedom (if n-1 denom is desired), mean is assumed zero so it works out
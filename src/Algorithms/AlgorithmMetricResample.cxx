@@ -27,6 +27,8 @@
 #include "SurfaceFile.h"
 #include "SurfaceResamplingHelper.h"
 
+#include <algorithm>
+
 using namespace caret;
 using namespace std;
 
@@ -203,13 +205,33 @@ AlgorithmMetricResample::AlgorithmMetricResample(ProgressObject* myProgObj, cons
     {
         metricOut->setColumnName(i, metricIn->getColumnName(i));
         *metricOut->getPaletteColorMapping(i) = *metricIn->getPaletteColorMapping(i);
-        if (largest)
+    }
+    if (largest)
+    {
+        for (int i = 0; i < numColumns; ++i)
         {
             myHelp.resampleLargest(metricIn->getValuePointerForColumn(i), colScratch.data());
-        } else {
-            myHelp.resampleNormal(metricIn->getValuePointerForColumn(i), colScratch.data());
+            metricOut->setValuesForColumn(i, colScratch.data());
+        }
+    } else {
+        const int COLUMN_CHUNK = 64;//resample many columns at a time, but don't allocate a second copy of the entire output
+        colScratch.resize((int64_t)numNewNodes * min(COLUMN_CHUNK, numColumns));
+        vector<const float*> inputs(COLUMN_CHUNK);
+        vector<float*> outputs(COLUMN_CHUNK);
+        for (int chunkStart = 0; chunkStart < numColumns; chunkStart += COLUMN_CHUNK)
+        {
+            int chunkSize = min(COLUMN_CHUNK, numColumns - chunkStart);
+            for (int c = 0; c < chunkSize; ++c)
+            {
+                inputs[c] = metricIn->getValuePointerForColumn(chunkStart + c);
+                outputs[c] = colScratch.data() + (int64_t)c * numNewNodes;
+            }
+            myHelp.resampleNormalColumns(inputs.data(), outputs.data(), chunkSize);
+            for (int c = 0; c < chunkSize; ++c)
+            {
+                metricOut->setValuesForColumn(chunkStart + c, outputs[c]);
+            }
         }
-        metricOut->setValuesForColumn(i, colScratch.data());
     }
 }
 
@@ -20,6 +20,7 @@
 
 #include "AlgorithmMetricSmoothing.h"
 #include "AlgorithmException.h"
+#include "CaretCommandGlobalOptions.h"
 #include "CaretOMP.h"
 #include "CaretPointer.h"
 #include "GeodesicHelper.h"
@@ -28,6 +29,7 @@
 #include "SurfaceFile.h"
 #include "TopologyHelper.h"
 
+#include <algorithm>
 #include <cmath>
 
 using namespace caret;
@@ -199,27 +201,39 @@ AlgorithmMetricSmoothing::AlgorithmMetricSmoothing(ProgressObject* myProgObj, co
     myProgress.setTask("Precomputing Smoothing Weights");
     if (matchRoiColumns)
     {
-        mySmoothObj.grabNew(new MetricSmoothingObject(mySurf, myKernel, NULL, myMethod, areaData));//don't use an ROI to build weights when the ROI changes each time
+        mySmoothObj.grabNew(new MetricSmoothingObject(mySurf, myKernel, NULL, myMethod, areaData, caret_global_command_options.m_smoothingWeightCacheDirectory));//don't use an ROI to build weights when the ROI changes each time
     } else {
-        mySmoothObj.grabNew(new MetricSmoothingObject(mySurf, myKernel, myRoi, myMethod, areaData));
+        mySmoothObj.grabNew(new MetricSmoothingObject(mySurf, myKernel, myRoi, myMethod, areaData, caret_global_command_options.m_smoothingWeightCacheDirectory));
     }
     myProgress.reportProgress(precomputeWeightWork);
     if (columnNum == -1)
     {
         myMetricOut->setNumberOfNodesAndColumns(numNodes, myMetric->getNumberOfColumns());
         myMetricOut->setStructure(mySurf->getStructure());
-        for (int32_t col = 0; col < numCols; ++col)
+        if (myRoi != NULL && matchRoiColumns)
         {
-            myProgress.setTask("Smoothing Column " + AString::number(col));
-            myMetricOut->setColumnName(col, myMetric->getColumnName(col) + ", smooth " + AString::number(myKernel));
-            *(myMetricOut->getPaletteColorMapping(col)) = *(myMetric->getPaletteColorMapping(col));//copy the palette settings
-            if (myRoi != NULL && matchRoiColumns)
+            for (int32_t col = 0; col < numCols; ++col)
             {
+                myProgress.setTask("Smoothing Column " + AString::number(col));
+                myMetricOut->setColumnName(col, myMetric->getColumnName(col) + ", smooth " + AString::number(myKernel));
+                *(myMetricOut->getPaletteColorMapping(col)) = *(myMetric->getPaletteColorMapping(col));//copy the palette settings
                 mySmoothObj->smoothColumn(myMetric, col, myMetricOut, col, myRoi, col, fixZeros);
-            } else {
-                mySmoothObj->smoothColumn(myMetric, col, myMetricOut, col, myRoi, 0, fixZeros);
+                myProgress.reportProgress(precomputeWeightWork + ((float)col + 1) / numCols);
+            }
+        } else {
+            for (int32_t col = 0; col < numCols; ++col)
+            {
+                myMetricOut->setColumnName(col, myMetric->getColumnName(col) + ", smooth " + AString::number(myKernel));
+                *(myMetricOut->getPaletteColorMapping(col)) = *(myMetric->getPaletteColorMapping(col));//copy the palette settings
+            }
+            const int32_t COLUMNS_PER_STEP = 64;//smoothColumns is much faster on many columns at once, but still report progress
+            for (int32_t col = 0; col < numCols; col += COLUMNS_PER_STEP)
+            {
+                int32_t numStep = min(COLUMNS_PER_STEP, numCols - col);
+                myProgress.setTask("Smoothing Columns " + AString::number(col) + " to " + AString::number(col + numStep - 1));
+                mySmoothObj->smoothColumns(myMetric, col, numStep, myMetricOut, col, myRoi, 0, fixZeros);
+                myProgress.reportProgress(precomputeWeightWork + ((float)col + numStep) / numCols);
             }
-            myProgress.reportProgress(precomputeWeightWork + ((float)col + 1) / numCols);
         }
     } else {
         myMetricOut->setNumberOfNodesAndColumns(numNodes, 1);
@@ -297,7 +297,7 @@ void AlgorithmMetricTFCE::tfce_pos(TopologyHelper* myHelper, const float* colDat
     {
         float value;
         int node = nodeHeap.pop(&value);
-        const vector<int32_t>& neighbors = myHelper->getNodeNeighbors(node);
+        const CaretSpan<int32_t> neighbors = myHelper->getNodeNeighbors(node);
         int numNeigh = (int)neighbors.size();
         set<int> touchingClusters;
         for (int i = 0; i < numNeigh; ++i)
@@ -38,12 +38,52 @@
 #include "AlgorithmSurfaceToSurface3dDistance.h"
 #include "AlgorithmCreateSignedDistanceVolume.h"
 
+#include <QCryptographicHash>
+
+#include <algorithm>
 #include <cmath>
 #include <fstream>
 
 using namespace caret;
 using namespace std;
 
+namespace
+{
+    const int32_t RIBBON_WEIGHTS_VERSION = 1;//increment when the ribbon weight computation changes, so old weights files get recomputed
+    
+    void addSurfaceToHash(QCryptographicHash& myHash, const SurfaceFile* mySurf)
+    {
+        int32_t numNodes = mySurf->getNumberOfNodes(), numTris = mySurf->getNumberOfTriangles();
+        myHash.addData((const char*)&numNodes, sizeof(int32_t));
+        myHash.addData((const char*)mySurf->getCoordinateData(), numNodes * 3 * sizeof(float));
+        myHash.addData((const char*)&numTris, sizeof(int32_t));
+        if (numTris > 0) myHash.addData((const char*)mySurf->getTriangle(0), numTris * 3 * sizeof(int32_t));
+    }
+    
+    ///identifies everything that goes into the ribbon weights, so a weights file made from other inputs is not used
+    AString getRibbonWeightsKey(const VolumeSpace& volSpace, const SurfaceFile* innerSurf, const SurfaceFile* outerSurf, const float* roiFrame, const bool roiWeights,
+                                const int& subdivisions, const bool& thinColumns, const SurfaceFile* gaussSurf, const float& gaussScale)
+    {
+        QCryptographicHash myHash(QCryptographicHash::Sha1);
+        myHash.addData((const char*)&RIBBON_WEIGHTS_VERSION, sizeof(int32_t));
+        const int64_t* dims = volSpace.getDims();
+        myHash.addData((const char*)dims, 3 * sizeof(int64_t));
+        const vector<vector<float> >& sform = volSpace.getSform();
+        for (int i = 0; i < (int)sform.size(); ++i)
+        {
+            myHash.addData((const char*)sform[i].data(), sform[i].size() * sizeof(float));
+        }
+        addSurfaceToHash(myHash, innerSurf);
+        addSurfaceToHash(myHash, outerSurf);
+        int32_t flags[4] = { subdivisions, thinColumns ? 1 : 0, roiFrame != NULL ? 1 : 0, roiWeights ? 1 : 0 };
+        myHash.addData((const char*)flags, sizeof(flags));
+        if (roiFrame != NULL) myHash.addData((const char*)roiFrame, dims[0] * dims[1] * dims[2] * sizeof(float));
+        myHash.addData((const char*)&gaussScale, sizeof(float));
+        if (gaussScale > 0.0f) addSurfaceToHash(myHash, gaussSurf);//only used for the gaussian
+        return AString(myHash.result().toHex());
+    }
+}
+
 AString AlgorithmVolumeToSurfaceMapping::getCommandSwitch()
 {
     return "-volume-to-surface-mapping";
@@ -92,6 +132,8 @@ OperationParameters* AlgorithmVolumeToSurfaceMapping::getParameters()
     ribbonWeightsOpt->addVolumeOutputParameter(2, "weights-out", "volume to write the weights to");
     OptionalParameter* ribbonWeightsTextOpt = ribbonOpt->createOptionalParameter(6, "-output-weights-text", "write the voxel weights for all vertices to a text file");
     ribbonWeightsTextOpt->addStringParameter(1, "text-out", "output - the output text filename");//fake the output formatting
+    OptionalParameter* ribbonWeightsFileOpt = ribbonOpt->createOptionalParameter(12, "-weights-file", "reuse the voxel weights across runs with the same surfaces and volume space");
+    ribbonWeightsFileOpt->addStringParameter(1, "file", "the binary weights file to read, or to write if it doesn't match the inputs");
     
     OptionalParameter* myelinStyleOpt = ret->createOptionalParameter(9, "-myelin-style", "use the method from myelin mapping");
     myelinStyleOpt->addVolumeParameter(1, "ribbon-roi", "an roi volume of the cortical ribbon for this hemisphere");
@@ -117,7 +159,9 @@ OperationParameters* AlgorithmVolumeToSurfaceMapping::getParameters()
         "The -gaussian option makes it act more like the myelin method, where the distance of a voxel from <surface> is used to downweight the voxel.  " +
         "The -interpolate suboption, instead of doing a weighted average of voxels, interpolates from the volume at the subdivided points inside the ribbon.  " +
         "If using both -interpolate and the -weighted suboption to -volume-roi, the roi volume weights are linearly interpolated, " +
-        "unless the -interpolate method is ENCLOSING_VOXEL, in which case ENCLOSING_VOXEL is also used for sampling the roi volume weights." +
+        "unless the -interpolate method is ENCLOSING_VOXEL, in which case ENCLOSING_VOXEL is also used for sampling the roi volume weights.  " +
+        "The -weights-file option saves the computed weights to a binary file, and if the file already holds weights computed from identical surfaces, volume space, roi and options, " +
+        "uses them instead of recomputing them, which saves time when mapping many volumes from the same subject.  It is not compatible with -interpolate." +
         "\n\n" +
         "The myelin style method uses part of the caret5 myelin mapping command to do the mapping: for each surface vertex, take all voxels that are in a cylinder " +
         "with radius and height equal to cortical thickness, centered on the vertex and aligned with the surface normal, and that are also within the ribbon ROI, " +
@@ -280,17 +324,27 @@ void AlgorithmVolumeToSurfaceMapping::useParameters(OperationParameters* myParam
                 weightsOut = ribbonWeights->getOutputVolume(2);
             }
             OptionalParameter* ribbonWeightsText = ribbonOpt->getOptionalParameter(6);
+            AString weightsFile;
+            OptionalParameter* ribbonWeightsFile = ribbonOpt->getOptionalParameter(12);
+            if (ribbonWeightsFile->m_present)
+            {
+                weightsFile = ribbonWeightsFile->getString(1);
+            }
             if (ribbonInterp)
             {
                 if (ribbonWeightsText->m_present || weightsOut != NULL)
                 {
                     throw AlgorithmException("-output-weights options are incompatible with -interpolate");
                 }
+                if (ribbonWeightsFile->m_present)
+                {
+                    throw AlgorithmException("-weights-file is incompatible with -interpolate");
+                }
                 AlgorithmVolumeToSurfaceMapping(myProgObj, myVolume, mySurface, myMetricOut, innerSurf, outerSurf, volInterpMethod, myRoiVol, weightedRoi, subdivisions, thinColumns,
                                                 mySubVol, gaussScale, badVertices, dilate, dilateNearest);
             } else {
                 AlgorithmVolumeToSurfaceMapping(myProgObj, myVolume, mySurface, myMetricOut, innerSurf, outerSurf, myRoiVol, weightedRoi, subdivisions, thinColumns,
-                                                mySubVol, gaussScale, badVertices, weightsOutVertex, weightsOut, dilate, dilateNearest);
+                                                mySubVol, gaussScale, badVertices, weightsOutVertex, weightsOut, dilate, dilateNearest, weightsFile);
             }
             if (ribbonWeightsText->m_present)
             {//do this after the algorithm, to let it do the error condition checking
@@ -428,7 +482,7 @@ AlgorithmVolumeToSurfaceMapping::AlgorithmVolumeToSurfaceMapping(ProgressObject*
 AlgorithmVolumeToSurfaceMapping::AlgorithmVolumeToSurfaceMapping(ProgressObject* myProgObj, const VolumeFile* myVolume, const SurfaceFile* mySurface, MetricFile* myMetricOut,
                                                                  const SurfaceFile* innerSurf, const SurfaceFile* outerSurf, const VolumeFile* roiVol, const bool roiWeights,
                                                                  const int32_t& subdivisions, const bool& thinColumns, const int64_t& mySubVol, const float& gaussScale, MetricFile* badVertices,
-                                                                 const int& weightsOutVertex, VolumeFile* weightsOut, float dilateDist, bool dilateNearest) : AbstractAlgorithm(myProgObj)
+                                                                 const int& weightsOutVertex, VolumeFile* weightsOut, float dilateDist, bool dilateNearest, const AString& weightsFile) : AbstractAlgorithm(myProgObj)
 {
     LevelProgress myProgress(myProgObj);
     vector<int64_t> myVolDims;
@@ -483,94 +537,74 @@ AlgorithmVolumeToSurfaceMapping::AlgorithmVolumeToSurfaceMapping(ProgressObject*
         weightDims.resize(3);
         weightsOut->reinitialize(weightDims, myVolume->getSform());
     }
-    vector<vector<VoxelWeight> > myWeights;
     const float* roiFrame = NULL;
     if (roiVol != NULL) roiFrame = roiVol->getFrame();
-    precomputeWeightsRibbon(myWeights, myVolume->getVolumeSpace(), innerSurf, outerSurf, roiFrame, roiWeights, subdivisions, thinColumns, mySurface, gaussScale);
+    RibbonWeightMatrix myWeights;
+    AString weightsKey;
+    bool haveWeights = false;
+    if (!weightsFile.isEmpty())
+    {
+        weightsKey = getRibbonWeightsKey(myVolume->getVolumeSpace(), innerSurf, outerSurf, roiFrame, roiWeights, subdivisions, thinColumns, mySurface, gaussScale);
+        haveWeights = myWeights.readFile(weightsFile, weightsKey, numNodes, myVolume->getVolumeSpace().getDims());
+    }
+    if (!haveWeights)
+    {
+        vector<vector<VoxelWeight> > weightLists;
+        precomputeWeightsRibbon(weightLists, myVolume->getVolumeSpace(), innerSurf, outerSurf, roiFrame, roiWeights, subdivisions, thinColumns, mySurface, gaussScale);
+        myWeights.setFromLists(weightLists, myVolume->getVolumeSpace().getDims());
+        if (!weightsFile.isEmpty())
+        {
+            myWeights.writeFile(weightsFile, weightsKey);
+        }
+    }
     if (weightsOut != NULL)
     {
         weightsOut->setValueAllVoxels(0.0f);
-        const vector<VoxelWeight>& vertexWeights = myWeights[weightsOutVertex];
-        int numWeights = (int)vertexWeights.size();
-        for (int i = 0; i < numWeights; ++i)
+        for (int64_t i = myWeights.m_rowStart[weightsOutVertex]; i < myWeights.m_rowStart[weightsOutVertex + 1]; ++i)
         {
-            weightsOut->setValue(vertexWeights[i].weight, vertexWeights[i].ijk);
+            int64_t voxel = myWeights.m_voxels[i];
+            int64_t ijk[3] = { voxel % myVolDims[0], (voxel / myVolDims[0]) % myVolDims[1], voxel / (myVolDims[0] * myVolDims[1]) };
+            weightsOut->setValue(myWeights.m_weights[i], ijk);
         }
     }
-    CaretArray<float> myScratchArray(numNodes);
-    float* myScratch = myScratchArray.getArray();
-    if (mySubVol == -1)
+    for (int64_t node = 0; node < numNodes; ++node)
     {
-        for (int64_t i = 0; i < myVolDims[3]; ++i)
+        if (myWeights.m_weightSums[node] == 0.0f)
         {
-            for (int64_t j = 0; j < myVolDims[4]; ++j)
-            {
-                int64_t thisCol = i * myVolDims[4] + j;
-                AString metricLabel = myVolume->getMapName(i);
-                if (myVolDims[4] != 1)
-                {
-                    metricLabel += " component " + AString::number(j);
-                }
-                metricLabel += " ribbon constrained";
-                rawMapping->setColumnName(thisCol, metricLabel);
-#pragma omp CARET_PARFOR schedule(dynamic)
-                for (int64_t node = 0; node < numNodes; ++node)
-                {
-                    myScratch[node] = 0.0f;
-                    float totalWeight = 0.0f;
-                    int numVoxels = (int)myWeights[node].size();
-                    for (int voxel = 0; voxel < numVoxels; ++voxel)
-                    {
-                        float thisWeight = myWeights[node][voxel].weight;
-                        totalWeight += thisWeight;
-                        myScratch[node] += thisWeight * myVolume->getValue(myWeights[node][voxel].ijk, i, j);
-                    }
-                    if (totalWeight != 0.0f)
-                    {
-                        myScratch[node] /= totalWeight;
-                    } else {
-                        myScratch[node] = 0.0f;
-                        if (thisCol == 0)
-                        {
-                            badVertScratch[node] = 1.0f;
-                        }
-                    }
-                }
-                rawMapping->setValuesForColumn(thisCol, myScratch);
-            }
+            badVertScratch[node] = 1.0f;
         }
-    } else {
+    }
+    vector<const float*> columnFrames;//the weights are the same for every frame, so do them together as a sparse matrix times a block of frames
+    int64_t startVol = 0, endVol = myVolDims[3];
+    if (mySubVol != -1)
+    {
+        startVol = mySubVol;
+        endVol = mySubVol + 1;
+    }
+    for (int64_t i = startVol; i < endVol; ++i)
+    {
         for (int64_t j = 0; j < myVolDims[4]; ++j)
         {
-            AString metricLabel = myVolume->getMapName(mySubVol);
+            int64_t thisCol = (i - startVol) * myVolDims[4] + j;
+            AString metricLabel = myVolume->getMapName(i);
             if (myVolDims[4] != 1)
             {
                 metricLabel += " component " + AString::number(j);
             }
             metricLabel += " ribbon constrained";
-            int64_t thisCol = j;
             rawMapping->setColumnName(thisCol, metricLabel);
-#pragma omp CARET_PARFOR schedule(dynamic)
-            for (int64_t node = 0; node < numNodes; ++node)
-            {
-                    myScratch[node] = 0.0f;
-                    float totalWeight = 0.0f;
-                    int numVoxels = (int)myWeights[node].size();
-                    for (int voxel = 0; voxel < numVoxels; ++voxel)
-                    {
-                        float thisWeight = myWeights[node][voxel].weight;
-                        totalWeight += thisWeight;
-                        myScratch[node] += thisWeight * myVolume->getValue(myWeights[node][voxel].ijk, mySubVol, j);
-                    }
-                    if (totalWeight != 0.0f)
-                    {
-                        myScratch[node] /= totalWeight;
-                    } else {
-                        myScratch[node] = 0.0f;
-                        badVertScratch[node] = 1.0f;
-                    }
-            }
-            rawMapping->setValuesForColumn(thisCol, myScratch);
+            columnFrames.push_back(myVolume->getFrame(i, j));
+        }
+    }
+    const int64_t COLUMN_CHUNK = 64;//limits the size of the output buffer
+    vector<float> myScratch(min(COLUMN_CHUNK, numColumns) * numNodes);
+    for (int64_t chunkStart = 0; chunkStart < numColumns; chunkStart += COLUMN_CHUNK)
+    {
+        int64_t chunkSize = min(COLUMN_CHUNK, numColumns - chunkStart);
+        myWeights.applyToFrames(columnFrames.data() + chunkStart, (int)chunkSize, myScratch.data());
+        for (int64_t col = 0; col < chunkSize; ++col)
+        {
+            rawMapping->setValuesForColumn(chunkStart + col, myScratch.data() + col * numNodes);
         }
     }
     badVertCompute->setValuesForColumn(0, badVertScratch.data());
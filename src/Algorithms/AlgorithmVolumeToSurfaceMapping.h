@@ -58,7 +58,8 @@ namespace caret {
                                         const SurfaceFile* innerSurf, const SurfaceFile* outerSurf,
                                         const VolumeFile* roiVol = NULL, const bool roiWeights = false, const int32_t& subdivisions = 3, const bool& thinColumns = false,
                                         const int64_t& mySubVol = -1, const float& gaussScale = -1.0f, MetricFile* badVertices = NULL,
-                                        const int& weightsOutVertex = -1, VolumeFile* weightsOut = NULL, float dilateDist = -1.0f, bool dilateNearest = false);
+                                        const int& weightsOutVertex = -1, VolumeFile* weightsOut = NULL, float dilateDist = -1.0f, bool dilateNearest = false,
+                                        const AString& weightsFile = AString());
         //interpolated ribbon
         AlgorithmVolumeToSurfaceMapping(ProgressObject* myProgObj, const VolumeFile* myVolume, const SurfaceFile* mySurface, MetricFile* myMetricOut,
                                         const SurfaceFile* innerSurf, const SurfaceFile* outerSurf, const VolumeFile::InterpType interpType,
@@ -21,7 +21,10 @@
 #include <algorithm>
 #include <cmath>
 #include <limits>
+#include <mutex>
 #include <new>
+#include <numeric>
+#include <thread>
 
 #include <QCollator>
 
@@ -184,6 +187,130 @@ sortDataFileTypeByFileNameNoPath(std::vector<DFT*>& dataFiles)
     });
 }
 
+/**
+ * Maximum number of data files that are read at the same time
+ * when loading a spec file or a scene.
+ */
+static const int32_t MAXIMUM_NUMBER_OF_DATA_FILES_READ_IN_PARALLEL = 4;
+
+/**
+ * Can data files of the given type be read on a worker thread prior to
+ * being added to the brain?  The reading of these types does not send
+ * events nor access the brain, and when added to the brain, files of these
+ * types are processed identically to files read by the brain except for
+ * the validation performed by addDataFileReadInParallel().
+ *
+ * @param dataFileType
+ *     Type of the data file.
+ * @return
+ *     True if files of the type may be read in parallel.
+ */
+static bool
+isDataFileTypeReadInParallel(const DataFileTypeEnum::Enum dataFileType)
+{
+    bool parallelFlag(false);
+    
+    switch (dataFileType) {
+        case DataFileTypeEnum::ANNOTATION:
+            break;
+        case DataFileTypeEnum::ANNOTATION_TEXT_SUBSTITUTION:
+            break;
+        case DataFileTypeEnum::BORDER:
+            break;
+        case DataFileTypeEnum::CONNECTIVITY_DENSE:
+            parallelFlag = true;
+            break;
+        case DataFileTypeEnum::CONNECTIVITY_DENSE_DYNAMIC:
+            break;
+        case DataFileTypeEnum::CONNECTIVITY_DENSE_LABEL:
+            parallelFlag = true;
+            break;
+        case DataFileTypeEnum::CONNECTIVITY_DENSE_PARCEL:
+            parallelFlag = true;
+            break;
+        case DataFileTypeEnum::CONNECTIVITY_DENSE_SCALAR:
+            parallelFlag = true;
+            break;
+        case DataFileTypeEnum::CONNECTIVITY_DENSE_SPARSE:
+            parallelFlag = true;
+            break;
+        case DataFileTypeEnum::CONNECTIVITY_DENSE_TIME_SERIES:
+            parallelFlag = true;
+            break;
+        case DataFileTypeEnum::CONNECTIVITY_FIBER_ORIENTATIONS_TEMPORARY:
+            break;
+        case DataFileTypeEnum::CONNECTIVITY_FIBER_TRAJECTORY_TEMPORARY:
+            break;
+        case DataFileTypeEnum::CONNECTIVITY_FIBER_TRAJECTORY_MAPS:
+            break;
+        case DataFileTypeEnum::CONNECTIVITY_PARCEL:
+            parallelFlag = true;
+            break;
+        case DataFileTypeEnum::CONNECTIVITY_PARCEL_DENSE:
+            parallelFlag = true;
+            break;
+        case DataFileTypeEnum::CONNECTIVITY_PARCEL_DYNAMIC:
+            break;
+        case DataFileTypeEnum::CONNECTIVITY_PARCEL_LABEL:
+            parallelFlag = true;
+            break;
+        case DataFileTypeEnum::CONNECTIVITY_PARCEL_SCALAR:
+            parallelFlag = true;
+            break;
+        case DataFileTypeEnum::CONNECTIVITY_PARCEL_SERIES:
+            parallelFlag = true;
+            break;
+        case DataFileTypeEnum::CONNECTIVITY_SCALAR_DATA_SERIES:
+            parallelFlag = true;
+            break;
+        case DataFileTypeEnum::CZI_IMAGE_FILE:
+            break;
+        case DataFileTypeEnum::FOCI:
+            break;
+        case DataFileTypeEnum::HISTOLOGY_SLICES:
+            break;
+        case DataFileTypeEnum::IMAGE:
+            break;
+        case DataFileTypeEnum::LABEL:
+            parallelFlag = true;
+            break;
+        case DataFileTypeEnum::META_VOLUME:
+            break;
+        case DataFileTypeEnum::METRIC:
+            parallelFlag = true;
+            break;
+        case DataFileTypeEnum::METRIC_DYNAMIC:
+            break;
+        case DataFileTypeEnum::NEUROGLANCER_ANNOTATION:
+            break;
+        case DataFileTypeEnum::OME_ZARR_IMAGE:
+            break;
+        case DataFileTypeEnum::PALETTE:
+            break;
+        case DataFileTypeEnum::RGBA:
+            parallelFlag = true;
+            break;
+        case DataFileTypeEnum::SAMPLES:
+            break;
+        case DataFileTypeEnum::SCENE:
+            break;
+        case DataFileTypeEnum::SPECIFICATION:
+            break;
+        case DataFileTypeEnum::SURFACE:
+            parallelFlag = true;
+            break;
+        case DataFileTypeEnum::UNKNOWN:
+            break;
+        case DataFileTypeEnum::VOLUME:
+            parallelFlag = true;
+            break;
+        case DataFileTypeEnum::VOLUME_DYNAMIC:
+            break;
+    }
+    
+    return parallelFlag;
+}
+
 /**
  *  Constructor.
  *
@@ -7226,7 +7353,9 @@ Brain::addReadOrReloadDataFile(const FileModeAddReadReload fileMode,
                                 false,
                                 false);
         
-        AString msg = ("Time to read "
+        AString msg = (((fileMode == FILE_MODE_ADD)
+                        ? "Time to add "
+                        : "Time to read ")
                        + dataFileName
                        + " was "
                        + AString::number(et.getElapsedTimeSeconds())
@@ -7312,6 +7441,230 @@ Brain::readDataFile(const DataFileTypeEnum::Enum dataFileType,
     return caretDataFileRead;
 }
 
+/**
+ * Read data files from a spec file on worker threads.  Only the reading
+ * of the files is performed, the files are NOT added to the brain.
+ * Files that are not local, that do not exist, or whose type is not
+ * read in parallel are not read.  Files that fail to read are deleted
+ * so that reading them with readDataFile() reports the error.
+ *
+ * @param specFileDataFiles
+ *    Spec file entries of the files to read.
+ * @param progressEvent
+ *    Event sent to report progress and to test for cancellation.  It is
+ *    sent only before the files are created since the constructors of some
+ *    files (surfaces, parcel matrices) add event listeners, and those files
+ *    must not receive events (the GUI processes events when it displays the
+ *    progress) until they are read and added to the brain.
+ * @return
+ *    Map of spec file entries to the files that were read successfully.
+ *    Empty if reading was cancelled.  Caller is responsible for adding
+ *    the files to the brain, or deleting them, in the order of the
+ *    spec file using addDataFileReadInParallel().
+ */
+std::map<const SpecFileDataFile*, CaretDataFile*>
+Brain::readDataFilesInParallel(const std::vector<const SpecFileDataFile*>& specFileDataFiles,
+                               EventProgressUpdate* progressEvent)
+{
+    CaretAssert(progressEvent);
+    
+    std::map<const SpecFileDataFile*, CaretDataFile*> filesReadOut;
+    
+    struct FileToRead {
+        const SpecFileDataFile* m_specFileDataFile;
+        AString m_filename;
+        int64_t m_fileSize;
+        CaretDataFile* m_caretDataFile;
+        double m_readingTime;
+        bool m_successFlag;
+    };
+    std::vector<FileToRead> filesToRead;
+    
+    for (const SpecFileDataFile* sfdf : specFileDataFiles) {
+        CaretAssert(sfdf);
+        const DataFileTypeEnum::Enum dataFileType = sfdf->getDataFileType();
+        if ( ! isDataFileTypeReadInParallel(dataFileType)) {
+            continue;
+        }
+        const AString filename = convertFilePathNameToAbsolutePathName(sfdf->getFileName());
+        if (DataFile::isFileOnNetwork(filename)) {
+            continue;
+        }
+        FileInformation fileInfo(filename);
+        if ( ! fileInfo.exists()) {
+            continue;
+        }
+        filesToRead.push_back({ sfdf, filename, fileInfo.size(), NULL, 0.0, false });
+    }
+    
+    const int32_t numberOfFiles = static_cast<int32_t>(filesToRead.size());
+    if (numberOfFiles < 2) {
+        /*
+         * Nothing gained from a worker thread
+         */
+        return filesReadOut;
+    }
+    
+    progressEvent->setProgressMessage("Reading "
+                                      + AString::number(numberOfFiles)
+                                      + " files");
+    EventManager::get()->sendEvent(progressEvent->getPointer());
+    if (progressEvent->isCancelled()) {
+        return filesReadOut;
+    }
+    
+    /*
+     * Files are created on this thread since the constructors of some
+     * files add event listeners.  From here until the workers finish,
+     * no events may be sent.
+     */
+    for (auto& ftr : filesToRead) {
+        const DataFileTypeEnum::Enum dataFileType = ftr.m_specFileDataFile->getDataFileType();
+        ftr.m_caretDataFile = ((dataFileType == DataFileTypeEnum::SURFACE)
+                               ? new Surface()
+                               : CaretDataFileHelper::createCaretDataFileForFileType(dataFileType));
+        CaretAssert(ftr.m_caretDataFile);
+    }
+    
+    ElapsedTimer timer;
+    timer.start();
+    
+    /*
+     * Start with the largest files so that the total reading
+     * time approaches the reading time of the largest file
+     */
+    std::vector<int32_t> readingOrder(numberOfFiles);
+    std::iota(readingOrder.begin(), readingOrder.end(), 0);
+    std::stable_sort(readingOrder.begin(),
+                     readingOrder.end(),
+                     [&filesToRead](const int32_t a, const int32_t b) -> bool {
+        return (filesToRead[a].m_fileSize > filesToRead[b].m_fileSize);
+    });
+    
+    std::mutex readingMutex;
+    int32_t nextFileIndex(0);
+    
+    auto readFiles = [&]() {
+        while (true) {
+            FileToRead* ftr(NULL);
+            {
+                std::lock_guard<std::mutex> lock(readingMutex);
+                if (nextFileIndex >= numberOfFiles) {
+                    return;
+                }
+                CaretAssertVectorIndex(readingOrder, nextFileIndex);
+                ftr = &filesToRead[readingOrder[nextFileIndex]];
+                ++nextFileIndex;
+            }
+            
+            ElapsedTimer fileTimer;
+            fileTimer.start();
+            try {
+                ftr->m_caretDataFile->readFile(ftr->m_filename);
+                ftr->m_successFlag = true;
+            }
+            catch (...) {
+                /*
+                 * File is read again with readDataFile() that reports the error
+                 */
+            }
+            ftr->m_readingTime = fileTimer.getElapsedTimeSeconds();
+        }
+    };
+    
+    const int32_t numberOfThreads = std::min(numberOfFiles,
+                                             std::min(MAXIMUM_NUMBER_OF_DATA_FILES_READ_IN_PARALLEL,
+                                                      std::max(static_cast<int32_t>(std::thread::hardware_concurrency()),
+                                                               1)));
+    std::vector<std::thread> threads;
+    for (int32_t i = 0; i < numberOfThreads; i++) {
+        threads.push_back(std::thread(readFiles));
+    }
+    
+    /*
+     * No events are sent until all files are read
+     */
+    for (auto& t : threads) {
+        t.join();
+    }
+    
+    for (auto& ftr : filesToRead) {
+        if (ftr.m_successFlag) {
+            CaretLogInfo("Time to read "
+                         + ftr.m_filename
+                         + " on a worker thread was "
+                         + AString::number(ftr.m_readingTime)
+                         + " seconds.");
+            filesReadOut.insert(std::make_pair(ftr.m_specFileDataFile,
+                                               ftr.m_caretDataFile));
+        }
+        else {
+            delete ftr.m_caretDataFile;
+        }
+    }
+    
+    CaretLogInfo("Time to read "
+                 + AString::number(numberOfFiles)
+                 + " files using "
+                 + AString::number(numberOfThreads)
+                 + " threads was "
+                 + AString::number(timer.getElapsedTimeSeconds())
+                 + " seconds.");
+    
+    return filesReadOut;
+}
+
+/**
+ * Add a data file that was read by readDataFilesInParallel() to the brain.
+ * Performs the processing that is performed after a file is read when
+ * the brain reads the file.
+ *
+ * @param caretDataFile
+ *    File that was read.  If adding the file fails, it is deleted.
+ * @param structure
+ *    Struture of file (used if not invalid)
+ * @param dataFileName
+ *    Name of data file.
+ * @throws DataFileException
+ *    If there is an error adding the file.
+ */
+void
+Brain::addDataFileReadInParallel(CaretDataFile* caretDataFile,
+                                 const StructureEnum::Enum structure,
+                                 const AString& dataFileName)
+{
+    CaretAssert(caretDataFile);
+    
+    try {
+        /*
+         * Validation performed by the addReadOrReload methods when a
+         * CIFTI file is read since it depends upon surfaces loaded previously
+         */
+        CiftiDenseSparseFile* ciftiDenseSparseFile = dynamic_cast<CiftiDenseSparseFile*>(caretDataFile);
+        CiftiMappableDataFile* ciftiMappableFile   = dynamic_cast<CiftiMappableDataFile*>(caretDataFile);
+        if (ciftiDenseSparseFile != NULL) {
+            validateCiftiDenseSparseDataFile(ciftiDenseSparseFile);
+        }
+        else if (ciftiMappableFile != NULL) {
+            validateCiftiMappableDataFile(ciftiMappableFile);
+        }
+        
+        addReadOrReloadDataFile(FILE_MODE_ADD,
+                                caretDataFile,
+                                caretDataFile->getDataFileType(),
+                                structure,
+                                dataFileName,
+                                false);
+    }
+    catch (const DataFileException& dfe) {
+        /*
+         * File is not in the brain when adding fails
+         */
+        delete caretDataFile;
+        throw dfe;
+    }
+}
+
 /**
  * Processing performed after adding or removing a data file.
  */
@@ -7402,6 +7755,37 @@ Brain::loadFilesSelectedInSpecFile(EventSpecFileReadDataFiles* readSpecFileDataF
      * reading routines update palette coloring when file is read
      */
     const int32_t numFileGroups = sf->getNumberOfDataFileTypeGroups();
+    
+    /*
+     * Read the files that permit it on worker threads.  These files
+     * are added to the brain below in the same order as if the brain
+     * had read them.
+     */
+    std::vector<const SpecFileDataFile*> selectedDataFiles;
+    for (int32_t ig = -1; ig < numFileGroups; ig++) {
+        const SpecFileDataFileTypeGroup* group = ((ig == -1)
+                                               ? sf->getDataFileTypeGroupByType(DataFileTypeEnum::PALETTE)
+                                               : sf->getDataFileTypeGroupByIndex(ig));
+        if (ig >= 0) {
+            if (group->getDataFileType() == DataFileTypeEnum::PALETTE) {
+                continue;
+            }
+        }
+        const int32_t numFiles = group->getNumberOfFiles();
+        for (int32_t iFile = 0; iFile < numFiles; iFile++) {
+            const SpecFileDataFile* dataFileInfo = group->getFileInformation(iFile);
+            if (dataFileInfo->isLoadingSelected()) {
+                selectedDataFiles.push_back(dataFileInfo);
+            }
+        }
+    }
+    std::map<const SpecFileDataFile*, CaretDataFile*> filesReadInParallel = readDataFilesInParallel(selectedDataFiles,
+                                                                                                  &progressUpdate);
+    if (progressUpdate.isCancelled()) {
+        resetBrain();
+        return;
+    }
+    
     for (int32_t ig = -1; ig < numFileGroups; ig++) {
         const SpecFileDataFileTypeGroup* group = ((ig == -1)
                                                ? sf->getDataFileTypeGroupByType(DataFileTypeEnum::PALETTE)
@@ -7432,15 +7816,28 @@ Brain::loadFilesSelectedInSpecFile(EventSpecFileReadDataFiles* readSpecFileDataF
                  * If user cancelled, reset brain and get out!
                  */
                 if (progressUpdate.isCancelled()) {
+                    for (auto& fileRead : filesReadInParallel) {
+                        delete fileRead.second;
+                    }
                     resetBrain();
                     return;
                 }
                 
                 try {
-                    readDataFile(dataFileType,
-                                 structure,
-                                 filename,
-                                 false);
+                    auto fileReadIter = filesReadInParallel.find(dataFileInfo);
+                    if (fileReadIter != filesReadInParallel.end()) {
+                        CaretDataFile* caretDataFile = fileReadIter->second;
+                        filesReadInParallel.erase(fileReadIter);
+                        addDataFileReadInParallel(caretDataFile,
+                                                  structure,
+                                                  convertFilePathNameToAbsolutePathName(filename));
+                    }
+                    else {
+                        readDataFile(dataFileType,
+                                     structure,
+                                     filename,
+                                     false);
+                    }
                 }
                 catch (const DataFileException& e) {
                     if (errorMessage.isEmpty() == false) {
@@ -7860,6 +8257,36 @@ Brain::loadSpecFileFromScene(const SceneAttributes* sceneAttributes,
     const int64_t numberOfFilesToLoad(specFileToLoad->getNumberOfFilesSelectedForLoading());
     int64_t fileLoadingCounter(1);
     const int32_t numFileGroups = specFileToLoad->getNumberOfDataFileTypeGroups();
+    
+    /*
+     * Read new files that permit it on worker threads.  Names of files
+     * in a scene on the network are changed to URLs below so these
+     * files are always read by readDataFile().
+     */
+    std::map<const SpecFileDataFile*, CaretDataFile*> filesReadInParallel;
+    if ( ! sceneFileOnNetwork) {
+        std::vector<const SpecFileDataFile*> newDataFiles;
+        for (int32_t ig = 0; ig < numFileGroups; ig++) {
+            const SpecFileDataFileTypeGroup* group = specFileToLoad->getDataFileTypeGroupByIndex(ig);
+            const int32_t numFiles = group->getNumberOfFiles();
+            for (int32_t iFile = 0; iFile < numFiles; iFile++) {
+                const SpecFileDataFile* fileInfo = group->getFileInformation(iFile);
+                if (fileInfo->isLoadingSelected()) {
+                    if (specFilesEntryToNonModifiedFile.find(fileInfo) == specFilesEntryToNonModifiedFile.end()) {
+                        newDataFiles.push_back(fileInfo);
+                    }
+                }
+            }
+        }
+        filesReadInParallel = readDataFilesInParallel(newDataFiles,
+                                                      &progressEvent);
+        if (progressEvent.isCancelled()) {
+            resetBrain(keepSceneFiles,
+                       keepSpecFile);
+            return;
+        }
+    }
+    
     for (int32_t ig = 0; ig < numFileGroups; ig++) {
         const SpecFileDataFileTypeGroup* group = specFileToLoad->getDataFileTypeGroupByIndex(ig);
         const DataFileTypeEnum::Enum dataFileType = group->getDataFileType();
@@ -7878,6 +8305,9 @@ Brain::loadSpecFileFromScene(const SceneAttributes* sceneAttributes,
                         progressEvent.setProgressMessage(msg);
                         EventManager::get()->sendEvent(progressEvent.getPointer());
                         if (progressEvent.isCancelled()) {
+                            for (auto& fileRead : filesReadInParallel) {
+                                delete fileRead.second;
+                            }
                             resetBrain(keepSceneFiles,
                                        keepSpecFile);
                             return;
@@ -7905,11 +8335,24 @@ Brain::loadSpecFileFromScene(const SceneAttributes* sceneAttributes,
                         progressEvent.setProgressMessage(msg);
                         EventManager::get()->sendEvent(progressEvent.getPointer());
                         if (progressEvent.isCancelled()) {
+                            for (auto& fileRead : filesReadInParallel) {
+                                delete fileRead.second;
+                            }
                             resetBrain(keepSceneFiles,
                                        keepSpecFile);
                             return;
                         }
                         
+                        auto fileReadIter = filesReadInParallel.find(fileInfo);
+                        if (fileReadIter != filesReadInParallel.end()) {
+                            CaretDataFile* caretDataFile = fileReadIter->second;
+                            filesReadInParallel.erase(fileReadIter);
+                            addDataFileReadInParallel(caretDataFile,
+                                                      structure,
+                                                      convertFilePathNameToAbsolutePathName(filename));
+                            continue;
+                        }
+                        
                         if (sceneFileOnNetwork) {
                             if (DataFile::isFileOnNetwork(filename) == false) {
                                 const int32_t lastSlashIndex = sceneFileName.lastIndexOf("/");
@@ -21,6 +21,7 @@
  */
 /*LICENSE_END*/
 
+#include <map>
 #include <memory>
 #include <vector>
 #include <stdint.h>
@@ -95,6 +96,7 @@ namespace caret {
     class EventDataFileRead;
     class EventDataFileReload;
     class EventDataFileReloadAll;
+    class EventProgressUpdate;
     class EventSpecFileReadDataFiles;
     class GapsAndMargins;
     class HistologySlicesFile;
@@ -123,6 +125,7 @@ namespace caret {
     class SceneFile;
     class SelectionManager;
     class SpecFile;
+    class SpecFileDataFile;
     class Surface;
     class SurfaceFile;
     class SurfaceProjectedItem;
@@ -663,6 +666,13 @@ namespace caret {
                           const AString& dataFileName,
                           const bool markDataFileAsModified);
         
+        std::map<const SpecFileDataFile*, CaretDataFile*> readDataFilesInParallel(const std::vector<const SpecFileDataFile*>& specFileDataFiles,
+                                                                                  EventProgressUpdate* progressEvent);
+        
+        void addDataFileReadInParallel(CaretDataFile* caretDataFile,
+                                       const StructureEnum::Enum structure,
+                                       const AString& dataFileName);
+        
         void sortDataFilesByFileNameNoPath();
         
         void createModelChartTwo();
@@ -72,6 +72,7 @@
 #include "CaretLogger.h"
 #include "CaretMappableDataFile.h"
 #include "CaretPreferences.h"
+#include "CaretTriangleBVH.h"
 #include "ChartableMatrixInterface.h"
 #include "ChartableMatrixSeriesInterface.h"
 #include "ChartModelDataSeries.h"
@@ -3109,8 +3110,16 @@ BrainOpenGLFixedPipeline::drawSurface(Surface* surface,
                  */
                 glPushAttrib(GL_ENABLE_BIT);
                 glDisable(GL_CULL_FACE);
-                this->drawSurfaceNodes(surface,
-                                       nodeColoringRGBA);
+                /*
+                 * When triangles are identified, the vertex is the
+                 * identified triangle's vertex nearest the mouse
+                 * (see SelectionManager::filterSelections) so the
+                 * vertices do not need to be drawn for identification
+                 */
+                if ( ! m_brain->getSelectionManager()->getSurfaceTriangleIdentification()->isEnabledForSelection()) {
+                    this->drawSurfaceNodes(surface,
+                                           nodeColoringRGBA);
+                }
                 this->drawSurfaceTriangles(surface,
                                            nodeColoringRGBA);
                 glPopAttrib();
@@ -3251,11 +3260,12 @@ BrainOpenGLFixedPipeline::drawSurfaceTriangles(Surface* surface,
     }
     
     if (isSelect) {
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        identifySurfaceTriangle(surface,
+                                triangleID,
+                                isProjection);
+        return;
     }
     
-    uint8_t rgba[4];
-    
     glBegin(GL_TRIANGLES);
     for (int32_t i = 0; i < numTriangles; i++) {
         const int32_t i3 = i * 3;
@@ -3263,255 +3273,199 @@ BrainOpenGLFixedPipeline::drawSurfaceTriangles(Surface* surface,
         const int32_t n2 = triangles[i3+1];
         const int32_t n3 = triangles[i3+2];
         
-        if (isSelect) {
-            this->colorIdentification->addItem(rgba, SelectionItemDataTypeEnum::SURFACE_TRIANGLE, i);
-            glColor3ubv(rgba);
-            glNormal3fv(&normals[n1*3]);
-            glVertex3fv(&coordinates[n1*3]);
-            glNormal3fv(&normals[n2*3]);
-            glVertex3fv(&coordinates[n2*3]);
-            glNormal3fv(&normals[n3*3]);
-            glVertex3fv(&coordinates[n3*3]);
-        }
-        else {
-            glColor4fv(&nodeColoringRGBA[n1*4]);
-            glNormal3fv(&normals[n1*3]);
-            glVertex3fv(&coordinates[n1*3]);
-            glColor4fv(&nodeColoringRGBA[n2*4]);
-            glNormal3fv(&normals[n2*3]);
-            glVertex3fv(&coordinates[n2*3]);
-            glColor4fv(&nodeColoringRGBA[n3*4]);
-            glNormal3fv(&normals[n3*3]);
-            glVertex3fv(&coordinates[n3*3]);
-        }
+        glColor4fv(&nodeColoringRGBA[n1*4]);
+        glNormal3fv(&normals[n1*3]);
+        glVertex3fv(&coordinates[n1*3]);
+        glColor4fv(&nodeColoringRGBA[n2*4]);
+        glNormal3fv(&normals[n2*3]);
+        glVertex3fv(&coordinates[n2*3]);
+        glColor4fv(&nodeColoringRGBA[n3*4]);
+        glNormal3fv(&normals[n3*3]);
+        glVertex3fv(&coordinates[n3*3]);
     }
     glEnd();
+}
+
+/**
+ * Identify the surface triangle under the mouse by intersecting the
+ * ray through the mouse position with the surface's triangles.  Unlike
+ * identification by drawing the triangles with identification colors
+ * and reading the pixels, this does not draw anything and provides
+ * the exact location of the mouse within the triangle.
+ *
+ * @param surface
+ *    Surface that is identified.
+ * @param triangleID
+ *    Receives the identified triangle, NULL in projection mode.
+ * @param isProjection
+ *    True if projecting to the surface.
+ */
+void
+BrainOpenGLFixedPipeline::identifySurfaceTriangle(Surface* surface,
+                                                  SelectionItemSurfaceTriangle* triangleID,
+                                                  const bool isProjection)
+{
+    /*
+     * Ray from the near clipping plane to the far clipping
+     * plane through the mouse position
+     */
+    const std::array<float, 4> orthoLRBT {
+        static_cast<float>(this->orthographicLeft),
+        static_cast<float>(this->orthographicRight),
+        static_cast<float>(this->orthographicBottom),
+        static_cast<float>(this->orthographicTop)
+    };
+    GraphicsObjectToWindowTransform transform;
+    loadObjectToWindowTransform(&transform,
+                                orthoLRBT,
+                                0.0,
+                                false);
+    if ( ! transform.isValid()) {
+        return;
+    }
+    float rayNearXYZ[3];
+    float rayFarXYZ[3];
+    if ( ! transform.inverseTransformPoint(this->mouseX, this->mouseY, 0.0, rayNearXYZ)) {
+        return;
+    }
+    if ( ! transform.inverseTransformPoint(this->mouseX, this->mouseY, 1.0, rayFarXYZ)) {
+        return;
+    }
+    const float rayVector[3] = {
+        rayFarXYZ[0] - rayNearXYZ[0],
+        rayFarXYZ[1] - rayNearXYZ[1],
+        rayFarXYZ[2] - rayNearXYZ[2]
+    };
     
-    if (isSelect) {
-        int32_t triangleIndex = -1;
-        float depth = -1.0;
-        this->getIndexFromColorSelection(SelectionItemDataTypeEnum::SURFACE_TRIANGLE, 
-                                         this->mouseX, 
-                                         this->mouseY,
-                                         triangleIndex,
-                                         depth);
-        
-        if (triangleIndex >= 0) {
-            bool isTriangleIdAccepted = false;
-            if (triangleID != NULL) {
-                if (triangleID->isOtherScreenDepthCloserToViewer(depth)) {
-                    triangleID->setBrain(surface->getBrainStructure()->getBrain());
-                    triangleID->setSurface(surface);
-                    triangleID->setTriangleNumber(triangleIndex);
-                    const int32_t* triangleNodeIndices = surface->getTriangle(triangleIndex);
-                    triangleID->setNearestNode(triangleNodeIndices[0]);
-                    triangleID->setScreenDepth(depth);
-                    isTriangleIdAccepted = true;
-                    CaretLogFine("Selected Triangle: " + triangleID->toString());   
-                }
-                else {
-                    CaretLogFine("Rejecting Selected Triangle but still using: " + triangleID->toString());   
-                }
+    /*
+     * Triangles are drawn without culling during identification
+     * so a triangle is hit from either side.  Hits removed by
+     * clipping planes are skipped so that the triangle behind
+     * them may be identified.
+     */
+    const std::vector<TriangleRayHit> hits = surface->getTriangleBVH()->allHits(rayNearXYZ,
+                                                                                  rayVector,
+                                                                                  1.0f);
+    const bool clippingFlag = ((this->browserTabContent != NULL)
+                               && m_clippingPlaneGroup->isEnabled()
+                               && m_clippingPlaneGroup->isSurfaceSelected());
+    const TriangleRayHit* hit = NULL;
+    for (const TriangleRayHit& rayHit : hits) {
+        if (clippingFlag) {
+            if ( ! isCoordinateInsideClippingPlanesForStructure(surface->getStructure(),
+                                                                rayHit.coords)) {
+                continue;
             }
+        }
+        hit = &rayHit;
+        break;
+    }
+    if (hit == NULL) {
+        return;
+    }
+    
+    const int32_t triangleIndex = hit->triangle;
+    const int32_t* triangleNodeIndices = surface->getTriangle(triangleIndex);
+    const int32_t n1 = triangleNodeIndices[0];
+    const int32_t n2 = triangleNodeIndices[1];
+    const int32_t n3 = triangleNodeIndices[2];
+    
+    GLdouble selectionModelviewMatrix[16];
+    glGetDoublev(GL_MODELVIEW_MATRIX, selectionModelviewMatrix);
+    
+    GLdouble selectionProjectionMatrix[16];
+    glGetDoublev(GL_PROJECTION_MATRIX, selectionProjectionMatrix);
+    
+    GLint selectionViewport[4];
+    glGetIntegerv(GL_VIEWPORT, selectionViewport);
+    
+    /*
+     * Screen depth of the hit, same as the depth buffer value
+     * compared with other identified items
+     */
+    double hitWindowXYZ[3];
+    if ( ! gluProject(hit->coords[0],
+                      hit->coords[1],
+                      hit->coords[2],
+                      selectionModelviewMatrix,
+                      selectionProjectionMatrix,
+                      selectionViewport,
+                      &hitWindowXYZ[0],
+                      &hitWindowXYZ[1],
+                      &hitWindowXYZ[2])) {
+        return;
+    }
+    const float depth = hitWindowXYZ[2];
+    
+    const float barycentricAreas[3] = {
+        hit->barycentric[0],
+        hit->barycentric[1],
+        hit->barycentric[2]
+    };
+    const int32_t barycentricNodes[3] = {
+        n1,
+        n2,
+        n3
+    };
+    
+    if (triangleID != NULL) {
+        if (triangleID->isOtherScreenDepthCloserToViewer(depth)) {
+            triangleID->setBrain(surface->getBrainStructure()->getBrain());
+            triangleID->setSurface(surface);
+            triangleID->setTriangleNumber(triangleIndex);
+            triangleID->setScreenDepth(depth);
+            this->setSelectedItemScreenXYZ(triangleID, hit->coords);
             
             /*
-             * Node indices
-             */
-            const int32_t n1 = triangles[triangleIndex*3];
-            const int32_t n2 = triangles[triangleIndex*3 + 1];
-            const int32_t n3 = triangles[triangleIndex*3 + 2];
-            
-            /*
-             * Node coordinates
+             * Nearest node is the triangle's node closest
+             * to the mouse in window coordinates
              */
-            const float* c1 = &coordinates[n1*3];
-            const float* c2 = &coordinates[n2*3];
-            const float* c3 = &coordinates[n3*3];
-            
-            const float average[3] = {
-                c1[0] + c2[0] + c3[0],
-                c1[1] + c2[1] + c3[1],
-                c1[2] + c2[2] + c3[2]
-            };
-            if (triangleID != NULL) {
-                if (isTriangleIdAccepted) {
-                    this->setSelectedItemScreenXYZ(triangleID, average);
+            double nearestDistance = -1.0;
+            for (int32_t i = 0; i < 3; i++) {
+                const int32_t nodeIndex = triangleNodeIndices[i];
+                const float* xyz = surface->getCoordinate(nodeIndex);
+                double modelXYZ[3] = { xyz[0], xyz[1], xyz[2] };
+                double windowXYZ[3];
+                if (gluProject(modelXYZ[0],
+                               modelXYZ[1],
+                               modelXYZ[2],
+                               selectionModelviewMatrix,
+                               selectionProjectionMatrix,
+                               selectionViewport,
+                               &windowXYZ[0],
+                               &windowXYZ[1],
+                               &windowXYZ[2])) {
+                    const double dist = MathFunctions::distanceSquared2D(windowXYZ[0],
+                                                                         windowXYZ[1],
+                                                                         this->mouseX,
+                                                                         this->mouseY);
+                    if ((nearestDistance < 0.0)
+                        || (dist < nearestDistance)) {
+                        nearestDistance = dist;
+                        triangleID->setNearestNode(nodeIndex);
+                        triangleID->setNearestNodeScreenXYZ(windowXYZ);
+                        triangleID->setNearestNodeModelXYZ(modelXYZ);
+                    }
                 }
             }
-                   
-            GLdouble selectionModelviewMatrix[16];
-            glGetDoublev(GL_MODELVIEW_MATRIX, selectionModelviewMatrix);
             
-            GLdouble selectionProjectionMatrix[16];
-            glGetDoublev(GL_PROJECTION_MATRIX, selectionProjectionMatrix);
-            
-            GLint selectionViewport[4];
-            glGetIntegerv(GL_VIEWPORT, selectionViewport);
-            
-            /*
-             * Window positions of each coordinate
-             */
-            double dc1[3] = { c1[0], c1[1], c1[2] };
-            double dc2[3] = { c2[0], c2[1], c2[2] };
-            double dc3[3] = { c3[0], c3[1], c3[2] };
-            double wc1[3], wc2[3], wc3[3];
-            if (gluProject(dc1[0], 
-                           dc1[1], 
-                           dc1[2],
-                           selectionModelviewMatrix,
-                           selectionProjectionMatrix,
-                           selectionViewport,
-                           &wc1[0],
-                           &wc1[1],
-                           &wc1[2])
-                && gluProject(dc2[0], 
-                              dc2[1], 
-                              dc2[2],
-                              selectionModelviewMatrix,
-                              selectionProjectionMatrix,
-                              selectionViewport,
-                              &wc2[0],
-                              &wc2[1],
-                              &wc2[2])
-                && gluProject(dc3[0], 
-                              dc3[1], 
-                              dc3[2],
-                              selectionModelviewMatrix,
-                              selectionProjectionMatrix,
-                              selectionViewport,
-                              &wc3[0],
-                              &wc3[1],
-                              &wc3[2])) {
-                    const double d1 = MathFunctions::distanceSquared2D(wc1[0], 
-                                                                       wc1[1], 
-                                                                       this->mouseX, 
-                                                                       this->mouseY);
-                    const double d2 = MathFunctions::distanceSquared2D(wc2[0], 
-                                                                       wc2[1], 
-                                                                       this->mouseX, 
-                                                                       this->mouseY);
-                    const double d3 = MathFunctions::distanceSquared2D(wc3[0], 
-                                                                       wc3[1], 
-                                                                       this->mouseX, 
-                                                                       this->mouseY);
-                    if (triangleID != NULL) {
-                        if (isTriangleIdAccepted) {
-                            triangleID->setNearestNode(n3);
-                            triangleID->setNearestNodeScreenXYZ(wc3);
-                            triangleID->setNearestNodeModelXYZ(dc3);
-                            if ((d1 < d2) && (d1 < d3)) {
-                                triangleID->setNearestNode(n1);
-                                triangleID->setNearestNodeScreenXYZ(wc1);
-                                triangleID->setNearestNodeModelXYZ(dc1);
-                            }
-                            else if ((d2 < d1) && (d2 < d3)) {
-                                triangleID->setNearestNode(n2);
-                                triangleID->setNearestNodeScreenXYZ(wc2);
-                                triangleID->setNearestNodeModelXYZ(dc2);
-                            }
-                        }
-                    }
-                    
-                    /*
-                     * Getting projected position?
-                     */
-                    if (isSelect
-                        || isProjection) {
-                        /*
-                         * Place window coordinates of triangle's nodes
-                         * onto the screen by setting Z-coordinate to zero
-                         */
-                        wc1[2] = 0.0;
-                        wc2[2] = 0.0;
-                        wc3[2] = 0.0;
-                        
-                        /*
-                         * Area of triangle when projected to display
-                         */
-                        const double triangleDisplayArea = 
-                            MathFunctions::triangleArea(wc1, wc2, wc3);
-                        
-                        /*
-                         * If area of triangle on display is small,
-                         * use a coordinate from the triangle
-                         */
-                        if (triangleDisplayArea < 0.001) {
-                            float barycentricAreas[3] = { 1.0, 0.0, 0.0 };
-                            int barycentricNodes[3] = { n1, n1, n1 };
-                            
-                            this->setProjectionModeData(depth, 
-                                                        c1, 
-                                                        surface->getStructure(), 
-                                                        barycentricAreas, 
-                                                        barycentricNodes, 
-                                                        surface->getNumberOfNodes());
-                        }
-                        else {
-                            /*
-                             * Determine position in triangle using barycentric coordinates
-                             */
-                            double displayXYZ[3] = { 
-                                (double)this->mouseX,
-                                (double)this->mouseY,
-                                0.0 
-                            };
-                            
-                            const double areaU = (MathFunctions::triangleArea(displayXYZ, wc2, wc3)
-                                                  / triangleDisplayArea);
-                            const double areaV = (MathFunctions::triangleArea(displayXYZ, wc3, wc1)
-                                                  / triangleDisplayArea);
-                            const double areaW = (MathFunctions::triangleArea(displayXYZ, wc1, wc2)
-                                                  / triangleDisplayArea);
-                            double totalArea = areaU + areaV + areaW;
-                            if (totalArea <= 0) {
-                                totalArea = 1.0;
-                            }
-                            if ((areaU < 0.0) || (areaV < 0.0) || (areaW < 0.0)) {
-                                CaretLogWarning("Invalid tile area: less than zero when projecting to surface.");
-                            }
-                            else {
-                                /*
-                                 * Convert to surface coordinates
-                                 */
-                                const float projectedXYZ[3] = {
-                                    (float)((dc1[0]*areaU + dc2[0]*areaV + dc3[0]*areaW) / totalArea),
-                                    (float)((dc1[1]*areaU + dc2[1]*areaV + dc3[1]*areaW) / totalArea),
-                                    (float)((dc1[2]*areaU + dc2[2]*areaV + dc3[2]*areaW) / totalArea)
-                                };
-                                
-                                const float barycentricAreas[3] = {
-                                    (float)areaU,
-                                    (float)areaV,
-                                    (float)areaW
-                                };
-                                
-                                const int32_t barycentricNodes[3] = {
-                                    n1,
-                                    n2,
-                                    n3
-                                };
-                            
-                                if (isSelect) {
-                                    if (triangleID != NULL) {
-                                        triangleID->setBarycentricAreas(barycentricAreas);
-                                        triangleID->setBarycentricVertices(barycentricNodes);
-                                        triangleID->setBarycentricProjectionValid(true);
-                                    }
-                                }
-                                if (isProjection) {
-                                    this->setProjectionModeData(depth,
-                                                                projectedXYZ,
-                                                                surface->getStructure(),
-                                                                barycentricAreas,
-                                                                barycentricNodes,
-                                                                surface->getNumberOfNodes());
-                                }
-                            }
-                        }
-                    }
-            }
-            CaretLogFine("Selected Triangle: " + QString::number(triangleIndex));
+            triangleID->setBarycentricAreas(barycentricAreas);
+            triangleID->setBarycentricVertices(barycentricNodes);
+            triangleID->setBarycentricProjectionValid(true);
+            CaretLogFine("Selected Triangle: " + triangleID->toString());
         }
+        else {
+            CaretLogFine("Rejecting Selected Triangle: " + QString::number(triangleIndex));
+        }
+    }
+    
+    if (isProjection) {
+        this->setProjectionModeData(depth,
+                                    hit->coords,
+                                    surface->getStructure(),
+                                    barycentricAreas,
+                                    barycentricNodes,
+                                    surface->getNumberOfNodes());
     }
 }
 
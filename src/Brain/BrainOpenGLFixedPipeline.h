@@ -81,6 +81,7 @@ namespace caret {
     class PaletteColorMapping;
     class Plane;
     class SelectionItem;
+    class SelectionItemSurfaceTriangle;
     class SelectionManager;
     class Surface;
     class SurfaceFile;
@@ -267,6 +268,10 @@ namespace caret {
         void drawSurfaceTriangles(Surface* surface,
                                   const float* nodeColoringRGBA);
         
+        void identifySurfaceTriangle(Surface* surface,
+                                     SelectionItemSurfaceTriangle* triangleID,
+                                     const bool isProjection);
+        
         void drawSurfaceNodeAttributes(Surface* surface,
                                        const int32_t viewportHeight);
         
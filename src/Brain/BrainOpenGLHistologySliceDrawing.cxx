@@ -24,10 +24,12 @@
 #undef __BRAIN_OPEN_G_L_HISTOLOGY_SLICE_DRAWING_DECLARE__
 
 #include <cmath>
+#include <set>
 #include <tuple>
 
 #include "AnnotationPercentSizeText.h"
 #include "AnnotationPointSizeText.h"
+#include "ApplicationInformation.h"
 #include "Brain.h"
 #include "BrainOpenGLFixedPipeline.h"
 #include "BrainOpenGLFociDrawing.h"
@@ -383,6 +385,80 @@ BrainOpenGLHistologySliceDrawing::draw(BrainOpenGLFixedPipeline* fixedPipelineDr
     m_fixedPipelineDrawing->checkForOpenGLError(NULL, "At end of BrainOpenGLHistologySliceDrawing::draw()");
 }
 
+/**
+ * Update the image in a CZI image file for drawing in a tab's overlay
+ * @param cziImageFile
+ *    The CZI image file
+ * @param tabIndex
+ *    Index of the tab
+ * @param overlayIndex
+ *    Index of the overlay
+ * @param transform
+ *   Transforms point from object to window space
+ */
+void
+BrainOpenGLHistologySliceDrawing::updateCziImageFileForDrawing(CziImageFile* cziImageFile,
+                                                               const int32_t tabIndex,
+                                                               const int32_t overlayIndex,
+                                                               const GraphicsObjectToWindowTransform* transform)
+{
+    CaretAssert(cziImageFile);
+    const int32_t frameIndex(0);
+    const bool allFramesSelectedFlag(true);
+    const int32_t channelIndex(0);
+    const int32_t manualPyramidLayerIndex(0);
+    cziImageFile->updateImageForDrawingInTab(tabIndex,
+                                             overlayIndex,
+                                             frameIndex,
+                                             allFramesSelectedFlag,
+                                             CziImageResolutionChangeModeEnum::AUTO2,
+                                             MediaDisplayCoordinateModeEnum::PLANE,
+                                             channelIndex,
+                                             manualPyramidLayerIndex,
+                                             transform);
+}
+
+/**
+ * Prefetch the slices adjacent to the slices that were drawn so that stepping
+ * to an adjacent slice is fast.  CZI images of adjacent slices are loaded
+ * at the current display resolution.  Only performed in the GUI since
+ * image data is loaded in background threads.
+ * @param transform
+ *   Transforms point from object to window space
+ */
+void
+BrainOpenGLHistologySliceDrawing::prefetchAdjacentSlices(const GraphicsObjectToWindowTransform* transform)
+{
+    if (ApplicationInformation::getApplicationType() != ApplicationTypeEnum::APPLICATION_TYPE_GRAPHICAL_USER_INTERFACE) {
+        return;
+    }
+    
+    std::set<std::tuple<HistologySlicesFile*, int32_t, int32_t>> prefetchedOverlays;
+    for (const auto& drawingData : m_mediaFilesAndDataToDraw) {
+        const auto key(std::make_tuple(drawingData.m_selectedFile,
+                                       drawingData.m_tabIndex,
+                                       drawingData.m_overlayIndex));
+        if (prefetchedOverlays.find(key) != prefetchedOverlays.end()) {
+            continue;
+        }
+        prefetchedOverlays.insert(key);
+        
+        CaretAssert(drawingData.m_selectedFile);
+        const std::vector<MediaFile*> mediaFiles(drawingData.m_selectedFile->prefetchAdjacentSlices(drawingData.m_tabIndex,
+                                                                                                    drawingData.m_overlayIndex,
+                                                                                                    drawingData.m_selectedSliceIndex));
+        for (MediaFile* mediaFile : mediaFiles) {
+            CziImageFile* cziImageFile(mediaFile->castToCziImageFile());
+            if (cziImageFile != NULL) {
+                updateCziImageFileForDrawing(cziImageFile,
+                                             drawingData.m_tabIndex,
+                                             drawingData.m_overlayIndex,
+                                             transform);
+            }
+        }
+    }
+}
+
 /**
  * Draw the models layers
  * @param orthographicProjection
@@ -447,19 +523,10 @@ BrainOpenGLHistologySliceDrawing::drawModelLayers(const GraphicsOrthographicProj
         ImageFile* imageFile(mediaFile->castToImageFile());
 
         if (cziImageFile != NULL) {
-            const int32_t frameIndex(0);
-            const bool allFramesSelectedFlag(true);
-            const int32_t channelIndex(0);
-            const int32_t manualPyramidLayerIndex(0);
-            cziImageFile->updateImageForDrawingInTab(drawingData.m_tabIndex,
-                                                     drawingData.m_overlayIndex,
-                                                     frameIndex,
-                                                     allFramesSelectedFlag,
-                                                     CziImageResolutionChangeModeEnum::AUTO2,
-                                                     MediaDisplayCoordinateModeEnum::PLANE,
-                                                     channelIndex,
-                                                     manualPyramidLayerIndex,
-                                                     transform);
+            updateCziImageFileForDrawing(cziImageFile,
+                                         drawingData.m_tabIndex,
+                                         drawingData.m_overlayIndex,
+                                         transform);
         }
         else if (imageFile != NULL) {
             /* nothing */
@@ -624,6 +691,10 @@ BrainOpenGLHistologySliceDrawing::drawModelLayers(const GraphicsOrthographicProj
     
     m_fixedPipelineDrawing->checkForOpenGLError(NULL, "After drawing histology slices in BrainOpenGLHistologySliceDrawing::drawModelLayers()");
     
+    if (m_fixedPipelineDrawing->mode == BrainOpenGLFixedPipeline::MODE_DRAWING) {
+        prefetchAdjacentSlices(transform);
+    }
+    
     drawVolumeOverlays();
 
     /*
@@ -37,6 +37,7 @@ namespace caret {
     class BrainOpenGLFixedPipeline;
     class BrainOpenGLViewportContent;
     class BrowserTabContent;
+    class CziImageFile;
     class GraphicsObjectToWindowTransform;
     class GraphicsOrthographicProjection;
     class GraphicsPrimitiveV3fT2f;
@@ -90,6 +91,13 @@ namespace caret {
                              const GraphicsObjectToWindowTransform* transform,
                              const Vector3D& underlayStereotaxicXYZ);
         
+        void updateCziImageFileForDrawing(CziImageFile* cziImageFile,
+                                          const int32_t tabIndex,
+                                          const int32_t overlayIndex,
+                                          const GraphicsObjectToWindowTransform* transform);
+        
+        void prefetchAdjacentSlices(const GraphicsObjectToWindowTransform* transform);
+        
         void processSelection(const int32_t tabIndex,
                               const HistologyOverlay::DrawingData& drawingData,
                               GraphicsPrimitiveV3fT2f* primitive);
@@ -252,7 +252,7 @@ HistologyOverlay::getDrawingData(const int32_t selectedSliceIndex) const
                 for (int32_t iImage = 0; iImage < numImages; iImage++) {
                     HistologySliceImage* sliceImage(slice->getHistologySliceImage(iImage));
                     CaretAssert(sliceImage);
-                    MediaFile* mediaFile(sliceImage->getMediaFile());
+                    MediaFile* mediaFile(sliceImage->getMediaFileForDrawing());
 
                     if (mediaFile != NULL) {
                         DrawingData dd(m_tabIndex,
@@ -31,6 +31,8 @@
 #include "MultiDimIterator.h"
 #include "NiftiIO.h"
 
+#include <algorithm>
+
 using namespace std;
 using namespace caret;
 
@@ -39,6 +41,7 @@ namespace
 {
     class CiftiOnDiskImpl : public CiftiFile::WriteImplInterface
     {
+    protected:
         mutable NiftiIO m_nifti;//because file objects aren't stateless (current position), so reading "changes" them
         vector<int64_t> m_matrixDims;//store the dimensions even if the xml is forgotten
         CiftiXML m_xml;//we need to store the xml somewhere before it gets put into CiftiFile's copy
@@ -48,6 +51,7 @@ namespace
                         const int16_t& datatype, const bool& rescale, const double& minval, const double& maxval);//make new empty file with read/write
         void getRow(float* dataOut, const std::vector<int64_t>& indexSelect, const bool& tolerateShortRead) const;
         void getColumn(float* dataOut, const int64_t& index) const;
+        void getColumns(float* dataOut, const int64_t& startIndex, const int64_t& count) const;
         const CiftiXML& getCiftiXML() const { return m_xml; }
         QString getFilename() const { return m_nifti.getFilename(); }
         bool isSwapped() const { return m_nifti.getHeader().isSwapped(); }
@@ -57,6 +61,20 @@ namespace
         void dropXML() { m_xml = CiftiXML(); m_nifti.dropExtensions(); }
     };
     
+    //read-only, maps the file and hands out rows directly when it is uncompressed native-endian float32 without scaling,
+    //otherwise behaves exactly like CiftiOnDiskImpl
+    class CiftiMappedImpl : public CiftiOnDiskImpl
+    {
+        const float* m_mappedData;//NULL if not mapped
+        const float* getRowStart(const std::vector<int64_t>& indexSelect) const;
+    public:
+        CiftiMappedImpl(const QString& filename);
+        void getRow(float* dataOut, const std::vector<int64_t>& indexSelect, const bool& tolerateShortRead) const;
+        void getColumn(float* dataOut, const int64_t& index) const;
+        void getColumns(float* dataOut, const int64_t& startIndex, const int64_t& count) const;
+        const float* getRowPointer(const std::vector<int64_t>& indexSelect) const;
+    };
+    
     class CiftiMemoryImpl : public CiftiFile::WriteImplInterface
     {
         MultiDimArray<float> m_array;
@@ -64,6 +82,8 @@ namespace
         CiftiMemoryImpl(const CiftiXML& xml);
         void getRow(float* dataOut, const std::vector<int64_t>& indexSelect, const bool& tolerateShortRead) const;
         void getColumn(float* dataOut, const int64_t& index) const;
+        void getColumns(float* dataOut, const int64_t& startIndex, const int64_t& count) const;
+        const float* getRowPointer(const std::vector<int64_t>& indexSelect) const { return m_array.get(1, indexSelect); }
         bool isInMemory() const { return true; }
         void setRow(const float* dataIn, const std::vector<int64_t>& indexSelect);
         void setColumn(const float* dataIn, const int64_t& index);
@@ -81,6 +101,7 @@ namespace
         CiftiXnatImpl(const QString& url);//reuse existing user/pass, or access non-protected url - in the future, maybe only the second use (private http manager)
         void getRow(float* dataOut, const std::vector<int64_t>& indexSelect, const bool& tolerateShortRead) const;
         void getColumn(float* dataOut, const int64_t& index) const;
+        void getColumns(float* dataOut, const int64_t& startIndex, const int64_t& count) const;
         const CiftiXML& getCiftiXML() const { return m_xml; }
     };
     
@@ -100,6 +121,26 @@ namespace
         return (endian == CiftiFile::ANY);
     }
     
+    //copy a range of columns out of a block of rows into column-after-column output, working on a few rows at a time so both sides stay in cache
+    void scatterRowsToColumns(const float* rows, const int64_t& rowStride, const int64_t& numRows, const int64_t& firstColumn, const int64_t& count,
+                              float* dataOut, const int64_t& columnLength, const int64_t& outRowOffset)
+    {
+        const int64_t BLOCK_ROWS = 64;
+        for (int64_t rowBase = 0; rowBase < numRows; rowBase += BLOCK_ROWS)
+        {
+            int64_t rowEnd = min(numRows, rowBase + BLOCK_ROWS);
+            for (int64_t c = 0; c < count; ++c)
+            {
+                float* colOut = dataOut + c * columnLength + outRowOffset;
+                const float* colIn = rows + firstColumn + c;
+                for (int64_t r = rowBase; r < rowEnd; ++r)
+                {
+                    colOut[r] = colIn[r * rowStride];
+                }
+            }
+        }
+    }
+    
 }
 
 CiftiFile::ReadImplInterface::~ReadImplInterface()
@@ -120,7 +161,7 @@ CiftiFile::CiftiFile(const QString& fileName)
 void CiftiFile::openFile(const QString& fileName)
 {
     close();//to make sure it closes everything first, even if the open throws
-    CaretPointer<CiftiOnDiskImpl> newRead(new CiftiOnDiskImpl(FileInformation(fileName).getAbsoluteFilePath()));//this constructor opens existing file read-only
+    CaretPointer<CiftiOnDiskImpl> newRead(new CiftiMappedImpl(FileInformation(fileName).getAbsoluteFilePath()));//opens existing file read-only, maps it if the data is usable without conversion
     m_readingImpl = newRead;//it should be noted that if the constructor throws (if the file isn't readable), new guarantees the memory allocated for the object will be freed
     m_xml = newRead->getCiftiXML();
     newRead->dropXML();//save some memory, we don't need 2 copies of the xml - figure out if there is a better way to prevent copies
@@ -267,6 +308,22 @@ void CiftiFile::getColumn(float* dataOut, const int64_t& index) const
     m_readingImpl->getColumn(dataOut, index);
 }
 
+const float* CiftiFile::getRowPointer(const vector<int64_t>& indexSelect) const
+{
+    if (m_dims.empty()) throw DataFileException("getRowPointer called on uninitialized CiftiFile");
+    if (m_readingImpl == NULL) return NULL;
+    return m_readingImpl->getRowPointer(indexSelect);
+}
+
+void CiftiFile::getColumns(float* dataOut, const int64_t& startIndex, const int64_t& count) const
+{
+    if (m_dims.empty()) throw DataFileException("getColumns called on uninitialized CiftiFile");
+    if (m_dims.size() != 2) throw DataFileException("getColumns called on non-2D CiftiFile");
+    if (startIndex < 0 || count < 0 || startIndex + count > m_dims[0]) throw DataFileException("getColumns called with invalid column range");
+    if (m_readingImpl == NULL || count == 0) return;//NOT an error because we are pretending to have a matrix already, while we are waiting for setRow to actually start writing the file
+    m_readingImpl->getColumns(dataOut, startIndex, count);
+}
+
 void CiftiFile::setCiftiXML(const CiftiXML& xml, const bool useOldMetadata)
 {
     if (xml.getNumberOfDimensions() == 0) throw DataFileException("setCiftiXML called with 0-dimensional CiftiXML");
@@ -360,6 +417,15 @@ void CiftiFile::getRow(float* dataOut, const int64_t& index) const
     getRow(dataOut, index, false);//once CiftiInterface is gone, we can collapse this into a default value
 }
 
+const float* CiftiFile::getRowPointer(const int64_t& index) const
+{
+    if (m_dims.empty()) throw DataFileException("getRowPointer called on uninitialized CiftiFile");
+    if (m_dims.size() != 2) throw DataFileException("getRowPointer with single index called on non-2D CiftiFile");
+    if (m_readingImpl == NULL) return NULL;
+    vector<int64_t> tempvec(1, index);
+    return m_readingImpl->getRowPointer(tempvec);
+}
+
 int64_t CiftiFile::getNumberOfRows() const
 {
     if (m_dims.empty()) throw DataFileException("getNumberOfRows called on uninitialized CiftiFile");
@@ -468,6 +534,16 @@ void CiftiMemoryImpl::getColumn(float* dataOut, const int64_t& index) const
     }
 }
 
+void CiftiMemoryImpl::getColumns(float* dataOut, const int64_t& startIndex, const int64_t& count) const
+{
+    CaretAssert(m_array.getDimensions().size() == 2);//otherwise, CiftiFile shouldn't have called this
+    const float* ref = m_array.get(2, vector<int64_t>());
+    int64_t rowSize = m_array.getDimensions()[0];
+    int64_t colSize = m_array.getDimensions()[1];
+    CaretAssert(startIndex >= 0 && startIndex + count <= rowSize);
+    scatterRowsToColumns(ref, rowSize, colSize, startIndex, count, dataOut, colSize, 0);
+}
+
 void CiftiMemoryImpl::setRow(const float* dataIn, const vector<int64_t>& indexSelect)
 {
     float* ref = m_array.get(1, indexSelect);
@@ -736,6 +812,33 @@ void CiftiOnDiskImpl::getColumn(float* dataOut, const int64_t& index) const
     }
 }
 
+void CiftiOnDiskImpl::getColumns(float* dataOut, const int64_t& startIndex, const int64_t& count) const
+{
+    CaretAssert(m_matrixDims.size() == 2);//otherwise this shouldn't be called
+    CaretAssert(startIndex >= 0 && count > 0 && startIndex + count <= m_matrixDims[0]);
+    const int64_t STRIP_BYTES = 1<<26;//64MiB of file data per read, so memory use doesn't depend on the file size
+    int64_t rowSize = m_matrixDims[0], colLength = m_matrixDims[1];
+    bool wholeRows = (count * 2 > rowSize);//if we need most of each row, reading the gaps too is cheaper than one read per row
+    int64_t readWidth = (wholeRows ? rowSize : count);
+    int64_t stripRows = max((int64_t)1, STRIP_BYTES / (readWidth * (int64_t)sizeof(float)));
+    if (stripRows > colLength) stripRows = colLength;
+    vector<float> strip(stripRows * readWidth);
+    for (int64_t rowStart = 0; rowStart < colLength; rowStart += stripRows)
+    {
+        int64_t numStripRows = min(stripRows, colLength - rowStart);
+        if (wholeRows)
+        {
+            m_nifti.readElements(strip.data(), rowStart * rowSize, numStripRows * rowSize);//rows are contiguous in the file, so this is a single read
+        } else {
+            for (int64_t r = 0; r < numStripRows; ++r)
+            {
+                m_nifti.readElements(strip.data() + r * readWidth, (rowStart + r) * rowSize + startIndex, count);
+            }
+        }
+        scatterRowsToColumns(strip.data(), readWidth, numStripRows, (wholeRows ? startIndex : 0), count, dataOut, colLength, rowStart);
+    }
+}
+
 void CiftiOnDiskImpl::setRow(const float* dataIn, const vector<int64_t>& indexSelect)
 {
     m_nifti.writeData(dataIn, 5, indexSelect);
@@ -756,6 +859,89 @@ void CiftiOnDiskImpl::setColumn(const float* dataIn, const int64_t& index)
     }
 }
 
+CiftiMappedImpl::CiftiMappedImpl(const QString& filename) : CiftiOnDiskImpl(filename)
+{
+    m_mappedData = NULL;
+    if (!m_nifti.isDataNativeFloat32()) return;
+    const char* mapped = m_nifti.getMappedData();//NULL if compressed, or the OS won't map it
+    if (mapped == NULL) return;
+    if (((uintptr_t)mapped) % sizeof(float) != 0)
+    {
+        CaretLogFine("cifti file '" + filename + "' has unaligned data offset, not using memory mapping");
+        return;
+    }
+    int64_t dataBytes = sizeof(float);
+    for (int i = 0; i < (int)m_matrixDims.size(); ++i)
+    {
+        dataBytes *= m_matrixDims[i];
+    }
+    int64_t fileSize = m_nifti.getFileSize();
+    if (fileSize < 0 || m_nifti.getHeader().getDataOffset() + dataBytes > fileSize)
+    {//reading past the end of the mapping would crash, the on-disk reads report the short file instead
+        CaretLogFine("cifti file '" + filename + "' is shorter than its data, not using memory mapping");
+        return;
+    }
+    m_mappedData = (const float*)mapped;
+}
+
+const float* CiftiMappedImpl::getRowStart(const vector<int64_t>& indexSelect) const
+{
+    CaretAssert(indexSelect.size() + 1 == m_matrixDims.size());
+    int64_t rowIndex = 0, stride = 1;
+    for (int i = 0; i < (int)indexSelect.size(); ++i)
+    {
+        CaretAssert(indexSelect[i] >= 0 && indexSelect[i] < m_matrixDims[i + 1]);
+        rowIndex += indexSelect[i] * stride;
+        stride *= m_matrixDims[i + 1];
+    }
+    return m_mappedData + rowIndex * m_matrixDims[0];
+}
+
+void CiftiMappedImpl::getRow(float* dataOut, const vector<int64_t>& indexSelect, const bool& tolerateShortRead) const
+{
+    if (m_mappedData == NULL)
+    {
+        CiftiOnDiskImpl::getRow(dataOut, indexSelect, tolerateShortRead);
+        return;
+    }
+    const float* rowStart = getRowStart(indexSelect);//only mapped when the file holds all the data, so tolerateShortRead never matters here
+    copy(rowStart, rowStart + m_matrixDims[0], dataOut);
+}
+
+void CiftiMappedImpl::getColumn(float* dataOut, const int64_t& index) const
+{
+    if (m_mappedData == NULL)
+    {
+        CiftiOnDiskImpl::getColumn(dataOut, index);
+        return;
+    }
+    CaretAssert(m_matrixDims.size() == 2);//otherwise this shouldn't be called
+    CaretAssert(index >= 0 && index < m_matrixDims[0]);
+    int64_t rowSize = m_matrixDims[0], colLength = m_matrixDims[1];
+    for (int64_t i = 0; i < colLength; ++i)//only touches one page per row, like the on-disk version
+    {
+        dataOut[i] = m_mappedData[index + rowSize * i];
+    }
+}
+
+void CiftiMappedImpl::getColumns(float* dataOut, const int64_t& startIndex, const int64_t& count) const
+{
+    if (m_mappedData == NULL)
+    {
+        CiftiOnDiskImpl::getColumns(dataOut, startIndex, count);
+        return;
+    }
+    CaretAssert(m_matrixDims.size() == 2);//otherwise this shouldn't be called
+    CaretAssert(startIndex >= 0 && startIndex + count <= m_matrixDims[0]);
+    scatterRowsToColumns(m_mappedData, m_matrixDims[0], m_matrixDims[1], startIndex, count, dataOut, m_matrixDims[1], 0);
+}
+
+const float* CiftiMappedImpl::getRowPointer(const vector<int64_t>& indexSelect) const
+{
+    if (m_mappedData == NULL) return NULL;
+    return getRowStart(indexSelect);
+}
+
 CiftiXnatImpl::CiftiXnatImpl(const QString& url, const QString& user, const QString& pass)
 {
     CaretHttpManager::setAuthentication(url, user, pass);
@@ -905,3 +1091,12 @@ void CiftiXnatImpl::getColumn(float* dataOut, const int64_t& index) const
     columnRequest.m_queries.push_back(make_pair(AString("column-index"), AString::number(index)));
     getReqAsFloats(dataOut, m_xml.getDimensionLength(CiftiXML::ALONG_COLUMN), columnRequest);
 }
+
+void CiftiXnatImpl::getColumns(float* dataOut, const int64_t& startIndex, const int64_t& count) const
+{
+    int64_t colLength = m_xml.getDimensionLength(CiftiXML::ALONG_COLUMN);
+    for (int64_t c = 0; c < count; ++c)
+    {
+        getColumn(dataOut + c * colLength, startIndex + c);
+    }
+}
@@ -70,6 +70,8 @@ namespace caret
             return MultiDimIterator<int64_t>(std::vector<int64_t>(m_dims.begin() + 1, m_dims.end()));
         }
         void getColumn(float* dataOut, const int64_t& index) const;//for 2D only, will be slow if on disk!
+        void getColumns(float* dataOut, const int64_t& startIndex, const int64_t& count) const;//for 2D only, columns are output one after another, reads strips of rows when on disk
+        const float* getRowPointer(const std::vector<int64_t>& indexSelect) const;//returns NULL if the row can't be accessed without a copy, use getRow() in that case
         
         void setCiftiXML(const CiftiXML& xml, const bool useOldMetadata = true);
         void setCiftiXML(const CiftiXMLOld &xml, const bool useOldMetadata = true);//set xml from old implementation
@@ -82,6 +84,7 @@ namespace caret
         
         void getRow(float* dataOut, const int64_t& index, const bool& tolerateShortRead) const;//backwards compatibility for old CiftiFile/CiftiInterface
         void getRow(float* dataOut, const int64_t& index) const;
+        const float* getRowPointer(const int64_t& index) const;
         int64_t getNumberOfRows() const;
         int64_t getNumberOfColumns() const;
         
@@ -94,7 +97,9 @@ namespace caret
         public:
             virtual void getRow(float* dataOut, const std::vector<int64_t>& indexSelect, const bool& tolerateShortRead) const = 0;
             virtual void getColumn(float* dataOut, const int64_t& index) const = 0;
+            virtual void getColumns(float* dataOut, const int64_t& startIndex, const int64_t& count) const = 0;
             virtual bool isInMemory() const { return false; }
+            virtual const float* getRowPointer(const std::vector<int64_t>&) const { return NULL; }//zero-copy access, for implementations that have the data as native floats
             virtual ~ReadImplInterface();
         };
         //assume if you can write to it, you can also read from it
@@ -644,6 +644,10 @@ CommandOperationManager::runCommand(ProgramParameters& parameters)
     {
         caret_global_command_options.m_ciftiReadMemory = true;
     }
+    if (getGlobalOption(parameters, "-smoothing-weight-cache", 1, globalOptionArgs))
+    {
+        caret_global_command_options.m_smoothingWeightCacheDirectory = globalOptionArgs[0];
+    }
 
     const uint64_t numberOfCommands = this->commandOperations.size();
     const uint64_t numberOfDeprecated = this->deprecatedOperations.size();
@@ -798,7 +802,12 @@ AString CommandOperationManager::doCompletion(ProgramParameters& parameters, con
         return "";
     }
     /*OptionInfo ciftiReadMemInfo = */parseGlobalOption(parameters, "-cifti-read-memory", 0, globalOptionArgs, true);
-    ret = "wordlist -disable-provenance\\ -logging\\ -simd\\ -cifti-output-datatype\\ -cifti-output-range\\ -nifti-output-datatype\\ -nifti-output-range\\ -cifti-read-memory";//we could prevent suggesting an already-provided global option, but that would be a bit surprising
+    OptionInfo smoothCacheInfo = parseGlobalOption(parameters, "-smoothing-weight-cache", 1, globalOptionArgs, true);//the previous option doesn't take arguments, doesn't need completion testing
+    if (smoothCacheInfo.specified && !smoothCacheInfo.complete)
+    {
+        return "fileglob *";
+    }
+    ret = "wordlist -disable-provenance\\ -logging\\ -simd\\ -cifti-output-datatype\\ -cifti-output-range\\ -nifti-output-datatype\\ -nifti-output-range\\ -cifti-read-memory\\ -smoothing-weight-cache";//we could prevent suggesting an already-provided global option, but that would be a bit surprising
     const uint64_t numberOfCommands = this->commandOperations.size();
     const uint64_t numberOfDeprecated = this->deprecatedOperations.size();
     if (!parameters.hasNext())
@@ -1197,6 +1206,11 @@ void CommandOperationManager::printGlobalOptions()
     cout << "                                        avoid hitting limits on number of open" << endl;
     cout << "                                        files" << endl;
     cout << endl;
+    cout << "   -smoothing-weight-cache <dir>     save surface smoothing weights in the" << endl;
+    cout << "                                        given directory, and reuse them when" << endl;
+    cout << "                                        the surface, roi, method and kernel" << endl;
+    cout << "                                        match a previous run" << endl;
+    cout << endl;
     cout << "   -cifti-output-datatype <type>     deprecated, only affects cifti outputs" << endl;
     cout << "   -cifti-output-range <min> <max>   deprecated, only affects cifti outputs" << endl;
     cout << endl;
@@ -233,6 +233,42 @@ int Base64::DecodeTriplet(unsigned char i0,
   return 3;
 }
 
+//----------------------------------------------------------------------------
+// Decode groups of 4 characters that contain no padding into 3 bytes each,
+// testing the validity of a group with a single branch.  Stops at the first
+// group containing an invalid or padding character so that the remaining
+// characters can be decoded by DecodeTriplet().  Returns the number of
+// groups decoded.
+static uint64_t DecodeQuadsWithoutPadding(const unsigned char *input,
+                                          unsigned char *output,
+                                          const uint64_t max_quads)
+{
+  uint64_t i = 0;
+  for (; i < max_quads; i++)
+    {
+    const unsigned char *ptr = input + i * 4;
+    const uint32_t d0 = Base64DecodeTable[ptr[0]];
+    const uint32_t d1 = Base64DecodeTable[ptr[1]];
+    const uint32_t d2 = Base64DecodeTable[ptr[2]];
+    const uint32_t d3 = Base64DecodeTable[ptr[3]];
+    
+    // Invalid characters decode to 0xFF and '=' decodes to 0x00
+    
+    if (((d0 | d1 | d2 | d3) & 0xC0)
+        || (ptr[2] == '=') || (ptr[3] == '='))
+      {
+      break;
+      }
+    
+    const uint32_t bits = (d0 << 18) | (d1 << 12) | (d2 << 6) | d3;
+    unsigned char *optr = output + i * 3;
+    optr[0] = static_cast<unsigned char>(bits >> 16);
+    optr[1] = static_cast<unsigned char>(bits >> 8);
+    optr[2] = static_cast<unsigned char>(bits);
+    }
+  return i;
+}
+
 //----------------------------------------------------------------------------
 uint64_t Base64::decode(const unsigned char *input, 
                              uint64_t length, 
@@ -247,6 +283,14 @@ uint64_t Base64::decode(const unsigned char *input,
   if (max_input_length)
     {
     const unsigned char *end = input + max_input_length;
+    
+    // Last group may contain padding, leave it to DecodeTriplet()
+    
+    const uint64_t num_quads =
+      DecodeQuadsWithoutPadding(ptr, optr,
+                                (max_input_length > 4) ? ((max_input_length - 1) / 4) : 0);
+    ptr  += num_quads * 4;
+    optr += num_quads * 3;
     while (ptr < end)
       {
       int len = 
@@ -263,6 +307,14 @@ uint64_t Base64::decode(const unsigned char *input,
   else 
     {
     unsigned char *oend = output + length;
+    
+    // Last triplet may be partial, leave it to DecodeTriplet()
+    
+    const uint64_t num_quads =
+      DecodeQuadsWithoutPadding(ptr, optr,
+                                (length > 3) ? ((length - 1) / 3) : 0);
+    ptr  += num_quads * 4;
+    optr += num_quads * 3;
     while ((oend - optr) >= 3)
       {
       int len = 
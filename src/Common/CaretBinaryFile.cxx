@@ -29,14 +29,20 @@
 #include "CaretBinaryFile.h"
 #include "CaretLogger.h"
 #include "DataFileException.h"
+#include "GzipSeekIndex.h"
 
 #include <QDir>
 #include <QFile>
 #include "zlib.h"
 
+#include <cerrno>
 #include <cstdio>
 #include <algorithm>
 
+#ifndef CARET_OS_WINDOWS
+#include <unistd.h>
+#endif
+
 using namespace caret;
 using namespace std;
 
@@ -47,9 +53,11 @@ namespace caret
     class ZFileImpl : public CaretBinaryFile::ImplInterface
     {
         gzFile m_zfile;
+        CaretPointer<GzipSeekIndex> m_index;//used instead of m_zfile when reading gzip data, so seeking doesn't restart decompression, and threads can read at once
+        int64_t m_indexPos;
         const static int64_t CHUNK_SIZE;
     public:
-        ZFileImpl() { m_zfile = NULL; }
+        ZFileImpl() { m_zfile = NULL; m_indexPos = 0; }
         void open(const QString& filename, const CaretBinaryFile::OpenMode& opmode);
         void close();
         void seek(const int64_t& position);
@@ -57,6 +65,8 @@ namespace caret
         int64_t size() { return -1; }
         void read(void* dataOut, const int64_t& count, int64_t* numRead);
         void write(const void* dataIn, const int64_t& count);
+        void readAt(const int64_t& position, void* dataOut, const int64_t& count, int64_t* numRead);
+        bool supportsConcurrentRead() { return m_index != NULL; }
         ~ZFileImpl();
     };
     
@@ -66,8 +76,11 @@ namespace caret
     class QFileImpl : public CaretBinaryFile::ImplInterface
     {
         QFile m_file;
+        bool m_readOnly;//positional reads bypass QFile's buffering, so only allow them when nothing can be waiting in a write buffer
+        uchar* m_mapping;
         const static int64_t CHUNK_SIZE;
     public:
+        QFileImpl() { m_readOnly = false; m_mapping = NULL; }
         void open(const QString& filename, const CaretBinaryFile::OpenMode& opmode);
         void close();
         void seek(const int64_t& position);
@@ -75,6 +88,9 @@ namespace caret
         int64_t size() { return m_file.size(); }
         void read(void* dataOut, const int64_t& count, int64_t* numRead);
         void write(const void* dataIn, const int64_t& count);
+        void readAt(const int64_t& position, void* dataOut, const int64_t& count, int64_t* numRead);
+        bool supportsConcurrentRead();
+        const char* mapReadOnly();
     };
     
     const int64_t QFileImpl::CHUNK_SIZE = 1<<30;//1GiB, QT4 apparently chokes at more than 2GiB via buffer.read using int32
@@ -138,6 +154,26 @@ void CaretBinaryFile::read(void* dataOut, const int64_t& count, int64_t* numRead
     m_impl->read(dataOut, count, numRead);
 }
 
+void CaretBinaryFile::readAt(const int64_t& position, void* dataOut, const int64_t& count, int64_t* numRead)
+{
+    CaretAssert(position >= 0);
+    CaretAssert(count >= 0);
+    if (!getOpenForRead()) throw DataFileException("file is not open for reading");
+    m_impl->readAt(position, dataOut, count, numRead);
+}
+
+bool CaretBinaryFile::supportsConcurrentRead()
+{
+    if (!getOpenForRead()) return false;
+    return m_impl->supportsConcurrentRead();
+}
+
+const char* CaretBinaryFile::mapReadOnly()
+{
+    if (m_curMode != READ) return NULL;//writing through a mapping isn't something we want to support
+    return m_impl->mapReadOnly();
+}
+
 void CaretBinaryFile::seek(const int64_t& position)
 {
     CaretAssert(position >= 0);
@@ -183,6 +219,15 @@ void ZFileImpl::open(const QString& filename, const CaretBinaryFile::OpenMode& o
         default:
             throw DataFileException("compressed file only supports READ and WRITE_TRUNCATE modes");
     }
+    if (opmode == CaretBinaryFile::READ)
+    {
+        m_index = GzipSeekIndex::getIndex(filename);
+        if (m_index != NULL)
+        {
+            m_indexPos = 0;
+            return;
+        }//if it isn't gzip data (or doesn't exist), let gzopen deal with it
+    }
 #if !defined(CARET_OS_MACOSX) && ZLIB_VERNUM > 0x1232
     m_zfile = gzopen64(filename.toLocal8Bit().constData(), mode);
 #else
@@ -205,6 +250,8 @@ void ZFileImpl::open(const QString& filename, const CaretBinaryFile::OpenMode& o
 
 void ZFileImpl::close()
 {
+    m_index.grabNew(NULL);
+    m_indexPos = 0;
     if (m_zfile == NULL) return;//happens when closed and then destroyed, error opening
     if (gzclose(m_zfile) != 0) throw DataFileException("error closing compressed file '" + m_fileName + "'");
     m_zfile = NULL;
@@ -212,6 +259,18 @@ void ZFileImpl::close()
 
 void ZFileImpl::read(void* dataOut, const int64_t& count, int64_t* numRead)
 {
+    if (m_index != NULL)
+    {
+        int64_t totalRead = m_index->readAt(m_indexPos, dataOut, count);
+        m_indexPos += totalRead;
+        if (numRead == NULL)
+        {
+            if (totalRead != count) throw DataFileException("premature end of file in compressed file '" + m_fileName + "'");
+        } else {
+            *numRead = totalRead;
+        }
+        return;
+    }
     if (m_zfile == NULL) throw DataFileException("read called on unopened ZFileImpl");//shouldn't happen
     int64_t totalRead = 0;
     int readret = 0;//to preserve the info of the read that broke early
@@ -234,8 +293,30 @@ void ZFileImpl::read(void* dataOut, const int64_t& count, int64_t* numRead)
     }
 }
 
+void ZFileImpl::readAt(const int64_t& position, void* dataOut, const int64_t& count, int64_t* numRead)
+{
+    if (m_index == NULL)
+    {
+        seek(position);
+        read(dataOut, count, numRead);
+        return;
+    }
+    int64_t totalRead = m_index->readAt(position, dataOut, count);//doesn't touch m_indexPos, so it is fine to call this from multiple threads
+    if (numRead == NULL)
+    {
+        if (totalRead != count) throw DataFileException("premature end of file in compressed file '" + m_fileName + "'");
+    } else {
+        *numRead = totalRead;
+    }
+}
+
 void ZFileImpl::seek(const int64_t& position)
 {
+    if (m_index != NULL)
+    {
+        m_indexPos = position;
+        return;
+    }
     if (m_zfile == NULL) throw DataFileException("seek called on unopened ZFileImpl");//shouldn't happen
     if (pos() == position) return;//slight hack, since gzseek is slow or nonfunctional for some cases, so don't try it unless necessary
 #if !defined(CARET_OS_MACOSX) && ZLIB_VERNUM > 0x1232
@@ -248,6 +329,7 @@ void ZFileImpl::seek(const int64_t& position)
 
 int64_t ZFileImpl::pos()
 {
+    if (m_index != NULL) return m_indexPos;
     if (m_zfile == NULL) throw DataFileException("pos called on unopened ZFileImpl");//shouldn't happen
 #if !defined(CARET_OS_MACOSX) && ZLIB_VERNUM > 0x1232
     return gztell64(m_zfile);
@@ -289,6 +371,7 @@ void QFileImpl::open(const QString& filename, const CaretBinaryFile::OpenMode& o
 {
     close();//don't need to, but just because
     m_fileName = filename;
+    m_readOnly = (opmode == CaretBinaryFile::READ);
     QIODevice::OpenMode mode = QIODevice::NotOpen;//means 0
     if (opmode & CaretBinaryFile::READ) mode |= QIODevice::ReadOnly;
     if (opmode & CaretBinaryFile::WRITE) mode |= QIODevice::WriteOnly;
@@ -328,6 +411,11 @@ void QFileImpl::open(const QString& filename, const CaretBinaryFile::OpenMode& o
 void QFileImpl::close()
 {
     if (!m_file.isOpen()) return; //not sure what flush() does if file isn't open, so let's not try it
+    if (m_mapping != NULL)
+    {
+        m_file.unmap(m_mapping);
+        m_mapping = NULL;
+    }
     //WARNING: QFileDevice::close() calls flush, ignores if it fails, then closes
     //so flush manually and check its error condition instead
     if (!m_file.flush()) throw DataFileException("failed to flush file '" + m_file.fileName() + "' before closing, data may be corrupted");
@@ -357,6 +445,60 @@ void QFileImpl::read(void* dataOut, const int64_t& count, int64_t* numRead)
     }
 }
 
+bool QFileImpl::supportsConcurrentRead()
+{
+#ifdef CARET_OS_WINDOWS
+    return false;//no pread, and the CRT file position is shared
+#else
+    return m_readOnly && m_file.isOpen() && m_file.handle() != -1;
+#endif
+}
+
+const char* QFileImpl::mapReadOnly()
+{
+    if (m_mapping != NULL) return (const char*)m_mapping;
+    if (!m_readOnly || !m_file.isOpen() || m_file.size() <= 0) return NULL;
+    m_mapping = m_file.map(0, m_file.size());//returns NULL on failure, such as a 32-bit address space, or a filesystem that doesn't support it
+    if (m_mapping == NULL)
+    {
+        CaretLogFine("unable to memory map file '" + m_fileName + "': " + m_file.errorString());
+    }
+    return (const char*)m_mapping;
+}
+
+void QFileImpl::readAt(const int64_t& position, void* dataOut, const int64_t& count, int64_t* numRead)
+{
+#ifndef CARET_OS_WINDOWS
+    if (supportsConcurrentRead())
+    {//pread doesn't touch the shared file offset, so many threads can read different parts of the file at once
+        int fd = m_file.handle();
+        int64_t total = 0;
+        int64_t readret = -1;
+        while (total < count)
+        {
+            int64_t maxToRead = min(count - total, CHUNK_SIZE);
+            readret = pread(fd, ((char*)dataOut) + total, maxToRead, position + total);
+            if (readret < 0 && errno == EINTR) continue;
+            if (readret < 1) break;//0 or -1 means eof or error
+            total += readret;
+        }
+        if (numRead == NULL)
+        {
+            if (total != count)
+            {
+                if (readret < 0) throw DataFileException("error while reading file '" + m_fileName + "'");
+                throw DataFileException("premature end of file in '" + m_fileName + "'");
+            }
+        } else {
+            *numRead = total;
+        }
+        return;
+    }
+#endif
+    seek(position);
+    read(dataOut, count, numRead);
+}
+
 void QFileImpl::seek(const int64_t& position)
 {
     if (m_file.pos() == position) return; //QFile::seek always does a flush in qt5, so try to avoid calling it
@@ -54,6 +54,9 @@ namespace caret {
         void seek(const int64_t& position);
         int64_t pos();
         void read(void* dataOut, const int64_t& count, int64_t* numRead = NULL);//throw if numRead is NULL and (error or end of file reached early)
+        void readAt(const int64_t& position, void* dataOut, const int64_t& count, int64_t* numRead = NULL);//same as seek + read, but doesn't use the current position when supportsConcurrentRead() is true
+        bool supportsConcurrentRead();//true if readAt() can be called from multiple threads at once without external locking
+        const char* mapReadOnly();//maps the whole file, returns NULL if not possible (compressed, opened for writing, etc), valid until close()
         void write(const void* dataIn, const int64_t& count);//failure to complete write is always an exception
         int64_t size();//may return -1 if size cannot be determined efficiently
         class ImplInterface
@@ -69,6 +72,10 @@ namespace caret {
             virtual int64_t size() = 0;
             virtual void read(void* dataOut, const int64_t& count, int64_t* numRead) = 0;
             virtual void write(const void* dataIn, const int64_t& count) = 0;
+            //default positional read changes the current position, so it is not thread-safe
+            virtual void readAt(const int64_t& position, void* dataOut, const int64_t& count, int64_t* numRead) { seek(position); read(dataOut, count, numRead); }
+            virtual bool supportsConcurrentRead() { return false; }
+            virtual const char* mapReadOnly() { return NULL; }
             virtual ~ImplInterface();
         };
     private:
@@ -0,0 +1,95 @@
+#ifndef __CARET_BLOCKING_QUEUE_H__
+#define __CARET_BLOCKING_QUEUE_H__
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+namespace caret
+{
+    
+    ///thread-safe FIFO for handing work from one thread to another
+    ///to bound memory use in a pipeline, pass indices of preallocated buffers, and send used ones back through a second queue
+    template<typename T>
+    class CaretBlockingQueue
+    {
+        std::deque<T> m_items;
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        bool m_closed;
+        CaretBlockingQueue(const CaretBlockingQueue&);
+        CaretBlockingQueue& operator=(const CaretBlockingQueue&);
+    public:
+        CaretBlockingQueue() { m_closed = false; }
+        
+        ///returns false if the queue has been closed, in which case the item was not added
+        bool push(const T& item)
+        {
+            {
+                std::lock_guard<std::mutex> myLock(m_mutex);
+                if (m_closed) return false;
+                m_items.push_back(item);
+            }
+            m_condition.notify_one();
+            return true;
+        }
+        
+        ///waits for an item, returns false once the queue is closed and empty
+        bool pop(T& itemOut)
+        {
+            std::unique_lock<std::mutex> myLock(m_mutex);
+            while (m_items.empty() && !m_closed)
+            {
+                m_condition.wait(myLock);
+            }
+            if (m_items.empty()) return false;
+            itemOut = m_items.front();
+            m_items.pop_front();
+            return true;
+        }
+        
+        ///end of input, items already queued can still be popped
+        void close()
+        {
+            {
+                std::lock_guard<std::mutex> myLock(m_mutex);
+                m_closed = true;
+            }
+            m_condition.notify_all();
+        }
+        
+        ///for errors, drops anything queued so that all waiting threads return immediately
+        void abort()
+        {
+            {
+                std::lock_guard<std::mutex> myLock(m_mutex);
+                m_closed = true;
+                m_items.clear();
+            }
+            m_condition.notify_all();
+        }
+    };
+    
+}
+
+#endif //__CARET_BLOCKING_QUEUE_H__
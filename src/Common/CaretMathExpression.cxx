@@ -23,11 +23,17 @@
 #include "CaretLogger.h"
 #include "CaretMathExpression.h"
 
+#include <algorithm>
 #include <cmath>
 
 using namespace caret;
 using namespace std;
 
+namespace
+{
+    const int EVAL_BLOCK_SIZE = 256;//elements per slot in evaluateBlock, small enough that all slots stay in cache
+}
+
 CaretMathExpression::CaretMathExpression(const AString& expression)
 {
     m_input = expression;
@@ -38,6 +44,8 @@ CaretMathExpression::CaretMathExpression(const AString& expression)
     {
         throw CaretException("extra characters on end of expression: '" + m_input.mid(m_position) + "'");
     }
+    m_numSlots = 0;
+    compileNode(*m_root, 0);
     CaretLogFiner("parsed '" + expression + "' as '" + toString() + "'");
 }
 
@@ -47,6 +55,380 @@ double CaretMathExpression::evaluate(const vector<float>& variableValues) const
     return m_root->eval(variableValues);
 }
 
+void CaretMathExpression::evaluateBlock(const vector<const float*>& variableArrays, float* dataOut, const int64_t& count) const
+{
+    CaretAssert(variableArrays.size() == m_varNames.size());
+    vector<double> slots(m_numSlots * EVAL_BLOCK_SIZE);//double, so results are identical to evaluate()
+    for (int64_t start = 0; start < count; start += EVAL_BLOCK_SIZE)
+    {
+        int thisCount = (int)min(int64_t(EVAL_BLOCK_SIZE), count - start);
+        for (int i = 0; i < (int)m_program.size(); ++i)
+        {
+            m_program[i].run(slots.data(), variableArrays, start, thisCount);
+        }
+        for (int j = 0; j < thisCount; ++j)
+        {
+            dataOut[start + j] = (float)slots[j];
+        }
+    }
+}
+
+void CaretMathExpression::compileNode(const MathNode& node, const int& slot)
+{
+    if (slot + 1 > m_numSlots) m_numSlots = slot + 1;
+    switch (node.m_type)
+    {
+        case MathNode::OR:
+        case MathNode::AND:
+        case MathNode::EQUAL:
+        case MathNode::GREATERLESS:
+        case MathNode::ADDSUB:
+        case MathNode::MULTDIV:
+        {//chains evaluate left to right, keeping the running result in slot
+            int end = (int)node.m_arguments.size();
+            CaretAssert(end > 1);
+            compileNode(*(node.m_arguments[0]), slot);
+            for (int i = 1; i < end; ++i)
+            {
+                compileNode(*(node.m_arguments[i]), slot + 1);
+                MathInstruction::OpCode op = MathInstruction::ADD;
+                switch (node.m_type)
+                {
+                    case MathNode::OR:
+                        op = MathInstruction::OR;
+                        break;
+                    case MathNode::AND:
+                        op = MathInstruction::AND;
+                        break;
+                    case MathNode::EQUAL:
+                        CaretAssert((int)node.m_invert.size() == end);
+                        op = (node.m_invert[i] ? MathInstruction::NOT_EQUAL : MathInstruction::EQUAL);
+                        break;
+                    case MathNode::GREATERLESS:
+                        CaretAssert((int)node.m_invert.size() == end);
+                        CaretAssert((int)node.m_inclusive.size() == end);
+                        if (node.m_inclusive[i])
+                        {
+                            op = (node.m_invert[i] ? MathInstruction::LESS_EQUAL : MathInstruction::GREATER_EQUAL);
+                        } else {
+                            op = (node.m_invert[i] ? MathInstruction::LESS : MathInstruction::GREATER);
+                        }
+                        break;
+                    case MathNode::ADDSUB:
+                        CaretAssert((int)node.m_invert.size() == end);
+                        op = (node.m_invert[i] ? MathInstruction::SUBTRACT : MathInstruction::ADD);
+                        break;
+                    case MathNode::MULTDIV:
+                        CaretAssert((int)node.m_invert.size() == end);
+                        op = (node.m_invert[i] ? MathInstruction::DIVIDE : MathInstruction::MULTIPLY);
+                        break;
+                    default:
+                        CaretAssert(0);
+                        break;
+                }
+                m_program.push_back(MathInstruction(op, slot));
+            }
+            break;
+        }
+        case MathNode::NOT:
+            CaretAssert(node.m_arguments.size() == 1);
+            compileNode(*(node.m_arguments[0]), slot);
+            m_program.push_back(MathInstruction(MathInstruction::NOT, slot));
+            break;
+        case MathNode::NEGATE:
+            CaretAssert(node.m_arguments.size() == 1);
+            compileNode(*(node.m_arguments[0]), slot);
+            m_program.push_back(MathInstruction(MathInstruction::NEGATE, slot));
+            break;
+        case MathNode::POW:
+            CaretAssert(node.m_arguments.size() == 2);
+            compileNode(*(node.m_arguments[0]), slot);
+            compileNode(*(node.m_arguments[1]), slot + 1);
+            m_program.push_back(MathInstruction(MathInstruction::POW, slot));
+            break;
+        case MathNode::FUNC:
+        {
+            CaretAssert(node.m_arguments.size() <= 3);
+            for (int i = 0; i < (int)node.m_arguments.size(); ++i)
+            {
+                compileNode(*(node.m_arguments[i]), slot + i);
+            }
+            MathInstruction inst(MathInstruction::FUNC, slot);
+            inst.m_function = node.m_function;
+            m_program.push_back(inst);
+            break;
+        }
+        case MathNode::VAR:
+        {
+            MathInstruction inst(MathInstruction::LOAD_VAR, slot);
+            inst.m_varIndex = node.m_varIndex;
+            m_program.push_back(inst);
+            break;
+        }
+        case MathNode::CONST:
+        {
+            MathInstruction inst(MathInstruction::LOAD_CONST, slot);
+            inst.m_constVal = node.m_constVal;
+            m_program.push_back(inst);
+            break;
+        }
+        case MathNode::INVALID:
+            CaretAssertMessage(0, "parsing left INVALID MathNode");
+            throw CaretException("parsing problem in CaretMathExpression");
+    }
+}
+
+//NOTE: must give the same results as MathNode::eval, including the fudge factor in comparisons and the manual implementations of some functions
+void CaretMathExpression::MathInstruction::run(double* slots, const vector<const float*>& variableArrays, const int64_t& offset, const int& count) const
+{
+    double* a = slots + m_slot * EVAL_BLOCK_SIZE;
+    const double* b = a + EVAL_BLOCK_SIZE;
+    const double* c = b + EVAL_BLOCK_SIZE;
+    switch (m_op)
+    {
+        case LOAD_VAR:
+        {
+            CaretAssertVectorIndex(variableArrays, m_varIndex);
+            const float* varData = variableArrays[m_varIndex] + offset;
+            for (int j = 0; j < count; ++j)
+            {
+                a[j] = varData[j];
+            }
+            break;
+        }
+        case LOAD_CONST:
+            for (int j = 0; j < count; ++j)
+            {
+                a[j] = m_constVal;
+            }
+            break;
+        case OR:
+            for (int j = 0; j < count; ++j)
+            {
+                a[j] = ((a[j] > 0.0 || b[j] > 0.0) ? 1.0 : 0.0);
+            }
+            break;
+        case AND:
+            for (int j = 0; j < count; ++j)
+            {
+                a[j] = ((a[j] > 0.0 && b[j] > 0.0) ? 1.0 : 0.0);
+            }
+            break;
+        case EQUAL:
+        case NOT_EQUAL:
+        {
+            double equalVal = (m_op == EQUAL ? 1.0 : 0.0);
+            for (int j = 0; j < count; ++j)
+            {
+                float adjust = min(abs(a[j]), abs(b[j])) / 1000000;
+                bool equal = (a[j] >= b[j] - adjust) && (a[j] <= b[j] + adjust);
+                a[j] = (equal ? equalVal : 1.0 - equalVal);
+            }
+            break;
+        }
+        case GREATER:
+            for (int j = 0; j < count; ++j)
+            {
+                a[j] = (a[j] > b[j] ? 1.0 : 0.0);
+            }
+            break;
+        case LESS:
+            for (int j = 0; j < count; ++j)
+            {
+                a[j] = (a[j] < b[j] ? 1.0 : 0.0);
+            }
+            break;
+        case GREATER_EQUAL:
+            for (int j = 0; j < count; ++j)
+            {
+                float adjust = min(abs(a[j]), abs(b[j])) / 1000000;
+                a[j] = (a[j] >= b[j] - adjust ? 1.0 : 0.0);
+            }
+            break;
+        case LESS_EQUAL:
+            for (int j = 0; j < count; ++j)
+            {
+                float adjust = min(abs(a[j]), abs(b[j])) / 1000000;
+                a[j] = (a[j] <= b[j] + adjust ? 1.0 : 0.0);
+            }
+            break;
+        case ADD:
+            for (int j = 0; j < count; ++j)
+            {
+                a[j] += b[j];
+            }
+            break;
+        case SUBTRACT:
+            for (int j = 0; j < count; ++j)
+            {
+                a[j] -= b[j];
+            }
+            break;
+        case MULTIPLY:
+            for (int j = 0; j < count; ++j)
+            {
+                a[j] *= b[j];
+            }
+            break;
+        case DIVIDE:
+            for (int j = 0; j < count; ++j)
+            {
+                a[j] /= b[j];
+            }
+            break;
+        case NOT:
+            for (int j = 0; j < count; ++j)
+            {
+                a[j] = (a[j] > 0.0 ? 0.0 : 1.0);
+            }
+            break;
+        case NEGATE:
+            for (int j = 0; j < count; ++j)
+            {
+                a[j] = -a[j];
+            }
+            break;
+        case POW:
+            for (int j = 0; j < count; ++j)
+            {
+                a[j] = pow(a[j], b[j]);
+            }
+            break;
+        case FUNC:
+            switch (m_function)
+            {
+                case MathFunctionEnum::SIN:
+                    for (int j = 0; j < count; ++j) a[j] = sin(a[j]);
+                    break;
+                case MathFunctionEnum::COS:
+                    for (int j = 0; j < count; ++j) a[j] = cos(a[j]);
+                    break;
+                case MathFunctionEnum::TAN:
+                    for (int j = 0; j < count; ++j) a[j] = tan(a[j]);
+                    break;
+                case MathFunctionEnum::ASIN:
+                    for (int j = 0; j < count; ++j) a[j] = asin(a[j]);
+                    break;
+                case MathFunctionEnum::ACOS:
+                    for (int j = 0; j < count; ++j) a[j] = acos(a[j]);
+                    break;
+                case MathFunctionEnum::ATAN:
+                    for (int j = 0; j < count; ++j) a[j] = atan(a[j]);
+                    break;
+                case MathFunctionEnum::SINH:
+                    for (int j = 0; j < count; ++j) a[j] = sinh(a[j]);
+                    break;
+                case MathFunctionEnum::COSH:
+                    for (int j = 0; j < count; ++j) a[j] = cosh(a[j]);
+                    break;
+                case MathFunctionEnum::TANH:
+                    for (int j = 0; j < count; ++j) a[j] = tanh(a[j]);
+                    break;
+                case MathFunctionEnum::ASINH:
+                    for (int j = 0; j < count; ++j)
+                    {
+                        double arg = a[j];
+                        if (arg > 0)
+                        {
+                            a[j] = log(arg + sqrt(arg * arg + 1));
+                        } else {
+                            a[j] = -log(-arg + sqrt(arg * arg + 1));
+                        }
+                    }
+                    break;
+                case MathFunctionEnum::ACOSH:
+                    for (int j = 0; j < count; ++j) a[j] = log(a[j] + sqrt(a[j] * a[j] - 1));
+                    break;
+                case MathFunctionEnum::ATANH:
+                    for (int j = 0; j < count; ++j) a[j] = 0.5 * log((1 + a[j]) / (1 - a[j]));
+                    break;
+                case MathFunctionEnum::SINC:
+                    for (int j = 0; j < count; ++j)
+                    {
+                        if (a[j] == 0.0)
+                        {
+                            a[j] = 1.0;
+                        } else {
+                            a[j] = sin(a[j]) / a[j];
+                        }
+                    }
+                    break;
+                case MathFunctionEnum::LN:
+                    for (int j = 0; j < count; ++j) a[j] = log(a[j]);
+                    break;
+                case MathFunctionEnum::EXP:
+                    for (int j = 0; j < count; ++j) a[j] = exp(a[j]);
+                    break;
+                case MathFunctionEnum::LOG:
+                    for (int j = 0; j < count; ++j) a[j] = log10(a[j]);
+                    break;
+                case MathFunctionEnum::LOG2:
+                    for (int j = 0; j < count; ++j) a[j] = log2(a[j]);
+                    break;
+                case MathFunctionEnum::SQRT:
+                    for (int j = 0; j < count; ++j) a[j] = sqrt(a[j]);
+                    break;
+                case MathFunctionEnum::ABS:
+                    for (int j = 0; j < count; ++j) a[j] = abs(a[j]);
+                    break;
+                case MathFunctionEnum::FLOOR:
+                    for (int j = 0; j < count; ++j) a[j] = floor(a[j]);
+                    break;
+                case MathFunctionEnum::ROUND:
+                    for (int j = 0; j < count; ++j)
+                    {
+                        if (a[j] > 0.0)
+                        {
+                            a[j] = floor(a[j] + 0.5);
+                        } else {
+                            a[j] = ceil(a[j] - 0.5);
+                        }
+                    }
+                    break;
+                case MathFunctionEnum::CEIL:
+                    for (int j = 0; j < count; ++j) a[j] = ceil(a[j]);
+                    break;
+                case MathFunctionEnum::ATAN2:
+                    for (int j = 0; j < count; ++j) a[j] = atan2(a[j], b[j]);
+                    break;
+                case MathFunctionEnum::MIN:
+                    for (int j = 0; j < count; ++j)
+                    {
+                        if (a[j] > b[j]) a[j] = b[j];
+                    }
+                    break;
+                case MathFunctionEnum::MAX:
+                    for (int j = 0; j < count; ++j)
+                    {
+                        if (a[j] < b[j]) a[j] = b[j];
+                    }
+                    break;
+                case MathFunctionEnum::MOD:
+                    for (int j = 0; j < count; ++j)
+                    {
+                        if (b[j] == 0.0)
+                        {
+                            a[j] = 0.0;
+                        } else {
+                            a[j] = a[j] - b[j] * floor(a[j] / b[j]);
+                        }
+                    }
+                    break;
+                case MathFunctionEnum::CLAMP:
+                    for (int j = 0; j < count; ++j)
+                    {
+                        if (a[j] < b[j]) a[j] = b[j];
+                        if (a[j] > c[j]) a[j] = c[j];
+                    }
+                    break;
+                case MathFunctionEnum::INVALID:
+                    CaretAssertMessage(0, "MathInstruction is type FUNC but INVALID function");
+                    throw CaretException("parsing problem in CaretMathExpression");
+            }
+            break;
+    }
+}
+
 vector<AString> CaretMathExpression::getVarNames() const
 {
     vector<AString> ret(m_varNames.size());
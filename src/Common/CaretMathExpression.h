@@ -28,6 +28,8 @@
 #include <map>
 #include <vector>
 
+#include <stdint.h>
+
 namespace caret {
 
 class CaretMathExpression
@@ -63,10 +65,44 @@ class CaretMathExpression
         double eval(const std::vector<float>& values) const;
         AString toString(const std::vector<AString>& varNames, bool addParens = true) const;
     };
+    struct MathInstruction
+    {//one step of the flattened expression, operating on a block of elements at once
+        enum OpCode
+        {
+            LOAD_VAR,
+            LOAD_CONST,
+            OR,
+            AND,
+            EQUAL,
+            NOT_EQUAL,
+            GREATER,
+            LESS,
+            GREATER_EQUAL,
+            LESS_EQUAL,
+            ADD,
+            SUBTRACT,
+            MULTIPLY,
+            DIVIDE,
+            NOT,
+            NEGATE,
+            POW,
+            FUNC
+        };
+        OpCode m_op;
+        int m_slot;//result goes here, operands are read from m_slot, m_slot + 1, m_slot + 2
+        int m_varIndex;
+        double m_constVal;
+        MathFunctionEnum::Enum m_function;
+        MathInstruction(const OpCode& op, const int& slot) { m_op = op; m_slot = slot; m_varIndex = -1; m_constVal = 0.0; m_function = MathFunctionEnum::INVALID; }
+        void run(double* slots, const std::vector<const float*>& variableArrays, const int64_t& offset, const int& count) const;
+    };
     std::map<AString, int> m_varNames;
     AString m_input;
     int m_position, m_end;
     CaretPointer<MathNode> m_root;
+    std::vector<MathInstruction> m_program;//postorder, so operands are always computed before they are used
+    int m_numSlots;
+    void compileNode(const MathNode& node, const int& slot);
     bool skipWhitespace();
     bool accept(const char& c);
     void expect(const char& c, const int& exprStart);
@@ -87,6 +123,8 @@ public:
     static bool getNamedConstant(const AString& name, double& valueOut);
     CaretMathExpression(const AString& expression);
     double evaluate(const std::vector<float>& variableValues) const;
+    ///evaluates count elements, each variable is a contiguous array in the order of getVarNames(), faster than evaluate() in a loop, and safe to call from multiple threads
+    void evaluateBlock(const std::vector<const float*>& variableArrays, float* dataOut, const int64_t& count) const;
     std::vector<AString> getVarNames() const;
     AString toString() const;//the expression, with a lot of parentheses added
 };
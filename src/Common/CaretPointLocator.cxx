@@ -19,12 +19,79 @@
 /*LICENSE_END*/
 
 #include "CaretPointLocator.h"
+#include "CaretAssert.h"
 #include "CaretHeap.h"
+#include "CaretOMP.h"
+
+#include <algorithm>
 #include <cmath>
 
 using namespace caret;
 using namespace std;
 
+namespace
+{
+    ///spread the low 10 bits of the input so that there are 2 zero bits between each
+    uint32_t mortonSpreadBits(uint32_t value)
+    {
+        value &= 0x3ff;
+        value = (value | (value << 16)) & 0x30000ff;
+        value = (value | (value << 8)) & 0x300f00f;
+        value = (value | (value << 4)) & 0x30c30c3;
+        value = (value | (value << 2)) & 0x9249249;
+        return value;
+    }
+    
+    ///order in which to run a batch of queries so that consecutive queries are near each other, and therefore visit mostly the same Octs
+    vector<int64_t> spatialQueryOrder(const float* targets, const int64_t numTargets)
+    {
+        vector<int64_t> ret(numTargets);
+        if (numTargets < 1) return ret;
+        Vector3D minBox, maxBox;
+        minBox = maxBox = targets;
+        for (int64_t i = 1; i < numTargets; ++i)
+        {
+            int64_t i3 = i * 3;
+            for (int j = 0; j < 3; ++j)
+            {
+                if (targets[i3 + j] < minBox[j]) minBox[j] = targets[i3 + j];
+                if (targets[i3 + j] > maxBox[j]) maxBox[j] = targets[i3 + j];
+            }
+        }
+        float scale[3];
+        for (int j = 0; j < 3; ++j)
+        {
+            float range = maxBox[j] - minBox[j];
+            scale[j] = (range > 0.0f ? 1023.0f / range : 0.0f);
+        }
+        vector<pair<uint32_t, int64_t> > codes(numTargets);
+        for (int64_t i = 0; i < numTargets; ++i)
+        {
+            int64_t i3 = i * 3;
+            uint32_t code = 0;
+            for (int j = 0; j < 3; ++j)
+            {
+                float scaled = (targets[i3 + j] - minBox[j]) * scale[j];//NaN fails both tests below, and is put in cell 0
+                uint32_t cell = 0;
+                if (scaled >= 1023.0f)
+                {
+                    cell = 1023;
+                } else if (scaled > 0.0f) {
+                    cell = (uint32_t)scaled;
+                }
+                code |= mortonSpreadBits(cell) << j;
+            }
+            codes[i] = make_pair(code, i);
+        }
+        sort(codes.begin(), codes.end());
+        for (int64_t i = 0; i < numTargets; ++i)
+        {
+            ret[i] = codes[i].second;
+        }
+        return ret;
+    }
+}
+
 void CaretPointLocator::addPoint(Oct<LeafVector<Point> >* thisOct, const float point[3], const int64_t index, const int32_t pointSet)
 {
     if (thisOct->m_leaf)
@@ -70,6 +137,79 @@ void CaretPointLocator::addPoint(Oct<LeafVector<Point> >* thisOct, const float p
     }
 }
 
+void CaretPointLocator::bulkLoad(Oct<LeafVector<Point> >* thisOct, vector<Point>& points)
+{
+    CaretAssert(thisOct->m_leaf && thisOct->m_data.m_vector->empty());
+    vector<pair<Oct<LeafVector<Point> >*, vector<Point> > > parallelJobs;
+    bulkLoadHelper(thisOct, points, 0, &parallelJobs);
+    int64_t numJobs = (int64_t)parallelJobs.size();
+#pragma omp CARET_PARFOR schedule(dynamic)
+    for (int64_t i = 0; i < numJobs; ++i)
+    {
+        bulkLoadHelper(parallelJobs[i].first, parallelJobs[i].second, -1, NULL);//subtrees don't share any Octs, so they can be built at the same time
+    }
+}
+
+void CaretPointLocator::bulkLoadHelper(Oct<LeafVector<Point> >* thisOct, vector<Point>& points, const int depth, vector<pair<Oct<LeafVector<Point> >*, vector<Point> > >* parallelJobs)
+{
+    if (parallelJobs != NULL && depth >= BULK_LOAD_PARALLEL_DEPTH)
+    {
+        parallelJobs->push_back(make_pair(thisOct, vector<Point>()));
+        parallelJobs->back().second.swap(points);
+        return;
+    }
+    int64_t curSize = (int64_t)points.size();
+    bool safeToSplit = false;
+    if (curSize > NUM_POINTS_SPLIT)
+    {//same test as addPoint, so the tree has the same shape as when adding the points one at a time
+        Vector3D minBox = points[0].m_point, maxBox = points[0].m_point, tempvec;
+        tempvec[0] = thisOct->m_bounds[0][2] - thisOct->m_bounds[0][0];
+        tempvec[1] = thisOct->m_bounds[1][2] - thisOct->m_bounds[1][0];
+        tempvec[2] = thisOct->m_bounds[2][2] - thisOct->m_bounds[2][0];
+        float diagonal = tempvec.length();
+        for (int64_t i = 1; i < curSize; ++i)
+        {
+            if (points[i].m_point[0] < minBox[0]) minBox[0] = points[i].m_point[0];
+            if (points[i].m_point[1] < minBox[1]) minBox[1] = points[i].m_point[1];
+            if (points[i].m_point[2] < minBox[2]) minBox[2] = points[i].m_point[2];
+            if (points[i].m_point[0] > maxBox[0]) maxBox[0] = points[i].m_point[0];
+            if (points[i].m_point[1] > maxBox[1]) maxBox[1] = points[i].m_point[1];
+            if (points[i].m_point[2] > maxBox[2]) maxBox[2] = points[i].m_point[2];
+            tempvec = minBox - maxBox;
+            if (tempvec.length() > 0.01f * diagonal)//make sure points aren't all identical, would go to infinity recursively
+            {
+                safeToSplit = true;
+                break;
+            }
+        }
+    }
+    if (!safeToSplit)
+    {
+        thisOct->m_data.m_vector->swap(points);
+        return;
+    }
+    thisOct->makeChildren();
+    thisOct->m_data.freeData();
+    vector<Point> childPoints[2][2][2];
+    int whichOct[3];
+    for (int64_t i = 0; i < curSize; ++i)
+    {
+        thisOct->containingChild(points[i].m_point, whichOct);
+        childPoints[whichOct[0]][whichOct[1]][whichOct[2]].push_back(points[i]);
+    }
+    vector<Point>().swap(points);//free memory before recursing
+    for (int ii = 0; ii < 2; ++ii)
+    {
+        for (int ij = 0; ij < 2; ++ij)
+        {
+            for (int ik = 0; ik < 2; ++ik)
+            {
+                bulkLoadHelper(thisOct->m_children[ii][ij][ik], childPoints[ii][ij][ik], depth + 1, parallelJobs);
+            }
+        }
+    }
+}
+
 int32_t CaretPointLocator::addPointSet(const float* coordsIn, const int64_t numCoords)
 {
     CaretMutexLocker locked(&m_modifyMutex);
@@ -90,6 +230,14 @@ int32_t CaretPointLocator::addPointSet(const float* coordsIn, const int64_t numC
             if (coordsIn[i3 + 2] > maxBox[2]) maxBox[2] = coordsIn[i3 + 2];
         }
         m_tree = new Oct<LeafVector<Point> >(minBox, maxBox);
+        vector<Point> points;
+        points.reserve(numCoords);
+        for (int64_t i = 0; i < numCoords; ++i)
+        {
+            points.push_back(Point(coordsIn + i * 3, i, setNum));
+        }
+        bulkLoad(m_tree, points);
+        return setNum;
     }
     for (int64_t i = 0; i < numCoords; ++i)
     {
@@ -119,11 +267,13 @@ CaretPointLocator::CaretPointLocator(const float* coordsIn, const int64_t numCoo
             if (coordsIn[i3 + 2] > maxBox[2]) maxBox[2] = coordsIn[i3 + 2];
         }
         m_tree = new Oct<LeafVector<Point> >(minBox, maxBox);
+        vector<Point> points;
+        points.reserve(numCoords);
         for (int64_t i = 0; i < numCoords; ++i)
         {
-            int64_t i3 = i * 3;
-            addPoint(m_tree, coordsIn + i3, i, 0);//this is set #0
+            points.push_back(Point(coordsIn + i * 3, i, 0));//this is set #0
         }
+        bulkLoad(m_tree, points);
     }
 }
 
@@ -350,6 +500,50 @@ bool CaretPointLocator::anyInRange(const float target[3], const float& maxDist)
     return false;
 }
 
+vector<int64_t> CaretPointLocator::closestPointBatch(const float* targets, const int64_t numTargets, vector<LocatorInfo>* infoOut) const
+{
+    vector<int64_t> ret(numTargets, -1);
+    if (infoOut != NULL) infoOut->assign(numTargets, LocatorInfo());
+    if (m_tree == NULL || numTargets < 1) return ret;
+    vector<int64_t> order = spatialQueryOrder(targets, numTargets);
+#pragma omp CARET_PARFOR schedule(dynamic, 256)
+    for (int64_t i = 0; i < numTargets; ++i)
+    {
+        int64_t which = order[i];
+        ret[which] = closestPoint(targets + which * 3, (infoOut != NULL ? &((*infoOut)[which]) : NULL));
+    }
+    return ret;
+}
+
+vector<int64_t> CaretPointLocator::closestPointLimitedBatch(const float* targets, const int64_t numTargets, const float& maxDist, vector<LocatorInfo>* infoOut) const
+{
+    vector<int64_t> ret(numTargets, -1);
+    if (infoOut != NULL) infoOut->assign(numTargets, LocatorInfo());
+    if (m_tree == NULL || numTargets < 1) return ret;
+    vector<int64_t> order = spatialQueryOrder(targets, numTargets);
+#pragma omp CARET_PARFOR schedule(dynamic, 256)
+    for (int64_t i = 0; i < numTargets; ++i)
+    {
+        int64_t which = order[i];
+        ret[which] = closestPointLimited(targets + which * 3, maxDist, (infoOut != NULL ? &((*infoOut)[which]) : NULL));
+    }
+    return ret;
+}
+
+vector<vector<LocatorInfo> > CaretPointLocator::pointsInRangeBatch(const float* targets, const int64_t numTargets, const float& maxDist) const
+{
+    vector<vector<LocatorInfo> > ret(numTargets);
+    if (m_tree == NULL || numTargets < 1) return ret;
+    vector<int64_t> order = spatialQueryOrder(targets, numTargets);
+#pragma omp CARET_PARFOR schedule(dynamic, 64)
+    for (int64_t i = 0; i < numTargets; ++i)
+    {
+        int64_t which = order[i];
+        ret[which] = pointsInRange(targets + which * 3, maxDist);
+    }
+    return ret;
+}
+
 int32_t CaretPointLocator::newIndex()
 {
     if (m_unusedIndexes.empty())
@@ -27,6 +27,7 @@
 #include "Vector3D.h"
 
 #include <set>
+#include <utility>
 #include <vector>
 
 namespace caret {
@@ -72,6 +73,10 @@ namespace caret {
         int32_t newIndex();
         static const int NUM_POINTS_SPLIT = 100;
         void removeSetHelper(Oct<LeafVector<Point> >* thisOct, const int32_t thisSet);
+        ///build the tree below an empty leaf from all of its points at once, top levels are split serially and the resulting subtrees are built in parallel
+        void bulkLoad(Oct<LeafVector<Point> >* thisOct, std::vector<Point>& points);
+        void bulkLoadHelper(Oct<LeafVector<Point> >* thisOct, std::vector<Point>& points, const int depth, std::vector<std::pair<Oct<LeafVector<Point> >*, std::vector<Point> > >* parallelJobs);
+        static const int BULK_LOAD_PARALLEL_DEPTH = 2;//64 subtrees to distribute across threads
         CaretPointLocator();
     public:
         ///make an empty point locator with given bounding box (bounding box can expand later, but may be less efficient
@@ -91,6 +96,11 @@ namespace caret {
         int64_t closestPointLimited(const float target[3], const float& maxDist, LocatorInfo* infoOut = NULL) const;
         std::vector<LocatorInfo> pointsInRange(const float target[3], const float& maxDist) const;
         bool anyInRange(const float target[3], const float& maxDist) const;
+        ///batch versions of the above queries, targets contains numTargets coordinate triples, queries are run in spatial (Morton) order across threads
+        ///outputs are in the same order as the targets
+        std::vector<int64_t> closestPointBatch(const float* targets, const int64_t numTargets, std::vector<LocatorInfo>* infoOut = NULL) const;
+        std::vector<int64_t> closestPointLimitedBatch(const float* targets, const int64_t numTargets, const float& maxDist, std::vector<LocatorInfo>* infoOut = NULL) const;
+        std::vector<std::vector<LocatorInfo> > pointsInRangeBatch(const float* targets, const int64_t numTargets, const float& maxDist) const;
     };
 }
 
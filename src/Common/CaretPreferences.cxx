@@ -106,6 +106,12 @@ CaretPreferences::CaretPreferences()
                                                       CaretPreferenceDataValue::SavedInScene::SAVE_NO,
                                                       s_defaultCziDimension));
     
+    m_mediaTileCacheSizeMegabytes.reset(new CaretPreferenceDataValue(this->qSettings,
+                                                                     "mediaTileCacheSizeMegabytes",
+                                                                     CaretPreferenceDataValue::DataType::INTEGER,
+                                                                     CaretPreferenceDataValue::SavedInScene::SAVE_NO,
+                                                                     s_defaultMediaTileCacheSizeMegabytes));
+    
     m_volumeSurfaceOutlineSeparation.reset(new CaretPreferenceDataValue(this->qSettings,
                                                                         "volumeSurfaceOutlineSeparation",
                                                                         CaretPreferenceDataValue::DataType::FLOAT,
@@ -1823,6 +1829,27 @@ CaretPreferences::setCziDimension(const int32_t dimension)
     m_cziDimension->setValue(dimension);
 }
 
+/**
+ * @return Maximum size, in megabytes, of the image tiles that are kept in memory for
+ * each CZI or OME-ZARR file and shared by all tabs and overlays displaying the file
+ */
+int32_t
+CaretPreferences::getMediaTileCacheSizeMegabytes() const
+{
+    return m_mediaTileCacheSizeMegabytes->getValue().toInt();
+}
+
+/**
+ * Set the maximum size, in megabytes, of the image tiles kept in memory for each CZI or OME-ZARR file
+ * @param sizeMegabytes
+ *    New size
+ */
+void
+CaretPreferences::setMediaTileCacheSizeMegabytes(const int32_t sizeMegabytes)
+{
+    m_mediaTileCacheSizeMegabytes->setValue(sizeMegabytes);
+}
+
 /**
  * @return The volume surface outline separartion
  */
@@ -326,6 +326,10 @@ namespace caret {
         
         static void getSupportedCziDimensions(std::vector<std::pair<int32_t, QString>>& supportedValuesOut);
         
+        int32_t getMediaTileCacheSizeMegabytes() const;
+        
+        void setMediaTileCacheSizeMegabytes(const int32_t sizeMegabytes);
+        
         WuQMacroGroup* getMacros();
         
         const WuQMacroGroup* getMacros() const;
@@ -504,6 +508,8 @@ namespace caret {
         
         std::unique_ptr<CaretPreferenceDataValue> m_cziDimension;
         
+        std::unique_ptr<CaretPreferenceDataValue> m_mediaTileCacheSizeMegabytes;
+        
         std::unique_ptr<CaretPreferenceDataValue> m_identificationStereotaxicDistance;
         
         std::unique_ptr<CaretPreferenceDataValue> m_imageFileTextureCompressionEnabled;
@@ -614,6 +620,8 @@ namespace caret {
         
         static const int32_t s_defaultCziDimension = 2048;
         
+        static const int32_t s_defaultMediaTileCacheSizeMegabytes = 512;
+        
 
         
     };
@@ -0,0 +1,58 @@
+#ifndef __CARET_SPAN_H__
+#define __CARET_SPAN_H__
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "CaretAssert.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace caret
+{
+
+    ///read-only view of a piece of a contiguous array, for returning parts of flattened (compressed row) storage without copying
+    ///converts to a vector for callers that want their own copy, but keep it as a span when just reading
+    template <typename T>
+    class CaretSpan
+    {
+        const T* m_data;
+        size_t m_size;
+    public:
+        CaretSpan() : m_data(NULL), m_size(0) { }
+        CaretSpan(const T* data, const size_t& size) : m_data(data), m_size(size) { }
+        
+        const T* data() const { return m_data; }
+        size_t size() const { return m_size; }
+        bool empty() const { return m_size == 0; }
+        const T* begin() const { return m_data; }
+        const T* end() const { return m_data + m_size; }
+        const T& operator[](const size_t& index) const
+        {
+            CaretAssert(index < m_size);
+            return m_data[index];
+        }
+        operator std::vector<T>() const { return std::vector<T>(m_data, m_data + m_size); }
+    };
+
+}
+
+#endif //__CARET_SPAN_H__
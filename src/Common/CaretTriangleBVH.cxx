@@ -0,0 +1,252 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "CaretTriangleBVH.h"
+#include "CaretAssert.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace caret;
+using namespace std;
+
+CaretTriangleBVH::CaretTriangleBVH(const float* coordsIn, const int64_t numCoords, const int32_t* trianglesIn, const int64_t numTriangles)
+{
+    CaretAssert(numTriangles < numeric_limits<int32_t>::max());
+    m_coords.assign(coordsIn, coordsIn + numCoords * 3);
+    m_triangles.assign(trianglesIn, trianglesIn + numTriangles * 3);
+    vector<Vector3D> centroids(numTriangles);
+    m_triangleOrder.reserve(numTriangles);
+    for (int32_t i = 0; i < numTriangles; ++i)
+    {
+        const int32_t* tri = m_triangles.data() + i * 3;
+        bool valid = true;
+        for (int j = 0; j < 3; ++j)
+        {
+            if (tri[j] < 0 || tri[j] >= numCoords) valid = false;
+        }
+        if (!valid) continue;//triangles with invalid vertices can't be hit
+        centroids[i] = (Vector3D(m_coords.data() + tri[0] * 3) + Vector3D(m_coords.data() + tri[1] * 3) + Vector3D(m_coords.data() + tri[2] * 3)) / 3.0f;
+        m_triangleOrder.push_back(i);
+    }
+    if (m_triangleOrder.empty()) return;
+    m_nodes.reserve(2 * (m_triangleOrder.size() / (LEAF_SIZE / 2)) + 1);
+    m_nodes.push_back(Node());
+    buildHelper(0, 0, m_triangleOrder.size(), centroids, 0);
+}
+
+void CaretTriangleBVH::buildHelper(const int32_t nodeIndex, const int32_t start, const int32_t end, const vector<Vector3D>& centroids, const int depth)
+{
+    CaretAssert(end > start);
+    float minBounds[3], maxBounds[3], minCentroid[3], maxCentroid[3];
+    for (int j = 0; j < 3; ++j)
+    {
+        minBounds[j] = minCentroid[j] = numeric_limits<float>::max();
+        maxBounds[j] = maxCentroid[j] = -numeric_limits<float>::max();
+    }
+    for (int32_t i = start; i < end; ++i)
+    {
+        const int32_t triangle = m_triangleOrder[i];
+        const int32_t* tri = m_triangles.data() + triangle * 3;
+        for (int k = 0; k < 3; ++k)
+        {
+            const float* coord = m_coords.data() + tri[k] * 3;
+            for (int j = 0; j < 3; ++j)
+            {
+                minBounds[j] = min(minBounds[j], coord[j]);
+                maxBounds[j] = max(maxBounds[j], coord[j]);
+            }
+        }
+        for (int j = 0; j < 3; ++j)
+        {
+            minCentroid[j] = min(minCentroid[j], centroids[triangle][j]);
+            maxCentroid[j] = max(maxCentroid[j], centroids[triangle][j]);
+        }
+    }
+    for (int j = 0; j < 3; ++j)
+    {
+        m_nodes[nodeIndex].m_minBounds[j] = minBounds[j];
+        m_nodes[nodeIndex].m_maxBounds[j] = maxBounds[j];
+    }
+    int axis = 0;
+    for (int j = 1; j < 3; ++j)
+    {
+        if (maxCentroid[j] - minCentroid[j] > maxCentroid[axis] - minCentroid[axis]) axis = j;
+    }
+    if (end - start <= LEAF_SIZE || depth >= MAX_DEPTH || !(maxCentroid[axis] > minCentroid[axis]))//identical centroids can't be split
+    {
+        m_nodes[nodeIndex].m_start = start;
+        m_nodes[nodeIndex].m_count = end - start;
+        return;
+    }
+    const int32_t mid = start + (end - start) / 2;
+    nth_element(m_triangleOrder.begin() + start, m_triangleOrder.begin() + mid, m_triangleOrder.begin() + end,
+                [&centroids, axis](const int32_t& lhs, const int32_t& rhs) { return centroids[lhs][axis] < centroids[rhs][axis]; });
+    const int32_t firstChild = m_nodes.size();
+    m_nodes.push_back(Node());//invalidates references into m_nodes, so only use indexes
+    m_nodes.push_back(Node());
+    m_nodes[nodeIndex].m_start = firstChild;
+    m_nodes[nodeIndex].m_count = 0;
+    buildHelper(firstChild, start, mid, centroids, depth + 1);
+    buildHelper(firstChild + 1, mid, end, centroids, depth + 1);
+}
+
+bool CaretTriangleBVH::intersectBox(const Node& node, const float origin[3], const float inverseDirection[3], const float& maxDistance, float& entryDistanceOut) const
+{
+    float nearDist = 0.0f, farDist = maxDistance;
+    for (int j = 0; j < 3; ++j)
+    {//a zero direction component gives infinite distances, or NaN if the origin is on the slab boundary, fmin/fmax ignore NaN
+        const float dist1 = (node.m_minBounds[j] - origin[j]) * inverseDirection[j];
+        const float dist2 = (node.m_maxBounds[j] - origin[j]) * inverseDirection[j];
+        nearDist = fmax(nearDist, fmin(dist1, dist2));
+        farDist = fmin(farDist, fmax(dist1, dist2));
+    }
+    entryDistanceOut = nearDist;
+    return nearDist <= farDist;
+}
+
+bool CaretTriangleBVH::intersectTriangle(const int32_t triangle, const float origin[3], const float direction[3], const float& maxDistance, TriangleRayHit& hitOut) const
+{//Moller-Trumbore, in double so that rays don't slip between adjacent triangles
+    const int32_t* tri = m_triangles.data() + triangle * 3;
+    const float* v0 = m_coords.data() + tri[0] * 3;
+    const float* v1 = m_coords.data() + tri[1] * 3;
+    const float* v2 = m_coords.data() + tri[2] * 3;
+    double edge1[3], edge2[3], toOrigin[3];
+    for (int j = 0; j < 3; ++j)
+    {
+        edge1[j] = (double)v1[j] - v0[j];
+        edge2[j] = (double)v2[j] - v0[j];
+        toOrigin[j] = (double)origin[j] - v0[j];
+    }
+    const double p[3] = { direction[1] * edge2[2] - direction[2] * edge2[1],
+                          direction[2] * edge2[0] - direction[0] * edge2[2],
+                          direction[0] * edge2[1] - direction[1] * edge2[0] };
+    const double det = edge1[0] * p[0] + edge1[1] * p[1] + edge1[2] * p[2];
+    if (det == 0.0) return false;//ray is parallel to the triangle, or triangle is degenerate
+    const double invDet = 1.0 / det;
+    const double u = (toOrigin[0] * p[0] + toOrigin[1] * p[1] + toOrigin[2] * p[2]) * invDet;
+    if (u < 0.0 || u > 1.0) return false;
+    const double q[3] = { toOrigin[1] * edge1[2] - toOrigin[2] * edge1[1],
+                          toOrigin[2] * edge1[0] - toOrigin[0] * edge1[2],
+                          toOrigin[0] * edge1[1] - toOrigin[1] * edge1[0] };
+    const double v = (direction[0] * q[0] + direction[1] * q[1] + direction[2] * q[2]) * invDet;
+    if (v < 0.0 || u + v > 1.0) return false;
+    const double dist = (edge2[0] * q[0] + edge2[1] * q[1] + edge2[2] * q[2]) * invDet;
+    if (!(dist >= 0.0 && dist <= maxDistance)) return false;
+    hitOut.triangle = triangle;
+    hitOut.distance = dist;
+    hitOut.barycentric[0] = 1.0 - u - v;
+    hitOut.barycentric[1] = u;
+    hitOut.barycentric[2] = v;
+    for (int j = 0; j < 3; ++j)
+    {
+        hitOut.coords[j] = origin[j] + dist * direction[j];
+    }
+    return true;
+}
+
+bool CaretTriangleBVH::closestHit(const float origin[3], const float direction[3], TriangleRayHit& hitOut, const float& maxDistance) const
+{
+    hitOut = TriangleRayHit();
+    if (m_nodes.empty()) return false;
+    const float inverseDirection[3] = { 1.0f / direction[0], 1.0f / direction[1], 1.0f / direction[2] };
+    float bestDist = maxDistance;
+    bool found = false;
+    vector<int32_t> stack;
+    stack.reserve(MAX_DEPTH + 2);
+    stack.push_back(0);
+    while (!stack.empty())
+    {
+        const Node& thisNode = m_nodes[stack.back()];
+        stack.pop_back();
+        float entryDist;
+        if (!intersectBox(thisNode, origin, inverseDirection, bestDist, entryDist)) continue;//also prunes nodes beyond a hit found after they were pushed
+        if (thisNode.m_count > 0)
+        {
+            for (int32_t i = thisNode.m_start; i < thisNode.m_start + thisNode.m_count; ++i)
+            {
+                TriangleRayHit tempHit;
+                if (intersectTriangle(m_triangleOrder[i], origin, direction, bestDist, tempHit))
+                {
+                    if (!found || tempHit.distance < hitOut.distance)
+                    {
+                        hitOut = tempHit;
+                        bestDist = tempHit.distance;
+                        found = true;
+                    }
+                }
+            }
+        } else {
+            const int32_t first = thisNode.m_start, second = first + 1;
+            float firstEntry, secondEntry;
+            const bool firstHit = intersectBox(m_nodes[first], origin, inverseDirection, bestDist, firstEntry);
+            const bool secondHit = intersectBox(m_nodes[second], origin, inverseDirection, bestDist, secondEntry);
+            if (firstHit && secondHit)
+            {//visit the nearer child first
+                if (firstEntry <= secondEntry)
+                {
+                    stack.push_back(second);
+                    stack.push_back(first);
+                } else {
+                    stack.push_back(first);
+                    stack.push_back(second);
+                }
+            } else if (firstHit) {
+                stack.push_back(first);
+            } else if (secondHit) {
+                stack.push_back(second);
+            }
+        }
+    }
+    return found;
+}
+
+vector<TriangleRayHit> CaretTriangleBVH::allHits(const float origin[3], const float direction[3], const float& maxDistance) const
+{
+    vector<TriangleRayHit> ret;
+    if (m_nodes.empty()) return ret;
+    const float inverseDirection[3] = { 1.0f / direction[0], 1.0f / direction[1], 1.0f / direction[2] };
+    vector<int32_t> stack;
+    stack.reserve(MAX_DEPTH + 2);
+    stack.push_back(0);
+    while (!stack.empty())
+    {
+        const Node& thisNode = m_nodes[stack.back()];
+        stack.pop_back();
+        float entryDist;
+        if (!intersectBox(thisNode, origin, inverseDirection, maxDistance, entryDist)) continue;
+        if (thisNode.m_count > 0)
+        {
+            for (int32_t i = thisNode.m_start; i < thisNode.m_start + thisNode.m_count; ++i)
+            {
+                TriangleRayHit tempHit;
+                if (intersectTriangle(m_triangleOrder[i], origin, direction, maxDistance, tempHit))
+                {
+                    ret.push_back(tempHit);
+                }
+            }
+        } else {
+            stack.push_back(thisNode.m_start);
+            stack.push_back(thisNode.m_start + 1);
+        }
+    }
+    sort(ret.begin(), ret.end());
+    return ret;
+}
@@ -0,0 +1,72 @@
+#ifndef __CARET_TRIANGLE_BVH_H__
+#define __CARET_TRIANGLE_BVH_H__
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "Vector3D.h"
+
+#include <limits>
+#include <vector>
+
+namespace caret {
+
+    struct TriangleRayHit
+    {
+        int32_t triangle;//index of the triangle that was hit, -1 when nothing was hit
+        float distance;//position of the hit along the ray, in multiples of the ray direction's length
+        float barycentric[3];//weights of the triangle's vertices at the hit, in the order the triangle lists them
+        Vector3D coords;//the point where the ray hits the triangle
+        TriangleRayHit() { triangle = -1; distance = -1.0f; barycentric[0] = barycentric[1] = barycentric[2] = 0.0f; }
+        bool operator<(const TriangleRayHit& rhs) const { return distance < rhs.distance; }
+    };
+
+    ///bounding volume hierarchy of a triangle mesh, for intersecting rays with the mesh
+    class CaretTriangleBVH
+    {
+        struct Node
+        {
+            float m_minBounds[3], m_maxBounds[3];
+            int32_t m_start;//for leaves, first position in m_triangleOrder, for internal nodes, index of the first child (the second child follows it)
+            int32_t m_count;//for leaves, number of triangles, 0 for internal nodes
+        };
+        std::vector<float> m_coords;
+        std::vector<int32_t> m_triangles;
+        std::vector<int32_t> m_triangleOrder;//triangle indexes, each leaf's triangles are contiguous
+        std::vector<Node> m_nodes;
+        static const int LEAF_SIZE = 4;
+        static const int MAX_DEPTH = 60;
+        void buildHelper(const int32_t nodeIndex, const int32_t start, const int32_t end, const std::vector<Vector3D>& centroids, const int depth);
+        bool intersectBox(const Node& node, const float origin[3], const float inverseDirection[3], const float& maxDistance, float& entryDistanceOut) const;
+        bool intersectTriangle(const int32_t triangle, const float origin[3], const float direction[3], const float& maxDistance, TriangleRayHit& hitOut) const;
+        CaretTriangleBVH();
+    public:
+        ///make a BVH of the triangles, coordinates and triangles are copied
+        CaretTriangleBVH(const float* coordsIn, const int64_t numCoords, const int32_t* trianglesIn, const int64_t numTriangles);
+        ///find the closest intersection of the ray (origin + distance * direction) with distance in [0, maxDistance], triangles are hit from either side
+        ///returns false if the ray does not hit any triangle
+        bool closestHit(const float origin[3], const float direction[3], TriangleRayHit& hitOut, const float& maxDistance = std::numeric_limits<float>::max()) const;
+        ///find all intersections of the ray with distance in [0, maxDistance], sorted from closest to farthest
+        std::vector<TriangleRayHit> allHits(const float origin[3], const float direction[3], const float& maxDistance = std::numeric_limits<float>::max()) const;
+        int64_t getNumberOfTriangles() const { return m_triangles.size() / 3; }
+    };
+}
+
+#endif //__CARET_TRIANGLE_BVH_H__
@@ -0,0 +1,451 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "GzipSeekIndex.h"
+
+#include "CaretAssert.h"
+#include "CaretOMP.h"
+#include "DataFileException.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include "zlib.h"
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+
+using namespace caret;
+using namespace std;
+
+struct GzipSeekIndex::AccessPointList
+{
+    vector<AccessPoint> m_points;
+    CaretMutex m_mutex;
+};
+
+namespace
+{
+    const int64_t SPAN = 1<<22;//4MiB of uncompressed data between access points, each point costs a 32KiB window, so this is under 1% memory overhead
+    const int WINSIZE = 32768;//maximum deflate back-reference distance
+    const int64_t INBUF_SIZE = 1<<18;
+    const int MAX_CACHED_INDEXES = 8;//an index can be rebuilt by reading the file again, so don't keep them for every file ever opened
+
+    struct IndexCacheEntry
+    {
+        QString m_path;
+        int64_t m_size;
+        QDateTime m_modified;
+        CaretPointer<GzipSeekIndex::AccessPointList> m_accessPoints;//no file handles or decompressors, those belong to each GzipSeekIndex
+    };
+
+    CaretMutex g_indexCacheMutex;
+    vector<IndexCacheEntry> g_indexCache;//most recently used at the back
+}
+
+struct GzipSeekIndex::Cursor
+{
+    QFile m_file;
+    z_stream m_strm;
+    bool m_strmInit, m_busy, m_finished;
+    bool m_raw;//started from a mid-member access point, so zlib doesn't know about the gzip trailer
+    int64_t m_outPos;//uncompressed position of the next byte inflate will produce
+    int64_t m_fileReadPos;//file position after the last fill of m_inBuf
+    int64_t m_lastUse;
+    vector<unsigned char> m_inBuf, m_window;//m_window is circular, and is also where inflate writes its output
+    int m_winPos, m_windowFill;//next position to write in m_window, and how much of it is history from the current member
+    Cursor() : m_inBuf(INBUF_SIZE), m_window(WINSIZE)
+    {
+        memset(&m_strm, 0, sizeof(m_strm));
+        m_strmInit = false;
+        m_busy = false;
+        m_finished = false;
+        m_raw = false;
+        m_outPos = 0;
+        m_fileReadPos = 0;
+        m_lastUse = 0;
+        m_winPos = 0;
+        m_windowFill = 0;
+    }
+    ~Cursor()
+    {
+        if (m_strmInit) inflateEnd(&m_strm);
+    }
+};
+
+CaretPointer<GzipSeekIndex> GzipSeekIndex::getIndex(const QString& filename)
+{
+    QFileInfo myInfo(filename);
+    if (!myInfo.exists()) return CaretPointer<GzipSeekIndex>();
+    QString path = myInfo.absoluteFilePath();
+    int64_t size = myInfo.size();
+    QDateTime modified = myInfo.lastModified();
+    CaretMutexLocker locked(&g_indexCacheMutex);
+    for (size_t i = 0; i < g_indexCache.size(); ++i)
+    {
+        if (g_indexCache[i].m_path == path && g_indexCache[i].m_size == size && g_indexCache[i].m_modified == modified)
+        {
+            IndexCacheEntry found = g_indexCache[i];
+            g_indexCache.erase(g_indexCache.begin() + i);
+            g_indexCache.push_back(found);
+            return CaretPointer<GzipSeekIndex>(new GzipSeekIndex(filename, found.m_accessPoints));
+        }
+        if (g_indexCache[i].m_path == path)
+        {//file changed, old index is useless
+            g_indexCache.erase(g_indexCache.begin() + i);
+            --i;
+        }
+    }
+    QFile checkFile(filename);
+    if (!checkFile.open(QIODevice::ReadOnly)) return CaretPointer<GzipSeekIndex>();
+    unsigned char magic[2];
+    if (checkFile.read((char*)magic, 2) != 2 || magic[0] != 0x1f || magic[1] != 0x8b)
+    {//zlib can read uncompressed files transparently, let the caller handle that
+        return CaretPointer<GzipSeekIndex>();
+    }
+    IndexCacheEntry newEntry;
+    newEntry.m_path = path;
+    newEntry.m_size = size;
+    newEntry.m_modified = modified;
+    newEntry.m_accessPoints.grabNew(new AccessPointList());
+    AccessPoint start;
+    start.m_outPos = 0;
+    start.m_inPos = 0;
+    start.m_bits = 0;
+    start.m_memberStart = true;
+    newEntry.m_accessPoints->m_points.push_back(start);
+    g_indexCache.push_back(newEntry);
+    if ((int)g_indexCache.size() > MAX_CACHED_INDEXES) g_indexCache.erase(g_indexCache.begin());//anything still using it keeps its own reference
+    return CaretPointer<GzipSeekIndex>(new GzipSeekIndex(filename, newEntry.m_accessPoints));
+}
+
+GzipSeekIndex::GzipSeekIndex(const QString& filename, const CaretPointer<AccessPointList>& accessPoints)
+{
+    m_fileName = filename;
+    m_accessPoints = accessPoints;
+    m_useCounter = 0;
+}
+
+GzipSeekIndex::~GzipSeekIndex()
+{
+}
+
+int64_t GzipSeekIndex::readAt(const int64_t& position, void* dataOut, const int64_t& count)
+{
+    CaretAssert(position >= 0 && count >= 0);
+    if (count == 0) return 0;
+    vector<int64_t> spanStarts(1, position);
+    if (count > 2 * SPAN)
+    {//split at the access points already inside the range, each span can be inflated independently
+        CaretMutexLocker locked(&(m_accessPoints->m_mutex));
+        for (size_t i = 0; i < m_accessPoints->m_points.size(); ++i)
+        {
+            if (m_accessPoints->m_points[i].m_outPos >= position + count) break;
+            if (m_accessPoints->m_points[i].m_outPos > spanStarts.back()) spanStarts.push_back(m_accessPoints->m_points[i].m_outPos);
+        }
+    }
+    if (spanStarts.size() == 1) return readSpan(position, (char*)dataOut, count);
+    int numSpans = (int)spanStarts.size();
+    spanStarts.push_back(position + count);
+    vector<int64_t> spanRead(numSpans, 0);
+    exception_ptr exPtr;
+    int exceptedSpan = -1;
+    //NOTE: throwing inside omp parallel causes an uninformative abort, so catch, skip the rest, and rethrow later
+#pragma omp CARET_PARFOR schedule(dynamic)
+    for (int i = 0; i < numSpans; ++i)
+    {
+        if (exceptedSpan > -1) continue;
+        try
+        {
+            spanRead[i] = readSpan(spanStarts[i], ((char*)dataOut) + (spanStarts[i] - position), spanStarts[i + 1] - spanStarts[i]);
+        } catch (...) {
+#pragma omp critical
+            {
+                if (exceptedSpan < 0 || i < exceptedSpan)
+                {
+                    exceptedSpan = i;
+                    exPtr = current_exception();
+                }
+            }
+        }
+    }
+    if (exceptedSpan > -1) rethrow_exception(exPtr);
+    int64_t total = 0;
+    for (int i = 0; i < numSpans; ++i)
+    {
+        total += spanRead[i];
+        if (spanRead[i] != spanStarts[i + 1] - spanStarts[i]) break;//end of data, the rest can't have anything
+    }
+    return total;
+}
+
+int64_t GzipSeekIndex::readSpan(const int64_t& position, char* dataOut, const int64_t& count)
+{
+    Cursor* myCursor = acquireCursor(position);
+    int64_t ret = 0;
+    try
+    {
+        ret = runCursor(*myCursor, position, dataOut, count);
+    } catch (...) {
+        releaseCursor(myCursor, true);//don't leave a half-updated zlib state lying around
+        throw;
+    }
+    releaseCursor(myCursor, false);
+    return ret;
+}
+
+GzipSeekIndex::Cursor* GzipSeekIndex::acquireCursor(const int64_t& position)
+{
+    AccessPoint bestPoint;
+    Cursor* ret = NULL;
+    bool restart = true;
+    {
+        CaretMutexLocker locked(&m_cursorMutex);
+        int64_t bestPointPos = 0;
+        size_t bestPointIndex = 0;
+        {
+            CaretMutexLocker pointsLocked(&(m_accessPoints->m_mutex));
+            for (size_t i = 0; i < m_accessPoints->m_points.size(); ++i)//linear is fine, a 4GB file only has 1000 points
+            {
+                if (m_accessPoints->m_points[i].m_outPos > position) break;
+                bestPointIndex = i;
+            }
+            bestPointPos = m_accessPoints->m_points[bestPointIndex].m_outPos;
+        }
+        Cursor* oldest = NULL;
+        for (size_t i = 0; i < m_cursors.size(); ++i)
+        {
+            Cursor* thisCursor = m_cursors[i];
+            if (thisCursor->m_busy) continue;
+            if (thisCursor->m_strmInit && thisCursor->m_outPos <= position && thisCursor->m_outPos >= bestPointPos)
+            {//continuing is no more work than restarting from the point
+                if (ret == NULL || thisCursor->m_outPos > ret->m_outPos) ret = thisCursor;
+            }
+            if (oldest == NULL || thisCursor->m_lastUse < oldest->m_lastUse) oldest = thisCursor;
+        }
+        if (ret != NULL)
+        {
+            restart = false;
+        } else {
+            if (oldest != NULL)
+            {
+                ret = oldest;
+            } else {//all busy, so add one - the number of cursors ends up as the number of threads reading at once
+                m_cursors.push_back(CaretPointer<Cursor>(new Cursor()));
+                ret = m_cursors.back();
+            }
+            CaretMutexLocker pointsLocked(&(m_accessPoints->m_mutex));
+            bestPoint = m_accessPoints->m_points[bestPointIndex];//copy, the vector may reallocate while we inflate
+        }
+        ret->m_busy = true;
+        ret->m_lastUse = ++m_useCounter;
+    }
+    if (restart)
+    {
+        try
+        {
+            startCursor(*ret, bestPoint);
+        } catch (...) {
+            releaseCursor(ret, true);
+            throw;
+        }
+    }
+    return ret;
+}
+
+void GzipSeekIndex::releaseCursor(Cursor* cursor, const bool& invalidate)
+{
+    CaretMutexLocker locked(&m_cursorMutex);
+    if (invalidate && cursor->m_strmInit)
+    {
+        inflateEnd(&(cursor->m_strm));
+        cursor->m_strmInit = false;
+    }
+    cursor->m_busy = false;
+}
+
+void GzipSeekIndex::startCursor(Cursor& cursor, const AccessPoint& point)
+{
+    if (!cursor.m_file.isOpen())
+    {
+        cursor.m_file.setFileName(m_fileName);
+        if (!cursor.m_file.open(QIODevice::ReadOnly)) throw DataFileException("failed to open compressed file '" + m_fileName + "'");
+    }
+    if (cursor.m_strmInit)
+    {
+        inflateEnd(&(cursor.m_strm));
+        cursor.m_strmInit = false;
+    }
+    memset(&(cursor.m_strm), 0, sizeof(cursor.m_strm));
+    cursor.m_raw = !point.m_memberStart;
+    int ret = inflateInit2(&(cursor.m_strm), (cursor.m_raw ? -15 : 15 + 16));//negative means raw deflate, +16 means gzip header
+    if (ret != Z_OK) throw DataFileException("failed to initialize zlib while reading '" + m_fileName + "'");
+    cursor.m_strmInit = true;
+    int64_t seekPos = point.m_inPos - (point.m_bits ? 1 : 0);
+    if (!cursor.m_file.seek(seekPos)) throw DataFileException("seek failed in compressed file '" + m_fileName + "'");
+    cursor.m_fileReadPos = seekPos;
+    cursor.m_strm.avail_in = 0;
+    if (point.m_bits)
+    {
+        char partial;
+        if (cursor.m_file.read(&partial, 1) != 1) throw DataFileException("error while reading compressed file '" + m_fileName + "'");
+        ++cursor.m_fileReadPos;
+        ret = inflatePrime(&(cursor.m_strm), point.m_bits, ((unsigned char)partial) >> (8 - point.m_bits));
+        if (ret != Z_OK) throw DataFileException("failed to initialize zlib while reading '" + m_fileName + "'");
+    }
+    int windowSize = (int)point.m_window.size();
+    if (windowSize > 0)
+    {
+        ret = inflateSetDictionary(&(cursor.m_strm), point.m_window.data(), windowSize);
+        if (ret != Z_OK) throw DataFileException("failed to initialize zlib while reading '" + m_fileName + "'");
+        memcpy(cursor.m_window.data(), point.m_window.data(), windowSize);
+    }
+    cursor.m_winPos = windowSize % WINSIZE;
+    cursor.m_windowFill = windowSize;
+    cursor.m_outPos = point.m_outPos;
+    cursor.m_finished = false;
+}
+
+bool GzipSeekIndex::fillInput(Cursor& cursor)
+{
+    int64_t got = cursor.m_file.read((char*)cursor.m_inBuf.data(), INBUF_SIZE);
+    if (got < 0) throw DataFileException("error while reading compressed file '" + m_fileName + "'");
+    cursor.m_fileReadPos += got;
+    cursor.m_strm.next_in = cursor.m_inBuf.data();
+    cursor.m_strm.avail_in = (uInt)got;
+    return got > 0;
+}
+
+int64_t GzipSeekIndex::runCursor(Cursor& cursor, const int64_t& position, char* dataOut, const int64_t& count)
+{
+    CaretAssert(cursor.m_strmInit && cursor.m_outPos <= position);
+    const int64_t endPos = position + count;
+    while (cursor.m_outPos < endPos && !cursor.m_finished)
+    {
+        if (cursor.m_strm.avail_in == 0 && !fillInput(cursor))
+        {
+            throw DataFileException("premature end of file in compressed file '" + m_fileName + "'");
+        }
+        uInt outSpace = (uInt)min(int64_t(WINSIZE - cursor.m_winPos), endPos - cursor.m_outPos);//stop exactly at the end of the request, so the next sequential read can continue from here
+        cursor.m_strm.next_out = cursor.m_window.data() + cursor.m_winPos;
+        cursor.m_strm.avail_out = outSpace;
+        int ret = inflate(&(cursor.m_strm), Z_BLOCK);
+        switch (ret)
+        {
+            case Z_NEED_DICT:
+            case Z_DATA_ERROR:
+            case Z_STREAM_ERROR:
+                throw DataFileException("corrupt compressed data in file '" + m_fileName + "'");
+            case Z_MEM_ERROR:
+                throw DataFileException("out of memory while decompressing file '" + m_fileName + "'");
+            default://Z_BUF_ERROR just means no progress this call, refilling input will fix it
+                break;
+        }
+        int64_t produced = outSpace - cursor.m_strm.avail_out;
+        if (produced > 0)
+        {
+            int64_t copyStart = max(cursor.m_outPos, position);
+            int64_t copyEnd = cursor.m_outPos + produced;
+            if (copyEnd > copyStart)
+            {
+                memcpy(dataOut + (copyStart - position), cursor.m_window.data() + cursor.m_winPos + (copyStart - cursor.m_outPos), copyEnd - copyStart);
+            }
+            cursor.m_outPos += produced;
+            cursor.m_winPos = (cursor.m_winPos + produced) % WINSIZE;
+            cursor.m_windowFill = (int)min(int64_t(WINSIZE), cursor.m_windowFill + produced);
+        }
+        if (ret == Z_STREAM_END)
+        {
+            nextMember(cursor);
+        } else if ((cursor.m_strm.data_type & 128) && !(cursor.m_strm.data_type & 64)) {//between deflate blocks, and not after the last one
+            maybeAddPoint(cursor, false);
+        }
+    }
+    return max(int64_t(0), min(cursor.m_outPos, endPos) - position);
+}
+
+void GzipSeekIndex::nextMember(Cursor& cursor)
+{
+    if (cursor.m_raw)
+    {//raw inflate stops before the gzip trailer (crc and length), skip it
+        int toSkip = 8;
+        while (toSkip > 0)
+        {
+            if (cursor.m_strm.avail_in == 0 && !fillInput(cursor))
+            {
+                throw DataFileException("premature end of file in compressed file '" + m_fileName + "'");
+            }
+            int skipNow = min(toSkip, (int)cursor.m_strm.avail_in);
+            cursor.m_strm.next_in += skipNow;
+            cursor.m_strm.avail_in -= skipNow;
+            toSkip -= skipNow;
+        }
+    }
+    //gzip allows concatenated members (pigz, bgzip, cat), gzread treats them as one stream, and ignores trailing garbage
+    int64_t memberStart = cursor.m_fileReadPos - cursor.m_strm.avail_in;
+    unsigned char magic[2];
+    for (int i = 0; i < 2; ++i)
+    {
+        if (cursor.m_strm.avail_in == 0 && !fillInput(cursor))
+        {
+            cursor.m_finished = true;
+            return;
+        }
+        magic[i] = *(cursor.m_strm.next_in);
+        ++cursor.m_strm.next_in;
+        --cursor.m_strm.avail_in;
+    }
+    if (magic[0] != 0x1f || magic[1] != 0x8b)
+    {
+        cursor.m_finished = true;
+        return;
+    }
+    if (!cursor.m_file.seek(memberStart)) throw DataFileException("seek failed in compressed file '" + m_fileName + "'");
+    cursor.m_fileReadPos = memberStart;
+    cursor.m_strm.avail_in = 0;
+    if (inflateReset2(&(cursor.m_strm), 15 + 16) != Z_OK) throw DataFileException("failed to reset zlib while reading '" + m_fileName + "'");
+    cursor.m_raw = false;
+    cursor.m_windowFill = 0;
+    maybeAddPoint(cursor, true);
+}
+
+void GzipSeekIndex::maybeAddPoint(Cursor& cursor, const bool& memberStart)
+{
+    CaretMutexLocker locked(&(m_accessPoints->m_mutex));
+    if (cursor.m_outPos < m_accessPoints->m_points.back().m_outPos + SPAN) return;//only the cursor that is past the end of the index adds points
+    AccessPoint newPoint;
+    newPoint.m_outPos = cursor.m_outPos;
+    newPoint.m_inPos = cursor.m_fileReadPos - cursor.m_strm.avail_in;
+    newPoint.m_memberStart = memberStart;
+    if (memberStart)
+    {
+        newPoint.m_bits = 0;
+    } else {
+        newPoint.m_bits = cursor.m_strm.data_type & 7;
+        int fill = cursor.m_windowFill;
+        newPoint.m_window.resize(fill);
+        int start = (cursor.m_winPos - fill + WINSIZE) % WINSIZE;
+        int firstPart = min(fill, WINSIZE - start);
+        memcpy(newPoint.m_window.data(), cursor.m_window.data() + start, firstPart);
+        if (firstPart < fill) memcpy(newPoint.m_window.data() + firstPart, cursor.m_window.data(), fill - firstPart);
+    }
+    m_accessPoints->m_points.push_back(newPoint);
+}
@@ -0,0 +1,83 @@
+#ifndef __GZIP_SEEK_INDEX_H__
+#define __GZIP_SEEK_INDEX_H__
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "CaretMutex.h"
+#include "CaretPointer.h"
+
+#include <QString>
+
+#include <stdint.h>
+#include <vector>
+
+namespace caret
+{
+
+    ///random access into gzip files, by saving the decompressor state (an "access point") every few megabytes of output
+    ///points are recorded as a side effect of decompressing, so the first pass through a file costs the same as gzread, and later
+    ///seeks only need to inflate from the nearest point - once a range is indexed, large reads are split at the points and decompressed in parallel
+    class GzipSeekIndex
+    {
+    public:
+        ///returns NULL if the file can't be opened or isn't gzip data, shares the access points with other users of the same unmodified file, but has its own file handles
+        static CaretPointer<GzipSeekIndex> getIndex(const QString& filename);
+
+        ///safe to call from multiple threads, returns number of bytes read, which is less than count only at end of data, throws on corrupt data
+        int64_t readAt(const int64_t& position, void* dataOut, const int64_t& count);
+
+        ~GzipSeekIndex();
+
+        struct AccessPointList;//the points found so far in a file, with their mutex, defined in the .cxx
+    private:
+        struct AccessPoint
+        {
+            int64_t m_outPos;//position in the uncompressed data
+            int64_t m_inPos;//position in the file of the first full byte of compressed data
+            int m_bits;//number of bits from the byte before m_inPos that are needed
+            bool m_memberStart;//at a gzip header, so there is no history and the header must be parsed
+            std::vector<unsigned char> m_window;//the uncompressed data leading up to the point, for back-references
+        };
+        struct Cursor;//holds zlib state, so hide it in the .cxx
+
+        QString m_fileName;
+        CaretPointer<AccessPointList> m_accessPoints;//shared through the cache, only the points are kept after the last reader of a file is done
+        std::vector<CaretPointer<Cursor> > m_cursors;//decompressors that stopped somewhere, so sequential reads don't restart at an access point
+        int64_t m_useCounter;
+        CaretMutex m_cursorMutex;
+
+        GzipSeekIndex(const QString& filename, const CaretPointer<AccessPointList>& accessPoints);
+        GzipSeekIndex(const GzipSeekIndex&);
+        GzipSeekIndex& operator=(const GzipSeekIndex&);
+
+        int64_t readSpan(const int64_t& position, char* dataOut, const int64_t& count);
+        Cursor* acquireCursor(const int64_t& position);
+        void releaseCursor(Cursor* cursor, const bool& invalidate);
+        void startCursor(Cursor& cursor, const AccessPoint& point);
+        int64_t runCursor(Cursor& cursor, const int64_t& position, char* dataOut, const int64_t& count);
+        bool fillInput(Cursor& cursor);
+        void nextMember(Cursor& cursor);
+        void maybeAddPoint(Cursor& cursor, const bool& memberStart);
+    };
+
+}
+
+#endif //__GZIP_SEEK_INDEX_H__
@@ -181,7 +181,7 @@ namespace caret
             {
                 for (ijk[2] = 0; ijk[2] < 2; ++ijk[2])
                 {
-                    if (ijk[0] != octant[0] && ijk[1] != octant[1] && ijk[2] != octant[2])
+                    if (ijk[0] != octant[0] || ijk[1] != octant[1] || ijk[2] != octant[2])
                     {//avoiding one new/delete pair should be worth 8 times this conditional
                         Oct<T>* temp = new Oct<T>();
                         m_children[ijk[0]][ijk[1]][ijk[2]] = temp;
@@ -23,6 +23,21 @@ inline double dsdot (const float *a, const float *b, int n)
     sum += a[k] * b[k];
   return sum;
 }  // dsdot()
+inline void dsdot4x4 (const float *const *a, const float *const *b, int n, double *out)
+{
+  double sum[16] = { 0 };
+  for (int k = 0; k < n; k++)
+  {
+    for (int i = 0; i < 4; i++)
+    {
+      double ai = a[i][k];
+      for (int j = 0; j < 4; j++)
+        sum[4*i+j] += ai * b[j][k];
+    }
+  }
+  for (int m = 0; m < 16; m++)
+    out[m] = sum[m];
+}  // dsdot4x4()
 //copy enum from dot.h
 //renamed to dot_flags in both files for less conflict chance
 typedef enum {
@@ -35,10 +35,12 @@
 #include "BoundingBox.h"
 #include "CaretAssert.h"
 #include "CaretLogger.h"
+#include "CaretMutex.h"
 #include "CaretPreferences.h"
 #include "CziImage.h"
 #include "CziImageFileMetaDataXmlReader.h"
 #include "CziImageLoaderMultiResolution.h"
+#include "CziImageTileCache.h"
 #include "CziUtilities.h"
 #include "DataFileContentInformation.h"
 #include "DataFileException.h"
@@ -67,6 +69,32 @@ using namespace caret;
 
 static bool cziDebugFlag(false);
 
+namespace {
+    /**
+     * Image tiles are read by multiple threads.  The stream from the CZI library
+     * seeks and then reads so one read must finish before another read starts.
+     * Decoding of the data read is not affected and still runs in parallel.
+     */
+    class CziMutexLockedStream : public libCZI::IStream {
+    public:
+        CziMutexLockedStream(const std::shared_ptr<libCZI::IStream>& stream)
+        : m_stream(stream) { }
+        
+        virtual void Read(std::uint64_t offset,
+                          void* pv,
+                          std::uint64_t size,
+                          std::uint64_t* ptrBytesRead) override {
+            CaretMutexLocker locker(&m_mutex);
+            m_stream->Read(offset, pv, size, ptrBytesRead);
+        }
+        
+    private:
+        std::shared_ptr<libCZI::IStream> m_stream;
+        
+        CaretMutex m_mutex;
+    };
+}
+
 /**
  * \class caret::CziImageFile
  * \brief A Zeiss CZI image file
@@ -79,6 +107,8 @@ static bool cziDebugFlag(false);
 CziImageFile::CziImageFile()
 : MediaFile(DataFileTypeEnum::CZI_IMAGE_FILE)
 {
+    m_tileCache.reset(new CziImageTileCache(this));
+    
     for (int32_t iTab = 0; iTab < BrainConstants::MAXIMUM_NUMBER_OF_BROWSER_TABS; iTab++) {
         for (int32_t iOverlay = 0; iOverlay < BrainConstants::MAXIMUM_NUMBER_OF_OVERLAYS; iOverlay++) {
             m_tabOverlayInfo[iTab][iOverlay].reset(new TabOverlayInfo(this, iTab, iOverlay));
@@ -119,13 +149,29 @@ CziImageFile::resetPrivate()
     EventCaretPreferencesGet prefsEvent;
     EventManager::get()->sendEvent(prefsEvent.getPointer());
     CaretPreferences* prefs = prefsEvent.getCaretPreferences();
+    int64_t tileCacheSizeMegabytes(512);
     if (prefs != NULL) {
         m_maximumImageDimension = prefs->getCziDimension();
+        tileCacheSizeMegabytes  = prefs->getMediaTileCacheSizeMegabytes();
     }
     else {
         m_maximumImageDimension = 2048;
     }
 
+    /*
+     * Image loaders and tile cache must be reset before the reader
+     * is closed since they may be reading image tiles in other threads
+     */
+    for (int32_t iTab = 0; iTab < BrainConstants::MAXIMUM_NUMBER_OF_BROWSER_TABS; iTab++) {
+        for (int32_t iOverlay = 0; iOverlay < BrainConstants::MAXIMUM_NUMBER_OF_OVERLAYS; iOverlay++) {
+            CaretAssertArrayIndex(m_tabOverlayInfo, BrainConstants::MAXIMUM_NUMBER_OF_BROWSER_TABS, iTab);
+            CaretAssertArrayIndex(m_tabOverlayInfo, BrainConstants::MAXIMUM_NUMBER_OF_OVERLAYS, iOverlay);
+            m_tabOverlayInfo[iTab][iOverlay]->resetContent();
+        }
+    }
+    m_tileCache->clear();
+    m_tileCache->setMaximumSizeBytes(tileCacheSizeMegabytes * 1024 * 1024);
+    
     m_allFramesPyramidInfo = CziSceneInfo();
     m_cziScenePyramidInfos.clear();
     m_scalingTileAccessor.reset();
@@ -146,14 +192,6 @@ CziImageFile::resetPrivate()
     m_imagePlane.reset();
     m_imagePlaneInvalid = false;
     
-    for (int32_t iTab = 0; iTab < BrainConstants::MAXIMUM_NUMBER_OF_BROWSER_TABS; iTab++) {
-        for (int32_t iOverlay = 0; iOverlay < BrainConstants::MAXIMUM_NUMBER_OF_OVERLAYS; iOverlay++) {
-            CaretAssertArrayIndex(m_tabOverlayInfo, BrainConstants::MAXIMUM_NUMBER_OF_BROWSER_TABS, iTab);
-            CaretAssertArrayIndex(m_tabOverlayInfo, BrainConstants::MAXIMUM_NUMBER_OF_OVERLAYS, iOverlay);
-            m_tabOverlayInfo[iTab][iOverlay]->resetContent();
-        }
-    }
-    
     resetMatrices();
     m_annotationFile.reset();
     m_annotationFileDisplayed = true;
@@ -330,37 +368,40 @@ CziImageFile::getFileMetaData() const
 void
 CziImageFile::readFile(const AString& filename)
 {
-    resetPrivate();
-    
-    setFileName(filename);
-    
-    switch (m_status) {
-        case Status::CLOSED:
-            break;
-        case Status::ERRORED:
-            return;
-            break;
-        case Status::OPEN:
-            return;
-            break;
-    }
+    readOpenedFile(filename,
+                   openFile(filename));
+}
+
+/**
+ * Open a CZI file's stream and reader and read its metadata segment.  These are
+ * the reading operations that take the most time when a file is opened.  No events
+ * are sent and no member of any instance is accessed so this may be called
+ * from a background thread.  Use readOpenedFile() to complete reading of the file.
+ * @param filename
+ *    Name of the file
+ * @return
+ *    The opened file.  If opening failed, its error message is not empty.
+ */
+std::unique_ptr<CziImageFile::OpenedFile>
+CziImageFile::openFile(const AString& filename)
+{
+    std::unique_ptr<OpenedFile> openedFile(new OpenedFile());
     
     try {
         /*
          * If file does not exist, a std::exception is thrown
          */
-        m_stream = libCZI::CreateStreamFromFile(filename.toStdWString().c_str());
-        if ( ! m_stream) {
-            m_errorMessage = "Creating stream for reading CZI file failed.";
-            m_status = Status::ERRORED;
-            return;
+        std::shared_ptr<libCZI::IStream> fileStream(libCZI::CreateStreamFromFile(filename.toStdWString().c_str()));
+        if ( ! fileStream) {
+            openedFile->m_errorMessage = "Creating stream for reading CZI file failed.";
+            return openedFile;
         }
+        openedFile->m_stream.reset(new CziMutexLockedStream(fileStream));
         
-        m_reader = libCZI::CreateCZIReader();
-        if ( ! m_reader) {
-            m_errorMessage = "Creating reader for reading CZI file failed.";
-            m_status = Status::ERRORED;
-            return;
+        openedFile->m_reader = libCZI::CreateCZIReader();
+        if ( ! openedFile->m_reader) {
+            openedFile->m_errorMessage = "Creating reader for reading CZI file failed.";
+            return openedFile;
         }
         
         /*
@@ -389,7 +430,67 @@ CziImageFile::readFile(const AString& filename)
          }
          
          */
-        m_reader->Open(m_stream);
+        openedFile->m_reader->Open(openedFile->m_stream);
+        
+        openedFile->m_metadataSegment = openedFile->m_reader->ReadMetadataSegment();
+    }
+    catch (const std::out_of_range& e) {
+        openedFile->m_errorMessage = ("std::out_of_range " + filename + ": " + QString(e.what()));
+        openedFile->m_exceptionMessage = ("std::out_of_range exception: "
+                                          + QString(e.what()));
+    }
+    catch (const std::exception& e) {
+        openedFile->m_errorMessage = ("std::exception " + filename + ": " + QString(e.what()));
+        openedFile->m_exceptionMessage = ("std::exception: "
+                                          + QString(e.what()));
+    }
+    
+    return openedFile;
+}
+
+/**
+ * Complete reading of a file opened by openFile().  Must be called from the GUI thread.
+ * @param filename
+ *    Name of the file
+ * @param openedFile
+ *    File opened by openFile()
+ * @throws DataFileException
+ *    If the file was not successfully read.
+ */
+void
+CziImageFile::readOpenedFile(const AString& filename,
+                             std::unique_ptr<OpenedFile> openedFile)
+{
+    CaretAssert(openedFile);
+    
+    resetPrivate();
+    
+    setFileName(filename);
+    
+    switch (m_status) {
+        case Status::CLOSED:
+            break;
+        case Status::ERRORED:
+            return;
+            break;
+        case Status::OPEN:
+            return;
+            break;
+    }
+    
+    if ( ! openedFile->m_errorMessage.isEmpty()) {
+        m_errorMessage = openedFile->m_errorMessage;
+        m_status = Status::ERRORED;
+        if ( ! openedFile->m_exceptionMessage.isEmpty()) {
+            throw DataFileException(filename,
+                                    openedFile->m_exceptionMessage);
+        }
+        return;
+    }
+    
+    try {
+        m_stream = openedFile->m_stream;
+        m_reader = openedFile->m_reader;
         
         /*
          * Statistics (bounding box of image)
@@ -397,7 +498,7 @@ CziImageFile::readFile(const AString& filename)
         libCZI::SubBlockStatistics subBlockStatistics = m_reader->GetStatistics();
         m_fullResolutionLogicalRect = CziUtilities::intRectToQRect(subBlockStatistics.boundingBox);
         
-        readMetaData();
+        readMetaData(openedFile->m_metadataSegment);
         
         /*
          * Read 'dimensions'
@@ -489,11 +590,12 @@ CziImageFile::readFile(const AString& filename)
 
 /**
  * Read metadata from the file
+ * @param metadataSegment
+ *    Metadata segment read from the file, may be NULL.
  */
 void
-CziImageFile::readMetaData()
+CziImageFile::readMetaData(std::shared_ptr<libCZI::IMetadataSegment> metadataSegment)
 {
-    std::shared_ptr<libCZI::IMetadataSegment> metadataSegment(m_reader->ReadMetadataSegment());
     if (metadataSegment) {
         std::shared_ptr<libCZI::ICziMetadata> metadata(metadataSegment->CreateMetaFromMetadataSegment());
         if (metadata) {
@@ -910,16 +1012,6 @@ CziImageFile::readFromCziImageFile(const ImageDataFormat imageDataFormat,
         return NULL;
     }
     
-    libCZI::CDimCoordinate coordinate;
-    coordinate.Set(libCZI::DimensionIndex::C, 0);
-    
-    const std::array<float, 3> prefBackRGB = getPreferencesImageBackgroundFloatRGB();
-    libCZI::ISingleChannelScalingTileAccessor::Options scstaOptions;
-    scstaOptions.Clear();
-    scstaOptions.backGroundColor.r = prefBackRGB[0];
-    scstaOptions.backGroundColor.g = prefBackRGB[1];
-    scstaOptions.backGroundColor.b = prefBackRGB[2];
-    
     float zoomToRead(1.0);
     QRectF regionOfInterest(regionOfInterestIn);
     
@@ -945,17 +1037,98 @@ CziImageFile::readFromCziImageFile(const ImageDataFormat imageDataFormat,
         zoomToRead = newZoom;
     }
     
-    /*
-     * Read into 24 bit RGB to avoid conversion from other pixel formats
-     */
     if (cziDebugFlag) {
         std::cout << "----------------------" << std::endl;
         std::cout << "READING IMAGE with ROI: " << CziUtilities::qRectToString(regionOfInterest) << std::endl;
     }
-    const libCZI::PixelType pixelType(libCZI::PixelType::Bgr24);
     const libCZI::IntRect intRectROI = CziUtilities::qRectToIntRect(regionOfInterest);
+    std::shared_ptr<libCZI::IBitmapData> bitmapDataRead(readBitmapFromCziImageFile(channelIndex,
+                                                                                   intRectROI,
+                                                                                   zoomToRead,
+                                                                                   getPreferencesImageBackgroundFloatRGB(),
+                                                                                   errorMessageOut));
+    if ( ! bitmapDataRead) {
+        return NULL;
+    }
+    
+    const bool removeGrayFlag(false);
+    if (removeGrayFlag) {
+        uint8_t backRGB[3] = { 0, 0, 0 };
+        makeWhiteGrayBackgroundColor(bitmapDataRead,
+                                     backRGB);
+    }
+    
+    CziImage* cziImageOut(NULL);
+    
+    switch (imageDataFormat) {
+        case ImageDataFormat::CZI_BITMAP:
+            cziImageOut = new CziImage(this,
+                                       imageName,
+                                       bitmapDataRead,
+                                       frameRegionOfInterest,
+                                       CziUtilities::intRectToQRect(intRectROI));
+            break;
+        case ImageDataFormat::Q_IMAGE:
+        {
+            QImage* qImage = createQImageFromBitmapData(QImagePixelFormat::RGBA,
+                                                        bitmapDataRead.get(),
+                                                        errorMessageOut);
+            if (qImage == NULL) {
+                return NULL;
+            }
+            
+            cziImageOut = new CziImage(this,
+                                       imageName,
+                                       qImage,
+                                       frameRegionOfInterest,
+                                       CziUtilities::intRectToQRect(intRectROI));
+        }
+            break;
+    }
+    return cziImageOut;
+}
+
+/**
+ * Read the specified region from the CZI file into bitmap data with 24 bit pixels (BGR).
+ * Multiple threads may read at the same time.
+ * @param channelIndex
+ *    Index of channel.  Use Zero for all channels.  This parameter is ignored if there
+ *    is only one channel in the file.
+ * @param intRectROI
+ *    Region of interest to read from file.  Origin is in top left.
+ * @param zoom
+ *    Zoom for reading (1.0 is full resolution, less than 1.0 reduces image dimensions)
+ * @param backgroundRGB
+ *    Background color for regions without image data
+ * @param errorMessageOut
+ *    Contains information about any errors
+ * @return
+ *    The bitmap data or NULL if there is an error.
+ */
+std::shared_ptr<libCZI::IBitmapData>
+CziImageFile::readBitmapFromCziImageFile(const int32_t channelIndex,
+                                         const libCZI::IntRect& intRectROI,
+                                         const float zoom,
+                                         const std::array<float, 3>& backgroundRGB,
+                                         AString& errorMessageOut) const
+{
+    errorMessageOut.clear();
+    
+    /*
+     * Read into 24 bit RGB to avoid conversion from other pixel formats
+     */
+    const libCZI::PixelType pixelType(libCZI::PixelType::Bgr24);
     CaretAssert(m_scalingTileAccessor);
     
+    libCZI::CDimCoordinate coordinate;
+    coordinate.Set(libCZI::DimensionIndex::C, 0);
+    
+    libCZI::ISingleChannelScalingTileAccessor::Options scstaOptions;
+    scstaOptions.Clear();
+    scstaOptions.backGroundColor.r = backgroundRGB[0];
+    scstaOptions.backGroundColor.g = backgroundRGB[1];
+    scstaOptions.backGroundColor.b = backgroundRGB[2];
+    
     std::shared_ptr<libCZI::IBitmapData> bitmapDataRead;
     
     /*
@@ -994,7 +1167,7 @@ CziImageFile::readFromCziImageFile(const ImageDataFormat imageDataFormat,
             libCZI::CDimCoordinate planeCoord{ { libCZI::DimensionIndex::C, chIdx } };
             actvChBms.emplace_back(m_scalingTileAccessor->Get(intRectROI,
                                                               &planeCoord,
-                                                              zoomToRead,
+                                                              zoom,
                                                               nullptr));
             activeChNoToChIdx[chIdx] = index++;
             return true;
@@ -1037,7 +1210,7 @@ CziImageFile::readFromCziImageFile(const ImageDataFormat imageDataFormat,
                                    + AString::number(channelIndex)
                                    + ", Valid range is 0 to "
                                    + AString::number(numberOfChannels - 1));
-                return NULL;
+                return bitmapDataRead;
             }
         }
     }
@@ -1045,51 +1218,16 @@ CziImageFile::readFromCziImageFile(const ImageDataFormat imageDataFormat,
         bitmapDataRead = m_scalingTileAccessor->Get(pixelType,
                                                     intRectROI,
                                                     &coordinate,
-                                                    zoomToRead,
+                                                    zoom,
                                                     &scstaOptions);
     }
 
     if ( ! bitmapDataRead) {
         errorMessageOut = ("Failed to read data for region "
                            + CziUtilities::intRectToString(intRectROI));
-        return NULL;
-    }
-    
-    const bool removeGrayFlag(false);
-    if (removeGrayFlag) {
-        uint8_t backRGB[3] = { 0, 0, 0 };
-        makeWhiteGrayBackgroundColor(bitmapDataRead,
-                                     backRGB);
     }
     
-    CziImage* cziImageOut(NULL);
-    
-    switch (imageDataFormat) {
-        case ImageDataFormat::CZI_BITMAP:
-            cziImageOut = new CziImage(this,
-                                       imageName,
-                                       bitmapDataRead,
-                                       frameRegionOfInterest,
-                                       CziUtilities::intRectToQRect(intRectROI));
-            break;
-        case ImageDataFormat::Q_IMAGE:
-        {
-            QImage* qImage = createQImageFromBitmapData(QImagePixelFormat::RGBA,
-                                                        bitmapDataRead.get(),
-                                                        errorMessageOut);
-            if (qImage == NULL) {
-                return NULL;
-            }
-            
-            cziImageOut = new CziImage(this,
-                                       imageName,
-                                       qImage,
-                                       frameRegionOfInterest,
-                                       CziUtilities::intRectToQRect(intRectROI));
-        }
-            break;
-    }
-    return cziImageOut;
+    return bitmapDataRead;
 }
 
 void
@@ -55,6 +55,7 @@ namespace caret {
     class CziImage;
     class CziImageLoaderBase;
     class CziImageLoaderMultiResolution;
+    class CziImageTileCache;
     class GraphicsObjectToWindowTransform;
     class Matrix4x4;
     class RectangleTransform;
@@ -63,6 +64,26 @@ namespace caret {
     class CziImageFile : public MediaFile, public EventListenerInterface {
         
     public:        
+        /**
+         * Stream, reader, and metadata of a CZI file opened by openFile().  Opening
+         * performs the file reading that does not send events so that it may be
+         * performed in a background thread.
+         */
+        class OpenedFile {
+        public:
+            std::shared_ptr<libCZI::IStream> m_stream;
+            
+            std::shared_ptr<libCZI::ICZIReader> m_reader;
+            
+            std::shared_ptr<libCZI::IMetadataSegment> m_metadataSegment;
+            
+            /** Error message if opening failed */
+            AString m_errorMessage;
+            
+            /** Message for DataFileException if opening failed with an exception */
+            AString m_exceptionMessage;
+        };
+        
         CziImageFile();
         
         virtual ~CziImageFile();
@@ -112,6 +133,11 @@ namespace caret {
         
         virtual void readFile(const AString& filename) override;
         
+        static std::unique_ptr<OpenedFile> openFile(const AString& filename);
+        
+        void readOpenedFile(const AString& filename,
+                            std::unique_ptr<OpenedFile> openedFile);
+        
         virtual void writeFile(const AString& filename) override;
 
         virtual bool supportsWriting() const override;
@@ -391,6 +417,12 @@ namespace caret {
                                        const int64_t outputImageWidthHeightMaximum,
                                        AString& errorMessageOut);
         
+        std::shared_ptr<libCZI::IBitmapData> readBitmapFromCziImageFile(const int32_t channelIndex,
+                                                                        const libCZI::IntRect& intRectROI,
+                                                                        const float zoom,
+                                                                        const std::array<float, 3>& backgroundRGB,
+                                                                        AString& errorMessageOut) const;
+        
         enum class QImagePixelFormat {
             RGB,
             RGBA
@@ -402,7 +434,7 @@ namespace caret {
         void addToMetadataIfNotEmpty(const AString& name,
                                      const AString& text);
         
-        void readMetaData();
+        void readMetaData(std::shared_ptr<libCZI::IMetadataSegment> metadataSegment);
         
         void readFileDimensions(const libCZI::SubBlockStatistics& subBlockStatistics);
         
@@ -461,6 +493,12 @@ namespace caret {
         
         mutable std::unique_ptr<GiftiMetaData> m_fileMetaData;
         
+        /*
+         * Tiles shared by the image loaders of all tabs and overlays.
+         * Must be destroyed after the image loaders and before the reader.
+         */
+        std::unique_ptr<CziImageTileCache> m_tileCache;
+        
         std::unique_ptr<TabOverlayInfo> m_tabOverlayInfo[BrainConstants::MAXIMUM_NUMBER_OF_BROWSER_TABS]
                                                         [BrainConstants::MAXIMUM_NUMBER_OF_OVERLAYS];
         
@@ -487,6 +525,8 @@ namespace caret {
 
         friend class CziImage;
         friend class CziImageLoaderMultiResolution;
+        friend class CziImageTileCache;
+        friend class CziImageTileLoader;
         
     };
     
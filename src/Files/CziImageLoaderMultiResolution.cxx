@@ -29,6 +29,7 @@
 #include "CaretLogger.h"
 #include "CziImage.h"
 #include "CziImageFile.h"
+#include "CziImageTileLoader.h"
 #include "CziUtilities.h"
 #include "ElapsedTimer.h"
 #include "GraphicsObjectToWindowTransform.h"
@@ -42,6 +43,9 @@ static const bool cziDebugFlag(false);
  * \class caret::CziImageLoaderMultiResolution
  * \brief Loads image data for all frames in a CZI Image File
  * \ingroup Files
+ *
+ * Image data is read as tiles by a CziImageTileLoader so that panning and
+ * zooming do not wait for image data to be read.
  */
 
 /**
@@ -58,6 +62,7 @@ CziImageLoaderMultiResolution::CziImageLoaderMultiResolution()
  */
 CziImageLoaderMultiResolution::~CziImageLoaderMultiResolution()
 {
+    m_tileLoader.reset();
     m_cziImage.reset();
 }
 
@@ -78,6 +83,7 @@ CziImageLoaderMultiResolution::initialize(const int32_t tabIndex,
     m_tabIndex = tabIndex;
     m_overlayIndex = overlayIndex;
     m_cziImageFile = cziImageFile;
+    m_tileLoader.reset(new CziImageTileLoader(cziImageFile));
 }
 
 /**
@@ -242,6 +248,16 @@ CziImageLoaderMultiResolution::updateImage(const CziImage* cziImage,
             m_cziImage.reset();
         }
     }
+    else if (m_tileLoader->getNumberOfTilesLoaded() != m_numberOfTilesLoadedForImage) {
+        /*
+         * Tiles have been loaded since the image was created
+         */
+        m_numberOfTilesLoadedForImage = m_tileLoader->getNumberOfTilesLoaded();
+        CziImage* newImage(m_tileLoader->createImage(m_tileImageName));
+        if (newImage != NULL) {
+            m_cziImage.reset(newImage);
+        }
+    }
     
     m_previousFrameIndex              = frameIndex;
     m_previousAllFramesFlag           = allFramesFlag;
@@ -782,6 +798,70 @@ CziImageLoaderMultiResolution::loadImageForPyrmaidLayer(const CziImage* oldCziIm
 }
 
 
+/**
+ * Request loading of the tiles for a region and create an image from the tiles that are loaded.
+ * Tiles are loaded in background threads and the image is updated as tiles arrive.
+ * @param oldCziImage
+ *    Current CZI image
+ * @param cziSceneInfo
+ *    CZI scene info (pyramid layers) for image selection
+ * @param channelIndex
+ *    Index of channel.  Use Zero for all channels.  This parameter is ignored if there
+ *    is only one channel in the file.
+ * @param pyramidLayerIndex
+ *    Index of the pyramid layer
+ * @param logicalRect
+ *    Logical region to load
+ * @param cziName
+ *    Name for the image
+ * @return
+ *    New image or the old image if none of the region's tiles are loaded
+ */
+CziImage*
+CziImageLoaderMultiResolution::loadImageFromTiles(const CziImage* oldCziImage,
+                                                  const CziImageFile::CziSceneInfo& cziSceneInfo,
+                                                  const int32_t channelIndex,
+                                                  const int32_t pyramidLayerIndex,
+                                                  const QRectF& logicalRect,
+                                                  const AString& cziName)
+{
+    /*
+     * Region may be enlarged to fill the preferred image dimension
+     */
+    QRectF regionToLoad(logicalRect);
+    float zoomNotUsed(1.0);
+    m_cziImageFile->zoomToMatchPixelDimension(logicalRect,
+                                              cziSceneInfo.m_logicalRectangle,
+                                              m_cziImageFile->getPreferencesImageDimension(),
+                                              regionToLoad,
+                                              zoomNotUsed);
+    regionToLoad = CziUtilities::intRectToQRect(CziUtilities::qRectToIntRect(regionToLoad));
+    
+    ElapsedTimer timer;
+    timer.start();
+    
+    m_tileLoader->loadRegion(cziSceneInfo,
+                             channelIndex,
+                             pyramidLayerIndex,
+                             regionToLoad);
+    m_tileImageName = cziName;
+    m_numberOfTilesLoadedForImage = m_tileLoader->getNumberOfTilesLoaded();
+    CziImage* cziImageOut(m_tileLoader->createImage(m_tileImageName));
+    
+    if (cziDebugFlag) std::cout << "Time to create CZI Image from tiles: (ms): " << timer.getElapsedTimeMilliseconds() << std::endl;
+    
+    if (cziImageOut == NULL) {
+        /*
+         * Continue using old image until tiles are loaded
+         */
+        return const_cast<CziImage*>(oldCziImage);
+    }
+    
+    if (cziDebugFlag) std::cout << "Image Pixels width=" << cziImageOut->getWidth() << ", " << cziImageOut->getHeight() << std::endl;
+    
+    return cziImageOut;
+}
+
 /**
  * Load a image from the given pyramid layer for the center of the tab region defined by the transform for PIXEL coords
  * @param oldCziImage
@@ -919,41 +999,16 @@ CziImageLoaderMultiResolution::loadImageForPyrmaidLayerForPixelCoords(const CziI
         }
     }
     
-    ElapsedTimer timer;
-    timer.start();
-    
     const AString cziName(cziSceneInfo.getName()
                           + " PyramidLayer="
                           + AString::number(pyramidLayerIndex));
     if (cziDebugFlag) std::cout << "Loading pyramid index=" << pyramidLayerIndex << ", rect=" << CziUtilities::qRectToString(rectToLoad) << std::endl;
-    AString errorMessage;
-    CziImage* cziImageOut = m_cziImageFile->readFromCziImageFile(s_imageDataFormatForReading,
-                                                                 cziName,
-                                                                 channelIndex,
-                                                                 rectToLoad,
-                                                                 cziSceneInfo.m_logicalRectangle,
-                                                                 m_cziImageFile->getPreferencesImageDimension(),
-                                                                 errorMessage);
-    
-    if (cziDebugFlag) std::cout << "Time to load CZI Image: (ms): " << timer.getElapsedTimeMilliseconds() << std::endl;
-    
-    if (cziImageOut == NULL) {
-        CaretLogSevere("Loading Pyramid level="
-                       + AString::number(pyramidLayerIndex)
-                       + " for frame(scene) index="
-                       + AString::number(cziSceneInfo.m_sceneIndex)
-                       + " for rectangle="
-                       + CziUtilities::qRectToString(rectToLoad)
-                       + " for file "
-                       + m_cziImageFile->getFileNameNoPath()
-                       + " error: "
-                       + errorMessage);
-    }
-    else {
-        if (cziDebugFlag) std::cout << "Image Pixels width=" << cziImageOut->getWidth() << ", " << cziImageOut->getHeight() << std::endl;
-    }
-    
-    return cziImageOut;
+    return loadImageFromTiles(oldCziImage,
+                              cziSceneInfo,
+                              channelIndex,
+                              pyramidLayerIndex,
+                              rectToLoad,
+                              cziName);
 }
 
 /**
@@ -1097,42 +1152,16 @@ CziImageLoaderMultiResolution::loadImageForPyrmaidLayerForPlaneCoords(const CziI
         }
     }
     
-    ElapsedTimer timer;
-    timer.start();
-    
-    
     const AString cziName(cziSceneInfo.getName()
                           + " PyramidLayer="
                           + AString::number(pyramidLayerIndex));
     if (cziDebugFlag) std::cout << "Loading pyramid index=" << pyramidLayerIndex << ", rect=" << CziUtilities::qRectToString(logicalRectToLoad) << std::endl;
-    AString errorMessage;
-    CziImage* cziImageOut = m_cziImageFile->readFromCziImageFile(s_imageDataFormatForReading,
-                                                                 cziName,
-                                                                 channelIndex,
-                                                                 logicalRectToLoad,
-                                                                 cziSceneInfo.m_logicalRectangle,
-                                                                 m_cziImageFile->getPreferencesImageDimension(),
-                                                                 errorMessage);
-    
-    if (cziDebugFlag) std::cout << "Time to load CZI Image: (ms): " << timer.getElapsedTimeMilliseconds() << std::endl;
-    
-    if (cziImageOut == NULL) {
-        CaretLogSevere("Loading Pyramid level="
-                       + AString::number(pyramidLayerIndex)
-                       + " for frame(scene) index="
-                       + AString::number(cziSceneInfo.m_sceneIndex)
-                       + " for rectangle="
-                       + CziUtilities::qRectToString(logicalRectToLoad)
-                       + " for file "
-                       + m_cziImageFile->getFileNameNoPath()
-                       + " error: "
-                       + errorMessage);
-    }
-    else {
-        if (cziDebugFlag) std::cout << "Image Pixels width=" << cziImageOut->getWidth() << ", " << cziImageOut->getHeight() << std::endl;
-    }
-    
-    return cziImageOut;
+    return loadImageFromTiles(oldCziImage,
+                              cziSceneInfo,
+                              channelIndex,
+                              pyramidLayerIndex,
+                              logicalRectToLoad,
+                              cziName);
 }
 
 /**
@@ -1270,40 +1299,14 @@ CziImageLoaderMultiResolution::loadImageForPyrmaidLayerForStereotaxicCoords(cons
         }
     }
     
-    ElapsedTimer timer;
-    timer.start();
-    
-    
     const AString cziName(cziSceneInfo.getName()
                           + " PyramidLayer="
                           + AString::number(pyramidLayerIndex));
     if (cziDebugFlag) std::cout << "Loading pyramid index=" << pyramidLayerIndex << ", rect=" << CziUtilities::qRectToString(logicalRectToLoad) << std::endl;
-    AString errorMessage;
-    CziImage* cziImageOut = m_cziImageFile->readFromCziImageFile(s_imageDataFormatForReading,
-                                                                 cziName,
-                                                                 channelIndex,
-                                                                 logicalRectToLoad,
-                                                                 cziSceneInfo.m_logicalRectangle,
-                                                                 m_cziImageFile->getPreferencesImageDimension(),
-                                                                 errorMessage);
-    
-    if (cziDebugFlag) std::cout << "Time to load CZI Image: (ms): " << timer.getElapsedTimeMilliseconds() << std::endl;
-    
-    if (cziImageOut == NULL) {
-        CaretLogSevere("Loading Pyramid level="
-                       + AString::number(pyramidLayerIndex)
-                       + " for frame(scene) index="
-                       + AString::number(cziSceneInfo.m_sceneIndex)
-                       + " for rectangle="
-                       + CziUtilities::qRectToString(logicalRectToLoad)
-                       + " for file "
-                       + m_cziImageFile->getFileNameNoPath()
-                       + " error: "
-                       + errorMessage);
-    }
-    else {
-        if (cziDebugFlag) std::cout << "Image Pixels width=" << cziImageOut->getWidth() << ", " << cziImageOut->getHeight() << std::endl;
-    }
-    
-    return cziImageOut;
+    return loadImageFromTiles(oldCziImage,
+                              cziSceneInfo,
+                              channelIndex,
+                              pyramidLayerIndex,
+                              logicalRectToLoad,
+                              cziName);
 }
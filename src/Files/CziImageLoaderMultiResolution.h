@@ -31,6 +31,8 @@
 
 namespace caret {
 
+    class CziImageTileLoader;
+    
     class CziImageLoaderMultiResolution : public CziImageLoaderBase {
         
     public:
@@ -103,6 +105,13 @@ namespace caret {
                                                                const int32_t channelIndex,
                                                                const int32_t pyramidLayerIndex);
 
+        CziImage* loadImageFromTiles(const CziImage* oldCziImage,
+                                     const CziImageFile::CziSceneInfo& cziSceneInfo,
+                                     const int32_t channelIndex,
+                                     const int32_t pyramidLayerIndex,
+                                     const QRectF& logicalRect,
+                                     const AString& cziName);
+        
         QRectF getViewportLogicalCoordinates(const GraphicsObjectToWindowTransform* transform,
                                              const MediaDisplayCoordinateModeEnum::Enum coordinateMode) const;
         
@@ -117,6 +126,14 @@ namespace caret {
         QRectF getViewportStereotaxicCoordinates(const GraphicsObjectToWindowTransform* transform) const;
         
         std::shared_ptr<CziImage> m_cziImage;
+        
+        std::unique_ptr<CziImageTileLoader> m_tileLoader;
+        
+        /** Name for images created from tiles */
+        AString m_tileImageName;
+        
+        /** Number of tiles loaded by the tile loader when the image was created */
+        int64_t m_numberOfTilesLoadedForImage = -1;
 
         int32_t m_tabIndex;
         
@@ -0,0 +1,453 @@
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026 Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#define __CZI_IMAGE_TILE_CACHE_DECLARE__
+#include "CziImageTileCache.h"
+#undef __CZI_IMAGE_TILE_CACHE_DECLARE__
+
+#include <algorithm>
+#include <tuple>
+
+#include "CaretAssert.h"
+#include "CaretLogger.h"
+#include "CziImageFile.h"
+#include "CziImageTileLoader.h"
+#include "CziUtilities.h"
+
+using namespace caret;
+
+/**
+ * \class caret::CziImageTileCache
+ * \brief Tiles of CZI image data shared by all tabs and overlays displaying a file
+ * \ingroup Files
+ *
+ * Each CziImageFile has one tile cache that is used by the tile loaders
+ * of all tabs and overlays so that a tile is read and decoded once, even if
+ * the same region is displayed in several tabs.  Tiles that are requested
+ * are read by a pool of worker threads that is shared by the caches of all
+ * files.  A tile requested by more than one loader is read once and its job
+ * is cancelled only when all of the loaders no longer want it.
+ *
+ * When the size of the tiles exceeds the maximum size (from the preferences),
+ * the least recently used tiles are removed.
+ */
+
+/**
+ * Constructor.
+ * @param cziImageFile
+ *    CZI image file whose tiles are in this cache
+ */
+CziImageTileCache::CziImageTileCache(CziImageFile* cziImageFile)
+: CaretObject(),
+m_cziImageFile(cziImageFile),
+m_maximumSizeBytes(512 * 1024 * 1024)
+{
+    CaretAssert(m_cziImageFile);
+}
+
+/**
+ * Destructor.
+ */
+CziImageTileCache::~CziImageTileCache()
+{
+    clear();
+}
+
+/**
+ * @return The worker pool, threads are started when first needed
+ */
+CziImageTileCache::WorkerPool*
+CziImageTileCache::getWorkerPool()
+{
+    static WorkerPool s_workerPool;
+    return &s_workerPool;
+}
+
+/**
+ * Destructor stops the worker threads
+ */
+CziImageTileCache::WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopFlag = true;
+        m_jobs.clear();
+    }
+    m_jobAvailableCondition.notify_all();
+    for (auto& thread : m_threads) {
+        thread.join();
+    }
+}
+
+/**
+ * Run by each worker thread, reads tiles until the pool is stopped
+ */
+void
+CziImageTileCache::runWorkerThread()
+{
+    WorkerPool* pool(getWorkerPool());
+    while (true) {
+        TileJob job;
+        {
+            std::unique_lock<std::mutex> lock(pool->m_mutex);
+            while (pool->m_jobs.empty()
+                   && ( ! pool->m_stopFlag)) {
+                pool->m_jobAvailableCondition.wait(lock);
+            }
+            if (pool->m_stopFlag) {
+                return;
+            }
+            job = pool->m_jobs.front();
+            pool->m_jobs.pop_front();
+            job.m_tileCache->m_numberOfJobsRunning++;
+        }
+
+        const TileRequest& request(job.m_tileRequest);
+        AString errorMessage;
+        std::shared_ptr<libCZI::IBitmapData> bitmapData;
+        try {
+            bitmapData = job.m_tileCache->m_cziImageFile->readBitmapFromCziImageFile(request.m_tileKey.m_channelIndex,
+                                                                                     request.m_logicalRect,
+                                                                                     request.m_zoom,
+                                                                                     request.m_backgroundRGB,
+                                                                                     errorMessage);
+        }
+        catch (const std::exception& e) {
+            errorMessage = e.what();
+        }
+
+        if (bitmapData) {
+            job.m_tileCache->addTile(request.m_tileKey,
+                                     CziUtilities::intRectToQRect(request.m_logicalRect),
+                                     bitmapData);
+        }
+        else {
+            CaretLogWarning("Failed to read CZI image tile for region "
+                            + CziUtilities::intRectToString(request.m_logicalRect)
+                            + ": "
+                            + errorMessage);
+        }
+
+        {
+            /*
+             * Tile cache may be destroyed once its running count is decremented
+             */
+            std::lock_guard<std::mutex> lock(pool->m_mutex);
+            job.m_tileCache->m_pendingTileKeys.erase(request.m_tileKey);
+            job.m_tileCache->m_numberOfJobsRunning--;
+        }
+        pool->m_jobFinishedCondition.notify_all();
+
+        if (bitmapData) {
+            CziImageTileLoader::getNotifier()->tileLoaded();
+        }
+    }
+}
+
+/**
+ * Request tiles for a tile loader.  Tiles that are not loaded and are not being read
+ * are queued for reading in the order given.  The loader's previously requested tiles
+ * that are not in this request are no longer wanted by the loader.
+ * @param requester
+ *    Tile loader requesting the tiles
+ * @param tileRequests
+ *    The tiles
+ */
+void
+CziImageTileCache::requestTiles(const CziImageTileLoader* requester,
+                                const std::vector<TileRequest>& tileRequests)
+{
+    std::set<TileKey> requestedTileKeys;
+    for (const auto& request : tileRequests) {
+        requestedTileKeys.insert(request.m_tileKey);
+    }
+
+    std::set<TileKey> tilesLoaded;
+    {
+        CaretMutexLocker locker(&m_tilesMutex);
+        for (const auto& tileKey : requestedTileKeys) {
+            if (m_tiles.find(tileKey) != m_tiles.end()) {
+                tilesLoaded.insert(tileKey);
+            }
+        }
+    }
+
+    WorkerPool* pool(getWorkerPool());
+    {
+        std::lock_guard<std::mutex> lock(pool->m_mutex);
+        auto jobIter(pool->m_jobs.begin());
+        while (jobIter != pool->m_jobs.end()) {
+            if ((jobIter->m_tileCache == this)
+                && (requestedTileKeys.find(jobIter->m_tileRequest.m_tileKey) == requestedTileKeys.end())) {
+                auto& requesters(jobIter->m_requesters);
+                requesters.erase(std::remove(requesters.begin(),
+                                             requesters.end(),
+                                             requester),
+                                 requesters.end());
+                if (requesters.empty()) {
+                    m_pendingTileKeys.erase(jobIter->m_tileRequest.m_tileKey);
+                    jobIter = pool->m_jobs.erase(jobIter);
+                    continue;
+                }
+            }
+            ++jobIter;
+        }
+
+        /*
+         * Erasing from a deque invalidates pointers to its
+         * elements so queued jobs are found after pruning
+         */
+        std::map<TileKey, TileJob*> queuedJobs;
+        for (auto& job : pool->m_jobs) {
+            if (job.m_tileCache == this) {
+                queuedJobs.insert(std::make_pair(job.m_tileRequest.m_tileKey,
+                                                 &job));
+            }
+        }
+
+        std::vector<TileJob> newJobs;
+        for (const auto& request : tileRequests) {
+            const TileKey& tileKey(request.m_tileKey);
+            if (tilesLoaded.find(tileKey) != tilesLoaded.end()) {
+                continue;
+            }
+            auto queuedIter(queuedJobs.find(tileKey));
+            if (queuedIter != queuedJobs.end()) {
+                auto& requesters(queuedIter->second->m_requesters);
+                if (std::find(requesters.begin(), requesters.end(), requester) == requesters.end()) {
+                    requesters.push_back(requester);
+                }
+            }
+            else if (m_pendingTileKeys.find(tileKey) == m_pendingTileKeys.end()) {
+                TileJob job;
+                job.m_tileCache   = this;
+                job.m_tileRequest = request;
+                job.m_requesters.push_back(requester);
+                newJobs.push_back(job);
+                m_pendingTileKeys.insert(tileKey);
+            }
+        }
+        pool->m_jobs.insert(pool->m_jobs.end(),
+                            newJobs.begin(),
+                            newJobs.end());
+
+        if (pool->m_threads.empty()) {
+            const int32_t numThreads(std::max(2,
+                                              std::min(4,
+                                                       static_cast<int32_t>(std::thread::hardware_concurrency() / 2))));
+            for (int32_t i = 0; i < numThreads; i++) {
+                pool->m_threads.push_back(std::thread(&CziImageTileCache::runWorkerThread));
+            }
+        }
+    }
+    pool->m_jobAvailableCondition.notify_all();
+}
+
+/**
+ * Remove a tile loader from all tile requests that have not started.  Jobs no longer
+ * wanted by any tile loader are removed.
+ * @param requester
+ *    The tile loader
+ */
+void
+CziImageTileCache::cancelRequests(const CziImageTileLoader* requester)
+{
+    requestTiles(requester,
+                 std::vector<TileRequest>());
+}
+
+/**
+ * Wait until none of the given tiles are being read.
+ * @param tileKeys
+ *    Keys of the tiles
+ */
+void
+CziImageTileCache::waitForTiles(const std::vector<TileKey>& tileKeys)
+{
+    WorkerPool* pool(getWorkerPool());
+    std::unique_lock<std::mutex> lock(pool->m_mutex);
+    while (std::any_of(tileKeys.begin(),
+                       tileKeys.end(),
+                       [this](const TileKey& tileKey) { return (m_pendingTileKeys.find(tileKey) != m_pendingTileKeys.end()); })) {
+        pool->m_jobFinishedCondition.wait(lock);
+    }
+}
+
+/**
+ * Get the tiles that are loaded and mark them as recently used
+ * @param tileKeys
+ *    Keys of the tiles
+ * @return
+ *    Tiles that are loaded in the order of the keys, tiles not loaded are omitted.
+ */
+std::vector<CziImageTileCache::Tile>
+CziImageTileCache::getTiles(const std::vector<TileKey>& tileKeys)
+{
+    std::vector<Tile> tilesOut;
+    CaretMutexLocker locker(&m_tilesMutex);
+    for (const auto& tileKey : tileKeys) {
+        auto iter(m_tiles.find(tileKey));
+        if (iter != m_tiles.end()) {
+            iter->second.m_lastUsed = ++m_tileUseCounter;
+            tilesOut.push_back(iter->second);
+        }
+    }
+    return tilesOut;
+}
+
+/**
+ * Called by a worker thread to add a tile that was read.
+ * @param tileKey
+ *    Key for the tile
+ * @param logicalRect
+ *    Logical region of the tile
+ * @param bitmapData
+ *    Tile's image data
+ */
+void
+CziImageTileCache::addTile(const TileKey& tileKey,
+                           const QRectF& logicalRect,
+                           const std::shared_ptr<libCZI::IBitmapData>& bitmapData)
+{
+    CaretAssert(bitmapData);
+    const int64_t sizeBytes(static_cast<int64_t>(bitmapData->GetWidth())
+                            * bitmapData->GetHeight() * 3);
+
+    CaretMutexLocker locker(&m_tilesMutex);
+    evictToSize(m_maximumSizeBytes - sizeBytes);
+
+    Tile tile;
+    tile.m_bitmapData  = bitmapData;
+    tile.m_logicalRect = logicalRect;
+    tile.m_sizeBytes   = sizeBytes;
+    tile.m_lastUsed    = ++m_tileUseCounter;
+    m_tilesSizeBytes += sizeBytes;
+    m_tiles[tileKey] = tile;
+    ++m_numberOfTilesLoaded;
+}
+
+/**
+ * Remove least recently used tiles until the size of the tiles does not exceed
+ * the given size.  Caller must lock the tiles mutex.
+ * @param sizeBytes
+ *    The size
+ */
+void
+CziImageTileCache::evictToSize(const int64_t sizeBytes)
+{
+    while (( ! m_tiles.empty())
+           && (m_tilesSizeBytes > sizeBytes)) {
+        auto oldestIter(m_tiles.begin());
+        for (auto iter = m_tiles.begin(); iter != m_tiles.end(); ++iter) {
+            if (iter->second.m_lastUsed < oldestIter->second.m_lastUsed) {
+                oldestIter = iter;
+            }
+        }
+        m_tilesSizeBytes -= oldestIter->second.m_sizeBytes;
+        m_tiles.erase(oldestIter);
+    }
+}
+
+/**
+ * @return Number of tiles that have been loaded.  When this changes, images
+ * created from the tiles may contain more image data.
+ */
+int64_t
+CziImageTileCache::getNumberOfTilesLoaded() const
+{
+    CaretMutexLocker locker(&m_tilesMutex);
+    return m_numberOfTilesLoaded;
+}
+
+/**
+ * @return Maximum size of the tiles in bytes
+ */
+int64_t
+CziImageTileCache::getMaximumSizeBytes() const
+{
+    CaretMutexLocker locker(&m_tilesMutex);
+    return m_maximumSizeBytes;
+}
+
+/**
+ * Set the maximum size of the tiles.  Tiles are removed if the tiles exceed the new size.
+ * @param maximumSizeBytes
+ *    The maximum size in bytes
+ */
+void
+CziImageTileCache::setMaximumSizeBytes(const int64_t maximumSizeBytes)
+{
+    CaretMutexLocker locker(&m_tilesMutex);
+    m_maximumSizeBytes = maximumSizeBytes;
+    evictToSize(m_maximumSizeBytes);
+}
+
+/**
+ * Remove this cache's jobs that have not started, wait for its running jobs
+ * to finish, and remove all tiles.
+ */
+void
+CziImageTileCache::clear()
+{
+    {
+        WorkerPool* pool(getWorkerPool());
+        std::unique_lock<std::mutex> lock(pool->m_mutex);
+        pool->m_jobs.erase(std::remove_if(pool->m_jobs.begin(),
+                                          pool->m_jobs.end(),
+                                          [this](const TileJob& job) { return (job.m_tileCache == this); }),
+                           pool->m_jobs.end());
+        while (m_numberOfJobsRunning > 0) {
+            pool->m_jobFinishedCondition.wait(lock);
+        }
+        m_pendingTileKeys.clear();
+    }
+
+    CaretMutexLocker locker(&m_tilesMutex);
+    m_tiles.clear();
+    m_tilesSizeBytes = 0;
+}
+
+/**
+ * @return True if this key is less than the other key
+ * @param rhs
+ *    The other key
+ */
+bool
+CziImageTileCache::TileKey::operator<(const TileKey& rhs) const
+{
+    return (std::tie(m_sceneIndex, m_channelIndex, m_pyramidLayerIndex, m_row, m_column)
+            < std::tie(rhs.m_sceneIndex, rhs.m_channelIndex, rhs.m_pyramidLayerIndex, rhs.m_row, rhs.m_column));
+}
+
+/**
+ * Get a description of this object's content.
+ * @return String describing this object's content.
+ */
+AString
+CziImageTileCache::toString() const
+{
+    CaretMutexLocker locker(&m_tilesMutex);
+    AString txt("CziImageTileCache");
+    txt.appendWithNewLine("   Tiles: " + AString::number(m_tiles.size()));
+    txt.appendWithNewLine("   Size (bytes): " + AString::number(m_tilesSizeBytes));
+    txt.appendWithNewLine("   Maximum Size (bytes): " + AString::number(m_maximumSizeBytes));
+    return txt;
+}
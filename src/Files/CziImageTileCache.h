@@ -0,0 +1,188 @@
+#ifndef __CZI_IMAGE_TILE_CACHE_H__
+#define __CZI_IMAGE_TILE_CACHE_H__
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026 Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+
+
+#include <array>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <QRectF>
+
+#include "CaretMutex.h"
+#include "CaretObject.h"
+#include "libCZI_Pixels.h"
+
+namespace caret {
+
+    class CziImageFile;
+    class CziImageTileLoader;
+
+    class CziImageTileCache : public CaretObject {
+
+    public:
+        /** Identifies a tile in a pyramid layer, tiles are numbered from the top left of the scene */
+        class TileKey {
+        public:
+            bool operator<(const TileKey& rhs) const;
+
+            int32_t m_sceneIndex;
+
+            int32_t m_channelIndex;
+
+            int32_t m_pyramidLayerIndex;
+
+            int64_t m_column;
+
+            int64_t m_row;
+        };
+
+        /** A tile that has been read */
+        class Tile {
+        public:
+            std::shared_ptr<libCZI::IBitmapData> m_bitmapData;
+
+            QRectF m_logicalRect;
+
+            int64_t m_sizeBytes = 0;
+
+            int64_t m_lastUsed = 0;
+        };
+
+        /** A request to read a tile */
+        class TileRequest {
+        public:
+            TileKey m_tileKey;
+
+            libCZI::IntRect m_logicalRect;
+
+            float m_zoom;
+
+            std::array<float, 3> m_backgroundRGB;
+        };
+
+        CziImageTileCache(CziImageFile* cziImageFile);
+
+        virtual ~CziImageTileCache();
+
+        CziImageTileCache(const CziImageTileCache&) = delete;
+
+        CziImageTileCache& operator=(const CziImageTileCache&) = delete;
+
+        void requestTiles(const CziImageTileLoader* requester,
+                          const std::vector<TileRequest>& tileRequests);
+
+        void cancelRequests(const CziImageTileLoader* requester);
+
+        void waitForTiles(const std::vector<TileKey>& tileKeys);
+
+        std::vector<Tile> getTiles(const std::vector<TileKey>& tileKeys);
+
+        int64_t getNumberOfTilesLoaded() const;
+
+        int64_t getMaximumSizeBytes() const;
+
+        void setMaximumSizeBytes(const int64_t maximumSizeBytes);
+
+        void clear();
+
+        // ADD_NEW_METHODS_HERE
+
+        virtual AString toString() const;
+
+    private:
+        class TileJob {
+        public:
+            CziImageTileCache* m_tileCache;
+
+            TileRequest m_tileRequest;
+
+            /** Tile loaders that want the tile, job is removed when there are none */
+            std::vector<const CziImageTileLoader*> m_requesters;
+        };
+
+        /** Threads that read tiles for the tile caches of all files */
+        class WorkerPool {
+        public:
+            ~WorkerPool();
+
+            std::mutex m_mutex;
+
+            std::condition_variable m_jobAvailableCondition;
+
+            std::condition_variable m_jobFinishedCondition;
+
+            std::deque<TileJob> m_jobs;
+
+            std::vector<std::thread> m_threads;
+
+            bool m_stopFlag = false;
+        };
+
+        static WorkerPool* getWorkerPool();
+
+        static void runWorkerThread();
+
+        void addTile(const TileKey& tileKey,
+                     const QRectF& logicalRect,
+                     const std::shared_ptr<libCZI::IBitmapData>& bitmapData);
+
+        void evictToSize(const int64_t sizeBytes);
+
+        CziImageFile* m_cziImageFile;
+
+        /** Tiles that have been read, accessed by GUI and worker threads */
+        std::map<TileKey, Tile> m_tiles;
+
+        int64_t m_tilesSizeBytes = 0;
+
+        int64_t m_maximumSizeBytes;
+
+        int64_t m_tileUseCounter = 0;
+
+        int64_t m_numberOfTilesLoaded = 0;
+
+        mutable CaretMutex m_tilesMutex;
+
+        /** Tiles queued or being read, protected by the worker pool's mutex */
+        std::set<TileKey> m_pendingTileKeys;
+
+        /** Number of this cache's jobs being run by worker threads, protected by the worker pool's mutex */
+        int32_t m_numberOfJobsRunning = 0;
+
+        // ADD_NEW_MEMBERS_HERE
+
+    };
+
+#ifdef __CZI_IMAGE_TILE_CACHE_DECLARE__
+    // <PLACE DECLARATIONS OF STATIC MEMBERS HERE>
+#endif // __CZI_IMAGE_TILE_CACHE_DECLARE__
+
+} // namespace
+#endif  //__CZI_IMAGE_TILE_CACHE_H__
@@ -0,0 +1,547 @@
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026 Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#define __CZI_IMAGE_TILE_LOADER_DECLARE__
+#include "CziImageTileLoader.h"
+#undef __CZI_IMAGE_TILE_LOADER_DECLARE__
+
+#include <algorithm>
+#include <cmath>
+
+#include <QCoreApplication>
+
+#include "CaretAssert.h"
+#include "CaretLogger.h"
+#include "CziImage.h"
+#include "CziUtilities.h"
+
+using namespace caret;
+
+namespace
+{
+    /**
+     * Bitmap data with 24 bit pixels (BGR) created by combining tiles
+     */
+    class TileCompositeBitmap : public libCZI::IBitmapData {
+    public:
+        TileCompositeBitmap(const uint32_t width,
+                            const uint32_t height)
+        : m_width(width),
+        m_height(height),
+        m_stride(width * 3),
+        m_data(static_cast<size_t>(width) * height * 3) { }
+
+        virtual libCZI::PixelType GetPixelType() const override {
+            return libCZI::PixelType::Bgr24;
+        }
+
+        virtual libCZI::IntSize GetSize() const override {
+            libCZI::IntSize size;
+            size.w = m_width;
+            size.h = m_height;
+            return size;
+        }
+
+        virtual libCZI::BitmapLockInfo Lock() override {
+            ++m_lockCount;
+            libCZI::BitmapLockInfo lockInfo;
+            lockInfo.ptrData    = m_data.data();
+            lockInfo.ptrDataRoi = m_data.data();
+            lockInfo.stride     = m_stride;
+            lockInfo.size       = m_data.size();
+            return lockInfo;
+        }
+
+        virtual void Unlock() override {
+            --m_lockCount;
+        }
+
+        uint8_t* getData() { return m_data.data(); }
+
+        uint32_t getStride() const { return m_stride; }
+
+    private:
+        const uint32_t m_width;
+
+        const uint32_t m_height;
+
+        const uint32_t m_stride;
+
+        std::vector<uint8_t> m_data;
+
+        std::atomic<int32_t> m_lockCount { 0 };
+    };
+
+    /**
+     * For each output pixel along one axis, find the nearest pixel in a tile.
+     * @param outputStart
+     *    Logical coordinate at start of output
+     * @param outputLength
+     *    Logical length of output
+     * @param outputPixels
+     *    Number of pixels in output
+     * @param tileStart
+     *    Logical coordinate at start of tile
+     * @param tileLength
+     *    Logical length of tile
+     * @param tilePixels
+     *    Number of pixels in the tile
+     * @param tileIndicesOut
+     *    Index of pixel in tile for each output pixel, negative if output pixel is not in the tile
+     * @return
+     *    True if any output pixels are in the tile
+     */
+    bool mapOutputPixelsToTilePixels(const double outputStart,
+                                     const double outputLength,
+                                     const int32_t outputPixels,
+                                     const double tileStart,
+                                     const double tileLength,
+                                     const int32_t tilePixels,
+                                     std::vector<int32_t>& tileIndicesOut)
+    {
+        tileIndicesOut.assign(outputPixels, -1);
+        if ((outputLength <= 0.0)
+            || (tileLength <= 0.0)
+            || (tilePixels <= 0)) {
+            return false;
+        }
+        const double outputPixelLength(outputLength / outputPixels);
+        const int32_t firstPixel(std::max(0,
+                                          static_cast<int32_t>(std::floor((tileStart - outputStart) / outputPixelLength))));
+        const int32_t lastPixel(std::min(outputPixels - 1,
+                                         static_cast<int32_t>(std::ceil((tileStart + tileLength - outputStart) / outputPixelLength))));
+        bool anyFlag(false);
+        for (int32_t i = firstPixel; i <= lastPixel; i++) {
+            const double logical(outputStart + (i + 0.5) * outputPixelLength);
+            if ((logical >= tileStart)
+                && (logical < (tileStart + tileLength))) {
+                const int32_t tileIndex(static_cast<int32_t>((logical - tileStart) * tilePixels / tileLength));
+                tileIndicesOut[i] = std::min(tileIndex, tilePixels - 1);
+                anyFlag = true;
+            }
+        }
+        return anyFlag;
+    }
+}
+
+/**
+ * \class caret::CziImageTileLoaderNotifier
+ * \brief Notifies the GUI that CZI image tiles have been loaded
+ * \ingroup Files
+ *
+ * Tiles are loaded in worker threads.  Notifications from worker threads
+ * are combined so that the signal is emitted once, in the GUI thread,
+ * for any number of tiles loaded since the last signal.
+ */
+
+/**
+ * Constructor.
+ * @param parent
+ *    Parent of this object
+ */
+CziImageTileLoaderNotifier::CziImageTileLoaderNotifier(QObject* parent)
+: QObject(parent),
+m_notificationPendingFlag(false)
+{
+
+}
+
+/**
+ * Destructor.
+ */
+CziImageTileLoaderNotifier::~CziImageTileLoaderNotifier()
+{
+}
+
+/**
+ * Called by a worker thread after a tile is loaded
+ */
+void
+CziImageTileLoaderNotifier::tileLoaded()
+{
+    if ( ! m_notificationPendingFlag.exchange(true)) {
+        QMetaObject::invokeMethod(this,
+                                  "emitTilesLoaded",
+                                  Qt::QueuedConnection);
+    }
+}
+
+/**
+ * Emit the tiles loaded signal, runs in the GUI thread
+ */
+void
+CziImageTileLoaderNotifier::emitTilesLoaded()
+{
+    m_notificationPendingFlag = false;
+    emit tilesLoaded();
+}
+
+/**
+ * \class caret::CziImageTileLoader
+ * \brief Loads CZI image data as fixed-size tiles in background threads
+ * \ingroup Files
+ *
+ * A region of a pyramid layer is divided into tiles of TILE_PIXEL_SIZE
+ * pixels.  Tiles are kept in the file's CziImageTileCache that is shared by
+ * the tile loaders of all tabs and overlays.  Tiles that are not loaded are
+ * read by the cache's worker threads so that reading never blocks the GUI.
+ * Tiles from the lowest resolution pyramid layer are read first so that
+ * an image is available quickly.  An image is created from the tiles that
+ * are loaded and tiles from a lower resolution layer are used where tiles
+ * from the requested layer are not yet loaded.
+ *
+ * When asynchronous loading is disabled (there is no GUI to redraw when
+ * tiles arrive), loading a region waits until all of its tiles are loaded.
+ */
+
+/**
+ * Constructor.
+ * @param cziImageFile
+ *    CZI image file whose data is load by this instance
+ */
+CziImageTileLoader::CziImageTileLoader(CziImageFile* cziImageFile)
+: CaretObject(),
+m_cziImageFile(cziImageFile)
+{
+    CaretAssert(m_cziImageFile);
+    m_tileCache = m_cziImageFile->m_tileCache.get();
+    CaretAssert(m_tileCache);
+}
+
+/**
+ * Destructor.
+ */
+CziImageTileLoader::~CziImageTileLoader()
+{
+    m_tileCache->cancelRequests(this);
+}
+
+/**
+ * @return The notifier that emits a signal when tiles have been loaded.
+ * Must be first called from the GUI thread.
+ */
+CziImageTileLoaderNotifier*
+CziImageTileLoader::getNotifier()
+{
+    if (s_notifier == NULL) {
+        s_notifier = new CziImageTileLoaderNotifier(QCoreApplication::instance());
+    }
+    return s_notifier;
+}
+
+/**
+ * Enable asynchronous loading.  Should only be enabled when something
+ * (the GUI) redraws after receiving the notifier's signal.
+ * @param enabled
+ *    New status
+ */
+void
+CziImageTileLoader::setAsynchronousLoadingEnabled(const bool enabled)
+{
+    s_asynchronousLoadingEnabled = enabled;
+}
+
+/**
+ * @return Zoom for reading a pyramid layer.  The zoom is the same for all tiles in a layer
+ * and reduces the pixel dimensions of the layer's loading region to the preferred image dimension.
+ * @param cziSceneInfo
+ *    The scene
+ * @param pyramidLayerIndex
+ *    Index of the pyramid layer
+ */
+float
+CziImageTileLoader::getPyramidLayerZoom(const CziImageFile::CziSceneInfo& cziSceneInfo,
+                                        const int32_t pyramidLayerIndex) const
+{
+    CaretAssertVectorIndex(cziSceneInfo.m_pyramidLayers, pyramidLayerIndex);
+    const auto& pyramidLayer(cziSceneInfo.m_pyramidLayers[pyramidLayerIndex]);
+    const float maxLogicalDimension(std::max(pyramidLayer.m_logicalWidthForImageReading,
+                                             pyramidLayer.m_logicalHeightForImageReading));
+    const float preferredDimension(m_cziImageFile->getPreferencesImageDimension());
+    if (maxLogicalDimension > preferredDimension) {
+        return (preferredDimension / maxLogicalDimension);
+    }
+    return 1.0;
+}
+
+/**
+ * Get the requests for reading the tiles in a pyramid layer that overlap a region.
+ * Requests are ordered by distance of the tile from the center of the region.
+ * @param cziSceneInfo
+ *    The scene
+ * @param channelIndex
+ *    Index of channel.
+ * @param pyramidLayerIndex
+ *    Index of the pyramid layer
+ * @param logicalRect
+ *    The region
+ * @param tileRequestsOut
+ *    Requests are added to this
+ */
+void
+CziImageTileLoader::getTileRequestsForLayer(const CziImageFile::CziSceneInfo& cziSceneInfo,
+                                            const int32_t channelIndex,
+                                            const int32_t pyramidLayerIndex,
+                                            const QRectF& logicalRect,
+                                            std::vector<CziImageTileCache::TileRequest>& tileRequestsOut) const
+{
+    const QRectF& sceneRect(cziSceneInfo.m_logicalRectangle);
+    const float zoom(getPyramidLayerZoom(cziSceneInfo,
+                                         pyramidLayerIndex));
+    const double tileLogicalSize(TILE_PIXEL_SIZE / zoom);
+    const int64_t numColumns(static_cast<int64_t>(std::ceil(sceneRect.width() / tileLogicalSize)));
+    const int64_t numRows(static_cast<int64_t>(std::ceil(sceneRect.height() / tileLogicalSize)));
+    if ((numColumns <= 0)
+        || (numRows <= 0)) {
+        return;
+    }
+
+    const int64_t firstColumn(std::max(static_cast<int64_t>(0),
+                                       static_cast<int64_t>(std::floor((logicalRect.left() - sceneRect.left()) / tileLogicalSize))));
+    const int64_t lastColumn(std::min(numColumns - 1,
+                                      static_cast<int64_t>(std::floor((logicalRect.right() - sceneRect.left()) / tileLogicalSize))));
+    const int64_t firstRow(std::max(static_cast<int64_t>(0),
+                                    static_cast<int64_t>(std::floor((logicalRect.top() - sceneRect.top()) / tileLogicalSize))));
+    const int64_t lastRow(std::min(numRows - 1,
+                                   static_cast<int64_t>(std::floor((logicalRect.bottom() - sceneRect.top()) / tileLogicalSize))));
+
+    const std::array<float, 3> backgroundRGB(m_cziImageFile->getPreferencesImageBackgroundFloatRGB());
+    const int64_t sceneRight(static_cast<int64_t>(std::floor(sceneRect.right())));
+    const int64_t sceneBottom(static_cast<int64_t>(std::floor(sceneRect.bottom())));
+    const QPointF regionCenter(logicalRect.center());
+    std::vector<std::pair<double, CziImageTileCache::TileRequest>> distanceRequests;
+    for (int64_t iRow = firstRow; iRow <= lastRow; iRow++) {
+        const int64_t y(static_cast<int64_t>(std::floor(sceneRect.top() + iRow * tileLogicalSize)));
+        const int64_t yEnd(std::min(sceneBottom,
+                                    static_cast<int64_t>(std::floor(sceneRect.top() + (iRow + 1) * tileLogicalSize))));
+        for (int64_t iCol = firstColumn; iCol <= lastColumn; iCol++) {
+            const int64_t x(static_cast<int64_t>(std::floor(sceneRect.left() + iCol * tileLogicalSize)));
+            const int64_t xEnd(std::min(sceneRight,
+                                        static_cast<int64_t>(std::floor(sceneRect.left() + (iCol + 1) * tileLogicalSize))));
+            if ((xEnd <= x)
+                || (yEnd <= y)) {
+                continue;
+            }
+
+            CziImageTileCache::TileRequest request;
+            request.m_tileKey.m_sceneIndex        = cziSceneInfo.m_sceneIndex;
+            request.m_tileKey.m_channelIndex      = channelIndex;
+            request.m_tileKey.m_pyramidLayerIndex = pyramidLayerIndex;
+            request.m_tileKey.m_column            = iCol;
+            request.m_tileKey.m_row               = iRow;
+            request.m_logicalRect.x = x;
+            request.m_logicalRect.y = y;
+            request.m_logicalRect.w = xEnd - x;
+            request.m_logicalRect.h = yEnd - y;
+            request.m_zoom          = zoom;
+            request.m_backgroundRGB = backgroundRGB;
+
+            const double dx((x + xEnd) / 2.0 - regionCenter.x());
+            const double dy((y + yEnd) / 2.0 - regionCenter.y());
+            distanceRequests.push_back(std::make_pair((dx * dx) + (dy * dy),
+                                                      request));
+        }
+    }
+
+    std::stable_sort(distanceRequests.begin(),
+                     distanceRequests.end(),
+                     [](const std::pair<double, CziImageTileCache::TileRequest>& a,
+                        const std::pair<double, CziImageTileCache::TileRequest>& b) { return (a.first < b.first); });
+    for (const auto& dr : distanceRequests) {
+        tileRequestsOut.push_back(dr.second);
+    }
+}
+
+/**
+ * Load the tiles for a region of a pyramid layer.  Tiles from the lowest resolution
+ * layer are also loaded so that there is image data while the region's tiles are loading.
+ * Requests for tiles that are not needed by this region and have not started are cancelled
+ * unless the tiles are wanted by another tab or overlay.
+ * @param cziSceneInfo
+ *    The scene
+ * @param channelIndex
+ *    Index of channel.  Use Zero for all channels.  This parameter is ignored if there
+ *    is only one channel in the file.
+ * @param pyramidLayerIndex
+ *    Index of the pyramid layer
+ * @param logicalRect
+ *    The region
+ */
+void
+CziImageTileLoader::loadRegion(const CziImageFile::CziSceneInfo& cziSceneInfo,
+                               const int32_t channelIndex,
+                               const int32_t pyramidLayerIndex,
+                               const QRectF& logicalRect)
+{
+    m_regionTileKeys.clear();
+    m_regionLogicalRect      = logicalRect;
+    m_regionFrameLogicalRect = cziSceneInfo.m_logicalRectangle;
+    m_regionZoom             = 1.0;
+    if (cziSceneInfo.m_pyramidLayers.empty()
+        || ( ! logicalRect.isValid())) {
+        return;
+    }
+
+    m_regionZoom = getPyramidLayerZoom(cziSceneInfo,
+                                       pyramidLayerIndex);
+
+    std::vector<CziImageTileCache::TileRequest> tileRequests;
+    const int32_t lowestPyramidLayerIndex(std::min(cziSceneInfo.getPyramidLayerIndexRange()[0],
+                                                   pyramidLayerIndex));
+    if (lowestPyramidLayerIndex != pyramidLayerIndex) {
+        getTileRequestsForLayer(cziSceneInfo,
+                                channelIndex,
+                                lowestPyramidLayerIndex,
+                                logicalRect,
+                                tileRequests);
+    }
+    getTileRequestsForLayer(cziSceneInfo,
+                            channelIndex,
+                            pyramidLayerIndex,
+                            logicalRect,
+                            tileRequests);
+    for (const auto& request : tileRequests) {
+        m_regionTileKeys.push_back(request.m_tileKey);
+    }
+
+    /*
+     * Notifier must be created in the GUI thread
+     */
+    getNotifier();
+
+    m_tileCache->requestTiles(this,
+                              tileRequests);
+
+    if ( ! s_asynchronousLoadingEnabled) {
+        m_tileCache->waitForTiles(m_regionTileKeys);
+    }
+}
+
+/**
+ * @return Number of tiles that have been loaded into the tile cache.  When this changes,
+ * an image created with createImage() may contain more of the region's image data.
+ */
+int64_t
+CziImageTileLoader::getNumberOfTilesLoaded() const
+{
+    return m_tileCache->getNumberOfTilesLoaded();
+}
+
+/**
+ * Create an image of the region most recently loaded from the tiles that have been loaded.
+ * Areas with tiles from the region's pyramid layer that are not loaded use tiles from the
+ * lowest resolution layer, and, if those are not loaded, the background color.
+ * @param imageName
+ *    Name for the image
+ * @return
+ *    The image or NULL if none of the region's tiles are loaded.
+ */
+CziImage*
+CziImageTileLoader::createImage(const AString& imageName)
+{
+    const std::vector<CziImageTileCache::Tile> tiles(m_tileCache->getTiles(m_regionTileKeys));
+    if (tiles.empty()) {
+        return NULL;
+    }
+
+    const int32_t outputWidth(std::max(1, static_cast<int32_t>(std::round(m_regionLogicalRect.width() * m_regionZoom))));
+    const int32_t outputHeight(std::max(1, static_cast<int32_t>(std::round(m_regionLogicalRect.height() * m_regionZoom))));
+    std::shared_ptr<TileCompositeBitmap> compositeBitmap(new TileCompositeBitmap(outputWidth,
+                                                                                 outputHeight));
+    uint8_t* outputData(compositeBitmap->getData());
+    const int64_t outputStride(compositeBitmap->getStride());
+
+    const std::array<uint8_t, 3> backgroundRGB(m_cziImageFile->getPreferencesImageBackgroundByteRGB());
+    for (int32_t j = 0; j < outputHeight; j++) {
+        uint8_t* row(outputData + (j * outputStride));
+        for (int32_t i = 0; i < outputWidth; i++) {
+            const int32_t i3(i * 3);
+            row[i3]     = backgroundRGB[2];
+            row[i3 + 1] = backgroundRGB[1];
+            row[i3 + 2] = backgroundRGB[0];
+        }
+    }
+
+    /*
+     * Tiles are in order of increasing resolution so
+     * higher resolution tiles replace lower resolution tiles
+     */
+    std::vector<int32_t> tileColumns;
+    std::vector<int32_t> tileRows;
+    for (const auto& tile : tiles) {
+        libCZI::IBitmapData* tileBitmap(tile.m_bitmapData.get());
+        if (tileBitmap->GetPixelType() != libCZI::PixelType::Bgr24) {
+            continue;
+        }
+        const int32_t tileWidth(tileBitmap->GetWidth());
+        const int32_t tileHeight(tileBitmap->GetHeight());
+        if ( ! mapOutputPixelsToTilePixels(m_regionLogicalRect.x(), m_regionLogicalRect.width(), outputWidth,
+                                           tile.m_logicalRect.x(), tile.m_logicalRect.width(), tileWidth,
+                                           tileColumns)) {
+            continue;
+        }
+        if ( ! mapOutputPixelsToTilePixels(m_regionLogicalRect.y(), m_regionLogicalRect.height(), outputHeight,
+                                           tile.m_logicalRect.y(), tile.m_logicalRect.height(), tileHeight,
+                                           tileRows)) {
+            continue;
+        }
+
+        libCZI::ScopedBitmapLocker<libCZI::IBitmapData*> tileLock(tileBitmap);
+        const uint8_t* tileData(static_cast<const uint8_t*>(tileLock.ptrDataRoi));
+        for (int32_t j = 0; j < outputHeight; j++) {
+            if (tileRows[j] < 0) {
+                continue;
+            }
+            const uint8_t* tileRow(tileData + (static_cast<int64_t>(tileRows[j]) * tileLock.stride));
+            uint8_t* row(outputData + (j * outputStride));
+            for (int32_t i = 0; i < outputWidth; i++) {
+                if (tileColumns[i] >= 0) {
+                    const uint8_t* tilePixel(tileRow + (tileColumns[i] * 3));
+                    uint8_t* pixel(row + (i * 3));
+                    pixel[0] = tilePixel[0];
+                    pixel[1] = tilePixel[1];
+                    pixel[2] = tilePixel[2];
+                }
+            }
+        }
+    }
+
+    std::shared_ptr<libCZI::IBitmapData> bitmapData(compositeBitmap);
+    return new CziImage(m_cziImageFile,
+                        imageName,
+                        bitmapData,
+                        m_regionFrameLogicalRect,
+                        m_regionLogicalRect);
+}
+
+/**
+ * Get a description of this object's content.
+ * @return String describing this object's content.
+ */
+AString
+CziImageTileLoader::toString() const
+{
+    AString txt("CziImageTileLoader");
+    txt.appendWithNewLine("   Region: " + CziUtilities::qRectToString(m_regionLogicalRect));
+    txt.appendWithNewLine("   Region Tiles: " + AString::number(m_regionTileKeys.size()));
+    txt.appendWithNewLine("   Tiles Loaded: " + AString::number(getNumberOfTilesLoaded()));
+    return txt;
+}
@@ -0,0 +1,131 @@
+#ifndef __CZI_IMAGE_TILE_LOADER_H__
+#define __CZI_IMAGE_TILE_LOADER_H__
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026 Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+
+
+#include <atomic>
+#include <vector>
+
+#include <QObject>
+#include <QRectF>
+
+#include "CaretObject.h"
+#include "CziImageFile.h"
+#include "CziImageTileCache.h"
+
+namespace caret {
+
+    class CziImage;
+
+    class CziImageTileLoaderNotifier : public QObject {
+
+        Q_OBJECT
+
+    public:
+        CziImageTileLoaderNotifier(QObject* parent);
+
+        virtual ~CziImageTileLoaderNotifier();
+
+        void tileLoaded();
+
+    signals:
+        /** Emitted in the GUI thread after one or more image tiles have been loaded */
+        void tilesLoaded();
+
+    private slots:
+        void emitTilesLoaded();
+
+    private:
+        std::atomic<bool> m_notificationPendingFlag;
+    };
+
+    class CziImageTileLoader : public CaretObject {
+
+    public:
+        CziImageTileLoader(CziImageFile* cziImageFile);
+
+        virtual ~CziImageTileLoader();
+
+        CziImageTileLoader(const CziImageTileLoader&) = delete;
+
+        CziImageTileLoader& operator=(const CziImageTileLoader&) = delete;
+
+        void loadRegion(const CziImageFile::CziSceneInfo& cziSceneInfo,
+                        const int32_t channelIndex,
+                        const int32_t pyramidLayerIndex,
+                        const QRectF& logicalRect);
+
+        CziImage* createImage(const AString& imageName);
+
+        int64_t getNumberOfTilesLoaded() const;
+
+        static CziImageTileLoaderNotifier* getNotifier();
+
+        static void setAsynchronousLoadingEnabled(const bool enabled);
+
+        // ADD_NEW_METHODS_HERE
+
+        virtual AString toString() const;
+
+    private:
+        float getPyramidLayerZoom(const CziImageFile::CziSceneInfo& cziSceneInfo,
+                                  const int32_t pyramidLayerIndex) const;
+
+        void getTileRequestsForLayer(const CziImageFile::CziSceneInfo& cziSceneInfo,
+                                     const int32_t channelIndex,
+                                     const int32_t pyramidLayerIndex,
+                                     const QRectF& logicalRect,
+                                     std::vector<CziImageTileCache::TileRequest>& tileRequestsOut) const;
+
+        CziImageFile* m_cziImageFile;
+
+        /** Cache containing tiles shared with the tile loaders of other tabs and overlays */
+        CziImageTileCache* m_tileCache;
+
+        /** Tiles for the region most recently loaded, coarsest pyramid layer first */
+        std::vector<CziImageTileCache::TileKey> m_regionTileKeys;
+
+        QRectF m_regionLogicalRect;
+
+        QRectF m_regionFrameLogicalRect;
+
+        float m_regionZoom = 1.0;
+
+        static bool s_asynchronousLoadingEnabled;
+
+        static CziImageTileLoaderNotifier* s_notifier;
+
+        /** Width and height of tile in pixels */
+        static const int32_t TILE_PIXEL_SIZE = 512;
+
+        // ADD_NEW_MEMBERS_HERE
+
+    };
+
+#ifdef __CZI_IMAGE_TILE_LOADER_DECLARE__
+    bool CziImageTileLoader::s_asynchronousLoadingEnabled = false;
+    CziImageTileLoaderNotifier* CziImageTileLoader::s_notifier = NULL;
+#endif // __CZI_IMAGE_TILE_LOADER_DECLARE__
+
+} // namespace
+#endif  //__CZI_IMAGE_TILE_LOADER_H__
@@ -23,10 +23,12 @@
 #include "CaretAssert.h"
 #include "CaretHeap.h"
 #include "CaretMutex.h"
+#include "CaretOMP.h"
 #include "FastStatistics.h"
 #include "SurfaceFile.h"
 #include "TopologyHelper.h"
 
+#include <algorithm>
 #include <cmath>
 #include <stdint.h>
 
@@ -90,6 +92,17 @@ GeodesicHelperBase::GeodesicHelperBase(const SurfaceFile* surfaceIn, const float
         }//so few floating point operations, this should turn out symmetric
     }
     m_avgNodeSpacing = nodeSpacingAccum / numEdges;
+    m_minEdgeLength = -1.0f;
+    m_maxEdgeLength = 0.0f;
+    for (int32_t i = 0; i < numNodes; ++i)
+    {
+        for (int32_t j = 0; j < (int32_t)distances[i].size(); ++j)
+        {
+            if (m_minEdgeLength < 0.0f || distances[i][j] < m_minEdgeLength) m_minEdgeLength = distances[i][j];
+            if (distances[i][j] > m_maxEdgeLength) m_maxEdgeLength = distances[i][j];
+        }
+    }
+    if (m_minEdgeLength < 0.0f) m_minEdgeLength = 0.0f;//no edges at all
     std::vector<int32_t> tempneigh2;
     std::vector<float> tempdist2;
     nodeNeighbors2.resize(numNodes);
@@ -162,6 +175,16 @@ GeodesicHelperBase::GeodesicHelperBase(const SurfaceFile* surfaceIn, const float
         distances2[baseNode].push_back(tempf);
         neighbors2PathInfo[baseNode].push_back(tempInfo);
     }
+    m_minEdgeLength2 = m_minEdgeLength;
+    m_maxEdgeLength2 = m_maxEdgeLength;
+    for (int32_t i = 0; i < numNodes; ++i)
+    {
+        for (int32_t j = 0; j < (int32_t)distances2[i].size(); ++j)
+        {
+            if (distances2[i][j] < m_minEdgeLength2) m_minEdgeLength2 = distances2[i][j];
+            if (distances2[i][j] > m_maxEdgeLength2) m_maxEdgeLength2 = distances2[i][j];
+        }
+    }
 }
 
 GeodesicHelper::GeodesicHelper(const CaretPointer<const GeodesicHelperBase>& baseIn)
@@ -214,6 +237,121 @@ void GeodesicHelper::getNodesToGeoDist(const int32_t node, const float maxdist,
     }
 }
 
+void GeodesicHelper::getNodesToGeoDist(const CaretPointer<const GeodesicHelperBase>& baseIn, const vector<int32_t>& roots, const float maxdist,
+                                       vector<vector<int32_t> >& nodesOut, vector<vector<float> >& distsOut, const bool smoothflag)
+{
+    int64_t numRoots = (int64_t)roots.size();
+    nodesOut.resize(numRoots);
+    distsOut.resize(numRoots);
+    int32_t numNodes = baseIn->numNodes;
+#pragma omp CARET_PAR
+    {
+        GeodesicHelper myHelper(baseIn);//scratch space for this thread, reused for every root it gets
+        float bucketWidth = myHelper.getBucketWidth(maxdist, smoothflag);
+#pragma omp CARET_FOR schedule(dynamic, 16)
+        for (int64_t i = 0; i < numRoots; ++i)
+        {
+            nodesOut[i].clear();
+            distsOut[i].clear();
+            int32_t root = roots[i];
+            CaretAssert(root < numNodes && root >= 0);
+            if (root >= numNodes || maxdist < 0.0f || root < 0) continue;
+            if (bucketWidth > 0.0f)
+            {
+                myHelper.dijkstraBuckets(root, maxdist, nodesOut[i], distsOut[i], smoothflag, bucketWidth);
+            } else {
+                myHelper.dijkstra(root, maxdist, nodesOut[i], distsOut[i], smoothflag);
+            }
+        }
+    }
+}
+
+float GeodesicHelper::getBucketWidth(const float maxdist, bool smooth)
+{
+    const int64_t MAX_BUCKETS = 4096;//scanning empty buckets costs something too, use the heap for long searches or tiny edges
+    float minEdge = (smooth ? m_myBase->m_minEdgeLength2 : m_myBase->m_minEdgeLength);
+    float maxEdge = (smooth ? m_myBase->m_maxEdgeLength2 : m_myBase->m_maxEdgeLength);
+    if (!(minEdge > 0.0f) || !(maxdist >= 0.0f)) return 0.0f;
+    float ret = minEdge * 0.99f;//slightly narrower than the shortest edge, so no relaxation from the current bucket can land in it, even with rounding
+    if (maxdist / ret > MAX_BUCKETS) return 0.0f;
+    int64_t ringSize = (int64_t)(min(maxEdge, maxdist) / ret) + 2;//largest jump a single relaxation can make, plus the current bucket
+    if ((int64_t)m_buckets.size() < ringSize) m_buckets.resize(ringSize);
+    return ret;
+}
+
+void GeodesicHelper::dijkstraBuckets(const int32_t root, const float maxdist, std::vector<int32_t>& nodesOut, std::vector<float>& dists, bool smooth, const float& bucketWidth)
+{//same search as the limited dijkstra, but buckets no wider than the shortest edge mean everything in the current bucket is already final, so no ordering within a bucket is needed
+    int32_t i, j, whichnode, whichneigh, numNeigh, numChanged = 0;
+    const int32_t* neighbors;
+    const float* neighDists;
+    float tempf;
+    int64_t ringSize = (int64_t)m_buckets.size(), lastBucket = (int64_t)(maxdist / bucketWidth);
+    output[root] = 0.0f;
+    marked[root] |= 4;
+    changed[numChanged++] = root;
+    m_buckets[0].push_back(root);
+    int64_t numQueued = 1;//includes stale entries, so we can stop early
+    for (int64_t curBucket = 0; curBucket <= lastBucket && numQueued > 0; ++curBucket)
+    {
+        vector<int32_t>& thisBucket = m_buckets[curBucket % ringSize];
+        for (size_t b = 0; b < thisBucket.size(); ++b)
+        {
+            --numQueued;
+            whichnode = thisBucket[b];
+            if (marked[whichnode] & 1) continue;//stale entry, the node moved to an earlier bucket and was already finished
+            marked[whichnode] |= 1;
+            nodesOut.push_back(whichnode);
+            dists.push_back(output[whichnode]);
+            for (int pass = 0; pass < (smooth ? 2 : 1); ++pass)
+            {
+                if (pass == 0)
+                {
+                    neighbors = nodeNeighbors[whichnode].data();
+                    neighDists = distances[whichnode].data();
+                    numNeigh = (int32_t)nodeNeighbors[whichnode].size();
+                } else {
+                    neighbors = nodeNeighbors2[whichnode].data();
+                    neighDists = distances2[whichnode].data();
+                    numNeigh = (int32_t)nodeNeighbors2[whichnode].size();
+                }
+                for (j = 0; j < numNeigh; ++j)
+                {
+                    whichneigh = neighbors[j];
+                    if (!(marked[whichneigh] & 1))
+                    {
+                        tempf = output[whichnode] + neighDists[j];
+                        if (tempf <= maxdist)
+                        {
+                            int64_t newBucket = (int64_t)(tempf / bucketWidth);
+                            if (!(marked[whichneigh] & 4))
+                            {
+                                marked[whichneigh] |= 4;
+                                changed[numChanged++] = whichneigh;
+                                output[whichneigh] = tempf;
+                                m_buckets[newBucket % ringSize].push_back(whichneigh);
+                                ++numQueued;
+                            } else if (tempf < output[whichneigh]) {
+                                int64_t oldBucket = (int64_t)(output[whichneigh] / bucketWidth);
+                                output[whichneigh] = tempf;
+                                if (newBucket != oldBucket)
+                                {
+                                    m_buckets[newBucket % ringSize].push_back(whichneigh);
+                                    ++numQueued;
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        thisBucket.clear();
+    }
+    for (i = 0; i < numChanged; ++i)
+    {
+        marked[changed[i]] = 0;
+    }
+}
+
 void GeodesicHelper::dijkstra(const int32_t root, const float maxdist, std::vector<int32_t>& nodesOut, std::vector<float>& dists, bool smooth)
 {
     int32_t i, j, whichnode, whichneigh, numNeigh, numChanged = 0;
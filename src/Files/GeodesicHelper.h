@@ -57,6 +57,8 @@ namespace caret {
         int32_t numNodes;
         float m_avgNodeSpacing;//to use for balancing line following penalty
         float m_corrAreaSmallestFactor;//so that heuristics can be consistent despite corrected areas
+        float m_minEdgeLength, m_maxEdgeLength;//range of neighbor distances, for sizing bucket queues
+        float m_minEdgeLength2, m_maxEdgeLength2;//ditto, including the smooth neighbors
     public:
         explicit GeodesicHelperBase(const SurfaceFile* surfaceIn, const float* correctedAreas = NULL);//NOTE: this is only an APPROXIMATE correction, use the real surface whenever possible
         friend class GeodesicHelper;//let it grab the private variables it needs
@@ -77,6 +79,7 @@ namespace caret {
         std::vector<float> heurVal;
         std::vector<int32_t> marked, changed, parentStore;
         std::vector<int64_t> m_heapIdent;
+        std::vector<std::vector<int32_t> > m_buckets;//circular bucket queue for short limited searches, kept to reuse the allocations
         int32_t numNodes;
         float m_avgNodeSpacing;
         float m_corrAreaSmallestFactor;
@@ -84,6 +87,8 @@ namespace caret {
         GeodesicHelper& operator=(const GeodesicHelper& right);//can't assign
         GeodesicHelper(const GeodesicHelper&);//can't use copy constructor
         void dijkstra(const int32_t root, const float maxdist, std::vector<int32_t>& nodes, std::vector<float>& dists, bool smooth);//geodesic distance restricted
+        void dijkstraBuckets(const int32_t root, const float maxdist, std::vector<int32_t>& nodes, std::vector<float>& dists, bool smooth, const float& bucketWidth);//ditto, bucket queue instead of heap, output not sorted
+        float getBucketWidth(const float maxdist, bool smooth);//returns 0 if a bucket queue would be slower or inexact
         void dijkstra(const int32_t root, bool smooth);//full surface
         void dijkstra(const std::set<int32_t>& startList, const bool smooth);//full surface from multiple starting points
         void dijkstra(const int32_t root, const std::vector<int32_t>& interested, bool smooth);//partial surface
@@ -103,6 +108,10 @@ namespace caret {
         /// Get distances from root node, up to a geodesic distance cutoff, and also return their parents (root node has -1 as parent)
         void getNodesToGeoDist(const int32_t node, const float maxdist, std::vector<int32_t>& neighborsOut, std::vector<float>& distsOut, std::vector<int32_t>& parentsOut, const bool smoothflag = true);
 
+        /// Get distances up to a geodesic cutoff from many root nodes, in parallel - outputs are indexed the same as roots, but nodes within each output are NOT sorted by distance
+        static void getNodesToGeoDist(const CaretPointer<const GeodesicHelperBase>& baseIn, const std::vector<int32_t>& roots, const float maxdist,
+                                      std::vector<std::vector<int32_t> >& neighborsOut, std::vector<std::vector<float> >& distsOut, const bool smoothflag = true);
+
         /// Get distances from root node to entire surface - allocate the array first
         void getGeoFromNode(const int32_t node, float* valuesOut, const bool smoothflag = true);//MUST be already allocated to number of nodes
 
@@ -23,6 +23,8 @@
 #include "HistologySliceImage.h"
 #undef __HISTOLOGY_SLICE_IMAGE_DECLARE__
 
+#include <chrono>
+
 #include "CaretAssert.h"
 #include "CaretLogger.h"
 #include "CziDistanceFile.h"
@@ -154,6 +156,194 @@ HistologySliceImage::getMediaFile() const
 const MediaFile*
 HistologySliceImage::getMediaFilePrivate() const
 {
+    return readMediaFile();
+}
+
+/**
+ * @return The media file for drawing.  A media file that was read by
+ * prefetching is no longer released by releasePrefetchedMediaFile()
+ * once it has been drawn.
+ */
+MediaFile*
+HistologySliceImage::getMediaFileForDrawing()
+{
+    m_mediaFilePrefetchedFlag = false;
+    return getMediaFile();
+}
+
+/**
+ * Start reading the media file, in a background thread, before it is needed for
+ * display.  For CZI files, the file is opened in the background thread and
+ * reading is completed, without waiting, in the GUI thread by getPrefetchedMediaFile()
+ * since completing reading of a CZI file sends events.  The CZI file's image data
+ * is read in background threads when the image is updated for drawing.
+ */
+void
+HistologySliceImage::prefetchMediaFile()
+{
+    if (m_attemptedToReadMediaFileFlag
+        || m_prefetchMediaFileFuture.valid()) {
+        return;
+    }
+    
+    bool validExtensionFlag(false);
+    const DataFileTypeEnum::Enum dataFileType = DataFileTypeEnum::fromFileExtension(m_mediaFileName,
+                                                                                    &validExtensionFlag);
+    if ( ! validExtensionFlag) {
+        return;
+    }
+    switch (dataFileType) {
+        case DataFileTypeEnum::CZI_IMAGE_FILE:
+        case DataFileTypeEnum::IMAGE:
+            m_prefetchMediaFileFuture = std::async(std::launch::async,
+                                                   &HistologySliceImage::readMediaFileInBackground,
+                                                   m_mediaFileName,
+                                                   dataFileType);
+            m_mediaFilePrefetchedFlag = true;
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * @return The media file if it has been read by prefetching and reading has finished,
+ * otherwise NULL.  Does not wait for reading to finish.
+ */
+MediaFile*
+HistologySliceImage::getPrefetchedMediaFile()
+{
+    if (m_prefetchMediaFileFuture.valid()) {
+        if (m_prefetchMediaFileFuture.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            return NULL;
+        }
+        readMediaFile();
+    }
+    if (m_attemptedToReadMediaFileFlag) {
+        return m_mediaFile.get();
+    }
+    return NULL;
+}
+
+/**
+ * Release a media file that was read by prefetching and has not been drawn.
+ * Does not wait for reading in a background thread to finish.
+ * @return
+ *    True if the media file was released or there is nothing to release.
+ *    False if the media file is still being read and release must be tried again.
+ */
+bool
+HistologySliceImage::releasePrefetchedMediaFile()
+{
+    if ( ! m_mediaFilePrefetchedFlag) {
+        return true;
+    }
+    if (m_prefetchMediaFileFuture.valid()) {
+        if (m_prefetchMediaFileFuture.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            return false;
+        }
+        
+        /*
+         * Discard without completing reading
+         */
+        m_prefetchMediaFileFuture.get();
+    }
+    m_mediaFile.reset();
+    m_attemptedToReadMediaFileFlag = false;
+    m_mediaFilePrefetchedFlag = false;
+    return true;
+}
+
+/**
+ * Read a media file, runs in a background thread.  Image files are read.
+ * CZI files are opened, completing reading of a CZI file sends events
+ * so it must be performed in the GUI thread.
+ * @param mediaFileName
+ *    Name of the media file
+ * @param dataFileType
+ *    Type of the media file
+ * @return
+ *    Function, called in the GUI thread, that completes reading and returns
+ *    the media file or NULL if reading failed
+ */
+HistologySliceImage::MediaFileCompletion
+HistologySliceImage::readMediaFileInBackground(const AString& mediaFileName,
+                                               const DataFileTypeEnum::Enum dataFileType)
+{
+    switch (dataFileType) {
+        case DataFileTypeEnum::CZI_IMAGE_FILE:
+        {
+            std::shared_ptr<std::unique_ptr<CziImageFile::OpenedFile>> openedFile(new std::unique_ptr<CziImageFile::OpenedFile>(CziImageFile::openFile(mediaFileName)));
+            return [mediaFileName, openedFile]() {
+                std::unique_ptr<MediaFile> mediaFileOut;
+                try {
+                    std::unique_ptr<CziImageFile> cziImageFile(new CziImageFile());
+                    cziImageFile->readOpenedFile(mediaFileName,
+                                                 std::move(*openedFile));
+                    mediaFileOut.reset(cziImageFile.release());
+                }
+                catch (const DataFileException& dfe) {
+                    const AString msg("Error while reading "
+                                      + mediaFileName
+                                      + ": "
+                                      + dfe.whatString());
+                    CaretLogSevere(msg);
+                }
+                return mediaFileOut;
+            };
+        }
+            break;
+        case DataFileTypeEnum::IMAGE:
+        {
+            std::shared_ptr<std::unique_ptr<MediaFile>> mediaFile(new std::unique_ptr<MediaFile>());
+            try {
+                std::unique_ptr<ImageFile> imageFile(new ImageFile());
+                imageFile->readFile(mediaFileName);
+                mediaFile->reset(imageFile.release());
+            }
+            catch (const DataFileException& dfe) {
+                const AString msg("Error while reading "
+                                  + mediaFileName
+                                  + ": "
+                                  + dfe.whatString());
+                CaretLogSevere(msg);
+            }
+            return [mediaFile]() {
+                return std::move(*mediaFile);
+            };
+        }
+            break;
+        default:
+            CaretAssert(0);
+            break;
+    }
+    
+    return []() {
+        return std::unique_ptr<MediaFile>();
+    };
+}
+
+/**
+ * @return The media file, reads the media file the first time called or, if the
+ * media file is being read by prefetching, waits for reading to finish.
+ */
+const MediaFile*
+HistologySliceImage::readMediaFile() const
+{
+    if (m_prefetchMediaFileFuture.valid()) {
+        MediaFileCompletion completion(m_prefetchMediaFileFuture.get());
+        m_mediaFile = completion();
+        m_attemptedToReadMediaFileFlag = true;
+        if (m_mediaFile) {
+            m_mediaFile->setTransformMatrices(m_scaledToPlaneMatrix,
+                                              m_scaledToPlaneMatrixValidFlag,
+                                              m_planeToMillimetersMatrix,
+                                              m_planeToMillimetersMatrixValidFlag,
+                                              m_toStereotaxicNonLinearTransform,
+                                              m_fromStereotaxicNonLinearTransform);
+        }
+        return m_mediaFile.get();
+    }
     
     if (m_attemptedToReadMediaFileFlag) {
         return m_mediaFile.get();
@@ -23,9 +23,12 @@
 
 
 
+#include <functional>
+#include <future>
 #include <memory>
 
 #include "CaretObject.h"
+#include "DataFileTypeEnum.h"
 
 #include "EventListenerInterface.h"
 #include "Matrix4x4.h"
@@ -59,6 +62,8 @@ namespace caret {
         
         const MediaFile* getMediaFile() const;
         
+        MediaFile* getMediaFileForDrawing();
+        
         virtual bool stereotaxicXyzToPlaneXyz(const Vector3D& stereotaxicXyz,
                                               Vector3D& planeXyzOut) const;
         
@@ -69,6 +74,12 @@ namespace caret {
         
         std::vector<AString> getChildDataFilePathNames() const;
         
+        void prefetchMediaFile();
+        
+        MediaFile* getPrefetchedMediaFile();
+        
+        bool releasePrefetchedMediaFile();
+        
         // ADD_NEW_METHODS_HERE
 
         const CziDistanceFile* getDistanceFile() const;
@@ -110,6 +121,14 @@ namespace caret {
 
         const MediaFile* getMediaFilePrivate() const;
         
+        const MediaFile* readMediaFile() const;
+        
+        /** Completes reading of a prefetched media file in the GUI thread */
+        typedef std::function<std::unique_ptr<MediaFile>()> MediaFileCompletion;
+        
+        static MediaFileCompletion readMediaFileInBackground(const AString& mediaFileName,
+                                                             const DataFileTypeEnum::Enum dataFileType);
+        
         std::unique_ptr<SceneClassAssistant> m_sceneAssistant;
 
         const AString m_sceneName;
@@ -133,6 +152,12 @@ namespace caret {
         mutable std::unique_ptr<MediaFile> m_mediaFile;
         
         mutable bool m_attemptedToReadMediaFileFlag = false;
+        
+        /** Media file being read in a background thread by prefetchMediaFile() */
+        mutable std::future<MediaFileCompletion> m_prefetchMediaFileFuture;
+        
+        /** True if the media file was read by prefetching and has not been used for display */
+        mutable bool m_mediaFilePrefetchedFlag = false;
 
         mutable std::unique_ptr<CziDistanceFile> m_distanceFile;
         
@@ -23,6 +23,8 @@
 #include "HistologySlicesFile.h"
 #undef __HISTOLOGY_SLICES_FILE_DECLARE__
 
+#include <algorithm>
+
 #include <QFile>
 
 #include "CaretAssert.h"
@@ -182,6 +184,8 @@ HistologySlicesFile::clear()
     CaretDataFile::clear();
     m_metaData->clear();
     m_histologySlices.clear();
+    m_prefetchNavigations.clear();
+    m_pendingReleaseSliceIndices.clear();
     resetAfterSlicesChanged();
 }
 
@@ -831,6 +835,162 @@ HistologySlicesFile::getSliceSpacing() const
     return m_sliceSpacing;
 }
 
+/**
+ * Prefetch the images of slices adjacent to the slice displayed in a tab's overlay
+ * so that stepping to the next slice does not wait for reading of the images.
+ * Slices ahead of the displayed slice, in the direction that slices were most recently
+ * stepped, and the slice behind are prefetched.  Each tab's overlay keeps its own list
+ * of prefetched slices so that views do not evict each other's slices.  When a list
+ * exceeds MAXIMUM_NUMBER_OF_PREFETCHED_SLICES_PER_NAVIGATION, its oldest slices are
+ * released unless displayed or prefetched by another tab's overlay.
+ * @param tabIndex
+ *    Index of the tab
+ * @param overlayIndex
+ *    Index of the overlay
+ * @param sliceIndex
+ *    Index of the slice displayed in the tab's overlay
+ * @return
+ *    Media files of adjacent slices that have finished reading.  These may be used to
+ *    start loading of image data at the current display resolution.
+ */
+std::vector<MediaFile*>
+HistologySlicesFile::prefetchAdjacentSlices(const int32_t tabIndex,
+                                            const int32_t overlayIndex,
+                                            const int32_t sliceIndex)
+{
+    std::vector<MediaFile*> mediaFilesOut;
+    
+    const int32_t numSlices(getNumberOfHistologySlices());
+    if ((sliceIndex < 0)
+        || (sliceIndex >= numSlices)) {
+        return mediaFilesOut;
+    }
+    
+    /*
+     * Retry release of slices that were still reading when released
+     */
+    const std::set<int32_t> pendingReleaseSliceIndices(m_pendingReleaseSliceIndices);
+    m_pendingReleaseSliceIndices.clear();
+    for (const int32_t pendingIndex : pendingReleaseSliceIndices) {
+        if ( ! isSliceUsedByPrefetchNavigation(pendingIndex)) {
+            releasePrefetchedSlice(pendingIndex);
+        }
+    }
+    
+    PrefetchNavigation& navigation(m_prefetchNavigations[std::make_pair(tabIndex, overlayIndex)]);
+    if (navigation.m_sliceIndex >= 0) {
+        if (sliceIndex > navigation.m_sliceIndex) {
+            navigation.m_direction = 1;
+        }
+        else if (sliceIndex < navigation.m_sliceIndex) {
+            navigation.m_direction = -1;
+        }
+    }
+    navigation.m_sliceIndex = sliceIndex;
+    
+    /*
+     * Displayed slice is no longer a prefetched slice
+     */
+    std::deque<int32_t>& prefetchedSliceIndices(navigation.m_prefetchedSliceIndices);
+    prefetchedSliceIndices.erase(std::remove(prefetchedSliceIndices.begin(),
+                                             prefetchedSliceIndices.end(),
+                                             sliceIndex),
+                                 prefetchedSliceIndices.end());
+    
+    std::vector<int32_t> adjacentSliceIndices;
+    for (int32_t i = 1; i <= PREFETCH_SLICES_AHEAD; i++) {
+        adjacentSliceIndices.push_back(sliceIndex + (i * navigation.m_direction));
+    }
+    for (int32_t i = 1; i <= PREFETCH_SLICES_BEHIND; i++) {
+        adjacentSliceIndices.push_back(sliceIndex - (i * navigation.m_direction));
+    }
+    
+    for (const int32_t adjacentIndex : adjacentSliceIndices) {
+        if ((adjacentIndex < 0)
+            || (adjacentIndex >= numSlices)) {
+            continue;
+        }
+        HistologySlice* slice(getHistologySliceByIndex(adjacentIndex));
+        CaretAssert(slice);
+        const int32_t numImages(slice->getNumberOfHistologySliceImages());
+        for (int32_t iImage = 0; iImage < numImages; iImage++) {
+            HistologySliceImage* sliceImage(slice->getHistologySliceImage(iImage));
+            CaretAssert(sliceImage);
+            sliceImage->prefetchMediaFile();
+            MediaFile* mediaFile(sliceImage->getPrefetchedMediaFile());
+            if (mediaFile != NULL) {
+                mediaFilesOut.push_back(mediaFile);
+            }
+        }
+        
+        m_pendingReleaseSliceIndices.erase(adjacentIndex);
+        prefetchedSliceIndices.erase(std::remove(prefetchedSliceIndices.begin(),
+                                                 prefetchedSliceIndices.end(),
+                                                 adjacentIndex),
+                                     prefetchedSliceIndices.end());
+        prefetchedSliceIndices.push_back(adjacentIndex);
+    }
+    
+    while (static_cast<int32_t>(prefetchedSliceIndices.size()) > MAXIMUM_NUMBER_OF_PREFETCHED_SLICES_PER_NAVIGATION) {
+        const int32_t oldestIndex(prefetchedSliceIndices.front());
+        prefetchedSliceIndices.pop_front();
+        if ( ! isSliceUsedByPrefetchNavigation(oldestIndex)) {
+            releasePrefetchedSlice(oldestIndex);
+        }
+    }
+    
+    return mediaFilesOut;
+}
+
+/**
+ * @return True if the slice is displayed by, or prefetched for, any tab's overlay
+ * @param sliceIndex
+ *    Index of the slice
+ */
+bool
+HistologySlicesFile::isSliceUsedByPrefetchNavigation(const int32_t sliceIndex) const
+{
+    for (const auto& keyAndNavigation : m_prefetchNavigations) {
+        const PrefetchNavigation& navigation(keyAndNavigation.second);
+        if (navigation.m_sliceIndex == sliceIndex) {
+            return true;
+        }
+        if (std::find(navigation.m_prefetchedSliceIndices.begin(),
+                      navigation.m_prefetchedSliceIndices.end(),
+                      sliceIndex) != navigation.m_prefetchedSliceIndices.end()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Release the prefetched images of a slice.  Releasing does not wait for images
+ * that are still being read; the slice is added to the pending releases and
+ * release is retried on the next prefetch.
+ * @param sliceIndex
+ *    Index of the slice
+ */
+void
+HistologySlicesFile::releasePrefetchedSlice(const int32_t sliceIndex)
+{
+    HistologySlice* slice(getHistologySliceByIndex(sliceIndex));
+    if (slice == NULL) {
+        return;
+    }
+    
+    bool allReleasedFlag(true);
+    const int32_t numImages(slice->getNumberOfHistologySliceImages());
+    for (int32_t iImage = 0; iImage < numImages; iImage++) {
+        if ( ! slice->getHistologySliceImage(iImage)->releasePrefetchedMediaFile()) {
+            allReleasedFlag = false;
+        }
+    }
+    if ( ! allReleasedFlag) {
+        m_pendingReleaseSliceIndices.insert(sliceIndex);
+    }
+}
+
 /**
  * Create the overlapping masking textures
  */
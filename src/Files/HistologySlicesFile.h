@@ -23,7 +23,10 @@
 
 
 
+#include <deque>
+#include <map>
 #include <memory>
+#include <set>
 
 #include "BoundingBox.h"
 #include "CaretDataFile.h"
@@ -33,6 +36,7 @@
 namespace caret {
     class HistologyCoordinate;
     class HistologySlice;
+    class MediaFile;
     class SceneClassAssistant;
 
     class HistologySlicesFile : public CaretDataFile, public EventListenerInterface {
@@ -112,6 +116,10 @@ namespace caret {
         
         void createOverlapMaskingTextures();
         
+        std::vector<MediaFile*> prefetchAdjacentSlices(const int32_t tabIndex,
+                                                       const int32_t overlayIndex,
+                                                       const int32_t sliceIndex);
+        
     protected:
         virtual void saveFileDataToScene(const SceneAttributes* sceneAttributes,
                                           SceneClass* sceneClass) override;
@@ -138,6 +146,21 @@ namespace caret {
 
         void resetAfterSlicesChanged();
         
+        /** Slice most recently displayed in a tab's overlay, direction of navigation to it, and slices prefetched for it */
+        class PrefetchNavigation {
+        public:
+            int32_t m_sliceIndex = -1;
+            
+            int32_t m_direction = 1;
+            
+            /** Indices of slices prefetched for the tab's overlay, most recently requested at back */
+            std::deque<int32_t> m_prefetchedSliceIndices;
+        };
+        
+        bool isSliceUsedByPrefetchNavigation(const int32_t sliceIndex) const;
+        
+        void releasePrefetchedSlice(const int32_t sliceIndex);
+        
         std::unique_ptr<SceneClassAssistant> m_sceneAssistant;
 
         std::unique_ptr<GiftiMetaData> m_metaData;
@@ -156,6 +179,21 @@ namespace caret {
         
         mutable bool m_sliceSpacingValid = false;
         
+        /** Navigation in each tab and overlay, key is tab index and overlay index */
+        std::map<std::pair<int32_t, int32_t>, PrefetchNavigation> m_prefetchNavigations;
+        
+        /** Indices of slices whose prefetched images were still reading when released, release is retried */
+        std::set<int32_t> m_pendingReleaseSliceIndices;
+        
+        /** Number of slices ahead of the displayed slice, in direction of navigation, that are prefetched */
+        static const int32_t PREFETCH_SLICES_AHEAD = 2;
+        
+        /** Number of slices behind the displayed slice that are prefetched */
+        static const int32_t PREFETCH_SLICES_BEHIND = 1;
+        
+        /** Maximum number of prefetched slices that are kept for each tab's overlay */
+        static const int32_t MAXIMUM_NUMBER_OF_PREFETCHED_SLICES_PER_NAVIGATION = 6;
+        
         // ADD_NEW_MEMBERS_HERE
 
     };
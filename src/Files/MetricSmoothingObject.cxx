@@ -22,31 +22,127 @@
 
 #include "CaretAssert.h"
 #include "CaretException.h"
+#include "CaretLogger.h"
 #include "SurfaceFile.h"
 #include "MetricFile.h"
 #include "GeodesicHelper.h"
 #include "TopologyHelper.h"
 #include "CaretOMP.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+#include <algorithm>
 #include <cmath>
+#include <cstring>
 
 using namespace std;
 using namespace caret;
 
-MetricSmoothingObject::MetricSmoothingObject(const SurfaceFile* mySurf, const float& kernel, const MetricFile* myRoi, Method myMethod, const float* nodeAreas)
+namespace
+{
+    
+    const int32_t PANEL_COLUMNS = 16;//columns smoothed together by smoothColumns, interleaved so each neighbor's values are contiguous
+    
+    const int32_t GEO_NEIGHBORHOOD_CHUNK = 4096;//nodes whose geodesic neighborhoods are found at once, so only a chunk of neighborhoods is in memory besides the weights
+    
+    const int32_t WEIGHT_CACHE_VERSION = 1;//increment when the weight computation changes, so that old cache files are not used
+    const char WEIGHT_CACHE_MAGIC[8] = { 'W', 'B', 'S', 'M', 'O', 'O', 'T', 'H' };
+    const int32_t WEIGHT_CACHE_BYTE_ORDER = 0x01020304;//cache files are only meant to be used on the machine that made them, so just detect a mismatch
+    
+    struct WeightCacheHeader
+    {
+        char m_magic[8];
+        int32_t m_byteOrder;
+        int32_t m_numNodes;
+        int64_t m_numWeights;
+        char m_padding[40];//make it 64 bytes, so the arrays after it are aligned
+    };
+    
+    AString getWeightCacheKey(const SurfaceFile* mySurf, const float& kernel, const MetricFile* theRoi, const int32_t& method, const float* nodeAreas)
+    {
+        int32_t numNodes = mySurf->getNumberOfNodes(), numTris = mySurf->getNumberOfTriangles();
+        QCryptographicHash myHash(QCryptographicHash::Sha1);
+        int32_t params[5] = { WEIGHT_CACHE_VERSION, method, numNodes, numTris, (theRoi != NULL ? 1 : 0) };
+        myHash.addData((const char*)params, sizeof(params));
+        myHash.addData((const char*)&kernel, sizeof(float));
+        myHash.addData((const char*)mySurf->getCoordinateData(), numNodes * 3 * sizeof(float));
+        for (int32_t i = 0; i < numTris; ++i)
+        {
+            myHash.addData((const char*)mySurf->getTriangle(i), 3 * sizeof(int32_t));
+        }
+        myHash.addData((const char*)nodeAreas, numNodes * sizeof(float));
+        if (theRoi != NULL)
+        {//weights only depend on which nodes are in the roi
+            const float* roiData = theRoi->getValuePointerForColumn(0);
+            vector<char> roiMask(numNodes);
+            for (int32_t i = 0; i < numNodes; ++i)
+            {
+                roiMask[i] = (roiData[i] > 0.0f ? 1 : 0);
+            }
+            myHash.addData(roiMask.data(), numNodes);
+        }
+        return AString(myHash.result().toHex());
+    }
+    
+    void computeGeoNeighborhoods(const CaretPointer<GeodesicHelperBase>& geoBase, const float& geoDist, const float* roiColumn, const int32_t& chunkStart, const int32_t& chunkEnd,
+                                 vector<vector<int32_t> >& nodesOut, vector<vector<float> >& distsOut)
+    {//doing all roots of a chunk in one call lets the helper reuse its scratch space and use its bucket queue, outputs are indexed by node - chunkStart, and empty outside the roi
+        vector<int32_t> roots;
+        for (int32_t i = chunkStart; i < chunkEnd; ++i)
+        {
+            if (roiColumn == NULL || roiColumn[i] > 0.0f) roots.push_back(i);
+        }
+        vector<vector<int32_t> > rootNodes;
+        vector<vector<float> > rootDists;
+        GeodesicHelper::getNodesToGeoDist(geoBase, roots, geoDist, rootNodes, rootDists, true);
+        nodesOut.assign(chunkEnd - chunkStart, vector<int32_t>());//also releases the previous chunk
+        distsOut.assign(chunkEnd - chunkStart, vector<float>());
+        for (size_t i = 0; i < roots.size(); ++i)
+        {
+            nodesOut[roots[i] - chunkStart].swap(rootNodes[i]);
+            distsOut[roots[i] - chunkStart].swap(rootDists[i]);
+        }
+    }
+    
+    void useTopologyNeighbors(const CaretPointer<GeodesicHelperBase>& geoBase, CaretPointer<GeodesicHelper>& geoHelp, const CaretSpan<int32_t>& neighbors, const int32_t& node,
+                              vector<int32_t>& nodesOut, vector<float>& distsOut)
+    {//too few nodes within the geodesic distance, use the topology neighbors and the center instead, the per-thread GeodesicHelper for their distances is only made when this happens
+        nodesOut = neighbors;
+        nodesOut.push_back(node);
+        if (geoHelp == NULL) geoHelp.grabNew(new GeodesicHelper(geoBase));
+        geoHelp->getGeoToTheseNodes(node, nodesOut, distsOut, true);
+    }
+}
+
+MetricSmoothingObject::MetricSmoothingObject(const SurfaceFile* mySurf, const float& kernel, const MetricFile* myRoi, Method myMethod, const float* nodeAreas,
+                                             const AString& weightCacheDirectory)
 {
     CaretAssert(mySurf != NULL);
     if (myRoi != NULL && mySurf->getNumberOfNodes() != myRoi->getNumberOfNodes())
     {
         throw CaretException("roi number of nodes doesn't match the surface");
     }
-    precomputeWeights(mySurf, kernel, myRoi, myMethod, nodeAreas);
+    m_numNodes = mySurf->getNumberOfNodes();
+    m_rowStart = NULL;
+    m_rowNodes = NULL;
+    m_rowWeights = NULL;
+    m_weightSums = NULL;
+    precomputeWeights(mySurf, kernel, myRoi, myMethod, nodeAreas, weightCacheDirectory);
+}
+
+MetricSmoothingObject::~MetricSmoothingObject()
+{
 }
 
 void MetricSmoothingObject::smoothColumn(const MetricFile* metricIn, const int& whichColumn, MetricFile* columnOut, const MetricFile* roi, const bool& fixZeros) const
 {
     CaretAssert(metricIn != NULL);
     CaretAssert(columnOut != NULL);
-    if (metricIn->getNumberOfNodes() != (int32_t)m_weightLists.size())
+    if (metricIn->getNumberOfNodes() != m_numNodes)
     {
         throw CaretException("metric does not match surface number of nodes");
     }
@@ -54,14 +150,14 @@ void MetricSmoothingObject::smoothColumn(const MetricFile* metricIn, const int&
     {
         throw CaretException("invalid column number");
     }
-    if (columnOut->getNumberOfNodes() != (int32_t)m_weightLists.size() || columnOut->getNumberOfColumns() != 1)
+    if (columnOut->getNumberOfNodes() != m_numNodes || columnOut->getNumberOfColumns() != 1)
     {
-        columnOut->setNumberOfNodesAndColumns(m_weightLists.size(), 1);
+        columnOut->setNumberOfNodesAndColumns(m_numNodes, 1);
     }
     vector<float> scratch(metricIn->getNumberOfNodes());
     if (roi != NULL)
     {
-        if (roi->getNumberOfNodes() != (int32_t)m_weightLists.size())
+        if (roi->getNumberOfNodes() != m_numNodes)
         {
             throw CaretException("roi does not match surface number of nodes");
         }
@@ -75,15 +171,15 @@ void MetricSmoothingObject::smoothColumn(const MetricFile* metricIn, const int&
 {
     CaretAssert(metricIn != NULL);
     CaretAssert(metricOut != NULL);
-    if (metricIn->getNumberOfNodes() != (int32_t)m_weightLists.size())
+    if (metricIn->getNumberOfNodes() != m_numNodes)
     {
         throw CaretException("metric does not match surface number of nodes");
     }
-    if (metricOut->getNumberOfNodes() != (int32_t)m_weightLists.size())
+    if (metricOut->getNumberOfNodes() != m_numNodes)
     {
         throw CaretException("output metric does not match surface number of nodes");
     }
-    if (roi != NULL && (roi->getNumberOfNodes() != (int32_t)m_weightLists.size()))
+    if (roi != NULL && (roi->getNumberOfNodes() != m_numNodes))
     {
         throw CaretException("roi does not match surface number of nodes");
     }
@@ -113,29 +209,159 @@ void MetricSmoothingObject::smoothMetric(const MetricFile* metricIn, MetricFile*
     CaretAssert(metricIn != NULL);
     CaretAssert(metricOut != NULL);
     int32_t numCols = metricIn->getNumberOfColumns();
-    if (metricIn->getNumberOfNodes() != (int32_t)m_weightLists.size())
+    if (metricIn->getNumberOfNodes() != m_numNodes)
     {
         throw CaretException("metric does not match surface number of nodes");
     }
-    if (metricOut->getNumberOfNodes() != (int32_t)m_weightLists.size() || metricOut->getNumberOfColumns() != numCols)
+    if (metricOut->getNumberOfNodes() != m_numNodes || metricOut->getNumberOfColumns() != numCols)
     {
-        metricOut->setNumberOfNodesAndColumns(m_weightLists.size(), numCols);
+        metricOut->setNumberOfNodesAndColumns(m_numNodes, numCols);
     }
-    vector<float> scratch(metricIn->getNumberOfNodes());
-    if (roi != NULL)
+    smoothColumns(metricIn, 0, numCols, metricOut, 0, roi, 0, fixZeros);
+}
+
+void MetricSmoothingObject::smoothColumns(const MetricFile* metricIn, const int& firstColumn, const int& numColumns, MetricFile* metricOut, const int& firstOutColumn,
+                                          const MetricFile* roi, const int& whichRoiColumn, const bool& fixZeros) const
+{
+    CaretAssert(metricIn != NULL);
+    CaretAssert(metricOut != NULL);
+    if (metricIn->getNumberOfNodes() != m_numNodes)
     {
-        if (roi->getNumberOfNodes() != (int32_t)m_weightLists.size())
+        throw CaretException("metric does not match surface number of nodes");
+    }
+    if (metricOut->getNumberOfNodes() != m_numNodes)
+    {
+        throw CaretException("output metric does not match surface number of nodes");
+    }
+    if (roi != NULL && (roi->getNumberOfNodes() != m_numNodes))
+    {
+        throw CaretException("roi does not match surface number of nodes");
+    }
+    if (firstColumn < 0 || numColumns < 0 || firstColumn + numColumns > metricIn->getNumberOfColumns())
+    {
+        throw CaretException("invalid input column range");
+    }
+    if (firstOutColumn < 0 || firstOutColumn + numColumns > metricOut->getNumberOfColumns())
+    {
+        throw CaretException("invalid output column range");
+    }
+    if (roi != NULL && (whichRoiColumn < 0 || whichRoiColumn >= roi->getNumberOfColumns()))
+    {
+        throw CaretException("invalid roi column number");
+    }
+    if (numColumns == 0) return;
+    const float* roiColumn = NULL;
+    if (roi != NULL) roiColumn = roi->getValuePointerForColumn(whichRoiColumn);
+    vector<float> panelIn((int64_t)m_numNodes * PANEL_COLUMNS), panelOut((int64_t)m_numNodes * PANEL_COLUMNS), scratch(m_numNodes);
+    for (int panelStart = 0; panelStart < numColumns; panelStart += PANEL_COLUMNS)
+    {
+        int panelSize = min(PANEL_COLUMNS, numColumns - panelStart);
+        vector<const float*> inColumns(panelSize);
+        for (int c = 0; c < panelSize; ++c)
         {
-            throw CaretException("roi does not match surface number of nodes");
+            inColumns[c] = metricIn->getValuePointerForColumn(firstColumn + panelStart + c);
         }
-        for (int32_t i = 0; i < numCols; ++i)
+#pragma omp CARET_PARFOR schedule(static)
+        for (int32_t i = 0; i < m_numNodes; ++i)
         {
-            smoothColumnInternal(scratch.data(), metricIn, i, metricOut, i, roi, 0, fixZeros);
+            float* panelRow = panelIn.data() + (int64_t)i * PANEL_COLUMNS;
+            for (int c = 0; c < panelSize; ++c)
+            {
+                panelRow[c] = inColumns[c][i];
+            }
+            for (int c = panelSize; c < PANEL_COLUMNS; ++c)
+            {
+                panelRow[c] = 0.0f;//a partial last panel just smooths some zeros
+            }
         }
-    } else {
-        for (int32_t i = 0; i < numCols; ++i)
+        smoothPanelInternal(panelIn.data(), panelOut.data(), roiColumn, fixZeros);
+        for (int c = 0; c < panelSize; ++c)
+        {
+            for (int32_t i = 0; i < m_numNodes; ++i)
+            {
+                scratch[i] = panelOut[(int64_t)i * PANEL_COLUMNS + c];
+            }
+            metricOut->setValuesForColumn(firstOutColumn + panelStart + c, scratch.data());
+        }
+    }
+}
+
+void MetricSmoothingObject::smoothPanelInternal(const float* panelIn, float* panelOut, const float* roiColumn, const bool& fixZeros) const
+{//each column gets the same operations in the same order as smoothColumnInternal, so results match except where the compiler fuses multiply-adds differently
+    CaretAssert(panelIn != NULL);
+    CaretAssert(panelOut != NULL);
+#pragma omp CARET_PARFOR schedule(dynamic, 64)
+    for (int32_t i = 0; i < m_numNodes; ++i)
+    {
+        float* outRow = panelOut + (int64_t)i * PANEL_COLUMNS;
+        const int64_t rowStart = m_rowStart[i], rowEnd = m_rowStart[i + 1];
+        if ((roiColumn != NULL && !(roiColumn[i] > 0.0f)) || m_weightSums[i] == 0.0f)
+        {
+            for (int c = 0; c < PANEL_COLUMNS; ++c)
+            {
+                outRow[c] = 0.0f;
+            }
+            continue;
+        }
+        float sums[PANEL_COLUMNS], weightSums[PANEL_COLUMNS];
+        for (int c = 0; c < PANEL_COLUMNS; ++c)
+        {
+            sums[c] = 0.0f;
+            weightSums[c] = 0.0f;
+        }
+        if (fixZeros)
         {
-            smoothColumnInternal(scratch.data(), metricIn, i, metricOut, i, fixZeros);
+            for (int64_t j = rowStart; j < rowEnd; ++j)
+            {
+                int32_t neighbor = m_rowNodes[j];
+                if (roiColumn != NULL && !(roiColumn[neighbor] > 0.0f)) continue;
+                const float weight = m_rowWeights[j];
+                const float* values = panelIn + (int64_t)neighbor * PANEL_COLUMNS;
+                for (int c = 0; c < PANEL_COLUMNS; ++c)
+                {
+                    if (values[c] != 0.0f)
+                    {
+                        sums[c] += weight * values[c];
+                        weightSums[c] += weight;
+                    }
+                }
+            }
+            for (int c = 0; c < PANEL_COLUMNS; ++c)
+            {
+                if (weightSums[c] != 0.0f)
+                {
+                    outRow[c] = sums[c] / weightSums[c];
+                } else {
+                    outRow[c] = 0.0f;
+                }
+            }
+        } else {
+            float weightSum = 0.0f;//only used with an roi, without one the precomputed sum is used
+            for (int64_t j = rowStart; j < rowEnd; ++j)
+            {
+                int32_t neighbor = m_rowNodes[j];
+                if (roiColumn != NULL)
+                {
+                    if (!(roiColumn[neighbor] > 0.0f)) continue;
+                    weightSum += m_rowWeights[j];
+                }
+                const float weight = m_rowWeights[j];
+                const float* values = panelIn + (int64_t)neighbor * PANEL_COLUMNS;
+                for (int c = 0; c < PANEL_COLUMNS; ++c)
+                {
+                    sums[c] += weight * values[c];
+                }
+            }
+            if (roiColumn == NULL) weightSum = m_weightSums[i];
+            for (int c = 0; c < PANEL_COLUMNS; ++c)
+            {
+                if (weightSum != 0.0f)
+                {
+                    outRow[c] = sums[c] / weightSum;
+                } else {
+                    outRow[c] = 0.0f;
+                }
+            }
         }
     }
 }
@@ -154,17 +380,17 @@ void MetricSmoothingObject::smoothColumnInternal(float* scratch, const MetricFil
 #pragma omp CARET_PARFOR schedule(dynamic)
         for (int32_t i = 0; i < numNodes; ++i)
         {
-            const WeightList& myWeightRef = m_weightLists[i];
-            if (myWeightRef.m_weightSum != 0.0f)//skip nodes with no neighbors quickly
+            const int64_t rowStart = m_rowStart[i], rowEnd = m_rowStart[i + 1];
+            const float weightSum = m_weightSums[i];
+            if (weightSum != 0.0f)//skip nodes with no neighbors quickly
             {
                 float sum = 0.0f, weightsum = 0.0f;
-                int32_t numWeights = myWeightRef.m_nodes.size();
-                for (int32_t j = 0; j < numWeights; ++j)
+                for (int64_t j = rowStart; j < rowEnd; ++j)
                 {
-                    float value = myColumn[myWeightRef.m_nodes[j]];
+                    float value = myColumn[m_rowNodes[j]];
                     if (value != 0.0f)
                     {
-                        float weight = myWeightRef.m_weights[j];
+                        float weight = m_rowWeights[j];
                         sum += weight * value;
                         weightsum += weight;
                     }
@@ -183,16 +409,16 @@ void MetricSmoothingObject::smoothColumnInternal(float* scratch, const MetricFil
 #pragma omp CARET_PARFOR schedule(dynamic)
         for (int32_t i = 0; i < numNodes; ++i)
         {
-            const WeightList& myWeightRef = m_weightLists[i];
-            if (myWeightRef.m_weightSum != 0.0f)
+            const int64_t rowStart = m_rowStart[i], rowEnd = m_rowStart[i + 1];
+            const float weightSum = m_weightSums[i];
+            if (weightSum != 0.0f)
             {
                 float sum = 0.0f;
-                int32_t numWeights = myWeightRef.m_nodes.size();
-                for (int32_t j = 0; j < numWeights; ++j)
+                for (int64_t j = rowStart; j < rowEnd; ++j)
                 {
-                    sum += myWeightRef.m_weights[j] * myColumn[myWeightRef.m_nodes[j]];
+                    sum += m_rowWeights[j] * myColumn[m_rowNodes[j]];
                 }
-                scratch[i] = sum / myWeightRef.m_weightSum;
+                scratch[i] = sum / weightSum;
             } else {
                 scratch[i] = 0.0f;
             }
@@ -218,18 +444,18 @@ void MetricSmoothingObject::smoothColumnInternal(float* scratch, const MetricFil
 #pragma omp CARET_PARFOR schedule(dynamic)
         for (int32_t i = 0; i < numNodes; ++i)
         {
-            const WeightList& myWeightRef = m_weightLists[i];
-            if (roiColumn[i] > 0.0f && myWeightRef.m_weightSum != 0.0f)//skip nodes with no neighbors quickly
+            const int64_t rowStart = m_rowStart[i], rowEnd = m_rowStart[i + 1];
+            const float weightSum = m_weightSums[i];
+            if (roiColumn[i] > 0.0f && weightSum != 0.0f)//skip nodes with no neighbors quickly
             {
                 float sum = 0.0f, weightsum = 0.0f;
-                int32_t numWeights = myWeightRef.m_nodes.size();
-                for (int32_t j = 0; j < numWeights; ++j)
+                for (int64_t j = rowStart; j < rowEnd; ++j)
                 {
-                    int32_t neighbor = myWeightRef.m_nodes[j];
+                    int32_t neighbor = m_rowNodes[j];
                     float value = myColumn[neighbor];
                     if (roiColumn[neighbor] > 0.0f && value != 0.0f)
                     {
-                        float weight = myWeightRef.m_weights[j];
+                        float weight = m_rowWeights[j];
                         sum += weight * value;
                         weightsum += weight;
                     }
@@ -248,17 +474,17 @@ void MetricSmoothingObject::smoothColumnInternal(float* scratch, const MetricFil
 #pragma omp CARET_PARFOR schedule(dynamic)
         for (int32_t i = 0; i < numNodes; ++i)
         {
-            const WeightList& myWeightRef = m_weightLists[i];
-            if (roiColumn[i] > 0.0f && myWeightRef.m_weightSum != 0.0f)
+            const int64_t rowStart = m_rowStart[i], rowEnd = m_rowStart[i + 1];
+            const float weightSum = m_weightSums[i];
+            if (roiColumn[i] > 0.0f && weightSum != 0.0f)
             {
                 float sum = 0.0f, weightsum = 0.0f;
-                int32_t numWeights = myWeightRef.m_nodes.size();
-                for (int32_t j = 0; j < numWeights; ++j)
+                for (int64_t j = rowStart; j < rowEnd; ++j)
                 {
-                    int32_t neighbor = myWeightRef.m_nodes[j];
+                    int32_t neighbor = m_rowNodes[j];
                     if (roiColumn[neighbor] > 0.0f)
                     {
-                        float weight = myWeightRef.m_weights[j];
+                        float weight = m_rowWeights[j];
                         sum += weight * myColumn[neighbor];
                         weightsum += weight;
                     }
@@ -284,29 +510,34 @@ void MetricSmoothingObject::precomputeWeightsGeoGauss(const SurfaceFile* mySurf,
     float gaussianDenom = -0.5f / myKernel / myKernel;
     m_weightLists.resize(numNodes);
     CaretPointer<GeodesicHelperBase> myGeoBase(new GeodesicHelperBase(mySurf, nodeAreas));//NOTE: if these are equal to the surface's areas, then it does some extra operations, but gets the same answer
-#pragma omp CARET_PAR
+    vector<vector<int32_t> > geoNodes;
+    vector<vector<float> > geoDists;
+    for (int32_t chunkStart = 0; chunkStart < numNodes; chunkStart += GEO_NEIGHBORHOOD_CHUNK)
     {
-        CaretPointer<TopologyHelper> myTopoHelp = mySurf->getTopologyHelper();//don't really need one per thread here, but good practice in case we want getNeighborsToDepth
-        CaretPointer<GeodesicHelper> myGeoHelp(new GeodesicHelper(myGeoBase));
-        vector<float> distances;
-#pragma omp CARET_FOR schedule(dynamic)
-        for (int32_t i = 0; i < numNodes; ++i)
+        int32_t chunkEnd = min(numNodes, chunkStart + GEO_NEIGHBORHOOD_CHUNK);
+        computeGeoNeighborhoods(myGeoBase, myGeoDist, NULL, chunkStart, chunkEnd, geoNodes, geoDists);
+#pragma omp CARET_PAR
         {
-            myGeoHelp->getNodesToGeoDist(i, myGeoDist, m_weightLists[i].m_nodes, distances, true);
-            if (distances.size() < 7)
-            {
-                m_weightLists[i].m_nodes = myTopoHelp->getNodeNeighbors(i);
-                m_weightLists[i].m_nodes.push_back(i);
-                myGeoHelp->getGeoToTheseNodes(i, m_weightLists[i].m_nodes, distances, true);
-            }
-            int32_t numNeigh = (int32_t)distances.size();
-            m_weightLists[i].m_weights.resize(numNeigh);
-            m_weightLists[i].m_weightSum = 0.0f;
-            for (int32_t j = 0; j < numNeigh; ++j)
+            CaretPointer<TopologyHelper> myTopoHelp = mySurf->getTopologyHelper();//don't really need one per thread here, but good practice in case we want getNeighborsToDepth
+            CaretPointer<GeodesicHelper> myGeoHelp;
+#pragma omp CARET_FOR schedule(dynamic)
+            for (int32_t i = chunkStart; i < chunkEnd; ++i)
             {
-                float weight = exp(distances[j] * distances[j] * gaussianDenom);//exp(- dist ^ 2 / (2 * sigma ^ 2))
-                m_weightLists[i].m_weights[j] = weight;
-                m_weightLists[i].m_weightSum += weight;
+                vector<float>& distances = geoDists[i - chunkStart];
+                m_weightLists[i].m_nodes.swap(geoNodes[i - chunkStart]);
+                if (distances.size() < 7)
+                {
+                    useTopologyNeighbors(myGeoBase, myGeoHelp, myTopoHelp->getNodeNeighbors(i), i, m_weightLists[i].m_nodes, distances);
+                }
+                int32_t numNeigh = (int32_t)distances.size();
+                m_weightLists[i].m_weights.resize(numNeigh);
+                m_weightLists[i].m_weightSum = 0.0f;
+                for (int32_t j = 0; j < numNeigh; ++j)
+                {
+                    float weight = exp(distances[j] * distances[j] * gaussianDenom);//exp(- dist ^ 2 / (2 * sigma ^ 2))
+                    m_weightLists[i].m_weights[j] = weight;
+                    m_weightLists[i].m_weightSum += weight;
+                }
             }
         }
     }
@@ -320,36 +551,40 @@ void MetricSmoothingObject::precomputeWeightsROIGeoGauss(const SurfaceFile* mySu
     m_weightLists.resize(numNodes);
     const float* myRoiColumn = theRoi->getValuePointerForColumn(0);
     CaretPointer<GeodesicHelperBase> myGeoBase(new GeodesicHelperBase(mySurf, nodeAreas));//NOTE: if these are equal to the surface's areas, then it does some extra operations, but gets the same answer
-#pragma omp CARET_PAR
+    vector<vector<int32_t> > geoNodes;
+    vector<vector<float> > geoDists;
+    for (int32_t chunkStart = 0; chunkStart < numNodes; chunkStart += GEO_NEIGHBORHOOD_CHUNK)
     {
-        CaretPointer<TopologyHelper> myTopoHelp = mySurf->getTopologyHelper();
-        CaretPointer<GeodesicHelper> myGeoHelp(new GeodesicHelper(myGeoBase));
-        vector<float> distances;
-        vector<int32_t> nodes;
-#pragma omp CARET_FOR schedule(dynamic)
-        for (int32_t i = 0; i < numNodes; ++i)
+        int32_t chunkEnd = min(numNodes, chunkStart + GEO_NEIGHBORHOOD_CHUNK);
+        computeGeoNeighborhoods(myGeoBase, myGeoDist, myRoiColumn, chunkStart, chunkEnd, geoNodes, geoDists);
+#pragma omp CARET_PAR
         {
-            if (myRoiColumn[i] > 0.0f)
+            CaretPointer<TopologyHelper> myTopoHelp = mySurf->getTopologyHelper();
+            CaretPointer<GeodesicHelper> myGeoHelp;
+#pragma omp CARET_FOR schedule(dynamic)
+            for (int32_t i = chunkStart; i < chunkEnd; ++i)
             {
-                myGeoHelp->getNodesToGeoDist(i, myGeoDist, nodes, distances, true);
-                if (distances.size() < 7)
-                {
-                    nodes = myTopoHelp->getNodeNeighbors(i);
-                    nodes.push_back(i);
-                    myGeoHelp->getGeoToTheseNodes(i, nodes, distances, true);
-                }
-                int32_t numNeigh = (int32_t)distances.size();
-                m_weightLists[i].m_weights.reserve(numNeigh);
-                m_weightLists[i].m_nodes.reserve(numNeigh);
-                m_weightLists[i].m_weightSum = 0.0f;
-                for (int32_t j = 0; j < numNeigh; ++j)
+                if (myRoiColumn[i] > 0.0f)
                 {
-                    if (myRoiColumn[nodes[j]] > 0.0f)
+                    vector<int32_t>& nodes = geoNodes[i - chunkStart];
+                    vector<float>& distances = geoDists[i - chunkStart];
+                    if (distances.size() < 7)
                     {
-                        float weight = exp(distances[j] * distances[j] * gaussianDenom);//exp(- dist ^ 2 / (2 * sigma ^ 2))
-                        m_weightLists[i].m_weights.push_back(weight);
-                        m_weightLists[i].m_nodes.push_back(nodes[j]);
-                        m_weightLists[i].m_weightSum += weight;
+                        useTopologyNeighbors(myGeoBase, myGeoHelp, myTopoHelp->getNodeNeighbors(i), i, nodes, distances);
+                    }
+                    int32_t numNeigh = (int32_t)distances.size();
+                    m_weightLists[i].m_weights.reserve(numNeigh);
+                    m_weightLists[i].m_nodes.reserve(numNeigh);
+                    m_weightLists[i].m_weightSum = 0.0f;
+                    for (int32_t j = 0; j < numNeigh; ++j)
+                    {
+                        if (myRoiColumn[nodes[j]] > 0.0f)
+                        {
+                            float weight = exp(distances[j] * distances[j] * gaussianDenom);//exp(- dist ^ 2 / (2 * sigma ^ 2))
+                            m_weightLists[i].m_weights.push_back(weight);
+                            m_weightLists[i].m_nodes.push_back(nodes[j]);
+                            m_weightLists[i].m_weightSum += weight;
+                        }
                     }
                 }
             }
@@ -365,37 +600,42 @@ void MetricSmoothingObject::precomputeWeightsGeoGaussArea(const SurfaceFile* myS
     vector<WeightList> tempList;//this is used to compute scattering kernels because it is easier to normalize scattering kernels correctly, and then convert to gathering kernels
     tempList.resize(numNodes);
     CaretPointer<GeodesicHelperBase> myGeoBase(new GeodesicHelperBase(mySurf, nodeAreas));//NOTE: if these are equal to the surface's areas, then it does some extra operations, but gets the same answer
-#pragma omp CARET_PAR
+    vector<vector<int32_t> > geoNodes;
+    vector<vector<float> > geoDists;
+    for (int32_t chunkStart = 0; chunkStart < numNodes; chunkStart += GEO_NEIGHBORHOOD_CHUNK)
     {
-        CaretPointer<TopologyHelper> myTopoHelp = mySurf->getTopologyHelper();//don't really need one per thread here, but good practice in case we want getNeighborsToDepth
-        CaretPointer<GeodesicHelper> myGeoHelp(new GeodesicHelper(myGeoBase));
-        vector<float> distances;
-#pragma omp CARET_FOR schedule(dynamic)
-        for (int32_t i = 0; i < numNodes; ++i)
+        int32_t chunkEnd = min(numNodes, chunkStart + GEO_NEIGHBORHOOD_CHUNK);
+        computeGeoNeighborhoods(myGeoBase, myGeoDist, NULL, chunkStart, chunkEnd, geoNodes, geoDists);
+#pragma omp CARET_PAR
         {
-            myGeoHelp->getNodesToGeoDist(i, myGeoDist, tempList[i].m_nodes, distances, true);
-            const vector<int32_t>& tempneighbors = myTopoHelp->getNodeNeighbors(i);
-            if (distances.size() <= tempneighbors.size())//because neighbors doesn't include center, so if they are equal, geo is missing a neighbor
-            {
-                tempList[i].m_nodes = tempneighbors;
-                tempList[i].m_nodes.push_back(i);
-                myGeoHelp->getGeoToTheseNodes(i, tempList[i].m_nodes, distances, true);
-            }
-            int32_t numNeigh = (int32_t)distances.size();
-            tempList[i].m_weights.resize(numNeigh);
-            tempList[i].m_weightSum = 0.0f;
-            for (int32_t j = 0; j < numNeigh; ++j)
-            {
-                float weight = exp(distances[j] * distances[j] * gaussianDenom) * nodeAreas[tempList[i].m_nodes[j]];//exp(- dist ^ 2 / (2 * sigma ^ 2)) * area
-                tempList[i].m_weights[j] = weight;//we multiply by area so that a node scattering to a dense region on one side and a sparse region on the other
-                tempList[i].m_weightSum += weight;//gives similar areal influence to each direction rather than giving a more influence on the dense region (simply because nodes are more numerous)
-            }
-            float myFactor = nodeAreas[i] / tempList[i].m_weightSum;//make each scattering kernel sum to the area of the node it scatters from
-            for (int32_t j = 0; j < numNeigh; ++j)
+            CaretPointer<TopologyHelper> myTopoHelp = mySurf->getTopologyHelper();//don't really need one per thread here, but good practice in case we want getNeighborsToDepth
+            CaretPointer<GeodesicHelper> myGeoHelp;
+#pragma omp CARET_FOR schedule(dynamic)
+            for (int32_t i = chunkStart; i < chunkEnd; ++i)
             {
-                tempList[i].m_weights[j] *= myFactor;
+                vector<float>& distances = geoDists[i - chunkStart];
+                tempList[i].m_nodes.swap(geoNodes[i - chunkStart]);
+                const CaretSpan<int32_t> tempneighbors = myTopoHelp->getNodeNeighbors(i);
+                if (distances.size() <= tempneighbors.size())//because neighbors doesn't include center, so if they are equal, geo is missing a neighbor
+                {
+                    useTopologyNeighbors(myGeoBase, myGeoHelp, tempneighbors, i, tempList[i].m_nodes, distances);
+                }
+                int32_t numNeigh = (int32_t)distances.size();
+                tempList[i].m_weights.resize(numNeigh);
+                tempList[i].m_weightSum = 0.0f;
+                for (int32_t j = 0; j < numNeigh; ++j)
+                {
+                    float weight = exp(distances[j] * distances[j] * gaussianDenom) * nodeAreas[tempList[i].m_nodes[j]];//exp(- dist ^ 2 / (2 * sigma ^ 2)) * area
+                    tempList[i].m_weights[j] = weight;//we multiply by area so that a node scattering to a dense region on one side and a sparse region on the other
+                    tempList[i].m_weightSum += weight;//gives similar areal influence to each direction rather than giving a more influence on the dense region (simply because nodes are more numerous)
+                }
+                float myFactor = nodeAreas[i] / tempList[i].m_weightSum;//make each scattering kernel sum to the area of the node it scatters from
+                for (int32_t j = 0; j < numNeigh; ++j)
+                {
+                    tempList[i].m_weights[j] *= myFactor;
+                }
+                tempList[i].m_weightSum = nodeAreas[i];
             }
-            tempList[i].m_weightSum = nodeAreas[i];
         }
     }
     m_weightLists.resize(numNodes);//now convert it to gathering kernels
@@ -429,44 +669,48 @@ void MetricSmoothingObject::precomputeWeightsROIGeoGaussArea(const SurfaceFile*
     tempList.resize(numNodes);
     const float* myRoiColumn = theRoi->getValuePointerForColumn(0);
     CaretPointer<GeodesicHelperBase> myGeoBase(new GeodesicHelperBase(mySurf, nodeAreas));//NOTE: if these are equal to the surface's areas, then it does some extra operations, but gets the same answer
-#pragma omp CARET_PAR
+    vector<vector<int32_t> > geoNodes;
+    vector<vector<float> > geoDists;
+    for (int32_t chunkStart = 0; chunkStart < numNodes; chunkStart += GEO_NEIGHBORHOOD_CHUNK)
     {
-        CaretPointer<TopologyHelper> myTopoHelp = mySurf->getTopologyHelper();
-        CaretPointer<GeodesicHelper> myGeoHelp(new GeodesicHelper(myGeoBase));
-        vector<float> distances;
-        vector<int32_t> nodes;
-#pragma omp CARET_FOR schedule(dynamic)
-        for (int32_t i = 0; i < numNodes; ++i)
+        int32_t chunkEnd = min(numNodes, chunkStart + GEO_NEIGHBORHOOD_CHUNK);
+        computeGeoNeighborhoods(myGeoBase, myGeoDist, myRoiColumn, chunkStart, chunkEnd, geoNodes, geoDists);
+#pragma omp CARET_PAR
         {
-            if (myRoiColumn[i] > 0.0f)//we don't need to scatter from things outside the ROI
+            CaretPointer<TopologyHelper> myTopoHelp = mySurf->getTopologyHelper();
+            CaretPointer<GeodesicHelper> myGeoHelp;
+#pragma omp CARET_FOR schedule(dynamic)
+            for (int32_t i = chunkStart; i < chunkEnd; ++i)
             {
-                myGeoHelp->getNodesToGeoDist(i, myGeoDist, nodes, distances, true);
-                const vector<int32_t>& tempneighbors = myTopoHelp->getNodeNeighbors(i);
-                if (distances.size() <= tempneighbors.size())//because neighbors doesn't include center, so if they are equal, geo is missing a neighbor
+                if (myRoiColumn[i] > 0.0f)//we don't need to scatter from things outside the ROI
                 {
-                    nodes = tempneighbors;
-                    nodes.push_back(i);
-                    myGeoHelp->getGeoToTheseNodes(i, nodes, distances, true);
-                }
-                int32_t numNeigh = (int32_t)distances.size();
-                tempList[i].m_weightSum = 0.0f;
-                for (int32_t j = 0; j < numNeigh; ++j)
-                {//but we DO need to compute scattering TO things outside the ROI, so that our normalization doesn't increase the in-ROI influence of edge nodes
-                    float weight = exp(distances[j] * distances[j] * gaussianDenom) * nodeAreas[nodes[j]];//exp(- dist ^ 2 / (2 * sigma ^ 2)) * area
-                    tempList[i].m_weightSum += weight;//add it to the total weight in order to normalize correctly
-                    if (myRoiColumn[nodes[j]] > 0.0f)
-                    {//BUT, don't add it to the list if it is outside the ROI
-                        tempList[i].m_nodes.push_back(nodes[j]);
-                        tempList[i].m_weights.push_back(weight);
+                    vector<int32_t>& nodes = geoNodes[i - chunkStart];
+                    vector<float>& distances = geoDists[i - chunkStart];
+                    const CaretSpan<int32_t> tempneighbors = myTopoHelp->getNodeNeighbors(i);
+                    if (distances.size() <= tempneighbors.size())//because neighbors doesn't include center, so if they are equal, geo is missing a neighbor
+                    {
+                        useTopologyNeighbors(myGeoBase, myGeoHelp, tempneighbors, i, nodes, distances);
                     }
+                    int32_t numNeigh = (int32_t)distances.size();
+                    tempList[i].m_weightSum = 0.0f;
+                    for (int32_t j = 0; j < numNeigh; ++j)
+                    {//but we DO need to compute scattering TO things outside the ROI, so that our normalization doesn't increase the in-ROI influence of edge nodes
+                        float weight = exp(distances[j] * distances[j] * gaussianDenom) * nodeAreas[nodes[j]];//exp(- dist ^ 2 / (2 * sigma ^ 2)) * area
+                        tempList[i].m_weightSum += weight;//add it to the total weight in order to normalize correctly
+                        if (myRoiColumn[nodes[j]] > 0.0f)
+                        {//BUT, don't add it to the list if it is outside the ROI
+                            tempList[i].m_nodes.push_back(nodes[j]);
+                            tempList[i].m_weights.push_back(weight);
+                        }
+                    }
+                    float myFactor = nodeAreas[i] / tempList[i].m_weightSum;//make each scattering kernel sum to the area of the node it scatters from
+                    int32_t numUsed = (int32_t)tempList[i].m_nodes.size();
+                    for (int32_t j = 0; j < numUsed; ++j)
+                    {
+                        tempList[i].m_weights[j] *= myFactor;
+                    }
+                    tempList[i].m_weightSum = 0.0f;//this is never actually used again, but make sure it is wrong in case anything tries to use it
                 }
-                float myFactor = nodeAreas[i] / tempList[i].m_weightSum;//make each scattering kernel sum to the area of the node it scatters from
-                int32_t numUsed = (int32_t)tempList[i].m_nodes.size();
-                for (int32_t j = 0; j < numUsed; ++j)
-                {
-                    tempList[i].m_weights[j] *= myFactor;
-                }
-                tempList[i].m_weightSum = 0.0f;//this is never actually used again, but make sure it is wrong in case anything tries to use it
             }
         }
     }
@@ -500,37 +744,42 @@ void MetricSmoothingObject::precomputeWeightsGeoGaussEqual(const SurfaceFile* my
     vector<WeightList> tempList;//this is used to compute scattering kernels because it is easier to normalize scattering kernels correctly, and then convert to gathering kernels
     tempList.resize(numNodes);
     CaretPointer<GeodesicHelperBase> myGeoBase(new GeodesicHelperBase(mySurf, nodeAreas));//NOTE: if these are equal to the surface's areas, then it does some extra operations, but gets the same answer
-#pragma omp CARET_PAR
+    vector<vector<int32_t> > geoNodes;
+    vector<vector<float> > geoDists;
+    for (int32_t chunkStart = 0; chunkStart < numNodes; chunkStart += GEO_NEIGHBORHOOD_CHUNK)
     {
-        CaretPointer<TopologyHelper> myTopoHelp = mySurf->getTopologyHelper();//don't really need one per thread here, but good practice in case we want getNeighborsToDepth
-        CaretPointer<GeodesicHelper> myGeoHelp(new GeodesicHelper(myGeoBase));
-        vector<float> distances;
-#pragma omp CARET_FOR schedule(dynamic)
-        for (int32_t i = 0; i < numNodes; ++i)
+        int32_t chunkEnd = min(numNodes, chunkStart + GEO_NEIGHBORHOOD_CHUNK);
+        computeGeoNeighborhoods(myGeoBase, myGeoDist, NULL, chunkStart, chunkEnd, geoNodes, geoDists);
+#pragma omp CARET_PAR
         {
-            myGeoHelp->getNodesToGeoDist(i, myGeoDist, tempList[i].m_nodes, distances, true);
-            const vector<int32_t>& tempneighbors = myTopoHelp->getNodeNeighbors(i);
-            if (distances.size() <= tempneighbors.size())//because neighbors doesn't include center, so if they are equal, geo is missing a neighbor
-            {
-                tempList[i].m_nodes = tempneighbors;
-                tempList[i].m_nodes.push_back(i);
-                myGeoHelp->getGeoToTheseNodes(i, tempList[i].m_nodes, distances, true);
-            }
-            int32_t numNeigh = (int32_t)distances.size();
-            tempList[i].m_weights.resize(numNeigh);
-            tempList[i].m_weightSum = 0.0f;
-            for (int32_t j = 0; j < numNeigh; ++j)
-            {
-                float weight = exp(distances[j] * distances[j] * gaussianDenom);//exp(- dist ^ 2 / (2 * sigma ^ 2))
-                tempList[i].m_weights[j] = weight;//we multiply by area so that a node scattering to a dense region on one side and a sparse region on the other
-                tempList[i].m_weightSum += weight;//gives similar areal influence to each direction rather than giving a more influence on the dense region (simply because nodes are more numerous)
-            }
-            float myFactor = 1.0f / tempList[i].m_weightSum;//make each scattering kernel sum to 1
-            for (int32_t j = 0; j < numNeigh; ++j)
+            CaretPointer<TopologyHelper> myTopoHelp = mySurf->getTopologyHelper();//don't really need one per thread here, but good practice in case we want getNeighborsToDepth
+            CaretPointer<GeodesicHelper> myGeoHelp;
+#pragma omp CARET_FOR schedule(dynamic)
+            for (int32_t i = chunkStart; i < chunkEnd; ++i)
             {
-                tempList[i].m_weights[j] *= myFactor;
+                vector<float>& distances = geoDists[i - chunkStart];
+                tempList[i].m_nodes.swap(geoNodes[i - chunkStart]);
+                const CaretSpan<int32_t> tempneighbors = myTopoHelp->getNodeNeighbors(i);
+                if (distances.size() <= tempneighbors.size())//because neighbors doesn't include center, so if they are equal, geo is missing a neighbor
+                {
+                    useTopologyNeighbors(myGeoBase, myGeoHelp, tempneighbors, i, tempList[i].m_nodes, distances);
+                }
+                int32_t numNeigh = (int32_t)distances.size();
+                tempList[i].m_weights.resize(numNeigh);
+                tempList[i].m_weightSum = 0.0f;
+                for (int32_t j = 0; j < numNeigh; ++j)
+                {
+                    float weight = exp(distances[j] * distances[j] * gaussianDenom);//exp(- dist ^ 2 / (2 * sigma ^ 2))
+                    tempList[i].m_weights[j] = weight;//we multiply by area so that a node scattering to a dense region on one side and a sparse region on the other
+                    tempList[i].m_weightSum += weight;//gives similar areal influence to each direction rather than giving a more influence on the dense region (simply because nodes are more numerous)
+                }
+                float myFactor = 1.0f / tempList[i].m_weightSum;//make each scattering kernel sum to 1
+                for (int32_t j = 0; j < numNeigh; ++j)
+                {
+                    tempList[i].m_weights[j] *= myFactor;
+                }
+                tempList[i].m_weightSum = 1.0f;
             }
-            tempList[i].m_weightSum = 1.0f;
         }
     }
     m_weightLists.resize(numNodes);//now convert it to gathering kernels
@@ -564,44 +813,48 @@ void MetricSmoothingObject::precomputeWeightsROIGeoGaussEqual(const SurfaceFile*
     tempList.resize(numNodes);
     const float* myRoiColumn = theRoi->getValuePointerForColumn(0);
     CaretPointer<GeodesicHelperBase> myGeoBase(new GeodesicHelperBase(mySurf, nodeAreas));//NOTE: if these are equal to the surface's areas, then it does some extra operations, but gets the same answer
-#pragma omp CARET_PAR
+    vector<vector<int32_t> > geoNodes;
+    vector<vector<float> > geoDists;
+    for (int32_t chunkStart = 0; chunkStart < numNodes; chunkStart += GEO_NEIGHBORHOOD_CHUNK)
     {
-        CaretPointer<TopologyHelper> myTopoHelp = mySurf->getTopologyHelper();
-        CaretPointer<GeodesicHelper> myGeoHelp(new GeodesicHelper(myGeoBase));
-        vector<float> distances;
-        vector<int32_t> nodes;
-#pragma omp CARET_FOR schedule(dynamic)
-        for (int32_t i = 0; i < numNodes; ++i)
+        int32_t chunkEnd = min(numNodes, chunkStart + GEO_NEIGHBORHOOD_CHUNK);
+        computeGeoNeighborhoods(myGeoBase, myGeoDist, myRoiColumn, chunkStart, chunkEnd, geoNodes, geoDists);
+#pragma omp CARET_PAR
         {
-            if (myRoiColumn[i] > 0.0f)//we don't need to scatter from things outside the ROI
+            CaretPointer<TopologyHelper> myTopoHelp = mySurf->getTopologyHelper();
+            CaretPointer<GeodesicHelper> myGeoHelp;
+#pragma omp CARET_FOR schedule(dynamic)
+            for (int32_t i = chunkStart; i < chunkEnd; ++i)
             {
-                myGeoHelp->getNodesToGeoDist(i, myGeoDist, nodes, distances, true);
-                const vector<int32_t>& tempneighbors = myTopoHelp->getNodeNeighbors(i);
-                if (distances.size() <= tempneighbors.size())//because neighbors doesn't include center, so if they are equal, geo is missing a neighbor
+                if (myRoiColumn[i] > 0.0f)//we don't need to scatter from things outside the ROI
                 {
-                    nodes = tempneighbors;
-                    nodes.push_back(i);
-                    myGeoHelp->getGeoToTheseNodes(i, nodes, distances, true);
-                }
-                int32_t numNeigh = (int32_t)distances.size();
-                tempList[i].m_weightSum = 0.0f;
-                for (int32_t j = 0; j < numNeigh; ++j)
-                {//but we DO need to compute scattering TO things outside the ROI, so that our normalization doesn't increase the in-ROI influence of edge nodes
-                    float weight = exp(distances[j] * distances[j] * gaussianDenom);//exp(- dist ^ 2 / (2 * sigma ^ 2))
-                    tempList[i].m_weightSum += weight;//add it to the total weight in order to normalize correctly
-                    if (myRoiColumn[nodes[j]] > 0.0f)
-                    {//BUT, don't add it to the list if it is outside the ROI
-                        tempList[i].m_nodes.push_back(nodes[j]);
-                        tempList[i].m_weights.push_back(weight);
+                    vector<int32_t>& nodes = geoNodes[i - chunkStart];
+                    vector<float>& distances = geoDists[i - chunkStart];
+                    const CaretSpan<int32_t> tempneighbors = myTopoHelp->getNodeNeighbors(i);
+                    if (distances.size() <= tempneighbors.size())//because neighbors doesn't include center, so if they are equal, geo is missing a neighbor
+                    {
+                        useTopologyNeighbors(myGeoBase, myGeoHelp, tempneighbors, i, nodes, distances);
                     }
+                    int32_t numNeigh = (int32_t)distances.size();
+                    tempList[i].m_weightSum = 0.0f;
+                    for (int32_t j = 0; j < numNeigh; ++j)
+                    {//but we DO need to compute scattering TO things outside the ROI, so that our normalization doesn't increase the in-ROI influence of edge nodes
+                        float weight = exp(distances[j] * distances[j] * gaussianDenom);//exp(- dist ^ 2 / (2 * sigma ^ 2))
+                        tempList[i].m_weightSum += weight;//add it to the total weight in order to normalize correctly
+                        if (myRoiColumn[nodes[j]] > 0.0f)
+                        {//BUT, don't add it to the list if it is outside the ROI
+                            tempList[i].m_nodes.push_back(nodes[j]);
+                            tempList[i].m_weights.push_back(weight);
+                        }
+                    }
+                    float myFactor = 1.0f / tempList[i].m_weightSum;//make each scattering kernel sum to 1
+                    int32_t numUsed = (int32_t)tempList[i].m_nodes.size();
+                    for (int32_t j = 0; j < numUsed; ++j)
+                    {
+                        tempList[i].m_weights[j] *= myFactor;
+                    }
+                    tempList[i].m_weightSum = 0.0f;//this is never actually used again, but make sure it is wrong in case anything tries to use it
                 }
-                float myFactor = 1.0f / tempList[i].m_weightSum;//make each scattering kernel sum to 1
-                int32_t numUsed = (int32_t)tempList[i].m_nodes.size();
-                for (int32_t j = 0; j < numUsed; ++j)
-                {
-                    tempList[i].m_weights[j] *= myFactor;
-                }
-                tempList[i].m_weightSum = 0.0f;//this is never actually used again, but make sure it is wrong in case anything tries to use it
             }
         }
     }
@@ -627,7 +880,8 @@ void MetricSmoothingObject::precomputeWeightsROIGeoGaussEqual(const SurfaceFile*
     }
 }
 
-void MetricSmoothingObject::precomputeWeights(const SurfaceFile* mySurf, float myKernel, const MetricFile* theRoi, Method myMethod, const float* nodeAreas)
+void MetricSmoothingObject::precomputeWeights(const SurfaceFile* mySurf, float myKernel, const MetricFile* theRoi, Method myMethod, const float* nodeAreas,
+                                              const AString& weightCacheDirectory)
 {
     const float* passAreas = nodeAreas;
     vector<float> areasTemp;
@@ -636,6 +890,15 @@ void MetricSmoothingObject::precomputeWeights(const SurfaceFile* mySurf, float m
         mySurf->computeNodeAreas(areasTemp);
         passAreas = areasTemp.data();
     }
+    AString cacheFileName;
+    if (!weightCacheDirectory.isEmpty())
+    {
+        cacheFileName = weightCacheDirectory + "/smoothing_" + getWeightCacheKey(mySurf, myKernel, theRoi, myMethod, passAreas) + ".weights";
+        if (loadWeightCache(cacheFileName))
+        {
+            return;
+        }
+    }
     if (theRoi != NULL)
     {
         switch (myMethod)
@@ -668,4 +931,126 @@ void MetricSmoothingObject::precomputeWeights(const SurfaceFile* mySurf, float m
                 throw CaretException("unknown smoothing method specified");
         };
     }
+    convertWeightLists();
+    if (!cacheFileName.isEmpty())
+    {
+        saveWeightCache(cacheFileName);
+    }
+}
+
+void MetricSmoothingObject::convertWeightLists()
+{
+    CaretAssert((int32_t)m_weightLists.size() == m_numNodes);
+    m_rowStartStore.resize(m_numNodes + 1);
+    m_weightSumsStore.resize(m_numNodes);
+    int64_t numWeights = 0;
+    for (int32_t i = 0; i < m_numNodes; ++i)
+    {
+        m_rowStartStore[i] = numWeights;
+        numWeights += m_weightLists[i].m_nodes.size();
+        m_weightSumsStore[i] = m_weightLists[i].m_weightSum;
+    }
+    m_rowStartStore[m_numNodes] = numWeights;
+    m_rowNodesStore.resize(numWeights);
+    m_rowWeightsStore.resize(numWeights);
+    for (int32_t i = 0; i < m_numNodes; ++i)
+    {
+        CaretAssert(m_weightLists[i].m_nodes.size() == m_weightLists[i].m_weights.size());
+        std::copy(m_weightLists[i].m_nodes.begin(), m_weightLists[i].m_nodes.end(), m_rowNodesStore.begin() + m_rowStartStore[i]);
+        std::copy(m_weightLists[i].m_weights.begin(), m_weightLists[i].m_weights.end(), m_rowWeightsStore.begin() + m_rowStartStore[i]);
+    }
+    vector<WeightList>().swap(m_weightLists);//release the memory
+    m_rowStart = m_rowStartStore.data();
+    m_rowNodes = m_rowNodesStore.data();
+    m_rowWeights = m_rowWeightsStore.data();
+    m_weightSums = m_weightSumsStore.data();
+}
+
+bool MetricSmoothingObject::loadWeightCache(const AString& fileName)
+{//any problem with the cache file just means computing the weights again
+    CaretPointer<QFile> myFile(new QFile(fileName));
+    if (!myFile->exists()) return false;
+    if (!myFile->open(QIODevice::ReadOnly))
+    {
+        CaretLogWarning("failed to open smoothing weight cache file '" + fileName + "', recomputing weights");
+        return false;
+    }
+    int64_t fileSize = myFile->size();
+    if (fileSize < (int64_t)sizeof(WeightCacheHeader))
+    {
+        CaretLogWarning("smoothing weight cache file '" + fileName + "' is truncated, recomputing weights");
+        return false;
+    }
+    const uchar* mapped = myFile->map(0, fileSize);
+    if (mapped == NULL)
+    {
+        CaretLogWarning("failed to map smoothing weight cache file '" + fileName + "', recomputing weights");
+        return false;
+    }
+    const WeightCacheHeader* myHeader = (const WeightCacheHeader*)mapped;
+    if (memcmp(myHeader->m_magic, WEIGHT_CACHE_MAGIC, sizeof(WEIGHT_CACHE_MAGIC)) != 0 || myHeader->m_byteOrder != WEIGHT_CACHE_BYTE_ORDER ||
+        myHeader->m_numNodes != m_numNodes || myHeader->m_numWeights < 0)
+    {
+        CaretLogWarning("smoothing weight cache file '" + fileName + "' does not match, recomputing weights");
+        return false;
+    }
+    int64_t numWeights = myHeader->m_numWeights;
+    if (fileSize != (int64_t)sizeof(WeightCacheHeader) + (m_numNodes + 1) * (int64_t)sizeof(int64_t) + m_numNodes * (int64_t)sizeof(float) +
+                    numWeights * (int64_t)(sizeof(int32_t) + sizeof(float)))
+    {
+        CaretLogWarning("smoothing weight cache file '" + fileName + "' has the wrong size, recomputing weights");
+        return false;
+    }
+    const int64_t* rowStart = (const int64_t*)(mapped + sizeof(WeightCacheHeader));
+    const float* weightSums = (const float*)(rowStart + m_numNodes + 1);
+    const int32_t* rowNodes = (const int32_t*)(weightSums + m_numNodes);
+    const float* rowWeights = (const float*)(rowNodes + numWeights);
+    bool valid = (rowStart[0] == 0 && rowStart[m_numNodes] == numWeights);
+    for (int32_t i = 0; valid && i < m_numNodes; ++i)
+    {
+        if (rowStart[i + 1] < rowStart[i]) valid = false;
+    }
+    for (int64_t j = 0; valid && j < numWeights; ++j)
+    {//don't trust indices we are going to use for reading memory
+        if (rowNodes[j] < 0 || rowNodes[j] >= m_numNodes) valid = false;
+    }
+    if (!valid)
+    {
+        CaretLogWarning("smoothing weight cache file '" + fileName + "' is corrupt, recomputing weights");
+        return false;
+    }
+    m_rowStart = rowStart;
+    m_weightSums = weightSums;
+    m_rowNodes = rowNodes;
+    m_rowWeights = rowWeights;
+    m_cacheFile = myFile;
+    CaretLogFine("using smoothing weights from cache file '" + fileName + "'");
+    return true;
+}
+
+void MetricSmoothingObject::saveWeightCache(const AString& fileName) const
+{//failing to write the cache isn't an error for the smoothing itself
+    QDir().mkpath(QFileInfo(fileName).absolutePath());
+    QSaveFile myFile(fileName);//writes to a temporary file and renames it, so concurrent jobs never see a partial cache file
+    if (!myFile.open(QIODevice::WriteOnly))
+    {
+        CaretLogWarning("failed to create smoothing weight cache file '" + fileName + "'");
+        return;
+    }
+    int64_t numWeights = m_rowStart[m_numNodes];
+    WeightCacheHeader myHeader;
+    memset(&myHeader, 0, sizeof(myHeader));
+    memcpy(myHeader.m_magic, WEIGHT_CACHE_MAGIC, sizeof(WEIGHT_CACHE_MAGIC));
+    myHeader.m_byteOrder = WEIGHT_CACHE_BYTE_ORDER;
+    myHeader.m_numNodes = m_numNodes;
+    myHeader.m_numWeights = numWeights;
+    bool ok = myFile.write((const char*)&myHeader, sizeof(myHeader)) == (int64_t)sizeof(myHeader);
+    ok = ok && myFile.write((const char*)m_rowStart, (m_numNodes + 1) * sizeof(int64_t)) == (int64_t)((m_numNodes + 1) * sizeof(int64_t));
+    ok = ok && myFile.write((const char*)m_weightSums, m_numNodes * sizeof(float)) == (int64_t)(m_numNodes * sizeof(float));
+    ok = ok && myFile.write((const char*)m_rowNodes, numWeights * sizeof(int32_t)) == (int64_t)(numWeights * sizeof(int32_t));
+    ok = ok && myFile.write((const char*)m_rowWeights, numWeights * sizeof(float)) == (int64_t)(numWeights * sizeof(float));
+    if (!ok || !myFile.commit())
+    {
+        CaretLogWarning("failed to write smoothing weight cache file '" + fileName + "'");
+    }
 }
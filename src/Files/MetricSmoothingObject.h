@@ -30,10 +30,15 @@
 //NOTE: for a static ROI, it is (sometimes much) more efficient to use it in the constructor, and provide no ROI (NULL) to the functions, using both an ROI in constructor and in method
 //      will result in the effective ROI being the logical AND of the two (intersection).
 
+#include "AString.h"
+#include "CaretPointer.h"
+
 #include "stdint.h"
 #include "stddef.h"
 #include <vector>
 
+class QFile;
+
 namespace caret {
     
     class SurfaceFile;
@@ -48,10 +53,16 @@ namespace caret {
             GEO_GAUSS_EQUAL,
             GEO_GAUSS
         };
-        MetricSmoothingObject(const SurfaceFile* mySurf, const float& kernel, const MetricFile* myRoi = NULL, Method myMethod = GEO_GAUSS_AREA, const float* nodeAreas = NULL);
+        ///if weightCacheDirectory is nonempty, weights are saved there and memory-mapped when the same surface, areas, roi, method and kernel are used again
+        MetricSmoothingObject(const SurfaceFile* mySurf, const float& kernel, const MetricFile* myRoi = NULL, Method myMethod = GEO_GAUSS_AREA, const float* nodeAreas = NULL,
+                              const AString& weightCacheDirectory = "");
         void smoothColumn(const MetricFile* metricIn, const int& whichColumn, MetricFile* columnOut, const MetricFile* roi = NULL, const bool& fixZeros = false) const;
         void smoothColumn(const MetricFile* metricIn, const int& whichColumn, MetricFile* metricOut, const int& whichOutColumn, const MetricFile* roi = NULL, const int& whichRoiColumn = 0, const bool& fixZeros = false) const;
         void smoothMetric(const MetricFile* metricIn, MetricFile* metricOut, const MetricFile* roi = NULL, const bool& fixZeros = false) const;
+        ///smooths several columns per pass through the weights, much faster than smoothColumn on many columns, output columns must already exist
+        void smoothColumns(const MetricFile* metricIn, const int& firstColumn, const int& numColumns, MetricFile* metricOut, const int& firstOutColumn,
+                           const MetricFile* roi = NULL, const int& whichRoiColumn = 0, const bool& fixZeros = false) const;
+        ~MetricSmoothingObject();
     private:
         struct WeightList
         {
@@ -59,10 +70,23 @@ namespace caret {
             std::vector<float> m_weights;
             float m_weightSum;
         };
-        std::vector<WeightList> m_weightLists;
+        std::vector<WeightList> m_weightLists;//only used while computing weights, then converted to the compressed rows below
+        int32_t m_numNodes;
+        const int64_t* m_rowStart;//compressed sparse rows, these point either into the vectors below or into a mapped cache file
+        const int32_t* m_rowNodes;
+        const float* m_rowWeights;
+        const float* m_weightSums;
+        std::vector<int64_t> m_rowStartStore;
+        std::vector<int32_t> m_rowNodesStore;
+        std::vector<float> m_rowWeightsStore, m_weightSumsStore;
+        CaretPointer<QFile> m_cacheFile;//keeps the mapping valid
+        void convertWeightLists();
+        bool loadWeightCache(const AString& fileName);
+        void saveWeightCache(const AString& fileName) const;
         void smoothColumnInternal(float* scratch, const MetricFile* metricIn, const int& whichColumn, MetricFile* metricOut, const int& whichOutColumn, const bool& fixZeros) const;
         void smoothColumnInternal(float* scratch, const MetricFile* metricIn, const int& whichColumn, MetricFile* metricOut, const int& whichOutColumn, const MetricFile* roi, const int& whichRoiColumn, const bool& fixZeros) const;
-        void precomputeWeights(const SurfaceFile* mySurf, float myKernel, const MetricFile* theRoi, Method myMethod, const float* nodeAreas);
+        void smoothPanelInternal(const float* panelIn, float* panelOut, const float* roiColumn, const bool& fixZeros) const;
+        void precomputeWeights(const SurfaceFile* mySurf, float myKernel, const MetricFile* theRoi, Method myMethod, const float* nodeAreas, const AString& weightCacheDirectory);
         void precomputeWeightsGeoGauss(const SurfaceFile* mySurf, float myKernel, const float* nodeAreas);
         void precomputeWeightsROIGeoGauss(const SurfaceFile* mySurf, float myKernel, const MetricFile* theRoi, const float* nodeAreas);
         void precomputeWeightsGeoGaussArea(const SurfaceFile* mySurf, float myKernel, const float* nodeAreas);
@@ -70,6 +94,8 @@ namespace caret {
         void precomputeWeightsGeoGaussEqual(const SurfaceFile* mySurf, float myKernel, const float* nodeAreas);
         void precomputeWeightsROIGeoGaussEqual(const SurfaceFile* mySurf, float myKernel, const MetricFile* theRoi, const float* nodeAreas);
         MetricSmoothingObject();
+        MetricSmoothingObject(const MetricSmoothingObject&);
+        MetricSmoothingObject& operator=(const MetricSmoothingObject&);
     };
     
 }
@@ -22,6 +22,7 @@
 #include <cmath>
 #include <limits>
 #include <unordered_map>
+#include <utility>
 
 #define __NODE_AND_VOXEL_COLORING_DECLARE__
 #include "NodeAndVoxelColoring.h"
@@ -37,7 +38,9 @@
 #include "LabelSelectionItem.h"
 #include "LabelSelectionItemModel.h"
 #include "Palette.h"
+#include "PaletteColoringCache.h"
 #include "PaletteColorMapping.h"
+#include "PaletteLookupTable.h"
 #include "MathFunctions.h"
 #include "TabDrawingInfo.h"
 
@@ -58,6 +61,156 @@ static const float negativeThresholdGreenColor[] = {
 };
 
 
+
+namespace {
+    /**
+     * Color a scalar using a palette.
+     *
+     * @param settings
+     *    Settings for coloring scalars.
+     * @param lookupTable
+     *    Lookup table with the palette's colors.
+     * @param scalar
+     *    The scalar.
+     * @param normalizedValue
+     *    Normalized palette value of the scalar.
+     * @param threshold
+     *    Threshold value for the scalar.
+     * @param rgbaOut
+     *    Output color, all components are zero if the scalar is not colored.
+     */
+    inline void colorScalarWithPalette(const PaletteColoringCache::ColoringSettings& settings,
+                                       const PaletteLookupTable* lookupTable,
+                                       const float scalar,
+                                       const float normalizedValue,
+                                       const float threshold,
+                                       float rgbaOut[4])
+    {
+        rgbaOut[0] = 0.0;
+        rgbaOut[1] = 0.0;
+        rgbaOut[2] = 0.0;
+        rgbaOut[3] = 0.0;
+        
+        /*
+         * Positive/Zero/Negative Test
+         */
+        if (scalar > PaletteColorMapping::SMALL_POSITIVE) {
+            if (settings.m_hidePositiveValues) {
+                return;
+            }
+        }
+        else if (scalar < PaletteColorMapping::SMALL_NEGATIVE) {
+            if (settings.m_hideNegativeValues) {
+                return;
+            }
+        }
+        else if (MathFunctions::isNaN(scalar)) {
+            return;//TSC: never color NaN
+        } else {
+            /*
+             * May be very near zero so force to zero.
+             * 
+             * TSC: that seems wrong, leave the normalized value alone
+             *  if the data value is near zero, that doesn't mean the palette settings aren't also near zero
+             *  therefore, normalized value may not be near zero, which is important
+             * 
+             */
+            if (settings.m_hideZeroValues) {
+                return;
+            }
+        }
+        
+        /*
+         * Color scalar using palette
+         */
+        float rgba[4];
+        lookupTable->getPaletteColor(normalizedValue,
+                                     rgba);
+        if (rgba[3] > 0.0f) {
+            rgbaOut[0] = rgba[0];
+            rgbaOut[1] = rgba[1];
+            rgbaOut[2] = rgba[2];
+            rgbaOut[3] = rgba[3];
+        }
+        
+        /*
+         * Threshold Test
+         * Threshold is done last so colors are still set
+         * but if threshold test fails, alpha is set invalid.
+         */
+        bool thresholdPassedFlag = false;
+        if (settings.m_skipThresholdTesting) {
+            thresholdPassedFlag = true;
+        }
+        else if (settings.m_showOutsideFlag) {
+            if (threshold > settings.m_thresholdMaximum) {
+                thresholdPassedFlag = true;
+            }
+            else if (threshold < settings.m_thresholdMinimum) {
+                thresholdPassedFlag = true;
+            }
+        }
+        else {
+            if ((threshold >= settings.m_thresholdMinimum) &&
+                (threshold <= settings.m_thresholdMaximum)) {
+                thresholdPassedFlag = true;
+            }
+        }
+        if ( ! thresholdPassedFlag) {
+            /*
+             * Need to clear RGB, in addition to alpha for volume Maximum Intensity Projection
+             */
+            rgbaOut[0] = 0.0;
+            rgbaOut[1] = 0.0;
+            rgbaOut[2] = 0.0;
+            rgbaOut[3] = 0.0;
+            if (settings.m_showMappedThresholdFailuresInGreen) {
+                if (settings.m_thresholdType == PaletteThresholdTypeEnum::THRESHOLD_TYPE_MAPPED) {
+                    if (threshold > 0.0f) {
+                        if ((threshold < settings.m_thresholdMappedPositive) &&
+                            (threshold > settings.m_thresholdMappedPositiveAverageArea)) {
+                            rgbaOut[0] = positiveThresholdGreenColor[0];
+                            rgbaOut[1] = positiveThresholdGreenColor[1];
+                            rgbaOut[2] = positiveThresholdGreenColor[2];
+                            rgbaOut[3] = positiveThresholdGreenColor[3];
+                        }
+                    }
+                    else if (threshold < 0.0f) {
+                        if ((threshold > settings.m_thresholdMappedNegative) &&
+                            (threshold < settings.m_thresholdMappedNegativeAverageArea)) {
+                            rgbaOut[0] = negativeThresholdGreenColor[0];
+                            rgbaOut[1] = negativeThresholdGreenColor[1];
+                            rgbaOut[2] = negativeThresholdGreenColor[2];
+                            rgbaOut[3] = negativeThresholdGreenColor[3];
+                        }
+                    }
+                }
+            }
+        }
+    }
+    
+    /**
+     * Convert a color with float components [0, 1] to unsigned byte components.
+     *
+     * @param rgba
+     *    The float color.
+     * @param rgbaOut
+     *    Output with unsigned byte color.
+     */
+    inline void setUnsignedByteColor(const float rgba[4],
+                                     uint8_t* rgbaOut)
+    {
+        rgbaOut[0] = rgba[0] * 255.0;
+        rgbaOut[1] = rgba[1] * 255.0;
+        rgbaOut[2] = rgba[2] * 255.0;
+        if (rgba[3] > 0.0) {
+            rgbaOut[3] = rgba[3] * 255.0;
+        }
+        else {
+            rgbaOut[3] = 0;
+        }
+    }
+}
     
 /**
  * \class NodeAndVoxelColoring 
@@ -93,6 +246,9 @@ static const float negativeThresholdGreenColor[] = {
  *    true type is provided by the previous parameter colorDataType.
  * @param ignoreThresholding
  *    If true, skip all threshold testing
+ * @param coloringCache
+ *    If not NULL, content retained from the previous coloring of
+ *    the scalars into 'rgbaOutPointer' (unsigned byte only).
  */
 void
 NodeAndVoxelColoring::colorScalarsWithPalettePrivate(const FastStatistics* statistics,
@@ -103,7 +259,8 @@ NodeAndVoxelColoring::colorScalarsWithPalettePrivate(const FastStatistics* stati
                                                      const int64_t numberOfScalars,
                                                      const ColorDataType colorDataType,
                                                      void* rgbaOutPointer,
-                                                     const bool ignoreThresholding)
+                                                     const bool ignoreThresholding,
+                                                     PaletteColoringCache* coloringCache)
 {
     if (numberOfScalars <= 0) {
         return;
@@ -132,234 +289,82 @@ NodeAndVoxelColoring::colorScalarsWithPalettePrivate(const FastStatistics* stati
             break;
     }
     
-    /*
-     * Type of threshold testing
-     */
-    bool showOutsideFlag = false;
-    const PaletteThresholdTestEnum::Enum thresholdTest = paletteColorMapping->getThresholdTest();
-    switch (thresholdTest) {
-        case PaletteThresholdTestEnum::THRESHOLD_TEST_SHOW_OUTSIDE:
-            showOutsideFlag = true;
-            break;
-        case PaletteThresholdTestEnum::THRESHOLD_TEST_SHOW_INSIDE:
-            showOutsideFlag = false;
-            break;
-    }
-    
-    /*
-     * Range of values allowed by thresholding
-     */
-    const PaletteThresholdTypeEnum::Enum thresholdType = paletteColorMapping->getThresholdType();
-    const float thresholdMinimum = paletteColorMapping->getThresholdMinimum(thresholdType);
-    const float thresholdMaximum = paletteColorMapping->getThresholdMaximum(thresholdType);
-    const float thresholdMappedPositive = paletteColorMapping->getThresholdMappedMaximum();
-    const float thresholdMappedPositiveAverageArea = paletteColorMapping->getThresholdMappedAverageAreaMaximum();
-    const float thresholdMappedNegative = paletteColorMapping->getThresholdMappedMinimum();
-    const float thresholdMappedNegativeAverageArea = paletteColorMapping->getThresholdMappedAverageAreaMinimum();
-    const bool showMappedThresholdFailuresInGreen = paletteColorMapping->isShowThresholdFailureInGreen();
-    
-    /*
-     * Skip threshold testing?
-     */
-    const bool skipThresholdTesting = (ignoreThresholding
-                                       || (thresholdType == PaletteThresholdTypeEnum::THRESHOLD_TYPE_OFF));
-    
-    /*
-     * Display of negative, zero, and positive values allowed.
-     */
-    const bool hidePositiveValues = (paletteColorMapping->isDisplayPositiveDataFlag() == false);
-    const bool hideNegativeValues = (paletteColorMapping->isDisplayNegativeDataFlag() == false);
-    const bool hideZeroValues =     (paletteColorMapping->isDisplayZeroDataFlag() == false);
-    
     const bool interpolateFlag = paletteColorMapping->isInterpolatePaletteFlag();
     
     /*
-     * Convert data values to normalized palette values.
+     * Lookup table avoids searching the palette for each value.
+     * It is cached by the palette so it is only created after
+     * the palette changes.
      */
-    std::vector<float> normalizedValues(numberOfScalars);
-    paletteColorMapping->mapDataToPaletteNormalizedValues(statistics,
-                                                          scalarValues,
-                                                          &normalizedValues[0],
-                                                          numberOfScalars);
+    const PaletteColoringCache::ColoringSettings coloringSettings(paletteColorMapping,
+                                                                  palette->getLookupTable(interpolateFlag),
+                                                                  ignoreThresholding);
+    const PaletteLookupTable* lookupTable(coloringSettings.m_lookupTable.get());
+    CaretAssert(lookupTable);
     
     /*
-     * Get color for normalized values of -1.0 and 1.0.
-     * Since there may be a large number of values that are -1.0 or 1.0
-     * we can compute the color only once for these values and save time.
+     * Convert data values to normalized palette values.
+     * Normalized values in the cache are reused when only
+     * the palette's colors or the thresholding changed.
      */
-    float rgbaPositiveOne[4], rgbaNegativeOne[4];
-    palette->getPaletteColor(1.0,
-                             interpolateFlag,
-                             rgbaPositiveOne);
-    const bool rgbaPositiveOneValid = (rgbaPositiveOne[3] > 0.0);
-    palette->getPaletteColor(-1.0,
-                             interpolateFlag,
-                             rgbaNegativeOne);
-    const bool rgbaNegativeOneValid = (rgbaNegativeOne[3] > 0.0);
+    std::vector<float> normalizedValuesVector;
+    const float* normalizedValues(NULL);
+    if (coloringCache != NULL) {
+        CaretAssert(colorDataType == COLOR_TYPE_UNSIGNED_BTYE);
+        if (coloringCache->m_numberOfScalars != numberOfScalars) {
+            coloringCache->invalidate();
+            coloringCache->m_numberOfScalars = numberOfScalars;
+        }
+        
+        const PaletteColoringCache::NormalizationSettings normalizationSettings(statistics,
+                                                                                paletteColorMapping);
+        if (coloringCache->m_validFlag
+            && (coloringCache->m_normalizationSettings == normalizationSettings)) {
+            if (coloringCache->m_coloringSettings.isEqualExceptThresholdRange(coloringSettings)) {
+                if (colorScalarsForThresholdRangeChange(coloringSettings,
+                                                        scalarValues,
+                                                        thresholdValues,
+                                                        rgbaUnsignedByte,
+                                                        coloringCache)) {
+                    return;
+                }
+            }
+        }
+        else {
+            coloringCache->m_validFlag = false;
+            coloringCache->m_normalizedValues.resize(numberOfScalars);
+            paletteColorMapping->mapDataToPaletteNormalizedValues(statistics,
+                                                                  scalarValues,
+                                                                  coloringCache->m_normalizedValues.data(),
+                                                                  numberOfScalars);
+            coloringCache->m_normalizationSettings = normalizationSettings;
+        }
+        normalizedValues = coloringCache->m_normalizedValues.data();
+    }
+    else {
+        normalizedValuesVector.resize(numberOfScalars);
+        paletteColorMapping->mapDataToPaletteNormalizedValues(statistics,
+                                                              scalarValues,
+                                                              &normalizedValuesVector[0],
+                                                              numberOfScalars);
+        normalizedValues = &normalizedValuesVector[0];
+    }
     
     /*
      * Color all scalars.
      */
 #pragma omp CARET_PARFOR schedule(dynamic, 4096)
-        for (int64_t i = 0; i < numberOfScalars; i++) {
+    for (int64_t i = 0; i < numberOfScalars; i++) {
         const int64_t i4 = i * 4;
         
-        /*
-         * Initialize coloring for node since one of the
-         * continue statements below may cause moving
-         * on to next node
-         */
-        switch (colorDataType) {
-            case COLOR_TYPE_FLOAT:
-                rgbaFloat[i4]   =  0.0;
-                rgbaFloat[i4+1] =  0.0;
-                rgbaFloat[i4+2] =  0.0;
-                rgbaFloat[i4+3] =  0.0;
-                break;
-            case COLOR_TYPE_UNSIGNED_BTYE:
-                rgbaUnsignedByte[i4]   =  0;
-                rgbaUnsignedByte[i4+1] =  0;
-                rgbaUnsignedByte[i4+2] =  0;
-                rgbaUnsignedByte[i4+3] =  0;
-                break;
-        }
-        
-        float scalar = scalarValues[i];
-        const float threshold = thresholdValues[i];
+        float rgbaOut[4];
+        colorScalarWithPalette(coloringSettings,
+                               lookupTable,
+                               scalarValues[i],
+                               normalizedValues[i],
+                               thresholdValues[i],
+                               rgbaOut);
         
-        /*
-         * Positive/Zero/Negative Test
-         */
-        if (scalar > PaletteColorMapping::SMALL_POSITIVE) {
-            if (hidePositiveValues) {
-                continue;
-            }
-        }
-        else if (scalar < PaletteColorMapping::SMALL_NEGATIVE) {
-            if (hideNegativeValues) {
-                continue;
-            }
-        }
-        else if (MathFunctions::isNaN(scalar)) {
-            continue;//TSC: never color NaN
-        } else {
-            /*
-             * May be very near zero so force to zero.
-             * 
-             * TSC: that seems wrong, leave the normalized value alone
-             *  if the data value is near zero, that doesn't mean the palette settings aren't also near zero
-             *  therefore, normalized value may not be near zero, which is important
-             * 
-             */
-            //normalizedValues[i] = 0.0;
-            if (hideZeroValues) {
-                continue;
-            }
-        }
-        
-        /*
-         * Temporary for rgba coloring now that past possible
-         * continue statements
-         */
-        float rgbaOut[4] = {
-             0.0,
-             0.0,
-             0.0,
-             0.0
-        };
-        
-        const float normalValue = normalizedValues[i];
-        
-        /*
-         * RGBA colors have been mapped for extreme values
-         */
-        if (normalValue >= 1.0) {
-            if (rgbaPositiveOneValid) {
-                rgbaOut[0] = rgbaPositiveOne[0];
-                rgbaOut[1] = rgbaPositiveOne[1];
-                rgbaOut[2] = rgbaPositiveOne[2];
-                rgbaOut[3] = rgbaPositiveOne[3];
-            }
-        }
-        else if (normalValue <= -1.0) {
-            if (rgbaNegativeOneValid) {
-                rgbaOut[0] = rgbaNegativeOne[0];
-                rgbaOut[1] = rgbaNegativeOne[1];
-                rgbaOut[2] = rgbaNegativeOne[2];
-                rgbaOut[3] = rgbaNegativeOne[3];
-            }
-        }
-        else {
-            /*
-             * Color scalar using palette
-             */
-            float rgba[4];
-            palette->getPaletteColor(normalValue,
-                                     interpolateFlag,
-                                     rgba);
-            if (rgba[3] > 0.0f) {
-                rgbaOut[0] = rgba[0];
-                rgbaOut[1] = rgba[1];
-                rgbaOut[2] = rgba[2];
-                rgbaOut[3] = rgba[3];
-            }
-        }
-        
-        /*
-         * Threshold Test
-         * Threshold is done last so colors are still set
-         * but if threshold test fails, alpha is set invalid.
-         */
-        bool thresholdPassedFlag = false;
-        if (skipThresholdTesting) {
-            thresholdPassedFlag = true;
-        }
-        else if (showOutsideFlag) {
-            if (threshold > thresholdMaximum) {
-                thresholdPassedFlag = true;
-            }
-            else if (threshold < thresholdMinimum) {
-                thresholdPassedFlag = true;
-            }
-        }
-        else {
-            if ((threshold >= thresholdMinimum) &&
-                (threshold <= thresholdMaximum)) {
-                thresholdPassedFlag = true;
-            }
-        }
-        if ( ! thresholdPassedFlag) {
-            /*
-             * Need to clear RGB, in addition to alpha for volume Maximum Intensity Projection
-             */
-            rgbaOut[0] = 0.0;
-            rgbaOut[1] = 0.0;
-            rgbaOut[2] = 0.0;
-            rgbaOut[3] = 0.0;
-            if (showMappedThresholdFailuresInGreen) {
-                if (thresholdType == PaletteThresholdTypeEnum::THRESHOLD_TYPE_MAPPED) {
-                    if (threshold > 0.0f) {
-                        if ((threshold < thresholdMappedPositive) &&
-                            (threshold > thresholdMappedPositiveAverageArea)) {
-                            rgbaOut[0] = positiveThresholdGreenColor[0];
-                            rgbaOut[1] = positiveThresholdGreenColor[1];
-                            rgbaOut[2] = positiveThresholdGreenColor[2];
-                            rgbaOut[3] = positiveThresholdGreenColor[3];
-                        }
-                    }
-                    else if (threshold < 0.0f) {
-                        if ((threshold > thresholdMappedNegative) &&
-                            (threshold < thresholdMappedNegativeAverageArea)) {
-                            rgbaOut[0] = negativeThresholdGreenColor[0];
-                            rgbaOut[1] = negativeThresholdGreenColor[1];
-                            rgbaOut[2] = negativeThresholdGreenColor[2];
-                            rgbaOut[3] = negativeThresholdGreenColor[3];
-                        }
-                    }
-                }
-            }
-        }
-
         switch (colorDataType) {
             case COLOR_TYPE_FLOAT:
                 CaretAssertArrayIndex(rgbaFloat, numberOfScalars * 4, i*4+3);
@@ -370,18 +375,131 @@ NodeAndVoxelColoring::colorScalarsWithPalettePrivate(const FastStatistics* stati
                 break;
             case COLOR_TYPE_UNSIGNED_BTYE:
                 CaretAssertArrayIndex(rgbaUnsignedByte, numberOfScalars * 4, i*4+3);
-                rgbaUnsignedByte[i4]   = rgbaOut[0] * 255.0;
-                rgbaUnsignedByte[i4+1] = rgbaOut[1] * 255.0;
-                rgbaUnsignedByte[i4+2] = rgbaOut[2] * 255.0;
-                if (rgbaOut[3] > 0.0) {
-                    rgbaUnsignedByte[i4+3] = rgbaOut[3] * 255.0;
-                }
-                else {
-                    rgbaUnsignedByte[i4+3] = 0;
-                }
+                setUnsignedByteColor(rgbaOut,
+                                     &rgbaUnsignedByte[i4]);
                 break;
         }
     }
+    
+    if (coloringCache != NULL) {
+        coloringCache->m_coloringSettings = coloringSettings;
+        coloringCache->m_validFlag = true;
+    }
+}
+
+/**
+ * Color only the scalars whose threshold test result may have changed
+ * when only the threshold minimum and/or maximum changed since the
+ * previous coloring.  Those scalars have threshold values between
+ * the previous and new minimum or between the previous and new maximum.
+ *
+ * @param coloringSettings
+ *    Settings for coloring scalars.
+ * @param scalarValues
+ *    Scalars that are used to color the values.
+ * @param thresholdValues
+ *    Thresholds for inhibiting coloring.
+ * @param rgbaOut
+ *    RGBA colors output by the previous coloring that are updated.
+ * @param coloringCache
+ *    Content retained from the previous coloring.
+ * @return
+ *    True if coloring was updated, false if all scalars need to be colored.
+ */
+bool
+NodeAndVoxelColoring::colorScalarsForThresholdRangeChange(const PaletteColoringCache::ColoringSettings& coloringSettings,
+                                                          const float* scalarValues,
+                                                          const float* thresholdValues,
+                                                          uint8_t* rgbaOut,
+                                                          PaletteColoringCache* coloringCache)
+{
+    CaretAssert(coloringCache);
+    CaretAssert(coloringCache->m_validFlag);
+    
+    PaletteColoringCache::ColoringSettings& previousSettings = coloringCache->m_coloringSettings;
+    if (coloringSettings.m_skipThresholdTesting) {
+        /* threshold range is not used */
+        previousSettings = coloringSettings;
+        return true;
+    }
+    
+    const float previousMinimum = previousSettings.m_thresholdMinimum;
+    const float previousMaximum = previousSettings.m_thresholdMaximum;
+    const float thresholdMinimum = coloringSettings.m_thresholdMinimum;
+    const float thresholdMaximum = coloringSettings.m_thresholdMaximum;
+    if ((previousMinimum == thresholdMinimum)
+        && (previousMaximum == thresholdMaximum)) {
+        return true;
+    }
+    if (MathFunctions::isNaN(previousMinimum)
+        || MathFunctions::isNaN(previousMaximum)
+        || MathFunctions::isNaN(thresholdMinimum)
+        || MathFunctions::isNaN(thresholdMaximum)) {
+        return false;
+    }
+    
+    const int64_t numberOfScalars = coloringCache->m_numberOfScalars;
+    if (numberOfScalars > static_cast<int64_t>(std::numeric_limits<uint32_t>::max())) {
+        return false;
+    }
+    coloringCache->updateThresholdIndex(thresholdValues);
+    
+    std::vector<std::pair<int64_t, int64_t>> positionRanges;
+    int64_t numberToColor = 0;
+    if (previousMinimum != thresholdMinimum) {
+        int64_t firstPosition(0), endPosition(0);
+        coloringCache->getThresholdIndexRange(std::min(previousMinimum, thresholdMinimum),
+                                              std::max(previousMinimum, thresholdMinimum),
+                                              firstPosition,
+                                              endPosition);
+        positionRanges.push_back(std::make_pair(firstPosition, endPosition));
+        numberToColor += (endPosition - firstPosition);
+    }
+    if (previousMaximum != thresholdMaximum) {
+        int64_t firstPosition(0), endPosition(0);
+        coloringCache->getThresholdIndexRange(std::min(previousMaximum, thresholdMaximum),
+                                              std::max(previousMaximum, thresholdMaximum),
+                                              firstPosition,
+                                              endPosition);
+        positionRanges.push_back(std::make_pair(firstPosition, endPosition));
+        numberToColor += (endPosition - firstPosition);
+    }
+    
+    /*
+     * Scattered access is slower than coloring all
+     * scalars when many of the scalars change
+     */
+    if (numberToColor > (numberOfScalars / 4)) {
+        return false;
+    }
+    
+    const PaletteLookupTable* lookupTable(coloringSettings.m_lookupTable.get());
+    CaretAssert(lookupTable);
+    const float* normalizedValues = coloringCache->m_normalizedValues.data();
+    const uint32_t* sortedIndices = coloringCache->m_thresholdSortedIndices.data();
+    
+    for (const auto& positionRange : positionRanges) {
+        const int64_t firstPosition = positionRange.first;
+        const int64_t endPosition   = positionRange.second;
+#pragma omp CARET_PARFOR schedule(dynamic, 4096)
+        for (int64_t iPos = firstPosition; iPos < endPosition; iPos++) {
+            const int64_t i = sortedIndices[iPos];
+            float rgba[4];
+            colorScalarWithPalette(coloringSettings,
+                                   lookupTable,
+                                   scalarValues[i],
+                                   normalizedValues[i],
+                                   thresholdValues[i],
+                                   rgba);
+            CaretAssertArrayIndex(rgbaOut, numberOfScalars * 4, i*4+3);
+            setUnsignedByteColor(rgba,
+                                 &rgbaOut[i * 4]);
+        }
+    }
+    
+    previousSettings = coloringSettings;
+    
+    return true;
 }
 
 
@@ -429,7 +547,8 @@ NodeAndVoxelColoring::colorScalarsWithPalette(const FastStatistics* statistics,
                                    numberOfScalars,
                                    COLOR_TYPE_FLOAT,
                                    (void*)rgbaOut,
-                                   ignoreThresholding);
+                                   ignoreThresholding,
+                                   NULL);
 }
 
 /**
@@ -456,6 +575,12 @@ NodeAndVoxelColoring::colorScalarsWithPalette(const FastStatistics* statistics,
  *    Number of elements is 'numberOfScalars' * 4.
  * @param ignoreThresholding
  *    If true, skip all threshold testing
+ * @param coloringCache
+ *    If not NULL, content retained from the previous coloring of the scalars
+ *    into 'rgbaOut'.  When the previous coloring differs only in the palette's
+ *    colors or the threshold range, less work is needed for coloring.
+ *    The caller must invalidate the cache when the scalars or threshold
+ *    values change or when it alters the colors in 'rgbaOut'.
  */
 void
 NodeAndVoxelColoring::colorScalarsWithPalette(const FastStatistics* statistics,
@@ -465,7 +590,8 @@ NodeAndVoxelColoring::colorScalarsWithPalette(const FastStatistics* statistics,
                                               const float* thresholdValues,
                                               const int64_t numberOfScalars,
                                               uint8_t* rgbaOut,
-                                              const bool ignoreThresholding)
+                                              const bool ignoreThresholding,
+                                              PaletteColoringCache* coloringCache)
 {
     colorScalarsWithPalettePrivate(statistics,
                                    paletteColorMapping,
@@ -475,7 +601,8 @@ NodeAndVoxelColoring::colorScalarsWithPalette(const FastStatistics* statistics,
                                    numberOfScalars,
                                    COLOR_TYPE_UNSIGNED_BTYE,
                                    (void*)rgbaOut,
-                                   ignoreThresholding);
+                                   ignoreThresholding,
+                                   coloringCache);
 }
 
 /**
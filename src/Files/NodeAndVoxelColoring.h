@@ -26,6 +26,7 @@
 #include "CaretColorEnum.h"
 #include "DisplayGroupEnum.h"
 #include "LabelDrawingTypeEnum.h"
+#include "PaletteColoringCache.h"
 #include "PaletteThresholdOutlineDrawingModeEnum.h"
 
 namespace caret {
@@ -53,7 +54,8 @@ namespace caret {
                                             const float* scalarThresholds,
                                             const int64_t numberOfScalars,
                                             uint8_t* rgbaOut,
-                                            const bool ignoreThresholding = false);
+                                            const bool ignoreThresholding = false,
+                                            PaletteColoringCache* coloringCache = NULL);
         
         static void colorScalarsWithRGBA(const float* redComponents,
                                          const float* greenComponents,
@@ -105,7 +107,14 @@ namespace caret {
                                                    const int64_t numberOfScalars,
                                                    const ColorDataType colorDataType,
                                                    void* rgbaOutPointer,
-                                                   const bool ignoreThresholding);
+                                                   const bool ignoreThresholding,
+                                                   PaletteColoringCache* coloringCache);
+        
+        static bool colorScalarsForThresholdRangeChange(const PaletteColoringCache::ColoringSettings& coloringSettings,
+                                                        const float* scalarValues,
+                                                        const float* thresholdValues,
+                                                        uint8_t* rgbaOut,
+                                                        PaletteColoringCache* coloringCache);
         
         static void colorIndicesWithLabelTableForDisplayGroupTabPrivate(const GiftiLabelTable* labelTable,
                                                       const float* labelIndices,
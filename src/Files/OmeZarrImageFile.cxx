@@ -137,12 +137,15 @@ OmeZarrImageFile::resetPrivate()
     EventCaretPreferencesGet prefsEvent;
     EventManager::get()->sendEvent(prefsEvent.getPointer());
     CaretPreferences* prefs = prefsEvent.getCaretPreferences();
+    int64_t sharedPrimitivesSizeMegabytes(512);
     if (prefs != NULL) {
         m_maximumImageDimension = prefs->getCziDimension();
+        sharedPrimitivesSizeMegabytes = prefs->getMediaTileCacheSizeMegabytes();
     }
     else {
         m_maximumImageDimension = 2048;
     }
+    m_sharedPrimitivesMaximumSizeBytes = sharedPrimitivesSizeMegabytes * 1024 * 1024;
 
     m_pyramidLevels.clear();
     
@@ -161,6 +164,8 @@ OmeZarrImageFile::resetPrivate()
             m_tabOverlayInfo[iTab][iOverlay]->resetContent();
         }
     }
+    m_sharedPrimitives.clear();
+    m_sharedPrimitivesSizeBytes = 0;
     
     m_imagesAsVolumeFile.reset();
     m_triedToCreateImagesAsVolumeFileFlag = false;
@@ -582,7 +587,18 @@ OmeZarrImageFile::reloadPyramidLayerInTabOverlay(const int32_t tabIndex,
 {
     CaretAssertArrayIndex(m_tabOverlayInfo, BrainConstants::MAXIMUM_NUMBER_OF_BROWSER_TABS, tabIndex);
     CaretAssertArrayIndex(m_tabOverlayInfo, BrainConstants::MAXIMUM_NUMBER_OF_OVERLAYS, overlayIndex);
-    m_tabOverlayInfo[tabIndex][overlayIndex]->m_graphicsPrimitive.reset();
+    TabOverlayInfo* tabOverlayInfo(m_tabOverlayInfo[tabIndex][overlayIndex].get());
+    
+    /*
+     * Remove shared primitive so that the data is read again
+     */
+    auto iter(m_sharedPrimitives.find(SharedPrimitiveKey(tabOverlayInfo->m_pyramidLevel,
+                                                         tabOverlayInfo->m_frameIndex)));
+    if (iter != m_sharedPrimitives.end()) {
+        m_sharedPrimitivesSizeBytes -= iter->second.m_sizeBytes;
+        m_sharedPrimitives.erase(iter);
+    }
+    tabOverlayInfo->m_graphicsPrimitive.reset();
 }
 
 /**
@@ -1271,10 +1287,8 @@ OmeZarrImageFile::getGraphicsPrimitiveForMediaDrawing(const int32_t tabIndex,
                 const int32_t dataSetIndex(tabOverlayInfo->m_pyramidLevel);
                 if ((dataSetIndex >= 0)
                     && (dataSetIndex < zattrs->getNumberOfDataSets())) {
-                    const OmeDataSet* dataSet(zattrs->getDataSet(dataSetIndex));
-                    GraphicsPrimitiveV3fT2f* primitive(createGraphicsPrimitive(dataSet,
-                                                                               sliceIndex));
-                    tabOverlayInfo->m_graphicsPrimitive.reset(primitive);
+                    tabOverlayInfo->m_graphicsPrimitive = getSharedGraphicsPrimitive(dataSetIndex,
+                                                                                     sliceIndex);
                 }
                 else {
                     CaretLogSevere("Invalid data set index="
@@ -1291,6 +1305,63 @@ OmeZarrImageFile::getGraphicsPrimitiveForMediaDrawing(const int32_t tabIndex,
 #endif
 }
 
+/**
+ * Get the graphics primitive for a pyramid level and slice that is shared by all tabs
+ * and overlays.  If the primitive is not available, it is created and, if the shared
+ * primitives exceed the maximum size, the least recently used primitives are removed
+ * (tabs and overlays using a removed primitive continue to use it).
+ * @param dataSetIndex
+ *    Index of the data set (pyramid level)
+ * @param sliceIndex
+ *    Index of the slice
+ * @return
+ *    The graphics primitive, NULL if failure.
+ */
+std::shared_ptr<GraphicsPrimitiveV3fT2f>
+OmeZarrImageFile::getSharedGraphicsPrimitive(const int32_t dataSetIndex,
+                                             const int64_t sliceIndex) const
+{
+    std::shared_ptr<GraphicsPrimitiveV3fT2f> primitiveOut;
+#if defined(WORKBENCH_HAVE_OME_ZARR_Z5)
+    const SharedPrimitiveKey key(dataSetIndex, sliceIndex);
+    auto iter(m_sharedPrimitives.find(key));
+    if (iter != m_sharedPrimitives.end()) {
+        iter->second.m_lastUsed = ++m_sharedPrimitivesUseCounter;
+        return iter->second.m_graphicsPrimitive;
+    }
+    
+    const OmeDataSet* dataSet(m_omeFileReader->getZAttrs()->getDataSet(dataSetIndex));
+    CaretAssert(dataSet);
+    primitiveOut.reset(createGraphicsPrimitive(dataSet,
+                                               sliceIndex));
+    if ( ! primitiveOut) {
+        return primitiveOut;
+    }
+    
+    SharedPrimitive sharedPrimitive;
+    sharedPrimitive.m_graphicsPrimitive = primitiveOut;
+    sharedPrimitive.m_sizeBytes         = dataSet->getWidth() * dataSet->getHeight() * 4;
+    sharedPrimitive.m_lastUsed          = ++m_sharedPrimitivesUseCounter;
+    
+    while (( ! m_sharedPrimitives.empty())
+           && ((m_sharedPrimitivesSizeBytes + sharedPrimitive.m_sizeBytes) > m_sharedPrimitivesMaximumSizeBytes)) {
+        auto oldestIter(m_sharedPrimitives.begin());
+        for (auto spIter = m_sharedPrimitives.begin(); spIter != m_sharedPrimitives.end(); ++spIter) {
+            if (spIter->second.m_lastUsed < oldestIter->second.m_lastUsed) {
+                oldestIter = spIter;
+            }
+        }
+        m_sharedPrimitivesSizeBytes -= oldestIter->second.m_sizeBytes;
+        m_sharedPrimitives.erase(oldestIter);
+    }
+    
+    m_sharedPrimitivesSizeBytes += sharedPrimitive.m_sizeBytes;
+    m_sharedPrimitives.insert(std::make_pair(key,
+                                             sharedPrimitive));
+#endif
+    return primitiveOut;
+}
+
 /*
  * @return Primitive for drawing media with coordinates
  * @param tabIndex
@@ -23,6 +23,7 @@
 
 
 #include <array>
+#include <map>
 #include <memory>
 
 #include <QRectF>
@@ -273,9 +274,26 @@ namespace caret {
             
             CziImageResolutionChangeModeEnum::Enum m_resolutionChangeMode = CziImageResolutionChangeModeEnum::AUTO2;
             
-            std::unique_ptr<GraphicsPrimitiveV3fT2f> m_graphicsPrimitive;
+            /** May be shared with other tabs and overlays displaying the same pyramid level and slice */
+            std::shared_ptr<GraphicsPrimitiveV3fT2f> m_graphicsPrimitive;
         };
         
+        /** Key for a shared graphics primitive: index of pyramid level and index of slice */
+        typedef std::pair<int32_t, int64_t> SharedPrimitiveKey;
+        
+        /** A graphics primitive shared by all tabs and overlays displaying a pyramid level and slice */
+        class SharedPrimitive {
+        public:
+            std::shared_ptr<GraphicsPrimitiveV3fT2f> m_graphicsPrimitive;
+            
+            int64_t m_sizeBytes = 0;
+            
+            int64_t m_lastUsed = 0;
+        };
+        
+        std::shared_ptr<GraphicsPrimitiveV3fT2f> getSharedGraphicsPrimitive(const int32_t dataSetIndex,
+                                                                            const int64_t sliceIndex) const;
+        
         GraphicsPrimitiveV3fT2f* createGraphicsPrimitive(const OmeImage* omeImage) const;
         
         GraphicsPrimitiveV3fT2f* createGraphicsPrimitive(const OmeDataSet* dataSet,
@@ -327,6 +345,18 @@ namespace caret {
         mutable std::unique_ptr<TabOverlayInfo> m_tabOverlayInfo[BrainConstants::MAXIMUM_NUMBER_OF_BROWSER_TABS]
                                                                 [BrainConstants::MAXIMUM_NUMBER_OF_OVERLAYS];
         
+        /*
+         * Graphics primitives shared by all tabs and overlays so that a
+         * pyramid level's slice is read once for any number of tabs
+         */
+        mutable std::map<SharedPrimitiveKey, SharedPrimitive> m_sharedPrimitives;
+        
+        mutable int64_t m_sharedPrimitivesSizeBytes = 0;
+        
+        mutable int64_t m_sharedPrimitivesUseCounter = 0;
+        
+        int64_t m_sharedPrimitivesMaximumSizeBytes = 512 * 1024 * 1024;
+        
         /*
          * Logical rectangle of full-resolution image
          */
@@ -0,0 +1,324 @@
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026 Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#define __PALETTE_COLORING_CACHE_DECLARE__
+#include "PaletteColoringCache.h"
+#undef __PALETTE_COLORING_CACHE_DECLARE__
+
+#include <algorithm>
+#include <cmath>
+
+#include "CaretAssert.h"
+#include "DeveloperFlagsEnum.h"
+#include "PaletteColorMapping.h"
+#include "PaletteLookupTable.h"
+
+using namespace caret;
+
+
+
+/**
+ * \class caret::PaletteColoringCache
+ * \brief Content retained between colorings of a map's scalars with a palette
+ * \ingroup Files
+ *
+ * Retains the normalized values so that they are not computed again
+ * when only the palette's colors change, and an index of the scalars
+ * binned by threshold value so that when only the threshold range changes,
+ * just the scalars with threshold values between the old and new
+ * threshold range are colored.
+ *
+ * The cache must be invalidated when the scalars or threshold values
+ * change or when the colors output by the previous coloring are altered.
+ */
+
+/**
+ * Constructor.
+ */
+PaletteColoringCache::PaletteColoringCache()
+: CaretObject()
+{
+
+}
+
+/**
+ * Destructor.
+ */
+PaletteColoringCache::~PaletteColoringCache()
+{
+}
+
+/**
+ * Invalidate the cache.  The next coloring colors all scalars.
+ */
+void
+PaletteColoringCache::invalidate()
+{
+    m_validFlag = false;
+    m_thresholdIndexValidFlag = false;
+}
+
+/**
+ * Create the index of scalars binned by threshold value if it is not valid.
+ *
+ * @param thresholdValues
+ *    The threshold values, number of elements is m_numberOfScalars.
+ */
+void
+PaletteColoringCache::updateThresholdIndex(const float* thresholdValues)
+{
+    if (m_thresholdIndexValidFlag) {
+        return;
+    }
+    CaretAssert(thresholdValues);
+
+    /*
+     * Range of the threshold values, infinite values
+     * are placed into the first or last bin
+     */
+    bool haveRangeFlag = false;
+    float minimumValue = 0.0;
+    float maximumValue = 0.0;
+    for (int64_t i = 0; i < m_numberOfScalars; i++) {
+        const float value = thresholdValues[i];
+        if (std::isfinite(value)) {
+            if (haveRangeFlag) {
+                minimumValue = std::min(minimumValue, value);
+                maximumValue = std::max(maximumValue, value);
+            }
+            else {
+                minimumValue = value;
+                maximumValue = value;
+                haveRangeFlag = true;
+            }
+        }
+    }
+
+    m_numberOfThresholdBins = std::max(static_cast<int64_t>(1),
+                                       std::min(m_numberOfScalars / 64,
+                                                static_cast<int64_t>(65536)));
+    m_thresholdBinMinimum = minimumValue;
+    m_thresholdBinMaximum = maximumValue;
+    m_thresholdBinScale = 0.0;
+    if (maximumValue > minimumValue) {
+        m_thresholdBinScale = m_numberOfThresholdBins / (maximumValue - minimumValue);
+        if ( ! std::isfinite(m_thresholdBinScale)) {
+            /* all values go into the first bin */
+            m_thresholdBinScale = 0.0;
+        }
+    }
+
+    /*
+     * Counting sort of the scalar indices by bin
+     */
+    m_thresholdBinOffsets.assign(m_numberOfThresholdBins + 1, 0);
+    for (int64_t i = 0; i < m_numberOfScalars; i++) {
+        const float value = thresholdValues[i];
+        if ( ! std::isnan(value)) {
+            ++m_thresholdBinOffsets[getThresholdBinIndex(value) + 1];
+        }
+    }
+    for (int64_t i = 0; i < m_numberOfThresholdBins; i++) {
+        m_thresholdBinOffsets[i + 1] += m_thresholdBinOffsets[i];
+    }
+
+    m_thresholdSortedIndices.resize(m_thresholdBinOffsets[m_numberOfThresholdBins]);
+    std::vector<int64_t> nextPosition(m_thresholdBinOffsets.begin(),
+                                      m_thresholdBinOffsets.end() - 1);
+    for (int64_t i = 0; i < m_numberOfScalars; i++) {
+        const float value = thresholdValues[i];
+        if ( ! std::isnan(value)) {
+            const int64_t binIndex = getThresholdBinIndex(value);
+            CaretAssertVectorIndex(nextPosition, binIndex);
+            m_thresholdSortedIndices[nextPosition[binIndex]] = static_cast<uint32_t>(i);
+            ++nextPosition[binIndex];
+        }
+    }
+
+    m_thresholdIndexValidFlag = true;
+}
+
+/**
+ * Get the range of positions in the threshold index that contains all
+ * scalars with threshold values in the given range.  The range may also
+ * contain scalars with threshold values outside of the given range.
+ *
+ * @param thresholdLow
+ *    Low end of threshold range, must not be NaN.
+ * @param thresholdHigh
+ *    High end of threshold range, must not be NaN.
+ * @param firstPositionOut
+ *    Output with first position in m_thresholdSortedIndices.
+ * @param endPositionOut
+ *    Output with position after the last position in m_thresholdSortedIndices.
+ */
+void
+PaletteColoringCache::getThresholdIndexRange(const float thresholdLow,
+                                             const float thresholdHigh,
+                                             int64_t& firstPositionOut,
+                                             int64_t& endPositionOut) const
+{
+    CaretAssert(m_thresholdIndexValidFlag);
+    CaretAssert(thresholdLow <= thresholdHigh);
+
+    const int64_t firstBin = getThresholdBinIndex(thresholdLow);
+    const int64_t lastBin  = getThresholdBinIndex(thresholdHigh);
+    CaretAssertVectorIndex(m_thresholdBinOffsets, lastBin + 1);
+    firstPositionOut = m_thresholdBinOffsets[firstBin];
+    endPositionOut   = m_thresholdBinOffsets[lastBin + 1];
+}
+
+/**
+ * Get a description of this object's content.
+ * @return String describing this object's content.
+ */
+AString
+PaletteColoringCache::toString() const
+{
+    return "PaletteColoringCache";
+}
+
+/**
+ * Constructor for invalid settings.
+ */
+PaletteColoringCache::NormalizationSettings::NormalizationSettings()
+{
+
+}
+
+/**
+ * Constructor.
+ *
+ * @param statistics
+ *    Statistics used for normalization.
+ * @param paletteColorMapping
+ *    The palette color mapping.
+ */
+PaletteColoringCache::NormalizationSettings::NormalizationSettings(const FastStatistics* statistics,
+                                                                   const PaletteColorMapping* paletteColorMapping)
+: m_statistics(statistics),
+m_scaleMode(paletteColorMapping->getScaleMode()),
+m_invertedMode(paletteColorMapping->getInvertedMode()),
+m_flipPaletteNotDataFlag(DeveloperFlagsEnum::isFlag(DeveloperFlagsEnum::DEVELOPER_FLAG_FLIP_PALETTE_NOT_DATA))
+{
+    m_scaleValues = {
+        paletteColorMapping->getAutoScalePercentageNegativeMaximum(),
+        paletteColorMapping->getAutoScalePercentageNegativeMinimum(),
+        paletteColorMapping->getAutoScalePercentagePositiveMinimum(),
+        paletteColorMapping->getAutoScalePercentagePositiveMaximum(),
+        paletteColorMapping->getAutoScaleAbsolutePercentageMinimum(),
+        paletteColorMapping->getAutoScaleAbsolutePercentageMaximum(),
+        paletteColorMapping->getUserScaleNegativeMaximum(),
+        paletteColorMapping->getUserScaleNegativeMinimum(),
+        paletteColorMapping->getUserScalePositiveMinimum(),
+        paletteColorMapping->getUserScalePositiveMaximum()
+    };
+}
+
+/**
+ * @return True if the settings produce the same normalized values.
+ * @param rhs
+ *    Settings compared to this.
+ */
+bool
+PaletteColoringCache::NormalizationSettings::operator==(const NormalizationSettings& rhs) const
+{
+    return ((m_statistics != NULL)
+            && (m_statistics == rhs.m_statistics)
+            && (m_scaleMode == rhs.m_scaleMode)
+            && (m_scaleValues == rhs.m_scaleValues)
+            && (m_invertedMode == rhs.m_invertedMode)
+            && (m_flipPaletteNotDataFlag == rhs.m_flipPaletteNotDataFlag));
+}
+
+/**
+ * Constructor for invalid settings.
+ */
+PaletteColoringCache::ColoringSettings::ColoringSettings()
+{
+
+}
+
+/**
+ * Constructor.
+ *
+ * @param paletteColorMapping
+ *    The palette color mapping.
+ * @param lookupTable
+ *    Lookup table containing the colors of the palette.
+ * @param ignoreThresholding
+ *    If true, skip all threshold testing
+ */
+PaletteColoringCache::ColoringSettings::ColoringSettings(const PaletteColorMapping* paletteColorMapping,
+                                                         const std::shared_ptr<const PaletteLookupTable>& lookupTable,
+                                                         const bool ignoreThresholding)
+: m_lookupTable(lookupTable)
+{
+    CaretAssert(paletteColorMapping);
+
+    switch (paletteColorMapping->getThresholdTest()) {
+        case PaletteThresholdTestEnum::THRESHOLD_TEST_SHOW_OUTSIDE:
+            m_showOutsideFlag = true;
+            break;
+        case PaletteThresholdTestEnum::THRESHOLD_TEST_SHOW_INSIDE:
+            m_showOutsideFlag = false;
+            break;
+    }
+
+    m_thresholdType = paletteColorMapping->getThresholdType();
+    m_thresholdMinimum = paletteColorMapping->getThresholdMinimum(m_thresholdType);
+    m_thresholdMaximum = paletteColorMapping->getThresholdMaximum(m_thresholdType);
+    m_thresholdMappedPositive = paletteColorMapping->getThresholdMappedMaximum();
+    m_thresholdMappedPositiveAverageArea = paletteColorMapping->getThresholdMappedAverageAreaMaximum();
+    m_thresholdMappedNegative = paletteColorMapping->getThresholdMappedMinimum();
+    m_thresholdMappedNegativeAverageArea = paletteColorMapping->getThresholdMappedAverageAreaMinimum();
+    m_showMappedThresholdFailuresInGreen = paletteColorMapping->isShowThresholdFailureInGreen();
+
+    m_skipThresholdTesting = (ignoreThresholding
+                              || (m_thresholdType == PaletteThresholdTypeEnum::THRESHOLD_TYPE_OFF));
+
+    m_hidePositiveValues = (paletteColorMapping->isDisplayPositiveDataFlag() == false);
+    m_hideNegativeValues = (paletteColorMapping->isDisplayNegativeDataFlag() == false);
+    m_hideZeroValues     = (paletteColorMapping->isDisplayZeroDataFlag() == false);
+}
+
+/**
+ * @return True if the settings are the same except for the threshold minimum and maximum.
+ * @param rhs
+ *    Settings compared to this.
+ */
+bool
+PaletteColoringCache::ColoringSettings::isEqualExceptThresholdRange(const ColoringSettings& rhs) const
+{
+    return ((m_lookupTable != NULL)
+            && (m_lookupTable == rhs.m_lookupTable)
+            && (m_thresholdType == rhs.m_thresholdType)
+            && (m_thresholdMappedPositive == rhs.m_thresholdMappedPositive)
+            && (m_thresholdMappedPositiveAverageArea == rhs.m_thresholdMappedPositiveAverageArea)
+            && (m_thresholdMappedNegative == rhs.m_thresholdMappedNegative)
+            && (m_thresholdMappedNegativeAverageArea == rhs.m_thresholdMappedNegativeAverageArea)
+            && (m_showOutsideFlag == rhs.m_showOutsideFlag)
+            && (m_skipThresholdTesting == rhs.m_skipThresholdTesting)
+            && (m_showMappedThresholdFailuresInGreen == rhs.m_showMappedThresholdFailuresInGreen)
+            && (m_hidePositiveValues == rhs.m_hidePositiveValues)
+            && (m_hideNegativeValues == rhs.m_hideNegativeValues)
+            && (m_hideZeroValues == rhs.m_hideZeroValues));
+}
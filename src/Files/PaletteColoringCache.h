@@ -0,0 +1,191 @@
+#ifndef __PALETTE_COLORING_CACHE_H__
+#define __PALETTE_COLORING_CACHE_H__
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026 Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "CaretObject.h"
+#include "PaletteEnums.h"
+#include "PaletteInvertModeEnum.h"
+
+namespace caret {
+
+    class FastStatistics;
+    class PaletteColorMapping;
+    class PaletteLookupTable;
+
+    class PaletteColoringCache : public CaretObject {
+
+    public:
+        /**
+         * Settings that determine the color of a scalar from its
+         * data value, normalized value, and threshold value.
+         */
+        class ColoringSettings {
+        public:
+            ColoringSettings();
+
+            ColoringSettings(const PaletteColorMapping* paletteColorMapping,
+                             const std::shared_ptr<const PaletteLookupTable>& lookupTable,
+                             const bool ignoreThresholding);
+
+            bool isEqualExceptThresholdRange(const ColoringSettings& rhs) const;
+
+            std::shared_ptr<const PaletteLookupTable> m_lookupTable;
+
+            PaletteThresholdTypeEnum::Enum m_thresholdType = PaletteThresholdTypeEnum::THRESHOLD_TYPE_OFF;
+
+            float m_thresholdMinimum = 0.0;
+
+            float m_thresholdMaximum = 0.0;
+
+            float m_thresholdMappedPositive = 0.0;
+
+            float m_thresholdMappedPositiveAverageArea = 0.0;
+
+            float m_thresholdMappedNegative = 0.0;
+
+            float m_thresholdMappedNegativeAverageArea = 0.0;
+
+            bool m_showOutsideFlag = false;
+
+            bool m_skipThresholdTesting = true;
+
+            bool m_showMappedThresholdFailuresInGreen = false;
+
+            bool m_hidePositiveValues = false;
+
+            bool m_hideNegativeValues = false;
+
+            bool m_hideZeroValues = false;
+        };
+
+        PaletteColoringCache();
+
+        virtual ~PaletteColoringCache();
+
+        PaletteColoringCache(const PaletteColoringCache&) = delete;
+
+        PaletteColoringCache& operator=(const PaletteColoringCache&) = delete;
+
+        void invalidate();
+
+        // ADD_NEW_METHODS_HERE
+
+        virtual AString toString() const;
+
+    private:
+        /**
+         * Settings that determine the normalized value of a scalar.
+         */
+        class NormalizationSettings {
+        public:
+            NormalizationSettings();
+
+            NormalizationSettings(const FastStatistics* statistics,
+                                  const PaletteColorMapping* paletteColorMapping);
+
+            bool operator==(const NormalizationSettings& rhs) const;
+
+            const FastStatistics* m_statistics = NULL;
+
+            PaletteScaleModeEnum::Enum m_scaleMode = PaletteScaleModeEnum::MODE_AUTO_SCALE;
+
+            std::vector<float> m_scaleValues;
+
+            PaletteInvertModeEnum::Enum m_invertedMode = PaletteInvertModeEnum::OFF;
+
+            bool m_flipPaletteNotDataFlag = false;
+        };
+
+        void updateThresholdIndex(const float* thresholdValues);
+
+        void getThresholdIndexRange(const float thresholdLow,
+                                    const float thresholdHigh,
+                                    int64_t& firstPositionOut,
+                                    int64_t& endPositionOut) const;
+
+        /**
+         * @return Index of the bin containing a threshold value that is not NaN.
+         * @param thresholdValue
+         *    The threshold value.
+         */
+        inline int64_t getThresholdBinIndex(const float thresholdValue) const {
+            if ( ! (thresholdValue > m_thresholdBinMinimum)) {
+                return 0;
+            }
+            if (thresholdValue >= m_thresholdBinMaximum) {
+                return m_numberOfThresholdBins - 1;
+            }
+            const int64_t binIndex = static_cast<int64_t>((thresholdValue - m_thresholdBinMinimum) * m_thresholdBinScale);
+            return ((binIndex < m_numberOfThresholdBins)
+                    ? binIndex
+                    : (m_numberOfThresholdBins - 1));
+        }
+
+        /** True if the cached content matches the output colors */
+        bool m_validFlag = false;
+
+        /** Number of scalars that were colored */
+        int64_t m_numberOfScalars = 0;
+
+        /** Settings used for the normalized values */
+        NormalizationSettings m_normalizationSettings;
+
+        /** Normalized values of the scalars */
+        std::vector<float> m_normalizedValues;
+
+        /** Settings used for the output colors */
+        ColoringSettings m_coloringSettings;
+
+        /** True if the threshold index is valid */
+        bool m_thresholdIndexValidFlag = false;
+
+        /** Indices of scalars sorted into bins by threshold value, NaN thresholds are excluded */
+        std::vector<uint32_t> m_thresholdSortedIndices;
+
+        /** Offset of each bin's first index in m_thresholdSortedIndices, contains one more than the number of bins */
+        std::vector<int64_t> m_thresholdBinOffsets;
+
+        int64_t m_numberOfThresholdBins = 1;
+
+        float m_thresholdBinMinimum = 0.0;
+
+        float m_thresholdBinMaximum = 0.0;
+
+        float m_thresholdBinScale = 0.0;
+
+        // ADD_NEW_MEMBERS_HERE
+
+        friend class NodeAndVoxelColoring;
+    };
+
+#ifdef __PALETTE_COLORING_CACHE_DECLARE__
+    // <PLACE DECLARATIONS OF STATIC MEMBERS HERE>
+#endif // __PALETTE_COLORING_CACHE_DECLARE__
+
+} // namespace
+#endif  //__PALETTE_COLORING_CACHE_H__
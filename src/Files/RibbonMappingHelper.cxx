@@ -48,13 +48,19 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SO
 #include "RibbonMappingHelper.h"
 
 #include "CaretException.h"
+#include "CaretLogger.h"
 #include "FloatMatrix.h"
 #include "MathFunctions.h"
 #include "SurfaceFile.h"
 #include "TopologyHelper.h"
 #include "VolumeSpace.h"
 
+#include <QFile>
+#include <QSaveFile>
+
+#include <algorithm>
 #include <cmath>
+#include <cstring>
 
 using namespace caret;
 using namespace std;
@@ -469,3 +475,183 @@ void RibbonMappingHelper::computeWeightsRibbon(vector<vector<VoxelWeight> >& myW
         }
     }
 }
+
+namespace
+{
+    const char RIBBON_WEIGHTS_MAGIC[8] = { 'W', 'B', 'R', 'I', 'B', 'B', 'O', 'N' };
+    const int32_t RIBBON_WEIGHTS_BYTE_ORDER = 0x01020304;
+    const int RIBBON_APPLY_BLOCK = 16;//frames per pass over the weights, keeps the accumulators in registers
+    
+    struct RibbonWeightsHeader
+    {
+        char m_magic[8];
+        int32_t m_byteOrder;
+        int32_t m_padding1;
+        int64_t m_numNodes;
+        int64_t m_numWeights;
+        int64_t m_dims[3];
+        char m_key[40];//hex sha1 of whatever the caller used to make the weights
+        char m_padding2[32];//make it 128 bytes
+    };
+}
+
+void RibbonWeightMatrix::setFromLists(const vector<vector<VoxelWeight> >& weightLists, const int64_t dims[3])
+{
+    int64_t numNodes = (int64_t)weightLists.size();
+    for (int i = 0; i < 3; ++i) m_dims[i] = dims[i];
+    m_rowStart.resize(numNodes + 1);
+    m_rowStart[0] = 0;
+    for (int64_t node = 0; node < numNodes; ++node)
+    {
+        m_rowStart[node + 1] = m_rowStart[node] + (int64_t)weightLists[node].size();
+    }
+    m_voxels.resize(m_rowStart[numNodes]);
+    m_weights.resize(m_rowStart[numNodes]);
+    m_weightSums.resize(numNodes);
+#pragma omp CARET_PARFOR schedule(dynamic, 256)
+    for (int64_t node = 0; node < numNodes; ++node)
+    {
+        const vector<VoxelWeight>& nodeWeights = weightLists[node];
+        int64_t base = m_rowStart[node];
+        float totalWeight = 0.0f;
+        for (int64_t j = 0; j < (int64_t)nodeWeights.size(); ++j)
+        {
+            const int64_t* ijk = nodeWeights[j].ijk;
+            m_voxels[base + j] = ijk[0] + dims[0] * (ijk[1] + dims[1] * ijk[2]);
+            m_weights[base + j] = nodeWeights[j].weight;
+            totalWeight += nodeWeights[j].weight;//same order as the mapping code used to sum them, so results don't change
+        }
+        m_weightSums[node] = totalWeight;
+    }
+}
+
+void RibbonWeightMatrix::applyToFrames(const float* const* frames, const int& numFrames, float* valuesOut) const
+{
+    const int64_t numNodes = getNumberOfNodes();
+    for (int blockStart = 0; blockStart < numFrames; blockStart += RIBBON_APPLY_BLOCK)
+    {
+        const int blockSize = min(RIBBON_APPLY_BLOCK, numFrames - blockStart);
+        const float* const* blockFrames = frames + blockStart;
+#pragma omp CARET_PARFOR schedule(dynamic, 256)
+        for (int64_t node = 0; node < numNodes; ++node)
+        {
+            float accum[RIBBON_APPLY_BLOCK];
+            for (int f = 0; f < blockSize; ++f) accum[f] = 0.0f;
+            for (int64_t j = m_rowStart[node]; j < m_rowStart[node + 1]; ++j)
+            {
+                const float thisWeight = m_weights[j];
+                const int64_t voxel = m_voxels[j];
+                for (int f = 0; f < blockSize; ++f)
+                {
+                    accum[f] += thisWeight * blockFrames[f][voxel];
+                }
+            }
+            const float totalWeight = m_weightSums[node];
+            for (int f = 0; f < blockSize; ++f)
+            {
+                if (totalWeight != 0.0f)
+                {
+                    valuesOut[(blockStart + f) * numNodes + node] = accum[f] / totalWeight;
+                } else {
+                    valuesOut[(blockStart + f) * numNodes + node] = 0.0f;
+                }
+            }
+        }
+    }
+}
+
+void RibbonWeightMatrix::writeFile(const AString& fileName, const AString& key) const
+{//failing to save the weights isn't an error for the mapping itself
+    QSaveFile myFile(fileName);//don't leave a partial file that looks like valid weights
+    if (!myFile.open(QIODevice::WriteOnly))
+    {
+        CaretLogWarning("failed to open ribbon weights file '" + fileName + "' for writing, weights will be recomputed next time");
+        return;
+    }
+    int64_t numNodes = getNumberOfNodes(), numWeights = (int64_t)m_weights.size();
+    RibbonWeightsHeader myHeader;
+    memset(&myHeader, 0, sizeof(myHeader));
+    memcpy(myHeader.m_magic, RIBBON_WEIGHTS_MAGIC, sizeof(RIBBON_WEIGHTS_MAGIC));
+    myHeader.m_byteOrder = RIBBON_WEIGHTS_BYTE_ORDER;
+    myHeader.m_numNodes = numNodes;
+    myHeader.m_numWeights = numWeights;
+    for (int i = 0; i < 3; ++i) myHeader.m_dims[i] = m_dims[i];
+    QByteArray keyBytes = key.toLatin1();
+    memcpy(myHeader.m_key, keyBytes.constData(), min((int)sizeof(myHeader.m_key), (int)keyBytes.size()));
+    bool ok = myFile.write((const char*)&myHeader, sizeof(myHeader)) == (int64_t)sizeof(myHeader);
+    ok = ok && myFile.write((const char*)m_rowStart.data(), (numNodes + 1) * sizeof(int64_t)) == (int64_t)((numNodes + 1) * sizeof(int64_t));
+    ok = ok && myFile.write((const char*)m_voxels.data(), numWeights * sizeof(int64_t)) == (int64_t)(numWeights * sizeof(int64_t));
+    ok = ok && myFile.write((const char*)m_weights.data(), numWeights * sizeof(float)) == (int64_t)(numWeights * sizeof(float));
+    if (!ok || !myFile.commit())
+    {
+        CaretLogWarning("failed to write ribbon weights file '" + fileName + "', weights will be recomputed next time");
+    }
+}
+
+bool RibbonWeightMatrix::readFile(const AString& fileName, const AString& key, const int64_t expectNodes, const int64_t expectDims[3])
+{
+    QFile myFile(fileName);
+    if (!myFile.exists()) return false;
+    if (!myFile.open(QIODevice::ReadOnly))
+    {
+        CaretLogWarning("failed to open ribbon weights file '" + fileName + "', recomputing weights");
+        return false;
+    }
+    RibbonWeightsHeader myHeader;
+    if (myFile.read((char*)&myHeader, sizeof(myHeader)) != (int64_t)sizeof(myHeader) ||
+        memcmp(myHeader.m_magic, RIBBON_WEIGHTS_MAGIC, sizeof(RIBBON_WEIGHTS_MAGIC)) != 0 || myHeader.m_byteOrder != RIBBON_WEIGHTS_BYTE_ORDER)
+    {
+        CaretLogWarning("'" + fileName + "' is not a ribbon weights file from this machine, recomputing weights");
+        return false;
+    }
+    QByteArray keyBytes = key.toLatin1();
+    keyBytes.resize(sizeof(myHeader.m_key), '\0');
+    if (memcmp(myHeader.m_key, keyBytes.constData(), sizeof(myHeader.m_key)) != 0 || myHeader.m_numNodes != expectNodes ||
+        myHeader.m_dims[0] != expectDims[0] || myHeader.m_dims[1] != expectDims[1] || myHeader.m_dims[2] != expectDims[2])
+    {
+        CaretLogInfo("ribbon weights file '" + fileName + "' was made from different inputs, recomputing weights");
+        return false;
+    }
+    int64_t numNodes = myHeader.m_numNodes, numWeights = myHeader.m_numWeights;
+    if (numWeights < 0 || myFile.size() != (int64_t)sizeof(myHeader) + (numNodes + 1) * (int64_t)sizeof(int64_t) + numWeights * (int64_t)(sizeof(int64_t) + sizeof(float)))
+    {
+        CaretLogWarning("ribbon weights file '" + fileName + "' has the wrong size, recomputing weights");
+        return false;
+    }
+    m_rowStart.resize(numNodes + 1);
+    m_voxels.resize(numWeights);
+    m_weights.resize(numWeights);
+    bool ok = myFile.read((char*)m_rowStart.data(), (numNodes + 1) * sizeof(int64_t)) == (int64_t)((numNodes + 1) * sizeof(int64_t));
+    ok = ok && myFile.read((char*)m_voxels.data(), numWeights * sizeof(int64_t)) == (int64_t)(numWeights * sizeof(int64_t));
+    ok = ok && myFile.read((char*)m_weights.data(), numWeights * sizeof(float)) == (int64_t)(numWeights * sizeof(float));
+    ok = ok && m_rowStart[0] == 0 && m_rowStart[numNodes] == numWeights;
+    for (int64_t node = 0; ok && node < numNodes; ++node)
+    {
+        if (m_rowStart[node + 1] < m_rowStart[node]) ok = false;
+    }
+    const int64_t frameSize = expectDims[0] * expectDims[1] * expectDims[2];
+    for (int64_t j = 0; ok && j < numWeights; ++j)
+    {//don't trust indices we are going to read memory with
+        if (m_voxels[j] < 0 || m_voxels[j] >= frameSize) ok = false;
+    }
+    if (!ok)
+    {
+        CaretLogWarning("ribbon weights file '" + fileName + "' is corrupt, recomputing weights");
+        m_rowStart.clear();
+        m_voxels.clear();
+        m_weights.clear();
+        return false;
+    }
+    for (int i = 0; i < 3; ++i) m_dims[i] = expectDims[i];
+    m_weightSums.resize(numNodes);
+    for (int64_t node = 0; node < numNodes; ++node)
+    {
+        float totalWeight = 0.0f;
+        for (int64_t j = m_rowStart[node]; j < m_rowStart[node + 1]; ++j)
+        {
+            totalWeight += m_weights[j];
+        }
+        m_weightSums[node] = totalWeight;
+    }
+    return true;
+}
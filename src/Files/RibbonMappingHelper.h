@@ -21,6 +21,7 @@
  */
 /*LICENSE_END*/
 
+#include "AString.h"
 #include "Vector3D.h"
 
 #include "stdint.h"
@@ -55,6 +56,29 @@ namespace caret
         PointWeight(const int weightIn, const Vector3D coordIn) { weight = weightIn; coord = coordIn; }
     };
     
+    ///all vertices' voxel weights as one compressed row matrix, with voxels stored as indices into a frame
+    struct RibbonWeightMatrix
+    {
+        int64_t m_dims[3];//spatial dimensions of the volume the voxel indices are for
+        std::vector<int64_t> m_rowStart;//the weights of vertex i are [m_rowStart[i], m_rowStart[i + 1])
+        std::vector<int64_t> m_voxels;
+        std::vector<float> m_weights;
+        std::vector<float> m_weightSums;//not saved, recomputed on read
+        
+        RibbonWeightMatrix() { m_dims[0] = 0; m_dims[1] = 0; m_dims[2] = 0; }
+        int64_t getNumberOfNodes() const { return m_rowStart.empty() ? 0 : (int64_t)m_rowStart.size() - 1; }
+        void setFromLists(const std::vector<std::vector<VoxelWeight> >& weightLists, const int64_t dims[3]);
+        
+        ///weighted average of each vertex's voxels, for several frames at once: valuesOut[frame * numNodes + node], vertices with no weight get 0
+        void applyToFrames(const float* const* frames, const int& numFrames, float* valuesOut) const;
+        
+        ///binary format, only meant to be read back on a machine with the same byte order - key is stored so that stale weights can be detected, failure to write only logs a warning
+        void writeFile(const AString& fileName, const AString& key) const;
+        
+        ///returns false with a warning if the file is missing, damaged, or was made for a different key
+        bool readFile(const AString& fileName, const AString& key, const int64_t expectNodes, const int64_t expectDims[3]);
+    };
+    
     class RibbonMappingHelper
     {
     public:
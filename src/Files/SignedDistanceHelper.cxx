@@ -513,7 +513,7 @@ int SignedDistanceHelper::computeSign(const float coord[3], const ClosestPointIn
                     {
                         int curSign = 0;
                         int numChanged = 0;
-                        const vector<int>& myTiles = m_base->m_topoHelp->getNodeTiles(myInfo.node1);
+                        const CaretSpan<int32_t> myTiles = m_base->m_topoHelp->getNodeTiles(myInfo.node1);
                         bool first = true;
                         float bestNorm = 0;
                         Vector3D tempvec, tempvec2, bestCent;
@@ -627,7 +627,7 @@ int SignedDistanceHelper::computeSign(const float coord[3], const ClosestPointIn
                     {
                         Vector3D result = point - myInfo.tempPoint;
                         const vector<TopologyEdgeInfo>& edgeInfo = m_base->m_topoHelp->getEdgeInfo();
-                        const vector<int>& edges = m_base->m_topoHelp->getNodeEdges(myInfo.node1);
+                        const CaretSpan<int32_t> edges = m_base->m_topoHelp->getNodeEdges(myInfo.node1);
                         int whichEdge = -1, numEdges = (int)edges.size();
                         for (int i = 0; i < numEdges; ++i)
                         {
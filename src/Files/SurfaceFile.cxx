@@ -45,6 +45,7 @@
 #include "Vector3D.h"
 
 #include "CaretPointLocator.h"
+#include "CaretTriangleBVH.h"
 #include "GeodesicHelper.h"
 #include "PlainTextStringBuilder.h"
 #include "SignedDistanceHelper.h"
@@ -674,7 +675,7 @@ std::vector<float> SurfaceFile::computeAverageNormals()
     {
         int i3 = i * 3;
         Vector3D accum;
-        const std::vector<int32_t>& neighbors = myTopoHelp->getNodeNeighbors(i);
+        const CaretSpan<int32_t> neighbors = myTopoHelp->getNodeNeighbors(i);
         int numNeigh = (int)neighbors.size();
         for (int j = 0; j < numNeigh; ++j)
         {
@@ -947,6 +948,11 @@ void SurfaceFile::invalidateHelpers()
         CaretMutexLocker myLock3(&m_locatorMutex);
         m_locator.grabNew(NULL);
     }
+    if (m_triangleBVH != NULL)
+    {
+        CaretMutexLocker myLock5(&m_triangleBVHMutex);
+        m_triangleBVH.grabNew(NULL);
+    }
 }
 
 /**
@@ -1547,6 +1553,20 @@ CaretPointer<const CaretPointLocator> SurfaceFile::getPointLocator() const
     return m_locator;
 }
 
+CaretPointer<const CaretTriangleBVH> SurfaceFile::getTriangleBVH() const
+{
+    if (m_triangleBVH == NULL)
+    {
+        CaretMutexLocker myLock(&m_triangleBVHMutex);
+        if (m_triangleBVH == NULL)
+        {
+            const int32_t numTriangles = getNumberOfTriangles();
+            m_triangleBVH.grabNew(new CaretTriangleBVH(getCoordinateData(), getNumberOfNodes(), (numTriangles > 0 ? getTriangle(0) : NULL), numTriangles));
+        }
+    }
+    return m_triangleBVH;
+}
+
 void SurfaceFile::clearCachedHelpers() const
 {
     {
@@ -1571,6 +1591,10 @@ void SurfaceFile::clearCachedHelpers() const
         CaretMutexLocker locked(&m_locatorMutex);
         m_locator.grabNew(NULL);
     }
+    {
+        CaretMutexLocker locked(&m_triangleBVHMutex);
+        m_triangleBVH.grabNew(NULL);
+    }
 }
 
 /**
@@ -2117,8 +2141,8 @@ bool SurfaceFile::hasNodeCorrespondence(const SurfaceFile& rhs) const
     CaretPointer<TopologyHelper> myHelp = getTopologyHelper(), rightHelp = rhs.getTopologyHelper();
     for (int i = 0; i < numNodes; ++i)
     {
-        const std::vector<int32_t>& myNeigh = myHelp->getNodeNeighbors(i);
-        const std::vector<int32_t>& rightNeigh = rightHelp->getNodeNeighbors(i);
+        const CaretSpan<int32_t> myNeigh = myHelp->getNodeNeighbors(i);
+        const CaretSpan<int32_t> rightNeigh = rightHelp->getNodeNeighbors(i);
         int mySize = (int)myNeigh.size();
         if (mySize != (int)rightNeigh.size()) return false;
         std::set<int32_t> myUsed;
@@ -39,6 +39,7 @@ namespace caret {
 
     class BoundingBox;
     class CaretPointLocator;
+    class CaretTriangleBVH;
     class DescriptiveStatistics;
     class FastStatistics;
     class GeodesicHelper;
@@ -146,6 +147,8 @@ namespace caret {
         
         CaretPointer<const CaretPointLocator> getPointLocator() const;
         
+        CaretPointer<const CaretTriangleBVH> getTriangleBVH() const;
+        
         void clearCachedHelpers() const;
         
         const BoundingBox* getBoundingBox() const;
@@ -344,12 +347,15 @@ namespace caret {
         ///used to search for the closest point in the surface
         mutable CaretPointer<CaretPointLocator> m_locator;
         
+        ///used to intersect rays with the triangles of the surface
+        mutable CaretPointer<CaretTriangleBVH> m_triangleBVH;
+        
         ///used to track when the surface file gets changed
         void invalidateHelpers();
         
         mutable BoundingBox* boundingBox;
         
-        mutable CaretMutex m_topoHelperMutex, m_geoHelperMutex, m_locatorMutex, m_distHelperMutex;
+        mutable CaretMutex m_topoHelperMutex, m_geoHelperMutex, m_locatorMutex, m_distHelperMutex, m_triangleBVHMutex;
     };
 
 } // namespace
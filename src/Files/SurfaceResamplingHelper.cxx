@@ -37,7 +37,6 @@
 #include "Vector3D.h"
 
 #include <algorithm>
-#include <set>
 #include <map>
 
 using namespace std;
@@ -47,6 +46,7 @@ SurfaceResamplingHelper::SurfaceResamplingHelper(const SurfaceResamplingMethodEn
                                                  const float* currentAreas, const float* newAreas, const float* currentRoi, const bool allowNonSphere)
 {
     m_nonsphereAllowed = allowNonSphere;
+    m_numInputNodes = currentSphere->getNumberOfNodes();
     SurfaceFile currentSphereMod, newSphereMod;
     const SurfaceFile* useCurrent = currentSphere, *useNew = newSphere;
     if (!allowNonSphere)
@@ -93,6 +93,55 @@ void SurfaceResamplingHelper::resampleNormal(const float* input, float* output,
     }
 }
 
+void SurfaceResamplingHelper::resampleNormalColumns(const float* const* inputs, float* const* outputs, const int& numColumns, const float& invalidVal) const
+{
+    const int BLOCK_COLUMNS = 16;
+    int numNodes = (int)m_weights.size() - 1;
+    vector<float> interleaved((int64_t)m_numInputNodes * min(BLOCK_COLUMNS, numColumns));//values of all columns in the block for a node are adjacent, so each weight is one contiguous read
+    for (int blockStart = 0; blockStart < numColumns; blockStart += BLOCK_COLUMNS)
+    {
+        const int blockSize = min(BLOCK_COLUMNS, numColumns - blockStart);
+        const float* const* blockInputs = inputs + blockStart;
+        float* const* blockOutputs = outputs + blockStart;
+#pragma omp CARET_PARFOR schedule(static)
+        for (int node = 0; node < m_numInputNodes; ++node)
+        {
+            float* nodeValues = interleaved.data() + (int64_t)node * blockSize;
+            for (int c = 0; c < blockSize; ++c)
+            {
+                nodeValues[c] = blockInputs[c][node];
+            }
+        }
+#pragma omp CARET_PARFOR schedule(dynamic)
+        for (int i = 0; i < numNodes; ++i)
+        {
+            WeightElem* end = m_weights[i + 1], *elem = m_weights[i];
+            if (elem != end)
+            {
+                double accum[BLOCK_COLUMNS];
+                for (int c = 0; c < blockSize; ++c) accum[c] = 0.0;
+                for (; elem != end; ++elem)
+                {
+                    const float* nodeValues = interleaved.data() + (int64_t)elem->node * blockSize;
+                    for (int c = 0; c < blockSize; ++c)
+                    {
+                        accum[c] += nodeValues[c] * elem->weight;//same arithmetic as resampleNormal, so the results are identical
+                    }
+                }
+                for (int c = 0; c < blockSize; ++c)
+                {
+                    blockOutputs[c][i] = accum[c];
+                }
+            } else {
+                for (int c = 0; c < blockSize; ++c)
+                {
+                    blockOutputs[c][i] = invalidVal;
+                }
+            }
+        }
+    }
+}
+
 void SurfaceResamplingHelper::resample3DCoord(const float* input, float* output) const
 {
     int numNodes = (int)m_weights.size() - 1;
@@ -271,7 +320,7 @@ void SurfaceResamplingHelper::resampleCutSurface(const SurfaceFile* cutSurfaceIn
                 break;
             case BarycentricInfo::EDGE:
             {
-                const vector<int32_t>& cutEdges = cutTopoHelp->getNodeEdges(largestNode[i]);
+                const CaretSpan<int32_t> cutEdges = cutTopoHelp->getNodeEdges(largestNode[i]);
                 for (int j = 0; j < (int)cutEdges.size(); ++j)
                 {
                     const TopologyEdgeInfo& myInfo = cutEdgeInfo[cutEdges[j]];
@@ -311,7 +360,7 @@ void SurfaceResamplingHelper::resampleCutSurface(const SurfaceFile* cutSurfaceIn
 #pragma omp CARET_FOR schedule(dynamic)
         for (int32_t i = 0; i < newNodes; ++i)
         {
-            const vector<int32_t>& neighbors = newTopoHelp->getNodeNeighbors(i);
+            const CaretSpan<int32_t> neighbors = newTopoHelp->getNodeNeighbors(i);
             if (isOnEdge[i])
             {
                 bool hasInteriorNeighbor = false;
@@ -333,7 +382,7 @@ void SurfaceResamplingHelper::resampleCutSurface(const SurfaceFile* cutSurfaceIn
                         cutGeoHelp->getPathToNode(largestNode[i], largestNode[neighbors[j]], cutPath, cutPathDists);
                         if (cutPathDists.size() == 0 || cutPathDists.back() > 2.0f * closedPathDists.back())//maybe this cutoff should be tunable
                         {
-                            const vector<int32_t>& myTiles = newTopoHelp->getNodeTiles(i);//find tiles on new mesh that share this edge, remove them
+                            const CaretSpan<int32_t> myTiles = newTopoHelp->getNodeTiles(i);//find tiles on new mesh that share this edge, remove them
                             for (int k = 0; k < (int)myTiles.size(); ++k)
                             {
                                 const int32_t* thisTile = newSphere->getTriangle(myTiles[k]);
@@ -346,7 +395,7 @@ void SurfaceResamplingHelper::resampleCutSurface(const SurfaceFile* cutSurfaceIn
                     }
                 } else {
                     nodeDisconnect[i] = 1;//disconnect it completely if it has no interior neighbors
-                    const vector<int32_t>& nodeTiles = newTopoHelp->getNodeTiles(i);
+                    const CaretSpan<int32_t> nodeTiles = newTopoHelp->getNodeTiles(i);
                     for (int j = 0; j < (int)nodeTiles.size(); ++j)
                     {
                         triRemove[nodeTiles[j]] = 1;
@@ -361,7 +410,7 @@ void SurfaceResamplingHelper::resampleCutSurface(const SurfaceFile* cutSurfaceIn
                     cutGeoHelp->getPathToNode(largestNode[i], largestNode[neighbors[j]], cutPath, cutPathDists);//note: path length of zero means no connection
                     if (cutPathDists.size() == 0 || cutPathDists.back() > 2.0f * closedPathDists.back())//maybe this cutoff should be tunable
                     {
-                        const vector<int32_t>& myTiles = newTopoHelp->getNodeTiles(i);//find tiles on new mesh that share this edge, remove them
+                        const CaretSpan<int32_t> myTiles = newTopoHelp->getNodeTiles(i);//find tiles on new mesh that share this edge, remove them
                         for (int k = 0; k < (int)myTiles.size(); ++k)
                         {
                             const int32_t* thisTile = newSphere->getTriangle(myTiles[k]);
@@ -413,91 +462,133 @@ void SurfaceResamplingHelper::resampleCutSurface(const SurfaceFile* cutSurfaceIn
 void SurfaceResamplingHelper::computeWeightsAdapBaryArea(const SurfaceFile* currentSphere, const SurfaceFile* newSphere,
                                                          const float* currentAreas, const float* newAreas, const float* currentRoi)
 {
-    vector<map<int, float> > forward, reverse, reverse_gather;
-    makeBarycentricWeights(currentSphere, newSphere, forward, NULL);//don't use an roi until after we have done area correction, because area correction MUST ignore ROI
-    makeBarycentricWeights(newSphere, currentSphere, reverse, NULL);
-    int numNewNodes = (int)forward.size(), numOldNodes = currentSphere->getNumberOfNodes();
-    reverse_gather.resize(numNewNodes);
-    for (int oldNode = 0; oldNode < numOldNodes; ++oldNode)//this loop can't be parallelized
-    {
-        for (map<int, float>::iterator iter = reverse[oldNode].begin(); iter != reverse[oldNode].end(); ++iter)//convert scattering weights to gathering weights
+    vector<WeightElem> forward, reverse;
+    vector<int> forwardCount, reverseCount;
+    makeBarycentricWeights(currentSphere, newSphere, forward, forwardCount, NULL);//don't use an roi until after we have done area correction, because area correction MUST ignore ROI
+    makeBarycentricWeights(newSphere, currentSphere, reverse, reverseCount, NULL);
+    int numNewNodes = (int)forwardCount.size(), numOldNodes = currentSphere->getNumberOfNodes();
+    vector<int64_t> gatherStart(numNewNodes + 1, 0);//convert scattering weights to gathering weights with a counting sort
+    for (int oldNode = 0; oldNode < numOldNodes; ++oldNode)
+    {
+        for (int j = 0; j < reverseCount[oldNode]; ++j)
         {
-            reverse_gather[iter->first][oldNode] = iter->second;
+            ++gatherStart[reverse[oldNode * 3 + j].node + 1];
         }
     }
-    vector<map<int, float> > adap_gather(numNewNodes);
-#pragma omp CARET_PARFOR schedule(dynamic)
     for (int newNode = 0; newNode < numNewNodes; ++newNode)
     {
-        set<int> forwardused;//build set of all nodes used by forward weights (really only 3, but this is a bit cleaner and more generic)
-        for (map<int, float>::iterator iter = forward[newNode].begin(); iter != forward[newNode].end(); ++iter)
+        gatherStart[newNode + 1] += gatherStart[newNode];
+    }
+    vector<WeightElem> reverseGather(gatherStart[numNewNodes]);
+    vector<int64_t> fillPos(gatherStart.begin(), gatherStart.end() - 1);
+    for (int oldNode = 0; oldNode < numOldNodes; ++oldNode)//this loop can't be parallelized, but going through old nodes in order leaves each gather list sorted
+    {
+        for (int j = 0; j < reverseCount[oldNode]; ++j)
         {
-            forwardused.insert(iter->first);
+            const WeightElem& scatter = reverse[oldNode * 3 + j];
+            reverseGather[fillPos[scatter.node]++] = WeightElem(oldNode, scatter.weight);
         }
+    }
+    vector<char> useForward(numNewNodes);
+#pragma omp CARET_PARFOR schedule(dynamic, 256)
+    for (int newNode = 0; newNode < numNewNodes; ++newNode)
+    {
+        const WeightElem* forwardRow = forward.data() + newNode * 3;
         bool useforward = true;
-        for (map<int, float>::iterator iter = reverse_gather[newNode].begin(); iter != reverse_gather[newNode].end(); ++iter)
+        for (int64_t j = gatherStart[newNode]; j < gatherStart[newNode + 1]; ++j)
         {
-            if (forwardused.find(iter->first) == forwardused.end())
+            bool found = false;
+            for (int k = 0; k < forwardCount[newNode]; ++k)
+            {
+                if (forwardRow[k].node == reverseGather[j].node)
+                {
+                    found = true;
+                    break;
+                }
+            }
+            if (!found)
             {
                 useforward = false;//if the reverse scatter weights include something the forward gather weights don't, use reverse scatter
                 break;
             }
         }
-        if (useforward)
+        useForward[newNode] = useforward;
+    }
+    vector<int64_t> adapStart(numNewNodes + 1);
+    vector<int> adapCount(numNewNodes);
+    adapStart[0] = 0;
+    for (int newNode = 0; newNode < numNewNodes; ++newNode)
+    {
+        if (useForward[newNode])
         {
-            adap_gather[newNode] = forward[newNode];
+            adapCount[newNode] = forwardCount[newNode];
         } else {
-            adap_gather[newNode] = reverse_gather[newNode];
+            adapCount[newNode] = (int)(gatherStart[newNode + 1] - gatherStart[newNode]);
+        }
+        adapStart[newNode + 1] = adapStart[newNode] + adapCount[newNode];
+    }
+    vector<WeightElem> adapGather(adapStart[numNewNodes]);
+#pragma omp CARET_PARFOR schedule(dynamic, 256)
+    for (int newNode = 0; newNode < numNewNodes; ++newNode)
+    {
+        const WeightElem* source = reverseGather.data() + gatherStart[newNode];
+        if (useForward[newNode])
+        {
+            source = forward.data() + newNode * 3;
         }
-        for (map<int, float>::iterator iter = adap_gather[newNode].begin(); iter != adap_gather[newNode].end(); ++iter)//begin area correction by multiplying by target node area
+        WeightElem* dest = adapGather.data() + adapStart[newNode];
+        for (int j = 0; j < adapCount[newNode]; ++j)
         {
-            iter->second *= newAreas[newNode];//begin the process of area correction by multiplying by gathering node areas
+            dest[j] = source[j];
+            dest[j].weight *= newAreas[newNode];//begin the process of area correction by multiplying by gathering node areas
         }
     }
     vector<float> correctionSum(numOldNodes, 0.0f);
-    for (int newNode = 0; newNode < numNewNodes; ++newNode)//this loop is separate because it can't be parallelized
+    for (int64_t j = 0; j < adapStart[numNewNodes]; ++j)//this loop is separate because it can't be parallelized
     {
-        for (map<int, float>::iterator iter = adap_gather[newNode].begin(); iter != adap_gather[newNode].end(); ++iter)
-        {
-            correctionSum[iter->first] += iter->second;//now, sum the scattering weights to prepare for first normalization
-        }
+        correctionSum[adapGather[j].node] += adapGather[j].weight;//now, sum the scattering weights to prepare for first normalization
     }
-#pragma omp CARET_PARFOR schedule(dynamic)
+#pragma omp CARET_PARFOR schedule(dynamic, 256)
     for (int newNode = 0; newNode < numNewNodes; ++newNode)
     {
         double weightsum = 0.0f;
-        vector<map<int, float>::iterator> toRemove;
-        for (map<int, float>::iterator iter = adap_gather[newNode].begin(); iter != adap_gather[newNode].end(); ++iter)
+        WeightElem* row = adapGather.data() + adapStart[newNode];
+        int numKept = 0;
+        for (int j = 0; j < adapCount[newNode]; ++j)
         {
-            if (currentRoi == NULL || currentRoi[iter->first] > 0.0f)
+            WeightElem thisElem = row[j];
+            if (currentRoi == NULL || currentRoi[thisElem.node] > 0.0f)
             {
-                iter->second *= currentAreas[iter->first] / correctionSum[iter->first];//divide the weights by their scatter sum, then multiply by current areas
-                weightsum += iter->second;//and compute the sum
-            } else {
-                toRemove.push_back(iter);
+                thisElem.weight *= currentAreas[thisElem.node] / correctionSum[thisElem.node];//divide the weights by their scatter sum, then multiply by current areas
+                weightsum += thisElem.weight;//and compute the sum
+                row[numKept] = thisElem;//drop weights outside the roi by shifting the rest down
+                ++numKept;
             }
         }
-        int numToRemove = (int)toRemove.size();
-        for (int i = 0; i < numToRemove; ++i)
-        {
-            adap_gather[newNode].erase(toRemove[i]);
-        }
+        adapCount[newNode] = numKept;
         if (weightsum != 0.0f)//this shouldn't happen unless no nodes remain due to roi, or node areas can be zero
         {
-            for (map<int, float>::iterator iter = adap_gather[newNode].begin(); iter != adap_gather[newNode].end(); ++iter)
+            for (int j = 0; j < numKept; ++j)
             {
-                iter->second /= weightsum;//and normalize to a sum of 1
+                row[j].weight /= weightsum;//and normalize to a sum of 1
             }
         }
     }
-    compactWeights(adap_gather);//and compact them into the internal weight storage
+    setWeights(adapGather, adapStart, adapCount);//and compact them into the internal weight storage
 }
 
 void SurfaceResamplingHelper::computeWeightsBarycentric(const SurfaceFile* currentSphere, const SurfaceFile* newSphere, const float* currentRoi)
 {
-    vector<map<int, float> > forward;
-    makeBarycentricWeights(currentSphere, newSphere, forward, currentRoi);//this should ensure they sum to 1, so we are done
-    compactWeights(forward);
+    vector<WeightElem> forward;
+    vector<int> forwardCount;
+    makeBarycentricWeights(currentSphere, newSphere, forward, forwardCount, currentRoi);//this should ensure they sum to 1, so we are done
+    int numNewNodes = (int)forwardCount.size();
+    vector<int64_t> rowStart(numNewNodes);
+    for (int i = 0; i < numNewNodes; ++i)
+    {
+        rowStart[i] = i * (int64_t)3;
+    }
+    setWeights(forward, rowStart, forwardCount);
 }
 
 bool SurfaceResamplingHelper::checkSphere(const SurfaceFile* surface)
@@ -545,23 +636,23 @@ void SurfaceResamplingHelper::changeRadius(const float& radius, const SurfaceFil
     output->setCoordinates(newCoordData.data());
 }
 
-void SurfaceResamplingHelper::compactWeights(const vector<map<int, float> >& weights)
+void SurfaceResamplingHelper::setWeights(const vector<WeightElem>& weights, const vector<int64_t>& rowStart, const vector<int>& rowCount)
 {
-    int compactsize = 0;
-    int numNodes = (int)weights.size();
+    int64_t compactsize = 0;
+    int numNodes = (int)rowCount.size();
     m_weights = CaretArray<WeightElem*>(numNodes + 1);//include a "one-after" pointer
     for (int i = 0; i < numNodes; ++i)
     {
-        compactsize += (int)weights[i].size();
+        compactsize += rowCount[i];
     }
     m_storagechunk = CaretArray<WeightElem>(compactsize);
-    int curpos = 0;
+    int64_t curpos = 0;
     for (int i = 0; i < numNodes; ++i)
     {
         m_weights[i] = m_storagechunk + curpos;
-        for (map<int, float>::const_iterator iter = weights[i].begin(); iter != weights[i].end(); ++iter)
+        for (int j = 0; j < rowCount[i]; ++j)
         {
-            m_storagechunk[curpos] = WeightElem(iter->first, iter->second);
+            m_storagechunk[curpos] = weights[rowStart[i] + j];
             ++curpos;
         }
     }
@@ -569,10 +660,28 @@ void SurfaceResamplingHelper::compactWeights(const vector<map<int, float> >& wei
     m_weights[numNodes] = m_storagechunk + compactsize;
 }
 
-void SurfaceResamplingHelper::makeBarycentricWeights(const SurfaceFile* from, const SurfaceFile* to, vector<map<int, float> >& weights, const float* currentRoi)
+void SurfaceResamplingHelper::addSortedWeight(WeightElem* row, int& count, const int& node, const float& weight)
+{//keep rows sorted by node, the order the weights are summed in when resampling
+    int pos = 0;
+    while (pos < count && row[pos].node < node) ++pos;
+    if (pos < count && row[pos].node == node)
+    {
+        row[pos].weight = weight;
+        return;
+    }
+    for (int j = count; j > pos; --j)
+    {
+        row[j] = row[j - 1];
+    }
+    row[pos] = WeightElem(node, weight);
+    ++count;
+}
+
+void SurfaceResamplingHelper::makeBarycentricWeights(const SurfaceFile* from, const SurfaceFile* to, vector<WeightElem>& weights, vector<int>& weightCounts, const float* currentRoi)
 {
     int numToNodes = to->getNumberOfNodes();
-    weights.resize(numToNodes);
+    weights.resize(numToNodes * (int64_t)3);
+    weightCounts.assign(numToNodes, 0);
     const float* toCoordData = to->getCoordinateData();
     FastStatistics fromEdgeStatistics, toEdgeStatistics;
     from->getNodesSpacingStatistics(fromEdgeStatistics);
@@ -589,9 +698,9 @@ void SurfaceResamplingHelper::makeBarycentricWeights(const SurfaceFile* from, co
             {
                 BarycentricInfo myInfo;
                 mySignedHelp->barycentricWeights(toCoordData + i * 3, myInfo);
-                if (myInfo.baryWeights[0] != 0.0f) weights[i][myInfo.nodes[0]] = myInfo.baryWeights[0];
-                if (myInfo.baryWeights[1] != 0.0f) weights[i][myInfo.nodes[1]] = myInfo.baryWeights[1];
-                if (myInfo.baryWeights[2] != 0.0f) weights[i][myInfo.nodes[2]] = myInfo.baryWeights[2];
+                if (myInfo.baryWeights[0] != 0.0f) addSortedWeight(weights.data() + i * 3, weightCounts[i], myInfo.nodes[0], myInfo.baryWeights[0]);
+                if (myInfo.baryWeights[1] != 0.0f) addSortedWeight(weights.data() + i * 3, weightCounts[i], myInfo.nodes[1], myInfo.baryWeights[1]);
+                if (myInfo.baryWeights[2] != 0.0f) addSortedWeight(weights.data() + i * 3, weightCounts[i], myInfo.nodes[2], myInfo.baryWeights[2]);
                 if (myInfo.absDistance > warningDistance) doWarn = true; //shouldn't matter if threads collide writing the same value
             }
         }
@@ -607,24 +716,24 @@ void SurfaceResamplingHelper::makeBarycentricWeights(const SurfaceFile* from, co
                 mySignedHelp->barycentricWeights(toCoordData + i * 3, myInfo);
                 if (myInfo.baryWeights[0] != 0.0f && currentRoi[myInfo.nodes[0]] > 0.0f)
                 {
-                    weights[i][myInfo.nodes[0]] = myInfo.baryWeights[0];
+                    addSortedWeight(weights.data() + i * 3, weightCounts[i], myInfo.nodes[0], myInfo.baryWeights[0]);
                     weightsum += myInfo.baryWeights[0];
                 }
                 if (myInfo.baryWeights[1] != 0.0f && currentRoi[myInfo.nodes[1]] > 0.0f)
                 {
-                    weights[i][myInfo.nodes[1]] = myInfo.baryWeights[1];
+                    addSortedWeight(weights.data() + i * 3, weightCounts[i], myInfo.nodes[1], myInfo.baryWeights[1]);
                     weightsum += myInfo.baryWeights[1];
                 }
                 if (myInfo.baryWeights[2] != 0.0f && currentRoi[myInfo.nodes[2]] > 0.0f)
                 {
-                    weights[i][myInfo.nodes[2]] = myInfo.baryWeights[2];
+                    addSortedWeight(weights.data() + i * 3, weightCounts[i], myInfo.nodes[2], myInfo.baryWeights[2]);
                     weightsum += myInfo.baryWeights[2];
                 }
                 if (weightsum != 0.0f)
                 {
-                    for (map<int, float>::iterator iter = weights[i].begin(); iter != weights[i].end(); ++iter)
+                    for (int j = 0; j < weightCounts[i]; ++j)
                     {
-                        iter->second /= weightsum;
+                        weights[i * 3 + j].weight /= weightsum;
                     }
                     if (myInfo.absDistance > warningDistance) doWarn = true;
                 }
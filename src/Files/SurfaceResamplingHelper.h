@@ -24,7 +24,6 @@
 #include "CaretPointer.h"
 #include "SurfaceResamplingMethodEnum.h"
 
-#include <map>
 #include <vector>
 
 namespace caret {
@@ -42,19 +41,25 @@ namespace caret {
         };
         CaretArray<WeightElem> m_storagechunk;
         CaretArray<WeightElem*> m_weights;
+        int m_numInputNodes;
         bool m_nonsphereAllowed;
         static bool checkSphere(const SurfaceFile* surface);
         static void changeRadius(const float& radius, const SurfaceFile* input, SurfaceFile* output);
         void computeWeightsAdapBaryArea(const SurfaceFile* currentSphere, const SurfaceFile* newSphere, const float* currentAreas, const float* newAreas, const float* currentRoi);
         void computeWeightsBarycentric(const SurfaceFile* currentSphere, const SurfaceFile* newSphere, const float* currentRoi);
-        void makeBarycentricWeights(const SurfaceFile* from, const SurfaceFile* to, std::vector<std::map<int, float> >& weights, const float* currentRoi);
-        void compactWeights(const std::vector<std::map<int, float> >& weights);
+        ///weights for target i are weights[i * 3] through weights[i * 3 + weightCounts[i] - 1], sorted by node
+        void makeBarycentricWeights(const SurfaceFile* from, const SurfaceFile* to, std::vector<WeightElem>& weights, std::vector<int>& weightCounts, const float* currentRoi);
+        static void addSortedWeight(WeightElem* row, int& count, const int& node, const float& weight);
+        ///copy rows of weights that may have gaps between them into the compact internal storage
+        void setWeights(const std::vector<WeightElem>& weights, const std::vector<int64_t>& rowStart, const std::vector<int>& rowCount);
     public:
-        SurfaceResamplingHelper() { }
+        SurfaceResamplingHelper() { m_numInputNodes = 0; m_nonsphereAllowed = false; }
         SurfaceResamplingHelper(const SurfaceResamplingMethodEnum::Enum& myMethod, const SurfaceFile* currentSphere, const SurfaceFile* newSphere,
                                 const float* currentAreas = NULL, const float* newAreas = NULL, const float* currentRoi = NULL, const bool allowNonSphere = false);
         ///resample real-valued data by means of weights
         void resampleNormal(const float* input, float* output, const float& invalidVal = 0.0f) const;
+        ///resample many columns of real-valued data, in interleaved blocks so each weight is used for several columns at once
+        void resampleNormalColumns(const float* const* inputs, float* const* outputs, const int& numColumns, const float& invalidVal = 0.0f) const;
         ///resample 3D coordinate data by means of weights
         void resample3DCoord(const float* input, float* output) const;
         ///resample label-like data according to which value gets the largest weight sum
@@ -21,6 +21,8 @@
 #include "SurfaceFile.h"
 #include "TopologyHelper.h"
 #include "CaretAssert.h"
+
+#include <algorithm>
 #include <cmath>
 
 using namespace caret;
@@ -30,78 +32,105 @@ TopologyHelperBase::TopologyHelperBase(const SurfaceFile* surfIn, bool sortFlag)
 {
     m_numNodes = surfIn->getNumberOfNodes();
     m_numTris = surfIn->getNumberOfTriangles();
-    m_nodeInfo.resize(m_numNodes);
-    m_boundaryCount.resize(m_numNodes);
+    m_boundaryCount.resize(m_numNodes, 0);
     m_tileInfo.resize(m_numTris);
-    vector<TopologyEdgeInfo> tempEdgeInfo;
-    tempEdgeInfo.reserve(m_numTris * 3);//worst case, to prevent reallocs, we will copy it over later to the exact right size
-    for (int32_t i = 0; i < m_numNodes; ++i)
-    {//preallocate what should be enough size for most nodes on most surfaces, including freesurfer
-        m_nodeInfo[i].m_edges.reserve(8);
-        m_nodeInfo[i].m_neighbors.reserve(8);
-        m_nodeInfo[i].m_tiles.reserve(8);
-        m_nodeInfo[i].m_whichVertex.reserve(8);
-    }
+    m_tileStart.resize(m_numNodes + 1, 0);//count first, then fill, so all per-node lists are in a few big arrays
     for (int32_t i = 0; i < m_numTris; ++i)
     {
         const int32_t* thisTri = surfIn->getTriangle(i);
-        m_nodeInfo[thisTri[0]].addTileInfo(i, 0);
-        m_nodeInfo[thisTri[1]].addTileInfo(i, 1);
-        m_nodeInfo[thisTri[2]].addTileInfo(i, 2);
-    }//node tiles complete, now we can sweep over nodes instead of triangles, making it easier to build node info
-    m_maxNeigh = -1;
+        ++m_tileStart[thisTri[0] + 1];
+        ++m_tileStart[thisTri[1] + 1];
+        ++m_tileStart[thisTri[2] + 1];
+    }
     m_maxTiles = -1;
-    CaretArray<int32_t> scratch(m_numNodes, -1);//mark array for added neighbors
     for (int32_t i = 0; i < m_numNodes; ++i)
     {
-        vector<int32_t>& tileList = m_nodeInfo[i].m_tiles;
-        vector<int32_t>& vertexList = m_nodeInfo[i].m_whichVertex;
-        int neighTiles = (int)tileList.size();
-        if (neighTiles > m_maxTiles)
+        if (m_tileStart[i + 1] > m_maxTiles) m_maxTiles = (int32_t)m_tileStart[i + 1];
+        m_tileStart[i + 1] += m_tileStart[i];
+    }
+    m_tiles.resize(m_tileStart[m_numNodes]);
+    m_whichVertex.resize(m_tileStart[m_numNodes]);
+    vector<int64_t> fillPos(m_tileStart.begin(), m_tileStart.end() - 1);
+    for (int32_t i = 0; i < m_numTris; ++i)
+    {
+        const int32_t* thisTri = surfIn->getTriangle(i);
+        for (int k = 0; k < 3; ++k)
         {
-            m_maxTiles = neighTiles;
+            int64_t pos = fillPos[thisTri[k]]++;
+            m_tiles[pos] = i;
+            m_whichVertex[pos] = k;
         }
-        for (int j = 0; j < neighTiles; ++j)
+    }//node tiles complete, now we can sweep over nodes instead of triangles, making it easier to build edge info
+    vector<TopologyEdgeInfo> tempEdgeInfo;
+    tempEdgeInfo.reserve(m_numTris * 3);//worst case, to prevent reallocs, we will copy it over later to the exact right size
+    CaretArray<int32_t> scratch(m_numNodes, -1);//mark array for added neighbors
+    vector<int32_t> newNeighbors;
+    for (int32_t i = 0; i < m_numNodes; ++i)
+    {
+        newNeighbors.clear();
+        for (int64_t j = m_tileStart[i]; j < m_tileStart[i + 1]; ++j)
         {
-            int32_t myTile = tileList[j];
+            int32_t myTile = m_tiles[j];
             const int32_t* thisTri = surfIn->getTriangle(myTile);
-            int32_t myVert = vertexList[j];
+            int32_t myVert = m_whichVertex[j];
             switch (myVert)
             {
                 case 0:
-                    if (thisTri[1] > i) processTileNeighbor(tempEdgeInfo, scratch, i, thisTri[1], thisTri[2], myTile, 0, false);//boolean signifies if root, neighbor is same ordering as the cycle of tile nodes
-                    if (thisTri[2] > i) processTileNeighbor(tempEdgeInfo, scratch, i, thisTri[2], thisTri[1], myTile, 2, true);
-                    break;//the if statement is a trick: processTileNeighbor adds neighbor to both nodes, so by checking that root is less, it does every edge/tile pair exactly once
+                    if (thisTri[1] > i) processTileNeighbor(tempEdgeInfo, scratch, newNeighbors, i, thisTri[1], thisTri[2], myTile, 0, false);//boolean signifies if root, neighbor is same ordering as the cycle of tile nodes
+                    if (thisTri[2] > i) processTileNeighbor(tempEdgeInfo, scratch, newNeighbors, i, thisTri[2], thisTri[1], myTile, 2, true);
+                    break;//the if statement is a trick: each edge is only built by its lower numbered node, so this does every edge/tile pair exactly once
                 case 1://this allows edge info building in a linear pass
-                    if (thisTri[2] > i) processTileNeighbor(tempEdgeInfo, scratch, i, thisTri[2], thisTri[0], myTile, 1, false);
-                    if (thisTri[0] > i) processTileNeighbor(tempEdgeInfo, scratch, i, thisTri[0], thisTri[2], myTile, 0, true);
+                    if (thisTri[2] > i) processTileNeighbor(tempEdgeInfo, scratch, newNeighbors, i, thisTri[2], thisTri[0], myTile, 1, false);
+                    if (thisTri[0] > i) processTileNeighbor(tempEdgeInfo, scratch, newNeighbors, i, thisTri[0], thisTri[2], myTile, 0, true);
                     break;
                 case 2:
-                    if (thisTri[0] > i) processTileNeighbor(tempEdgeInfo, scratch, i, thisTri[0], thisTri[1], myTile, 2, false);
-                    if (thisTri[1] > i) processTileNeighbor(tempEdgeInfo, scratch, i, thisTri[1], thisTri[0], myTile, 1, true);
+                    if (thisTri[0] > i) processTileNeighbor(tempEdgeInfo, scratch, newNeighbors, i, thisTri[0], thisTri[1], myTile, 2, false);
+                    if (thisTri[1] > i) processTileNeighbor(tempEdgeInfo, scratch, newNeighbors, i, thisTri[1], thisTri[0], myTile, 1, true);
             }
         }
-        vector<int32_t>& myNeighList = m_nodeInfo[i].m_neighbors;
-        vector<int32_t>& myEdgeList = m_nodeInfo[i].m_edges;
-        int numNeigh = (int)myNeighList.size();
-        if (numNeigh > m_maxNeigh)
+        for (int j = 0; j < (int)newNeighbors.size(); ++j)
         {
-            m_maxNeigh = numNeigh;
+            scratch[newNeighbors[j]] = -1;//NOTE: -1 as sentinel because 0 is a valid edge number
         }
-        m_boundaryCount[i] = 0;
-        for (int j = 0; j < numNeigh; ++j)
+    }//edge and tile info done, all tiles of an edge are found while processing its lower numbered node
+    m_edgeInfo = tempEdgeInfo;//copy edge info into member to get allocation correct
+    int32_t numEdges = (int32_t)m_edgeInfo.size();
+    m_neighborStart.resize(m_numNodes + 1, 0);
+    for (int32_t e = 0; e < numEdges; ++e)
+    {
+        ++m_neighborStart[m_edgeInfo[e].node1 + 1];
+        ++m_neighborStart[m_edgeInfo[e].node2 + 1];
+        if (m_edgeInfo[e].numTiles == 1)
         {
-            if (tempEdgeInfo[myEdgeList[j]].numTiles == 1) ++m_boundaryCount[i];
-            scratch[myNeighList[j]] = -1;//NOTE: -1 as sentinel because 0 is a valid edge number
+            ++m_boundaryCount[m_edgeInfo[e].node1];
+            ++m_boundaryCount[m_edgeInfo[e].node2];
         }
-    }//neighbor, edge and tile info done
-    m_edgeInfo = tempEdgeInfo;//copy edge info into member to get allocation correct
+    }
+    m_maxNeigh = -1;
+    for (int32_t i = 0; i < m_numNodes; ++i)
+    {
+        if (m_neighborStart[i + 1] > m_maxNeigh) m_maxNeigh = (int32_t)m_neighborStart[i + 1];
+        m_neighborStart[i + 1] += m_neighborStart[i];
+    }
+    m_neighbors.resize(m_neighborStart[m_numNodes]);
+    m_edges.resize(m_neighborStart[m_numNodes]);
+    fillPos.assign(m_neighborStart.begin(), m_neighborStart.end() - 1);
+    for (int32_t e = 0; e < numEdges; ++e)//filling in edge order gives each node its neighbors in the order the edges were found
+    {
+        int32_t node1 = m_edgeInfo[e].node1, node2 = m_edgeInfo[e].node2;
+        int64_t pos = fillPos[node1]++;
+        m_neighbors[pos] = node2;
+        m_edges[pos] = e;
+        pos = fillPos[node2]++;
+        m_neighbors[pos] = node1;
+        m_edges[pos] = e;
+    }
     CaretArray<int32_t> scratch2(m_numTris, -1);
     if (sortFlag)
     {
         for (int32_t i = 0; i < m_numNodes; ++i)
         {
-            sortNeighbors(surfIn, i, scratch, scratch2);//not a member function of node info object because I need m_edgeInfo and m_nodeInfo
+            sortNeighbors(surfIn, i, scratch, scratch2);//member function because it needs m_edgeInfo and m_tileInfo
         }
         m_neighborsSorted = true;
     } else {
@@ -111,16 +140,15 @@ TopologyHelperBase::TopologyHelperBase(const SurfaceFile* surfIn, bool sortFlag)
 
 //1) check mark array
 //      a) if marked, find edge, add triangle to edge
-//      b) if unmarked, make edge from triangle, add neighbor, add reverse neighbor
-void TopologyHelperBase::processTileNeighbor(vector<TopologyEdgeInfo>& tempEdgeInfo, CaretArray<int32_t>& scratch, const int32_t& root, const int32_t& neighbor, const int32_t& thirdNode, const int32_t& tile, const int32_t& tileEdge, const bool& reversed)
+//      b) if unmarked, make edge from triangle, record neighbor for clearing the mark array
+void TopologyHelperBase::processTileNeighbor(vector<TopologyEdgeInfo>& tempEdgeInfo, CaretArray<int32_t>& scratch, vector<int32_t>& newNeighbors, const int32_t& root, const int32_t& neighbor, const int32_t& thirdNode, const int32_t& tile, const int32_t& tileEdge, const bool& reversed)
 {
     if (scratch[neighbor] == -1)
     {
         TopologyEdgeInfo tempInfo(root, neighbor, thirdNode, tile, tileEdge, reversed);
         int32_t myEdge = (int32_t)tempEdgeInfo.size();
         tempEdgeInfo.push_back(tempInfo);
-        m_nodeInfo[root].addNeighborInfo(neighbor, myEdge);
-        m_nodeInfo[neighbor].addNeighborInfo(root, myEdge);
+        newNeighbors.push_back(neighbor);
         scratch[neighbor] = myEdge;//use mark array both as "have this neighbor" AND "this is this neighbor's edge"
         m_tileInfo[tile].edges[tileEdge].edge = myEdge;
     } else {
@@ -132,12 +160,15 @@ void TopologyHelperBase::processTileNeighbor(vector<TopologyEdgeInfo>& tempEdgeI
 
 void TopologyHelperBase::sortNeighbors(const SurfaceFile* mySurf, const int32_t& node, CaretArray<int32_t>& nodeScratch, CaretArray<int32_t>& tileScratch)
 {
-    TopologyHelperBase::NodeInfo& myNodeInfo = m_nodeInfo[node];
-    if (myNodeInfo.m_neighbors.size() == 0) return;
-    int firstIndex = 0, numNeigh = (int)myNodeInfo.m_neighbors.size();
+    int firstIndex = 0, numNeigh = (int)(m_neighborStart[node + 1] - m_neighborStart[node]);
+    if (numNeigh == 0) return;
+    int32_t* myNeighbors = m_neighbors.data() + m_neighborStart[node];
+    int32_t* myEdges = m_edges.data() + m_neighborStart[node];
+    int32_t* myTiles = m_tiles.data() + m_tileStart[node];
+    int32_t* myWhichVertex = m_whichVertex.data() + m_tileStart[node];
     for (int i = 0; i < numNeigh; ++i)
     {
-        int32_t thisEdge = myNodeInfo.m_edges[i];
+        int32_t thisEdge = myEdges[i];
         if (m_edgeInfo[thisEdge].numTiles == 1)//there cannot be edge info with zero tiles, we are looking for the edge of a cut
         {
             firstIndex = i;
@@ -149,12 +180,12 @@ void TopologyHelperBase::sortNeighbors(const SurfaceFile* mySurf, const int32_t&
     }
     vector<int32_t> tempNeigh;
     vector<int32_t> tempEdges, tempTiles;//why not sort everything? verts get regenerated in place
-    int numTiles = myNodeInfo.m_tiles.size();
+    int numTiles = (int)(m_tileStart[node + 1] - m_tileStart[node]);
     tempNeigh.reserve(numNeigh);
     tempEdges.reserve(numNeigh);
     tempTiles.reserve(numTiles);
-    int32_t nextNode = myNodeInfo.m_neighbors[firstIndex];
-    int32_t nextEdge = myNodeInfo.m_edges[firstIndex];
+    int32_t nextNode = myNeighbors[firstIndex];
+    int32_t nextEdge = myEdges[firstIndex];
     int32_t nextTile;
     bool foundNext = true;
     int tileToUse = 0;
@@ -206,45 +237,46 @@ void TopologyHelperBase::sortNeighbors(const SurfaceFile* mySurf, const int32_t&
     } while (foundNext);
     for (int i = 0; i < numNeigh; ++i)//clean up scratch array, find any neighbors that are gap-separated or on third+ tile of an edge
     {
-        if (nodeScratch[myNodeInfo.m_neighbors[i]] == 0)
+        if (nodeScratch[myNeighbors[i]] == 0)
         {
-            nodeScratch[myNodeInfo.m_neighbors[i]] = -1;
+            nodeScratch[myNeighbors[i]] = -1;
         } else {
-            tempNeigh.push_back(myNodeInfo.m_neighbors[i]);
-            tempEdges.push_back(myNodeInfo.m_edges[i]);
+            tempNeigh.push_back(myNeighbors[i]);
+            tempEdges.push_back(myEdges[i]);
         }
     }
-    CaretAssert(tempNeigh.size() == myNodeInfo.m_neighbors.size());//check against original size
-    CaretAssert(tempEdges.size() == myNodeInfo.m_edges.size());
-    myNodeInfo.m_neighbors = tempNeigh;//copy over
-    myNodeInfo.m_edges = tempEdges;
+    CaretAssert((int)tempNeigh.size() == numNeigh);//check against original size
+    CaretAssert((int)tempEdges.size() == numNeigh);
+    std::copy(tempNeigh.begin(), tempNeigh.end(), myNeighbors);//copy over
+    std::copy(tempEdges.begin(), tempEdges.end(), myEdges);
     for (int i = 0; i < numTiles; ++i)//and find similar tiles
     {
-        if (tileScratch[myNodeInfo.m_tiles[i]] == 0)
+        if (tileScratch[myTiles[i]] == 0)
         {
-            tileScratch[myNodeInfo.m_tiles[i]] = -1;
+            tileScratch[myTiles[i]] = -1;
         } else {
-            tempTiles.push_back(myNodeInfo.m_tiles[i]);
+            tempTiles.push_back(myTiles[i]);
         }
     }
-    CaretAssert(tempTiles.size() == myNodeInfo.m_tiles.size());
-    myNodeInfo.m_tiles = tempTiles;
+    CaretAssert((int)tempTiles.size() == numTiles);
+    std::copy(tempTiles.begin(), tempTiles.end(), myTiles);
     for (int i = 0; i < numTiles; ++i)//finally, regenerate verts
     {
-        const int32_t* myTri = mySurf->getTriangle(myNodeInfo.m_tiles[i]);
+        const int32_t* myTri = mySurf->getTriangle(myTiles[i]);
         if (myTri[0] == node)
         {
-            myNodeInfo.m_whichVertex[i] = 0;
+            myWhichVertex[i] = 0;
         } else if (myTri[1] == node) {
-            myNodeInfo.m_whichVertex[i] = 1;
+            myWhichVertex[i] = 1;
         } else {
-            myNodeInfo.m_whichVertex[i] = 2;
+            myWhichVertex[i] = 2;
         }
     }
 }
 
-TopologyHelper::TopologyHelper(CaretPointer<TopologyHelperBase> myBase) : m_base(myBase), m_nodeInfo(myBase->m_nodeInfo), m_edgeInfo(myBase->m_edgeInfo),
-                                                                                    m_tileInfo(myBase->m_tileInfo), m_boundaryCount(myBase->m_boundaryCount)
+TopologyHelper::TopologyHelper(CaretPointer<TopologyHelperBase> myBase) : m_base(myBase), m_neighborStart(myBase->m_neighborStart), m_neighbors(myBase->m_neighbors),
+                                                                          m_edges(myBase->m_edges), m_tileStart(myBase->m_tileStart), m_tiles(myBase->m_tiles),
+                                                                          m_edgeInfo(myBase->m_edgeInfo), m_tileInfo(myBase->m_tileInfo), m_boundaryCount(myBase->m_boundaryCount)
 {//pointer is by-value so that it makes a private copy that can't be pointed elsewhere during this constructor
     m_maxNeigh = m_base->m_maxNeigh;
     m_neighborsSorted = m_base->m_neighborsSorted;
@@ -261,50 +293,6 @@ int32_t TopologyHelper::getMaximumNumberOfNeighbors() const
     return m_maxNeigh;
 }
 
-bool TopologyHelper::getNodeHasNeighbors(const int32_t nodeNum) const
-{
-    CaretAssertVectorIndex(m_nodeInfo, nodeNum);
-    return m_nodeInfo[nodeNum].m_neighbors.size() != 0;
-}
-
-const vector<int32_t>& TopologyHelper::getNodeNeighbors(const int32_t nodeNum) const
-{
-    CaretAssertVectorIndex(m_nodeInfo, nodeNum);
-    return m_nodeInfo[nodeNum].m_neighbors;
-}
-
-const int32_t* TopologyHelper::getNodeNeighbors(const int32_t nodeNum, int32_t& numNeighborsOut) const
-{
-    CaretAssertVectorIndex(m_nodeInfo, nodeNum);
-    numNeighborsOut = (int32_t)m_nodeInfo[nodeNum].m_neighbors.size();
-    return m_nodeInfo[nodeNum].m_neighbors.data();
-}
-
-int32_t TopologyHelper::getNodeNumberOfNeighbors(const int32_t nodeNum) const
-{
-    CaretAssertVectorIndex(m_nodeInfo, nodeNum);
-    return m_nodeInfo[nodeNum].m_neighbors.size();
-}
-
-const vector<int32_t>& TopologyHelper::getNodeTiles(const int32_t nodeNum) const
-{
-    CaretAssertVectorIndex(m_nodeInfo, nodeNum);
-    return m_nodeInfo[nodeNum].m_tiles;
-}
-
-const int32_t* TopologyHelper::getNodeTiles(const int32_t nodeNum, int32_t& numTilesOut) const
-{
-    CaretAssertVectorIndex(m_nodeInfo, nodeNum);
-    numTilesOut = (int32_t)m_nodeInfo[nodeNum].m_tiles.size();
-    return m_nodeInfo[nodeNum].m_tiles.data();
-}
-
-const vector<int32_t>& TopologyHelper::getNodeEdges(const int32_t nodeNum) const
-{
-    CaretAssertVectorIndex(m_nodeInfo, nodeNum);
-    return m_nodeInfo[nodeNum].m_edges;
-}
-
 void TopologyHelper::checkArrays() const
 {
     if (m_markNodes.size() != m_numNodes)
@@ -336,11 +324,10 @@ void TopologyHelper::getNodeNeighborsToDepth(const int32_t nodeNum, const int32_
     {
         for (int32_t i = 0; i < curNum; ++i)
         {
-            const vector<int32_t>& nodeNeighbors = m_nodeInfo[(*curlist)[i]].m_neighbors;
-            int numNeigh = (int)nodeNeighbors.size();
-            for (int j = 0; j < numNeigh; ++j)
+            const int32_t curNode = (*curlist)[i];
+            for (int64_t j = m_neighborStart[curNode]; j < m_neighborStart[curNode + 1]; ++j)
             {
-                int32_t thisNode = nodeNeighbors[j];
+                int32_t thisNode = m_neighbors[j];
                 if (m_markNodes[thisNode] == 0)
                 {
                     m_markNodes[thisNode] = 1;
@@ -23,6 +23,7 @@
 
 #include <vector>
 #include "CaretPointer.h"
+#include "CaretSpan.h"
 
 namespace caret {
 
@@ -82,26 +83,14 @@ namespace caret {
         TopologyHelperBase();//prevent default, copy, assign
         TopologyHelperBase(const TopologyHelperBase&);
         TopologyHelperBase& operator=(const TopologyHelperBase&);
-        void processTileNeighbor(std::vector<TopologyEdgeInfo>& tempEdgeInfo, CaretArray<int32_t>& scratch, const int32_t& root, const int32_t& neighbor, const int32_t& thirdNode, const int32_t& tile, const int32_t& tileEdge, const bool& reversed);
+        void processTileNeighbor(std::vector<TopologyEdgeInfo>& tempEdgeInfo, CaretArray<int32_t>& scratch, std::vector<int32_t>& newNeighbors, const int32_t& root, const int32_t& neighbor, const int32_t& thirdNode, const int32_t& tile, const int32_t& tileEdge, const bool& reversed);
         void sortNeighbors(const SurfaceFile* mySurf, const int32_t& node, CaretArray<int32_t>& nodeScratch, CaretArray<int32_t>& tileScratch);
-        struct NodeInfo
-        {
-            std::vector<int32_t> m_neighbors;
-            std::vector<int32_t> m_edges;//index into the topology edges vector, matched with neighbors
-            std::vector<int32_t> m_tiles;
-            std::vector<int32_t> m_whichVertex;//stores which tile vertex this node is, matched to m_tiles
-            void addTileInfo(int32_t tile, int32_t vertexNum)//don't take edge info yet because it is built after neighbor info
-            {
-                m_tiles.push_back(tile);
-                m_whichVertex.push_back(vertexNum);
-            }
-            void addNeighborInfo(int32_t neighbor, int32_t edge)//after we have tile info, we then generate neighbor info with the help of a mark array
-            {
-                m_neighbors.push_back(neighbor);
-                m_edges.push_back(edge);
-            }
-        };
-        std::vector<NodeInfo> m_nodeInfo;
+        std::vector<int64_t> m_neighborStart;//compressed rows: the neighbors and edges of node i are in [m_neighborStart[i], m_neighborStart[i + 1])
+        std::vector<int32_t> m_neighbors;
+        std::vector<int32_t> m_edges;//index into the topology edges vector, matched with neighbors
+        std::vector<int64_t> m_tileStart;//same for tiles
+        std::vector<int32_t> m_tiles;
+        std::vector<int32_t> m_whichVertex;//stores which tile vertex this node is, matched to m_tiles
         std::vector<TopologyEdgeInfo> m_edgeInfo;
         std::vector<TopologyTileInfo> m_tileInfo;
         std::vector<int32_t> m_boundaryCount;
@@ -122,7 +111,11 @@ namespace caret {
         mutable CaretMutex m_usingMarkNodes;
         bool m_neighborsSorted;
         int32_t m_numNodes, m_maxNeigh;
-        const std::vector<TopologyHelperBase::NodeInfo>& m_nodeInfo;//references for convenience instead of using the m_base pointer
+        const std::vector<int64_t>& m_neighborStart;//references for convenience instead of using the m_base pointer
+        const std::vector<int32_t>& m_neighbors;
+        const std::vector<int32_t>& m_edges;
+        const std::vector<int64_t>& m_tileStart;
+        const std::vector<int32_t>& m_tiles;
         const std::vector<TopologyEdgeInfo>& m_edgeInfo;
         const std::vector<TopologyTileInfo>& m_tileInfo;
         const std::vector<int32_t>& m_boundaryCount;
@@ -142,20 +135,34 @@ namespace caret {
         }
 
         /// See if a node has neighbors
-        bool getNodeHasNeighbors(const int32_t nodeNum) const;
+        bool getNodeHasNeighbors(const int32_t nodeNum) const {
+            return getNodeNumberOfNeighbors(nodeNum) != 0;
+        }
 
         /// Get the number of neighbors for a node
-        int32_t getNodeNumberOfNeighbors(const int32_t nodeNum) const;
+        int32_t getNodeNumberOfNeighbors(const int32_t nodeNum) const {
+            CaretAssert(nodeNum >= 0 && nodeNum < m_numNodes);
+            return (int32_t)(m_neighborStart[nodeNum + 1] - m_neighborStart[nodeNum]);
+        }
 
-        /// Get the neighbors of a node
-        const std::vector<int32_t>& getNodeNeighbors(const int32_t nodeNum) const;
+        /// Get the neighbors of a node, points into the helper's storage, so copy it to a vector if it needs to outlive the helper
+        CaretSpan<int32_t> getNodeNeighbors(const int32_t nodeNum) const {
+            CaretAssert(nodeNum >= 0 && nodeNum < m_numNodes);
+            return CaretSpan<int32_t>(m_neighbors.data() + m_neighborStart[nodeNum], m_neighborStart[nodeNum + 1] - m_neighborStart[nodeNum]);
+        }
 
         /// Get the neighboring nodes for a node.  Returns a pointer to an array
         /// containing the neighbors.
-        const int32_t* getNodeNeighbors(const int32_t nodeNum, int32_t& numNeighborsOut) const;
+        const int32_t* getNodeNeighbors(const int32_t nodeNum, int32_t& numNeighborsOut) const {
+            numNeighborsOut = getNodeNumberOfNeighbors(nodeNum);
+            return m_neighbors.data() + m_neighborStart[nodeNum];
+        }
         
-        ///get the edges of a node
-        const std::vector<int32_t>& getNodeEdges(const int32_t nodeNum) const;
+        ///get the edges of a node, matched with the neighbors
+        CaretSpan<int32_t> getNodeEdges(const int32_t nodeNum) const {
+            CaretAssert(nodeNum >= 0 && nodeNum < m_numNodes);
+            return CaretSpan<int32_t>(m_edges.data() + m_neighborStart[nodeNum], m_neighborStart[nodeNum + 1] - m_neighborStart[nodeNum]);
+        }
 
         /// Get the neighbors to a specified depth
         void getNodeNeighborsToDepth(const int32_t nodeNum,
@@ -169,11 +176,18 @@ namespace caret {
         int32_t getMaximumNumberOfNeighbors() const;
 
         /// Get the tiles used by a node
-        const std::vector<int32_t>& getNodeTiles(const int32_t nodeNum) const;
+        CaretSpan<int32_t> getNodeTiles(const int32_t nodeNum) const {
+            CaretAssert(nodeNum >= 0 && nodeNum < m_numNodes);
+            return CaretSpan<int32_t>(m_tiles.data() + m_tileStart[nodeNum], m_tileStart[nodeNum + 1] - m_tileStart[nodeNum]);
+        }
 
         /// Get the tiles for a node.  Returns a pointer to an array
         /// containing the tiles.
-        const int32_t* getNodeTiles(const int32_t nodeNum, int32_t& numTilesOut) const;
+        const int32_t* getNodeTiles(const int32_t nodeNum, int32_t& numTilesOut) const {
+            CaretAssert(nodeNum >= 0 && nodeNum < m_numNodes);
+            numTilesOut = (int32_t)(m_tileStart[nodeNum + 1] - m_tileStart[nodeNum]);
+            return m_tiles.data() + m_tileStart[nodeNum];
+        }
 
         /// get node sorted info validity
         bool isNodeInfoSorted() const {
@@ -956,6 +956,9 @@ VolumeFile::setModified()
     m_fileFastStatistics.grabNew(NULL);
     m_fileHistogram.grabNew(NULL);
     m_fileHistorgramLimitedValues.grabNew(NULL);
+    if (m_voxelColorizer != NULL) {
+        m_voxelColorizer->invalidateColoringCaches();
+    }
 }
 
 /**
@@ -33,10 +33,12 @@
 #include "LabelSelectionItemModel.h"
 #include "NodeAndVoxelColoring.h"
 #include "Palette.h"
+#include "PaletteColoringCache.h"
 #include "TabDrawingInfo.h"
 #include "VolumeFile.h"
 #include "VoxelColorUpdate.h"
 
+#include <algorithm>
 #include <cmath>
 
 using namespace caret;
@@ -76,6 +78,7 @@ m_coloringMode(coloringMode)
         m_mapRGBA.push_back(new uint8_t[m_mapRGBACount]);
         m_mapColoringValid.push_back(false);
     }
+    m_mapColoringCaches.resize(m_mapCount);
 }
 
 /**
@@ -180,7 +183,9 @@ VolumeFileVoxelColorizer::assignVoxelColorsForMap(const int32_t mapIndex) const
     }
     
     const SubvolumeAttributes::VolumeType volumeType(m_volumeFile->getType());
-        
+    
+    PaletteColoringCache* coloringCache(NULL);
+    
     switch (volumeType) {
         case SubvolumeAttributes::UNKNOWN:
         case SubvolumeAttributes::ANATOMY:
@@ -204,6 +209,20 @@ VolumeFileVoxelColorizer::assignVoxelColorsForMap(const int32_t mapIndex) const
                                                                        ? m_volumeFile->getMapPaletteColorMapping(mapIndex)
                                                                        : thresholdVolume->getMapPaletteColorMapping(thresholdVolumeMapIndex));
 
+            /*
+             * The cache allows recoloring of only the voxels whose threshold
+             * test changes when only the threshold range changes.  It requires
+             * that the colors are not altered after coloring (color modulation)
+             * and that thresholding is with the map's own data since changes
+             * to data in another volume are not tracked.
+             */
+            const DataFileColorModulateSelector* modulateSelector(m_volumeFile->getMapColorModulateFileSelector(mapIndex));
+            CaretAssert(modulateSelector);
+            if ((thresholdDataPointer == mapDataPointer)
+                && ( ! modulateSelector->isEnabled())) {
+                coloringCache = getColoringCacheForMap(mapIndex);
+            }
+
             NodeAndVoxelColoring::colorScalarsWithPalette(statistics,
                                                           m_volumeFile->getMapPaletteColorMapping(mapIndex),
                                                           mapDataPointer,
@@ -211,7 +230,8 @@ VolumeFileVoxelColorizer::assignVoxelColorsForMap(const int32_t mapIndex) const
                                                           thresholdDataPointer,
                                                           m_voxelCountPerMap,
                                                           m_mapRGBA[mapIndex],
-                                                          ignoreThresholding);
+                                                          ignoreThresholding,
+                                                          coloringCache);
             m_mapColoringValid[mapIndex] = true;
         }
             break;
@@ -284,6 +304,10 @@ VolumeFileVoxelColorizer::assignVoxelColorsForMap(const int32_t mapIndex) const
             break;
     }
     
+    if (coloringCache == NULL) {
+        releaseColoringCacheForMap(mapIndex);
+    }
+    
     if (m_mapColoringValid[mapIndex]) {
         applyColorModulation(mapIndex,
                              showZerosFlag);
@@ -492,6 +516,74 @@ VolumeFileVoxelColorizer::applyColorModulation(const int32_t mapIndex,
     }
 }
 
+/**
+ * @return The coloring cache for a map, it is created if needed.
+ * Caches of the least recently used maps are released.
+ *
+ * @param mapIndex
+ *    Index of map.
+ */
+PaletteColoringCache*
+VolumeFileVoxelColorizer::getColoringCacheForMap(const int32_t mapIndex) const
+{
+    CaretAssertVectorIndex(m_mapColoringCaches, mapIndex);
+    
+    auto iter = std::find(m_coloringCacheMapIndices.begin(),
+                          m_coloringCacheMapIndices.end(),
+                          mapIndex);
+    if (iter != m_coloringCacheMapIndices.end()) {
+        m_coloringCacheMapIndices.erase(iter);
+    }
+    m_coloringCacheMapIndices.push_back(mapIndex);
+    
+    while (static_cast<int32_t>(m_coloringCacheMapIndices.size()) > MAXIMUM_NUMBER_OF_COLORING_CACHES) {
+        const int32_t oldestMapIndex(m_coloringCacheMapIndices.front());
+        m_coloringCacheMapIndices.pop_front();
+        CaretAssertVectorIndex(m_mapColoringCaches, oldestMapIndex);
+        m_mapColoringCaches[oldestMapIndex].reset();
+    }
+    
+    if ( ! m_mapColoringCaches[mapIndex]) {
+        m_mapColoringCaches[mapIndex].reset(new PaletteColoringCache());
+    }
+    return m_mapColoringCaches[mapIndex].get();
+}
+
+/**
+ * Release the coloring cache for a map.
+ *
+ * @param mapIndex
+ *    Index of map.
+ */
+void
+VolumeFileVoxelColorizer::releaseColoringCacheForMap(const int32_t mapIndex) const
+{
+    CaretAssertVectorIndex(m_mapColoringCaches, mapIndex);
+    if (m_mapColoringCaches[mapIndex]) {
+        m_mapColoringCaches[mapIndex].reset();
+        auto iter = std::find(m_coloringCacheMapIndices.begin(),
+                              m_coloringCacheMapIndices.end(),
+                              mapIndex);
+        if (iter != m_coloringCacheMapIndices.end()) {
+            m_coloringCacheMapIndices.erase(iter);
+        }
+    }
+}
+
+/**
+ * Invalidate the coloring caches of all maps.  Must be called
+ * when voxel data is changed.
+ */
+void
+VolumeFileVoxelColorizer::invalidateColoringCaches()
+{
+    for (auto& coloringCache : m_mapColoringCaches) {
+        if (coloringCache) {
+            coloringCache->invalidate();
+        }
+    }
+}
+
 /**
  * Invalidate the RGBA coloring for all maps.
  */
@@ -1081,6 +1173,11 @@ VolumeFileVoxelColorizer::clearVoxelColoringForMap(const int64_t mapIndex) const
     
     CaretAssertVectorIndex(m_mapColoringValid, mapIndex);
     m_mapColoringValid[mapIndex] = false;
+    
+    CaretAssertVectorIndex(m_mapColoringCaches, mapIndex);
+    if (m_mapColoringCaches[mapIndex]) {
+        m_mapColoringCaches[mapIndex]->invalidate();
+    }
 }
 
 /**
@@ -1095,6 +1192,11 @@ VolumeFileVoxelColorizer::updateVoxelColorsInMap(const VoxelColorUpdate& voxelCo
     const int32_t mapIndex(voxelColorUpdate.getMapIndex());
     CaretAssertVectorIndex(m_mapColoringValid, mapIndex);
     
+    CaretAssertVectorIndex(m_mapColoringCaches, mapIndex);
+    if (m_mapColoringCaches[mapIndex]) {
+        m_mapColoringCaches[mapIndex]->invalidate();
+    }
+    
     if (m_mapColoringValid[mapIndex]) {
         CaretAssertVectorIndex(m_mapRGBA, mapIndex);
         uint8_t* mapRGBA = m_mapRGBA[mapIndex];
@@ -22,12 +22,17 @@
 /*LICENSE_END*/
 
 
+#include <deque>
+#include <memory>
+#include <vector>
+
 #include "CaretObject.h"
 #include "VolumeSliceViewPlaneEnum.h"
 #include "VoxelIJK.h"
 
 namespace caret {
 
+    class PaletteColoringCache;
     class TabDrawingInfo;
     class VolumeFile;
     class VoxelColorUpdate;
@@ -90,6 +95,8 @@ namespace caret {
         
         void invalidateColoring();
         
+        void invalidateColoringCaches();
+        
     private:
         VolumeFileVoxelColorizer(const VolumeFileVoxelColorizer&);
 
@@ -130,6 +137,10 @@ namespace caret {
         void applyColorModulation(const int32_t mapIndex,
                                   const bool showZerosFlag) const;
         
+        PaletteColoringCache* getColoringCacheForMap(const int32_t mapIndex) const;
+        
+        void releaseColoringCacheForMap(const int32_t mapIndex) const;
+        
         // ADD_NEW_MEMBERS_HERE
 
         VolumeFile* m_volumeFile;
@@ -145,6 +156,15 @@ namespace caret {
         
         mutable std::vector<bool> m_mapColoringValid;
         mutable std::vector<uint8_t*> m_mapRGBA;
+        
+        /** Content retained between colorings of palette mapped maps, NULL for maps without a cache */
+        mutable std::vector<std::unique_ptr<PaletteColoringCache>> m_mapColoringCaches;
+        
+        /** Indices of maps with a coloring cache, most recently used at the back */
+        mutable std::deque<int32_t> m_coloringCacheMapIndices;
+        
+        /** Coloring caches use more memory than the map's colors so only a few are kept */
+        static const int32_t MAXIMUM_NUMBER_OF_COLORING_CACHES = 4;
     };
     
 #ifdef __VOLUME_FILE_VOXEL_COLORIZER_DECLARE__
@@ -577,9 +577,17 @@ GiftiDataArray::transferLabelIndices(const std::map<int32_t,int32_t>& indexConve
 /**
  * read a GIFTI data array from text.
  * Data array should already be initialized and allocated.
+ * Only modifies this data array so different data arrays
+ * may be read at the same time from different threads.
+ *
+ * @param text
+ *    Content of the Data element (not necessarily NULL terminated).
+ * @param textLength
+ *    Number of characters in text.
  */
 void 
-GiftiDataArray::readFromText(const AString text,
+GiftiDataArray::readFromText(const char* text,
+                             const int64_t textLength,
                              const GiftiEndianEnum::Enum dataEndianForReading,
                              const GiftiArrayIndexingOrderEnum::Enum arraySubscriptingOrderForReading,
                              const NiftiDataTypeEnum::Enum dataTypeForReading,
@@ -613,7 +621,7 @@ GiftiDataArray::readFromText(const AString text,
       switch (encoding) {
           case GiftiEncodingEnum::ASCII:
             {
-                std::istringstream stream(text.toStdString());
+                std::istringstream stream(std::string(text, textLength));
                 
                switch (dataType) {
                   case NiftiDataTypeEnum::NIFTI_TYPE_FLOAT32:
@@ -659,10 +667,10 @@ GiftiDataArray::readFromText(const AString text,
                // Decode the Base64 data using VTK's algorithm
                //
                const uint64_t numDecoded =
-                     Base64::decode((const unsigned char*)(text.toStdString().c_str()),
+                     Base64::decode((const unsigned char*)text,
                                                 data.size(),
                                                 &data[0],
-                                                text.size());
+                                                textLength);
                if (numDecoded != data.size()) {
                   std::ostringstream str;
                   str << "Decoding of Base64 Binary data failed.\n"
@@ -684,13 +692,12 @@ GiftiDataArray::readFromText(const AString text,
                //
                // Decode the Base64 data using VTK's algorithm
                //
-               std::vector<unsigned char> dataBuffer(text.size() - text.size() / 4 + 10);//generous constant to make up for integer rounding
-               //const char* textChars = text.toLatin1().constData();
+               std::vector<unsigned char> dataBuffer(textLength - textLength / 4 + 10);//generous constant to make up for integer rounding
                const uint64_t numDecoded =
-                     Base64::decode((unsigned char*)text.toStdString().c_str(),
+                     Base64::decode((const unsigned char*)text,
                                                 dataBuffer.size(),
                                                 dataBuffer.data(),
-                                                text.size());
+                                                textLength);
                if (numDecoded == 0) {
                    std::ostringstream str;
                    str << "Decoding of GZip Base64 Binary data failed."
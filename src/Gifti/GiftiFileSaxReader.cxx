@@ -18,9 +18,14 @@
  */
 /*LICENSE_END*/
 
+#include <new>
 #include <sstream>
 
+#include <QCoreApplication>
+#include <QThread>
+
 #include "CaretLogger.h"
+#include "CaretOMP.h"
 #include "FileInformation.h"
 #include "GiftiEndianEnum.h"
 #include "GiftiLabel.h"
@@ -36,6 +41,12 @@
 
 using namespace caret;
 
+/**
+ * Data arrays are decoded, in parallel, once the text of their Data elements
+ * exceeds this number of characters or when the end of the document is reached.
+ */
+static const int64_t MAXIMUM_ARRAY_DATA_TO_DECODE_TEXT_LENGTH = 256 * 1024 * 1024;
+
 /**
  * constructor.
  */
@@ -50,6 +61,7 @@ GiftiFileSaxReader::GiftiFileSaxReader(GiftiFile* giftiFileIn)
     this->labelTableSaxReader = NULL;
     this->metaDataSaxReader = NULL;
     this->dataArrayDataHasBeenRead = false;
+    this->arrayDataToDecodeTextLength = 0;
 }
 
 /**
@@ -214,6 +226,7 @@ GiftiFileSaxReader::startElement(const AString& namespaceURI,
    stateStack.push(previousState);
    
    elementText = "";
+   dataArrayText.clear();
 }
 
 /**
@@ -515,8 +528,34 @@ GiftiFileSaxReader::processArrayData()
     this->dataArrayDataHasBeenRead = true;
 
     CaretAssert(dataArray);
+    
+    /*
+     * Decoding of array data in the file is deferred so that
+     * the data arrays are decoded in parallel.
+     */
+    if ((encodingForReadingArrayData != GiftiEncodingEnum::EXTERNAL_FILE_BINARY)
+        && ( ! this->giftiFile->getReadMetaDataOnlyFlag())) {
+        ArrayDataToDecode arrayData;
+        arrayData.dataArray              = dataArray.getPointer();
+        arrayData.text                   = std::move(dataArrayText);
+        arrayData.endian                 = endianForReadingArrayData;
+        arrayData.arraySubscriptingOrder = arraySubscriptingOrderForReadingArrayData;
+        arrayData.dataType               = dataTypeForReadingArrayData;
+        arrayData.dimensions             = dimensionsForReadingArrayData;
+        arrayData.encoding               = encodingForReadingArrayData;
+        arrayDataToDecodeTextLength += arrayData.text.size();
+        arrayDataToDecode.push_back(std::move(arrayData));
+        dataArrayText.clear();
+        
+        if (arrayDataToDecodeTextLength > MAXIMUM_ARRAY_DATA_TO_DECODE_TEXT_LENGTH) {
+            decodeArrayData();
+        }
+        return;
+    }
+    
     try {
-        dataArray->readFromText(elementText,
+        dataArray->readFromText(dataArrayText.data(),
+                                dataArrayText.size(),
                                 this->endianForReadingArrayData,
                                 arraySubscriptingOrderForReadingArrayData,
                                 dataTypeForReadingArrayData,
@@ -531,6 +570,87 @@ GiftiFileSaxReader::processArrayData()
     }
 }
 
+/**
+ * Decode the data of the data arrays waiting for decoding.  Each
+ * data array is independent so they are decoded in parallel.
+ * The data arrays are owned by the GIFTI file, or in the case
+ * of the last data array, by this reader.
+ */
+void
+GiftiFileSaxReader::decodeArrayData()
+{
+    const int64_t numArrays = static_cast<int64_t>(arrayDataToDecode.size());
+    
+    /*
+     * Report the error of the first data array that fails,
+     * as if the data arrays were decoded sequentially
+     */
+    int64_t errorArrayIndex = numArrays;
+    AString errorMessage;
+    bool badAllocFlag = false;
+    
+#ifdef CARET_OMP
+    /*
+     * When a spec file or scene is loaded, several files are read at once
+     * by reader threads, so only decode in parallel on the main thread to
+     * avoid creating a full team of OpenMP threads for each reader thread.
+     */
+    int numThreads = 1;
+    const QCoreApplication* app = QCoreApplication::instance();
+    if ((app == NULL)
+        || (QThread::currentThread() == app->thread())) {
+        numThreads = omp_get_max_threads();
+    }
+#endif
+    
+#pragma omp CARET_PARFOR schedule(dynamic) num_threads(numThreads)
+    for (int64_t i = 0; i < numArrays; i++) {
+        ArrayDataToDecode& arrayData = arrayDataToDecode[i];
+        try {
+            arrayData.dataArray->readFromText(arrayData.text.data(),
+                                              arrayData.text.size(),
+                                              arrayData.endian,
+                                              arrayData.arraySubscriptingOrder,
+                                              arrayData.dataType,
+                                              arrayData.dimensions,
+                                              arrayData.encoding,
+                                              "",
+                                              0,
+                                              false);
+        }
+        catch (const GiftiException& e) {
+#pragma omp critical
+            {
+                if (i < errorArrayIndex) {
+                    errorArrayIndex = i;
+                    errorMessage = e.whatString();
+                }
+            }
+        }
+        catch (const std::bad_alloc&) {
+#pragma omp critical
+            {
+                badAllocFlag = true;
+            }
+        }
+        
+        /*
+         * Release the text as soon as it is no longer needed
+         */
+        std::string().swap(arrayData.text);
+    }
+    
+    arrayDataToDecode.clear();
+    arrayDataToDecodeTextLength = 0;
+    
+    if (badAllocFlag) {
+        throw std::bad_alloc();
+    }
+    if (errorArrayIndex < numArrays) {
+        throw XmlSaxParserException(errorMessage);
+    }
+}
+
 /**
  * get characters in an element.
  */
@@ -543,6 +663,9 @@ GiftiFileSaxReader::characters(const char* ch)
     else if (this->labelTableSaxReader != NULL) {
         this->labelTableSaxReader->characters(ch);
     }
+    else if (this->state == STATE_DATA_ARRAY_DATA) {
+        dataArrayText.append(ch);
+    }
     else {
         elementText += ch;
     }
@@ -594,5 +717,6 @@ GiftiFileSaxReader::startDocument()
 void 
 GiftiFileSaxReader::endDocument()
 {
+    decodeArrayData();
 }
 
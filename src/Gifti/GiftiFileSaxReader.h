@@ -23,6 +23,8 @@
 /*LICENSE_END*/
 
 #include <stack>
+#include <string>
+#include <vector>
 #include <AString.h>
 #include <stdint.h>
 
@@ -100,9 +102,23 @@ namespace caret {
             STATE_DATA_ARRAY_MATRIX_DATA
         };
         
+        /// Data element of a data array that is decoded after the XML is parsed
+        struct ArrayDataToDecode {
+            GiftiDataArray* dataArray;
+            std::string text;
+            GiftiEndianEnum::Enum endian;
+            GiftiArrayIndexingOrderEnum::Enum arraySubscriptingOrder;
+            NiftiDataTypeEnum::Enum dataType;
+            std::vector<int64_t> dimensions;
+            GiftiEncodingEnum::Enum encoding;
+        };
+        
         // process the array data into numbers
         void processArrayData();
         
+        // decode the data of data arrays waiting for decoding
+        void decodeArrayData();
+        
         // create a data array
         void createDataArray(const XmlAttributes& attributes);
         
@@ -121,6 +137,15 @@ namespace caret {
         /// element text
         AString elementText;
         
+        /// text of a data array's Data element, kept as bytes since it may be very large
+        std::string dataArrayText;
+        
+        /// data arrays whose Data element has been read but not decoded
+        std::vector<ArrayDataToDecode> arrayDataToDecode;
+        
+        /// number of characters in arrayDataToDecode
+        int64_t arrayDataToDecodeTextLength;
+        
         /// GIFTI data array being read
         CaretPointer<GiftiDataArray> dataArray;
         
@@ -174,6 +174,17 @@ GraphicsObjectToWindowTransform::inverseTransformPoint(const float windowXYZ[3],
     
     m_inverseTransformMatrix->multiplyPoint4(xyzw);
     
+    /*
+     * W is one for an orthographic projection but
+     * not for a perspective projection
+     */
+    if ((xyzw[3] != 0.0f)
+        && (xyzw[3] != 1.0f)) {
+        xyzw[0] /= xyzw[3];
+        xyzw[1] /= xyzw[3];
+        xyzw[2] /= xyzw[3];
+    }
+    
     objectXYZOut[0] = xyzw[0];
     objectXYZOut[1] = xyzw[1];
     objectXYZOut[2] = xyzw[2];
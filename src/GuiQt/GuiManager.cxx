@@ -64,6 +64,7 @@
 #include "CursorDisplayScoped.h"
 #include "CursorManager.h"
 #include "CustomViewDialog.h"
+#include "CziImageTileLoader.h"
 #include "DataFileException.h"
 #include "DataToolTipsManager.h"
 #include "ElapsedTimer.h"
@@ -360,6 +361,14 @@ GuiManager::initializeGuiManager()
     
     QObject::connect(WuQHyperlinkToolTip::instance(), &WuQHyperlinkToolTip::hyperlinkClicked,
                      this, &GuiManager::toolTipHyperlinkClicked);
+    
+    /*
+     * CZI image tiles are loaded in background threads and
+     * graphics are updated as the tiles are loaded
+     */
+    QObject::connect(CziImageTileLoader::getNotifier(), &CziImageTileLoaderNotifier::tilesLoaded,
+                     this, &GuiManager::cziImageTilesLoaded);
+    CziImageTileLoader::setAsynchronousLoadingEnabled(true);
 }
 
 /**
@@ -4211,3 +4220,12 @@ GuiManager::toolTipHyperlinkClicked(const QString& hyperlink)
     }
 }
 
+/**
+ * Called when CZI image tiles have been loaded in background threads
+ */
+void
+GuiManager::cziImageTilesLoaded()
+{
+    EventManager::get()->sendEvent(EventGraphicsPaintSoonAllWindows().getPointer());
+}
+
@@ -244,6 +244,7 @@ namespace caret {
         void identifyBrainordinateDialogWasClosed();
         void dataToolTipsActionTriggered(bool);
         void toolTipHyperlinkClicked(const QString& hyperlink);
+        void cziImageTilesLoaded();
         
     private:
         GuiManager(QObject* parent = 0);
@@ -32,6 +32,7 @@
 #include <QComboBox>
 #include <QGridLayout>
 #include <QLabel>
+#include <QSpinBox>
 
 #include "BrainOpenGLMediaDrawing.h"
 #include "CaretAssert.h"
@@ -93,6 +94,27 @@ PreferencesImageWidget::PreferencesImageWidget(QWidget* parent)
 //    PreferencesDialog::addWidgetToLayout(gridLayout, cziDimNote, NULL);
     gridLayout->addWidget(cziDimNoteLabel, gridLayout->rowCount(), 0, 1, 2);
     
+    /*
+     * Tile cache size
+     */
+    const AString tileCacheToolTip("Maximum size (in megabytes) of the image tiles kept in memory "
+                                   "for each CZI and OME-ZARR file.  Tiles are shared by all tabs "
+                                   "and overlays displaying the file.  Changes do not take effect "
+                                   "until the file is reloaded.");
+    m_mediaTileCacheSizeSpinBox = new QSpinBox();
+    m_mediaTileCacheSizeSpinBox->setRange(64, 65536);
+    m_mediaTileCacheSizeSpinBox->setSingleStep(128);
+    m_mediaTileCacheSizeSpinBox->setSuffix(" MB");
+    QObject::connect(m_mediaTileCacheSizeSpinBox, QOverload<int>::of(&QSpinBox::valueChanged),
+                     this, &PreferencesImageWidget::mediaTileCacheSizeSpinBoxValueChanged);
+    QLabel* tileCacheLabel = PreferencesDialog::addWidgetToLayout(gridLayout,
+                                                                  "CZI/OME-ZARR Tile Memory",
+                                                                  m_mediaTileCacheSizeSpinBox);
+    WuQtUtilities::setWordWrappedToolTip(tileCacheLabel,
+                                         tileCacheToolTip);
+    WuQtUtilities::setWordWrappedToolTip(m_mediaTileCacheSizeSpinBox,
+                                         tileCacheToolTip);
+    
     /*
      * Texture compression
      */
@@ -194,6 +216,9 @@ PreferencesImageWidget::updateContent(CaretPreferences* caretPreferences)
         CaretLogSevere("Unable to find CZI Dimension when updating Preferences Dialog.");
     }
 
+    QSignalBlocker tileCacheSizeBlocker(m_mediaTileCacheSizeSpinBox);
+    m_mediaTileCacheSizeSpinBox->setValue(m_preferences->getMediaTileCacheSizeMegabytes());
+    
     m_imageFileTextureCompressionComboBox->setStatus(m_preferences->isImageFileTextureCompressionEnabled());
     
     const GraphicsTextureMinificationFilterEnum::Enum minFilter  = BrainOpenGLMediaDrawing::getTextureMinificationFilter();
@@ -219,6 +244,18 @@ PreferencesImageWidget::cziDimensionChanged(int index)
     WuQMessageBox::informationOk(this, "CZI files must be reloaded or wb_view restarted after changing this value.");
 }
 
+/**
+ * Called when tile cache size is changed
+ * @param value
+ *    New size in megabytes
+ */
+void
+PreferencesImageWidget::mediaTileCacheSizeSpinBoxValueChanged(int value)
+{
+    CaretAssert(m_preferences);
+    m_preferences->setMediaTileCacheSizeMegabytes(value);
+}
+
 /**
  * Called when graphics magnification filter changed
  */
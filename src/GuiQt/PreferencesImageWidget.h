@@ -27,6 +27,7 @@
 #include <memory>
 
 class QComboBox;
+class QSpinBox;
 
 namespace caret {
     class CaretPreferences;
@@ -57,6 +58,8 @@ namespace caret {
     private slots:
         void cziDimensionChanged(int index);
         
+        void mediaTileCacheSizeSpinBoxValueChanged(int value);
+        
         void textureCompressionStatusChanged(bool status);
         
         void graphicsTextureMagnificationFilterEnumComboBoxItemActivated();
@@ -71,6 +74,8 @@ namespace caret {
         
         QComboBox* m_cziDimensionComboBox;
         
+        QSpinBox* m_mediaTileCacheSizeSpinBox = NULL;
+        
         WuQTrueFalseComboBox* m_imageFileTextureCompressionComboBox = NULL;
         
         EnumComboBoxTemplate* m_graphicsTextureMagnificationFilterEnumComboBox = NULL;
@@ -74,6 +74,20 @@ int NiftiIO::getNumComponents() const
     return m_header.getNumComponents();
 }
 
+const char* NiftiIO::getMappedData()
+{
+    const char* base = m_file.mapReadOnly();
+    if (base == NULL) return NULL;
+    return base + m_header.getDataOffset();
+}
+
+bool NiftiIO::isDataNativeFloat32() const
+{
+    if (m_header.getDataType() != NIFTI_TYPE_FLOAT32 || m_header.isSwapped()) return false;
+    double mult, offset;
+    return !m_header.getDataScaling(mult, offset);
+}
+
 int NiftiIO::numBytesPerElem()
 {
     switch (m_header.getDataType())
@@ -43,10 +43,12 @@ namespace caret
         NiftiHeader m_header;
         std::vector<int64_t> m_dims;
         std::vector<char> m_scratch;//scratch memory for byteswapping, type conversion, etc
-        CaretMutex m_mutex;//protect multithreaded calls from each other
+        CaretMutex m_mutex;//protect multithreaded calls from each other, when the file can't do positional reads
         int numBytesPerElem();//for resizing scratch
         template<typename TO, typename FROM>
         void convertRead(TO* out, FROM* in, const int64_t& count);//for reading from file
+        template<typename T>
+        void convertReadBuffer(T* dataOut, char* scratch, const int64_t& numElems);//dispatch on file datatype, scratch gets modified by byteswapping
         template<typename TO, typename FROM>
         void convertWrite(TO* out, const FROM* in, const int64_t& count);//for writing to file
         template<typename TO, typename FROM>
@@ -61,10 +63,16 @@ namespace caret
         void dropExtensions() { m_header.m_extensions.clear(); }
         const std::vector<int64_t>& getDimensions() const { return m_dims; }
         int getNumComponents() const;
+        const char* getMappedData();//start of the voxel data in a read-only memory map of the file, NULL if the file can't be mapped
+        int64_t getFileSize() { return m_file.size(); }//may return -1 if size cannot be determined efficiently
+        bool isDataNativeFloat32() const;//true if the data on disk needs no conversion to be used as float
         //to read/write 1 frame of a standard volume file, call with fullDims = 3, indexSelect containing indexes for any of dims 4-7 that exist
         //NOTE: you need to provide storage for all components within the range, if getNumComponents() == 3 and fullDims == 0, you need 3 elements allocated
         template<typename T>
         void readData(T* dataOut, const int& fullDims, const std::vector<int64_t>& indexSelect, const bool& tolerateShortRead = false);
+        //read a contiguous range of elements from the data, in file order (components count as separate elements), for access patterns that don't match whole frames
+        template<typename T>
+        void readElements(T* dataOut, const int64_t& startElem, const int64_t& numElems, const bool& tolerateShortRead = false);
         template<typename T>
         void writeData(const T* dataIn, const int& fullDims, const std::vector<int64_t>& indexSelect);
     };
@@ -87,55 +95,82 @@ namespace caret
             numSkip += indexSelect[curDim - fullDims] * numDimSkip;
             numDimSkip *= m_dims[curDim];
         }
+        readElements(dataOut, numSkip, numElems, tolerateShortRead);
+    }
+    
+    template<typename T>
+    void NiftiIO::readElements(T* dataOut, const int64_t& startElem, const int64_t& numElems, const bool& tolerateShortRead)
+    {
+        CaretAssert(startElem >= 0 && numElems >= 0);
+        const int64_t readSize = numElems * numBytesPerElem();
+        const int64_t readPos = startElem * numBytesPerElem() + m_header.getDataOffset();
+        if (m_file.supportsConcurrentRead())
+        {//positional reads share no file state, so use per-call scratch and skip the mutex, letting threads read rows in parallel
+            std::vector<char> scratch(readSize);
+            int64_t numRead = 0;
+            m_file.readAt(readPos, scratch.data(), readSize, &numRead);
+            if ((numRead != readSize && !tolerateShortRead) || numRead < 0)
+            {
+                throw DataFileException("error while reading from nifti file '" + m_file.getFilename() + "'");
+            }
+            convertReadBuffer(dataOut, scratch.data(), numElems);
+            return;
+        }
         CaretMutexLocker locked(&m_mutex);//protect starting with resizing until we are done converting, because we use an internal variable for scratch space
         //we can't guarantee that the output memory is enough to use as scratch space, as we might be doing a narrowing conversion
         //we are doing FILE ACCESS, so cpu performance isn't really something to worry about
-        m_scratch.resize(numElems * numBytesPerElem());
-        m_file.seek(numSkip * numBytesPerElem() + m_header.getDataOffset());
+        m_scratch.resize(readSize);
+        m_file.seek(readPos);
         int64_t numRead = 0;
         m_file.read(m_scratch.data(), m_scratch.size(), &numRead);
         if ((numRead != (int64_t)m_scratch.size() && !tolerateShortRead) || numRead < 0)//for now, assume read giving -1 is always a problem
         {
             throw DataFileException("error while reading from nifti file '" + m_file.getFilename() + "'");
         }
+        convertReadBuffer(dataOut, m_scratch.data(), numElems);
+    }
+    
+    template<typename T>
+    void NiftiIO::convertReadBuffer(T* dataOut, char* scratch, const int64_t& numElems)
+    {
         switch (m_header.getDataType())
         {
             case NIFTI_TYPE_UINT8:
             case NIFTI_TYPE_RGB24://handled by components
-                convertRead(dataOut, (uint8_t*)m_scratch.data(), numElems);
+                convertRead(dataOut, (uint8_t*)scratch, numElems);
                 break;
             case NIFTI_TYPE_INT8:
-                convertRead(dataOut, (int8_t*)m_scratch.data(), numElems);
+                convertRead(dataOut, (int8_t*)scratch, numElems);
                 break;
             case NIFTI_TYPE_UINT16:
-                convertRead(dataOut, (uint16_t*)m_scratch.data(), numElems);
+                convertRead(dataOut, (uint16_t*)scratch, numElems);
                 break;
             case NIFTI_TYPE_INT16:
-                convertRead(dataOut, (int16_t*)m_scratch.data(), numElems);
+                convertRead(dataOut, (int16_t*)scratch, numElems);
                 break;
             case NIFTI_TYPE_UINT32:
-                convertRead(dataOut, (uint32_t*)m_scratch.data(), numElems);
+                convertRead(dataOut, (uint32_t*)scratch, numElems);
                 break;
             case NIFTI_TYPE_INT32:
-                convertRead(dataOut, (int32_t*)m_scratch.data(), numElems);
+                convertRead(dataOut, (int32_t*)scratch, numElems);
                 break;
             case NIFTI_TYPE_UINT64:
-                convertRead(dataOut, (uint64_t*)m_scratch.data(), numElems);
+                convertRead(dataOut, (uint64_t*)scratch, numElems);
                 break;
             case NIFTI_TYPE_INT64:
-                convertRead(dataOut, (int64_t*)m_scratch.data(), numElems);
+                convertRead(dataOut, (int64_t*)scratch, numElems);
                 break;
             case NIFTI_TYPE_FLOAT32:
             case NIFTI_TYPE_COMPLEX64://components
-                convertRead(dataOut, (float*)m_scratch.data(), numElems);
+                convertRead(dataOut, (float*)scratch, numElems);
                 break;
             case NIFTI_TYPE_FLOAT64:
             case NIFTI_TYPE_COMPLEX128:
-                convertRead(dataOut, (double*)m_scratch.data(), numElems);
+                convertRead(dataOut, (double*)scratch, numElems);
                 break;
             case NIFTI_TYPE_FLOAT128:
             case NIFTI_TYPE_COMPLEX256:
-                convertRead(dataOut, (long double*)m_scratch.data(), numElems);
+                convertRead(dataOut, (long double*)scratch, numElems);
                 break;
             default:
                 CaretAssert(0);
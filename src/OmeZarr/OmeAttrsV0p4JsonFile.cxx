@@ -23,6 +23,7 @@
 #include "OmeAttrsV0p4JsonFile.h"
 #undef __OME_ATTRS_V0P4_JSON_FILE_DECLARE__
 
+#include <algorithm>
 #include <iostream>
 
 #include <nlohmann/json.hpp>
@@ -73,6 +74,10 @@ OmeAttrsV0p4JsonFile::clear()
     m_dataSets.clear();
     
     m_dimensionIndices = OmeDimensionIndices();
+    
+    m_displayWindowStart = 0.0;
+    m_displayWindowEnd   = 0.0;
+    m_displayWindowValidFlag = false;
 }
 
 /**
@@ -168,6 +173,25 @@ OmeAttrsV0p4JsonFile::getDimensionIndices() const
     return m_dimensionIndices;
 }
 
+/**
+ * Get the display window from the optional 'omero' metadata.  When there are
+ * multiple channels, the window contains the windows of all channels.
+ * @param startOut
+ *    Output with start of the window
+ * @param endOut
+ *    Output with end of the window
+ * @return
+ *    True if the window is valid, else false.
+ */
+bool
+OmeAttrsV0p4JsonFile::getDisplayWindow(double& startOut,
+                                       double& endOut) const
+{
+    startOut = m_displayWindowStart;
+    endOut   = m_displayWindowEnd;
+    return m_displayWindowValidFlag;
+}
+
 /**
  * Must be override by child classes to read the file's content from JSON
  * @param json
@@ -219,9 +243,58 @@ OmeAttrsV0p4JsonFile::readContentFromJson(const nlohmann::json& json)
         }
     }
     
+    /*
+     * Read optional 'omero'
+     */
+    if (json.contains("omero")) {
+        parseZattsOmeroJson(json.at("omero"));
+    }
+    
     return FunctionResult::ok();
 }
 
+/**
+ * Read the display window from the optional 'omero' in the .zattrs file json.
+ * Since 'omero' is transitional metadata, content that is not understood is ignored.
+ * @param json
+ *    The JSON
+ */
+void
+OmeAttrsV0p4JsonFile::parseZattsOmeroJson(const nlohmann::json& json)
+{
+    if ( ! json.contains("channels")) {
+        return;
+    }
+    const auto channelsArray(json.at("channels"));
+    if ( ! channelsArray.is_array()) {
+        return;
+    }
+    for (const auto& channel : channelsArray) {
+        if ( ! channel.contains("window")) {
+            continue;
+        }
+        const auto window(channel.at("window"));
+        if (window.contains("start")
+            && window.contains("end")
+            && window.at("start").is_number()
+            && window.at("end").is_number()) {
+            const double start(window.at("start").get<double>());
+            const double end(window.at("end").get<double>());
+            if (end > start) {
+                if (m_displayWindowValidFlag) {
+                    m_displayWindowStart = std::min(m_displayWindowStart, start);
+                    m_displayWindowEnd   = std::max(m_displayWindowEnd, end);
+                }
+                else {
+                    m_displayWindowStart = start;
+                    m_displayWindowEnd   = end;
+                    m_displayWindowValidFlag = true;
+                }
+            }
+        }
+    }
+}
+
 /**
  * Read the 'axes' from the .zattrs file jason
  * @param json
@@ -459,6 +532,12 @@ OmeAttrsV0p4JsonFile::toString() const
     txt.appendWithNewLine("Name: " + m_name);
     txt.appendWithNewLine("Version: " + OmeVersionEnum::toGuiName(m_version));
     txt.appendWithNewLine("Indices: " + m_dimensionIndices.toString());
+    if (m_displayWindowValidFlag) {
+        txt.appendWithNewLine("Display Window: "
+                              + AString::number(m_displayWindowStart)
+                              + ", "
+                              + AString::number(m_displayWindowEnd));
+    }
     
     txt.appendWithNewLine("Axes: ");
     for (const auto& axis : m_axes) {
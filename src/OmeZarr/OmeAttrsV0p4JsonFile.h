@@ -63,6 +63,9 @@ namespace caret {
         const OmeDataSet* getDataSet(const int32_t index) const;
         
         const OmeDimensionIndices& getDimensionIndices() const;
+        
+        bool getDisplayWindow(double& startOut,
+                              double& endOut) const;
 
         virtual AString toString() const override;
         
@@ -76,6 +79,8 @@ namespace caret {
         
         FunctionResult parseZattsDatasetsJson(const nlohmann::json& json);
         
+        void parseZattsOmeroJson(const nlohmann::json& json);
+        
         std::vector<OmeAxis> m_axes;
         
         std::vector<std::unique_ptr<OmeDataSet>> m_dataSets;
@@ -85,6 +90,13 @@ namespace caret {
         OmeVersionEnum::Enum m_version = OmeVersionEnum::UNKNOWN;
         
         OmeDimensionIndices m_dimensionIndices;
+        
+        /** display window from the 'omero' channels, union of all channels */
+        double m_displayWindowStart = 0.0;
+        
+        double m_displayWindowEnd = 0.0;
+        
+        bool m_displayWindowValidFlag = false;
 
         // ADD_NEW_MEMBERS_HERE
 
@@ -257,6 +257,44 @@ OmeDataSet::initializeForReading(const ZarrDriverTypeEnum::Enum driverType,
     return FunctionResult::ok();
 }
 
+/**
+ * Compute the range of the finite values in this data set
+ * @param minimumValueOut
+ *    Output with the minimum value
+ * @param maximumValueOut
+ *    Output with the maximum value
+ * @return
+ *    Result of computing the range
+ */
+FunctionResult
+OmeDataSet::computeDataRange(double& minimumValueOut,
+                             double& maximumValueOut) const
+{
+    if ( ! m_zarrImageReader) {
+        return FunctionResult::error("ZarrImageReader in OmeDataSet is invalid.");
+    }
+    return m_zarrImageReader->computeDataRange(minimumValueOut,
+                                               maximumValueOut);
+}
+
+/**
+ * Set the range of values that is mapped to the display range when
+ * data that is not unsigned 8-bit is read for display
+ * @param minimumValue
+ *    Value mapped to zero
+ * @param maximumValue
+ *    Value mapped to 255
+ */
+void
+OmeDataSet::setDisplayRange(const double minimumValue,
+                            const double maximumValue)
+{
+    if (m_zarrImageReader) {
+        m_zarrImageReader->setDisplayRange(minimumValue,
+                                           maximumValue);
+    }
+}
+
 /**
  * Read the given data set from the ZARR file for display in an image.
  * @param sliceIndex
@@ -83,6 +83,12 @@ namespace caret {
         FunctionResult initializeForReading(const ZarrDriverTypeEnum::Enum driverType,
                                             const AString& zarrPath);
         
+        FunctionResult computeDataRange(double& minimumValueOut,
+                                        double& maximumValueOut) const;
+        
+        void setDisplayRange(const double minimumValue,
+                             const double maximumValue);
+        
         FunctionResultValue<OmeImage*> readSlice(const int64_t sliceIndex) const;
         
         FunctionResultValue<std::array<uint8_t, 4>> readSlicePixel(const int64_t sliceIndex,
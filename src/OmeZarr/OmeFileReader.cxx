@@ -48,6 +48,7 @@
 #include <QImageWriter>
 
 #include "CaretAssert.h"
+#include "CaretLogger.h"
 #include "OmeImage.h"
 #include "OmeAttrsV0p4JsonFile.h"
 #include "ZarrHelper.h"
@@ -202,6 +203,39 @@ OmeFileReader::initialize(const AString& omeZarrPath)
             }
         }
     }
+    
+    /*
+     * All data sets (resolutions) use one display range so that tiles
+     * read from different regions and resolutions are consistent.  Use the
+     * OMERO window if available, otherwise the range of the data in the
+     * lowest resolution data set (last data set).
+     */
+    if ((numDataSets > 0)
+        && (m_omeZAttrs->getDataSet(0)->getZarrDataType() != ZarrDataTypeEnum::UINT_8)) {
+        double minimumValue(0.0);
+        double maximumValue(0.0);
+        bool rangeValidFlag(m_omeZAttrs->getDisplayWindow(minimumValue,
+                                                          maximumValue));
+        if ( ! rangeValidFlag) {
+            const FunctionResult rangeResult(m_omeZAttrs->getDataSet(numDataSets - 1)->computeDataRange(minimumValue,
+                                                                                                       maximumValue));
+            if (rangeResult.isOk()) {
+                rangeValidFlag = true;
+            }
+            else {
+                CaretLogWarning("Unable to compute display range for "
+                                + omeZarrPath
+                                + ": "
+                                + rangeResult.getErrorMessage());
+            }
+        }
+        if (rangeValidFlag) {
+            for (int32_t i = 0; i < numDataSets; i++) {
+                m_omeZAttrs->getDataSet(i)->setDisplayRange(minimumValue,
+                                                            maximumValue);
+            }
+        }
+    }
 
     return FunctionResult::ok();
 }
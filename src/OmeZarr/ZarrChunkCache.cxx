@@ -0,0 +1,232 @@
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026 Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#define __ZARR_CHUNK_CACHE_DECLARE__
+#include "ZarrChunkCache.h"
+#undef __ZARR_CHUNK_CACHE_DECLARE__
+
+#include <algorithm>
+
+#include "CaretAssert.h"
+
+using namespace caret;
+
+
+/**
+ * \class caret::ZarrChunkCache
+ * \brief Least recently used cache of decompressed ZARR chunks
+ * \ingroup OmeZarr
+ *
+ * One cache is shared by all ZARR image readers so that the total memory
+ * used by decompressed chunks stays under a single limit no matter how
+ * many files or tabs are displaying ZARR data.  Each reader obtains an
+ * owner identifier and chunks are keyed by the owner and the chunk's
+ * linear index within the reader's array.
+ */
+
+/**
+ * Constructor.
+ */
+ZarrChunkCache::ZarrChunkCache()
+: CaretObject(),
+m_maximumSizeBytes(512 * 1024 * 1024)
+{
+
+}
+
+/**
+ * Destructor.
+ */
+ZarrChunkCache::~ZarrChunkCache()
+{
+}
+
+/**
+ * @return The one instance of the cache
+ */
+ZarrChunkCache*
+ZarrChunkCache::getCache()
+{
+    static ZarrChunkCache s_cache;
+    return &s_cache;
+}
+
+/**
+ * @return A new identifier for a reader that puts chunks into the cache
+ */
+int64_t
+ZarrChunkCache::newOwnerIdentifier()
+{
+    ZarrChunkCache* cache(getCache());
+    CaretMutexLocker locker(&cache->m_mutex);
+    return cache->m_nextOwnerIdentifier++;
+}
+
+/**
+ * Get a chunk from the cache and make it the most recently used chunk
+ * @param ownerIdentifier
+ *    Identifier of reader that added the chunk
+ * @param chunkIndex
+ *    Linear index of the chunk
+ * @return
+ *    The chunk or NULL if it is not in the cache
+ */
+std::shared_ptr<const ZarrChunkCache::Chunk>
+ZarrChunkCache::getChunk(const int64_t ownerIdentifier,
+                         const int64_t chunkIndex)
+{
+    ZarrChunkCache* cache(getCache());
+    CaretMutexLocker locker(&cache->m_mutex);
+    auto iter(cache->m_entryLookup.find(Key(ownerIdentifier, chunkIndex)));
+    if (iter == cache->m_entryLookup.end()) {
+        return std::shared_ptr<const Chunk>();
+    }
+    cache->m_entries.splice(cache->m_entries.begin(),
+                            cache->m_entries,
+                            iter->second);
+    return iter->second->m_chunk;
+}
+
+/**
+ * Add a chunk to the cache, removing least recently used chunks
+ * if the cache exceeds its maximum size.  The chunk is added even
+ * when it is larger than the maximum size so that it remains available
+ * until the next chunk is added.
+ * @param ownerIdentifier
+ *    Identifier of reader that is adding the chunk
+ * @param chunkIndex
+ *    Linear index of the chunk
+ * @param chunk
+ *    The chunk
+ */
+void
+ZarrChunkCache::addChunk(const int64_t ownerIdentifier,
+                         const int64_t chunkIndex,
+                         const std::shared_ptr<const Chunk>& chunk)
+{
+    CaretAssert(chunk);
+    ZarrChunkCache* cache(getCache());
+    CaretMutexLocker locker(&cache->m_mutex);
+    const Key key(ownerIdentifier, chunkIndex);
+    auto iter(cache->m_entryLookup.find(key));
+    if (iter != cache->m_entryLookup.end()) {
+        /*
+         * Another thread may have read the same chunk
+         */
+        cache->m_entries.splice(cache->m_entries.begin(),
+                                cache->m_entries,
+                                iter->second);
+        return;
+    }
+
+    const int64_t sizeBytes(chunk->m_data.size());
+    cache->evictToSize(cache->m_maximumSizeBytes - sizeBytes);
+
+    Entry entry;
+    entry.m_key       = key;
+    entry.m_chunk     = chunk;
+    entry.m_sizeBytes = sizeBytes;
+    cache->m_entries.push_front(entry);
+    cache->m_entryLookup.insert(std::make_pair(key,
+                                               cache->m_entries.begin()));
+    cache->m_sizeBytes += sizeBytes;
+}
+
+/**
+ * Remove all chunks added by the given owner, typically when the owner is destroyed
+ * @param ownerIdentifier
+ *    Identifier of reader
+ */
+void
+ZarrChunkCache::removeOwner(const int64_t ownerIdentifier)
+{
+    ZarrChunkCache* cache(getCache());
+    CaretMutexLocker locker(&cache->m_mutex);
+    auto iter(cache->m_entries.begin());
+    while (iter != cache->m_entries.end()) {
+        if (iter->m_key.first == ownerIdentifier) {
+            cache->m_sizeBytes -= iter->m_sizeBytes;
+            cache->m_entryLookup.erase(iter->m_key);
+            iter = cache->m_entries.erase(iter);
+        }
+        else {
+            ++iter;
+        }
+    }
+}
+
+/**
+ * @return Maximum size of the cache in bytes
+ */
+int64_t
+ZarrChunkCache::getMaximumSizeBytes()
+{
+    ZarrChunkCache* cache(getCache());
+    CaretMutexLocker locker(&cache->m_mutex);
+    return cache->m_maximumSizeBytes;
+}
+
+/**
+ * Set the maximum size of the cache in bytes, removing least recently used chunks
+ * if the cache is now too large
+ * @param maximumSizeBytes
+ *    New maximum size
+ */
+void
+ZarrChunkCache::setMaximumSizeBytes(const int64_t maximumSizeBytes)
+{
+    ZarrChunkCache* cache(getCache());
+    CaretMutexLocker locker(&cache->m_mutex);
+    cache->m_maximumSizeBytes = std::max(maximumSizeBytes, static_cast<int64_t>(0));
+    cache->evictToSize(cache->m_maximumSizeBytes);
+}
+
+/**
+ * Remove least recently used chunks until the cache is no larger than the given size.
+ * Caller must hold the mutex.
+ * @param sizeBytes
+ *    Size for the cache
+ */
+void
+ZarrChunkCache::evictToSize(const int64_t sizeBytes)
+{
+    while (( ! m_entries.empty())
+           && (m_sizeBytes > sizeBytes)) {
+        const Entry& entry(m_entries.back());
+        m_sizeBytes -= entry.m_sizeBytes;
+        m_entryLookup.erase(entry.m_key);
+        m_entries.pop_back();
+    }
+}
+
+/**
+ * Get a description of this object's content.
+ * @return String describing this object's content.
+ */
+AString
+ZarrChunkCache::toString() const
+{
+    AString txt("ZarrChunkCache");
+    txt.appendWithNewLine("   Chunks: " + AString::number(m_entries.size()));
+    txt.appendWithNewLine("   Size Bytes: " + AString::number(m_sizeBytes));
+    txt.appendWithNewLine("   Maximum Size Bytes: " + AString::number(m_maximumSizeBytes));
+    return txt;
+}
@@ -0,0 +1,120 @@
+#ifndef __ZARR_CHUNK_CACHE_H__
+#define __ZARR_CHUNK_CACHE_H__
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026 Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+
+
+#include <cinttypes>
+#include <list>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "CaretMutex.h"
+#include "CaretObject.h"
+
+namespace caret {
+
+    class ZarrChunkCache : public CaretObject {
+
+    public:
+        /**
+         * A decompressed chunk, elements are in C (row major) order, in the native data type of
+         * the array and the byte order of this system.
+         * Chunks at the edge of the array contain only the elements inside the array.
+         */
+        class Chunk {
+        public:
+            /** Number of elements in each dimension */
+            std::vector<int64_t> m_shape;
+
+            /** The element data as bytes */
+            std::vector<uint8_t> m_data;
+        };
+
+        virtual ~ZarrChunkCache();
+
+        ZarrChunkCache(const ZarrChunkCache&) = delete;
+
+        ZarrChunkCache& operator=(const ZarrChunkCache&) = delete;
+
+        static int64_t newOwnerIdentifier();
+
+        static std::shared_ptr<const Chunk> getChunk(const int64_t ownerIdentifier,
+                                                     const int64_t chunkIndex);
+
+        static void addChunk(const int64_t ownerIdentifier,
+                             const int64_t chunkIndex,
+                             const std::shared_ptr<const Chunk>& chunk);
+
+        static void removeOwner(const int64_t ownerIdentifier);
+
+        static int64_t getMaximumSizeBytes();
+
+        static void setMaximumSizeBytes(const int64_t maximumSizeBytes);
+
+        // ADD_NEW_METHODS_HERE
+
+        virtual AString toString() const;
+
+    private:
+        typedef std::pair<int64_t, int64_t> Key;
+
+        class Entry {
+        public:
+            Key m_key;
+
+            std::shared_ptr<const Chunk> m_chunk;
+
+            int64_t m_sizeBytes;
+        };
+
+        ZarrChunkCache();
+
+        static ZarrChunkCache* getCache();
+
+        void evictToSize(const int64_t sizeBytes);
+
+        /** Most recently used entry is at the front */
+        std::list<Entry> m_entries;
+
+        std::map<Key, std::list<Entry>::iterator> m_entryLookup;
+
+        int64_t m_sizeBytes = 0;
+
+        int64_t m_maximumSizeBytes;
+
+        int64_t m_nextOwnerIdentifier = 1;
+
+        CaretMutex m_mutex;
+
+        // ADD_NEW_MEMBERS_HERE
+
+    };
+
+#ifdef __ZARR_CHUNK_CACHE_DECLARE__
+    // <PLACE DECLARATIONS OF STATIC MEMBERS HERE>
+#endif // __ZARR_CHUNK_CACHE_DECLARE__
+
+} // namespace
+#endif  //__ZARR_CHUNK_CACHE_H__
@@ -145,10 +145,6 @@ ZarrHelper::getDriverTypeFromFilename(const AString& filename)
     }
     else if (filename.endsWith(".zip")) {
         driverType = ZarrDriverTypeEnum::LOCAL_ZIP_FILE;
-        
-        /* Remove thenext two line when ZIP support is added */
-        errorMessage = ("Reading from ZIP file not supported.");
-        driverType   = ZarrDriverTypeEnum::INVALID;
     }
     else if ( ! filename.isEmpty()) {
         driverType = ZarrDriverTypeEnum::LOCAL_FILE;
@@ -43,11 +43,19 @@
 #include "ZarrImageReader.h"
 #undef __ZARR_IMAGE_READER_DECLARE__
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <limits>
 #include <string>
-#include <thread>
+
+#ifdef WITH_BLOSC
+#include <blosc.h>
+#endif
+#include <zlib.h>
 
 //#include "xtensor/xarray.hpp"
 
@@ -58,13 +66,358 @@
 // io for xtensor multi-arrays
 #include "z5/multiarray/xtensor_access.hxx"
 
+#include "ByteOrderEnum.h"
 #include "CaretAssert.h"
+#include "CaretOMP.h"
 #include "FileInformation.h"
 #include "ZarrHelper.h"
 #include "ZarrV2ArrayJsonFile.h"
+#include "ZarrZipStore.h"
 
 using namespace caret;
 
+namespace
+{
+    /**
+     * Copy the part of a chunk that overlaps a region into the region's data.
+     * Both are in C (row major) order.
+     * @param chunk
+     *    The chunk
+     * @param chunkOffset
+     *    Offset of the chunk's first element in the array
+     * @param regionOffset
+     *    Offset of the region's first element in the array
+     * @param regionLengths
+     *    Lengths of the region
+     * @param elementSize
+     *    Number of bytes in each element
+     * @param regionData
+     *    Data for the region
+     */
+    void copyChunkToRegion(const ZarrChunkCache::Chunk& chunk,
+                           const std::vector<int64_t>& chunkOffset,
+                           const std::vector<int64_t>& regionOffset,
+                           const std::vector<int64_t>& regionLengths,
+                           const int64_t elementSize,
+                           uint8_t* regionData)
+    {
+        const int32_t numDims(regionLengths.size());
+        CaretAssert(numDims > 0);
+        CaretAssert(static_cast<int32_t>(chunk.m_shape.size()) == numDims);
+        std::vector<int64_t> overlapStart(numDims), overlapLength(numDims);
+        for (int32_t d = 0; d < numDims; d++) {
+            overlapStart[d] = std::max(chunkOffset[d], regionOffset[d]);
+            const int64_t overlapEnd(std::min(chunkOffset[d] + chunk.m_shape[d],
+                                              regionOffset[d] + regionLengths[d]));
+            if (overlapEnd <= overlapStart[d]) {
+                return;
+            }
+            overlapLength[d] = overlapEnd - overlapStart[d];
+        }
+        
+        std::vector<int64_t> chunkStrides(numDims), regionStrides(numDims);
+        chunkStrides[numDims - 1]  = 1;
+        regionStrides[numDims - 1] = 1;
+        for (int32_t d = numDims - 2; d >= 0; d--) {
+            chunkStrides[d]  = chunkStrides[d + 1] * chunk.m_shape[d + 1];
+            regionStrides[d] = regionStrides[d + 1] * regionLengths[d + 1];
+        }
+        
+        /*
+         * Copy contiguous rows along the last dimension, stepping
+         * through the other dimensions like an odometer
+         */
+        const int32_t lastDim(numDims - 1);
+        const int64_t rowBytes(overlapLength[lastDim] * elementSize);
+        std::vector<int64_t> position(numDims, 0);
+        while (true) {
+            int64_t chunkIndex(0), regionIndex(0);
+            for (int32_t d = 0; d < numDims; d++) {
+                const int64_t arrayIndex(overlapStart[d] + position[d]);
+                chunkIndex  += (arrayIndex - chunkOffset[d]) * chunkStrides[d];
+                regionIndex += (arrayIndex - regionOffset[d]) * regionStrides[d];
+            }
+            std::memcpy(regionData + (regionIndex * elementSize),
+                        chunk.m_data.data() + (chunkIndex * elementSize),
+                        rowBytes);
+            
+            int32_t d(lastDim - 1);
+            while (d >= 0) {
+                ++position[d];
+                if (position[d] < overlapLength[d]) {
+                    break;
+                }
+                position[d] = 0;
+                --d;
+            }
+            if (d < 0) {
+                break;
+            }
+        }
+    }
+    
+    /**
+     * @return Number of bytes in an element of the given data type, zero if unknown
+     * @param dataType
+     *    The data type
+     */
+    int64_t getElementSize(const ZarrDataTypeEnum::Enum dataType)
+    {
+        switch (dataType) {
+            case ZarrDataTypeEnum::UNKNOWN:
+                break;
+            case ZarrDataTypeEnum::INT_8:
+            case ZarrDataTypeEnum::UINT_8:
+                return 1;
+            case ZarrDataTypeEnum::INT_16:
+            case ZarrDataTypeEnum::UINT_16:
+                return 2;
+            case ZarrDataTypeEnum::INT_32:
+            case ZarrDataTypeEnum::UINT_32:
+            case ZarrDataTypeEnum::FLOAT_32:
+                return 4;
+            case ZarrDataTypeEnum::INT_64:
+            case ZarrDataTypeEnum::UINT_64:
+            case ZarrDataTypeEnum::FLOAT_64:
+                return 8;
+        }
+        return 0;
+    }
+    
+    /**
+     * Call a function with a value of the C++ type matching the given data type,
+     * so that the function can be written once as a generic lambda
+     * @param dataType
+     *    The data type
+     * @param function
+     *    Function called with a value of the C++ type
+     * @return
+     *    True if the data type is valid and the function was called
+     */
+    template <typename FUNCTION>
+    bool callWithDataType(const ZarrDataTypeEnum::Enum dataType,
+                          FUNCTION&& function)
+    {
+        switch (dataType) {
+            case ZarrDataTypeEnum::UNKNOWN:
+                return false;
+            case ZarrDataTypeEnum::INT_8:
+                function(int8_t(0));
+                return true;
+            case ZarrDataTypeEnum::UINT_8:
+                function(uint8_t(0));
+                return true;
+            case ZarrDataTypeEnum::INT_16:
+                function(int16_t(0));
+                return true;
+            case ZarrDataTypeEnum::UINT_16:
+                function(uint16_t(0));
+                return true;
+            case ZarrDataTypeEnum::INT_32:
+                function(int32_t(0));
+                return true;
+            case ZarrDataTypeEnum::UINT_32:
+                function(uint32_t(0));
+                return true;
+            case ZarrDataTypeEnum::INT_64:
+                function(int64_t(0));
+                return true;
+            case ZarrDataTypeEnum::UINT_64:
+                function(uint64_t(0));
+                return true;
+            case ZarrDataTypeEnum::FLOAT_32:
+                function(float(0));
+                return true;
+            case ZarrDataTypeEnum::FLOAT_64:
+                function(double(0));
+                return true;
+        }
+        return false;
+    }
+    
+    /**
+     * Find the range of the finite values in native data
+     * @param nativeData
+     *    The native data
+     * @param numElements
+     *    Number of elements
+     * @param minimumValueInOut
+     *    Minimum value, updated with the data's minimum value
+     * @param maximumValueInOut
+     *    Maximum value, updated with the data's maximum value
+     */
+    template <typename T>
+    void updateDataRange(const T* nativeData,
+                         const int64_t numElements,
+                         double& minimumValueInOut,
+                         double& maximumValueInOut)
+    {
+        for (int64_t i = 0; i < numElements; i++) {
+            const double value(nativeData[i]);
+            if (std::isfinite(value)) {
+                minimumValueInOut = std::min(minimumValueInOut, value);
+                maximumValueInOut = std::max(maximumValueInOut, value);
+            }
+        }
+    }
+    
+    /**
+     * Convert native data to unsigned bytes for display.  Values are scaled
+     * from the given range so that all regions of a file are scaled alike.
+     * @param nativeData
+     *    The native data
+     * @param numElements
+     *    Number of elements
+     * @param minimumValue
+     *    Value mapped to zero
+     * @param maximumValue
+     *    Value mapped to 255
+     * @param displayOut
+     *    Output with the display data
+     */
+    template <typename T>
+    void convertToDisplay(const T* nativeData,
+                          const int64_t numElements,
+                          const double minimumValue,
+                          const double maximumValue,
+                          uint8_t* displayOut)
+    {
+        const double range(maximumValue - minimumValue);
+        const double scale((range > 0.0)
+                           ? (255.0 / range)
+                           : 0.0);
+        for (int64_t i = 0; i < numElements; i++) {
+            const double value((nativeData[i] - minimumValue) * scale);
+            if (value >= 255.0) {
+                displayOut[i] = 255;
+            }
+            else if (value > 0.0) {
+                displayOut[i] = static_cast<uint8_t>(value + 0.5);
+            }
+            else {
+                /* also NaN */
+                displayOut[i] = 0;
+            }
+        }
+    }
+    
+    /**
+     * Read a chunk using z5 with the native type of the data.
+     * @param dataSet
+     *    The z5 dataset
+     * @param offset
+     *    Offset of the chunk in the array
+     * @param shape
+     *    Shape of the chunk, clipped to the array
+     * @param dataOut
+     *    Output with bytes of the native data
+     * @param nativeTypeValue
+     *    Unused, selects the type
+     * @return
+     *    Empty string if successful, else an error message
+     */
+    template <typename T>
+    AString readSubarrayChunk(const std::unique_ptr<z5::Dataset>& dataSet,
+                              const z5::types::ShapeType& offset,
+                              const std::vector<int64_t>& shape,
+                              std::vector<uint8_t>& dataOut,
+                              const T /*nativeTypeValue*/)
+    {
+        typename xt::xarray<T>::shape_type arrayShape;
+        for (const int64_t s : shape) {
+            arrayShape.push_back(s);
+        }
+        try {
+            xt::xarray<T> chunkData(arrayShape);
+            z5::multiarray::readSubarray<T>(dataSet,
+                                            chunkData,
+                                            offset.begin(),
+                                            1);
+            const uint8_t* bytes(reinterpret_cast<const uint8_t*>(chunkData.data()));
+            dataOut.assign(bytes,
+                           bytes + (chunkData.size() * sizeof(T)));
+        }
+        catch(const std::exception& re) {
+            return ("Z5::readSubarray exeception: "
+                    + AString(re.what()));
+        }
+        return "";
+    }
+    
+    /**
+     * Decompress an encoded chunk
+     * @param compressorType
+     *    Type of compressor used to encode the chunk
+     * @param encodedData
+     *    The encoded chunk
+     * @param dataOut
+     *    Output containing the decoded chunk, must be sized for the number of bytes in the decoded chunk
+     * @return
+     *    Empty string if successful, else an error message
+     */
+    AString decompressChunk(const ZarrCompressorTypeEnum::Enum compressorType,
+                            std::vector<uint8_t>& encodedData,
+                            std::vector<uint8_t>& dataOut)
+    {
+        const int64_t numBytes(dataOut.size());
+        switch (compressorType) {
+            case ZarrCompressorTypeEnum::NO_COMPRESSOR:
+                if (static_cast<int64_t>(encodedData.size()) != numBytes) {
+                    return ("Chunk contains "
+                            + AString::number(encodedData.size())
+                            + " bytes but should contain "
+                            + AString::number(numBytes));
+                }
+                dataOut.swap(encodedData);
+                return "";
+            case ZarrCompressorTypeEnum::BLOSC:
+            {
+#ifdef WITH_BLOSC
+                const int numThreads(1);
+                const int result(blosc_decompress_ctx(encodedData.data(),
+                                                      dataOut.data(),
+                                                      numBytes,
+                                                      numThreads));
+                if (result != numBytes) {
+                    return ("Blosc decompression of chunk failed, result="
+                            + AString::number(result));
+                }
+                return "";
+#else
+                return "Blosc decompression is not available";
+#endif
+            }
+            case ZarrCompressorTypeEnum::GZIP:
+            {
+                z_stream stream;
+                std::memset(&stream, 0, sizeof(stream));
+                if (inflateInit2(&stream, 16 + MAX_WBITS) != Z_OK) {
+                    return "Unable to initialize gzip decompression";
+                }
+                stream.next_in   = encodedData.data();
+                stream.avail_in  = encodedData.size();
+                stream.next_out  = dataOut.data();
+                stream.avail_out = numBytes;
+                const int result(inflate(&stream, Z_FINISH));
+                const int64_t numDecoded(stream.total_out);
+                inflateEnd(&stream);
+                if ((result != Z_STREAM_END)
+                    || (numDecoded != numBytes)) {
+                    return ("Gzip decompression of chunk failed, result="
+                            + AString::number(result));
+                }
+                return "";
+            }
+            case ZarrCompressorTypeEnum::BYTES:
+            case ZarrCompressorTypeEnum::CRC32C:
+                break;
+        }
+        
+        return ("Compressor not supported for reading chunks from zip file: "
+                + ZarrCompressorTypeEnum::toEncodingName(compressorType));
+    }
+}
+
 /**
  * \class caret::ZarrImageReader 
  * \brief Reads from a ZARR file
@@ -78,7 +431,8 @@ using namespace caret;
  * Constructor.
  */
 ZarrImageReader::ZarrImageReader()
-: CaretObject()
+: CaretObject(),
+m_chunkCacheOwnerIdentifier(ZarrChunkCache::newOwnerIdentifier())
 {
     
 }
@@ -88,18 +442,7 @@ ZarrImageReader::ZarrImageReader()
  */
 ZarrImageReader::~ZarrImageReader()
 {
-}
-
-/**
- * Helps with copying an object of this type.
- * @param obj
- *    Object that is copied.
- */
-void 
-ZarrImageReader::copyHelperZarrImageReader(const ZarrImageReader& obj)
-{
-    m_shapeSizes = obj.m_shapeSizes;
-    m_dataType   = obj.m_dataType;
+    ZarrChunkCache::removeOwner(m_chunkCacheOwnerIdentifier);
 }
 
 /**
@@ -112,6 +455,7 @@ ZarrImageReader::toString() const
     AString txt("ZarrImageReader");
     txt.appendWithNewLine("   Shape Sizes: " + AString::fromNumbers(m_shapeSizes));
     txt.appendWithNewLine("   Data Type: " + ZarrDataTypeEnum::toGuiName(m_dataType));
+    txt.appendWithNewLine("   Chunk Sizes: " + AString::fromNumbers(m_chunkSizes));
     return txt;
 }
 
@@ -179,13 +523,29 @@ ZarrImageReader::initialize(const ZarrDriverTypeEnum::Enum driverType,
 
     m_shapeSizes = m_zarrayFile->getShapeSizes();
     m_dataType   = m_zarrayFile->getDataType();
+    m_chunkSizes = m_zarrayFile->getChunkSizes();
     
     if (m_shapeSizes.empty()) {
         return FunctionResult::error("Shape sizes for ZARR Image are invalid (empty).");
     }
+    if (m_chunkSizes.size() != m_shapeSizes.size()) {
+        return FunctionResult::error("Chunk sizes for ZARR Image are invalid: "
+                                     + AString::fromNumbers(m_chunkSizes));
+    }
+    for (const int64_t cs : m_chunkSizes) {
+        if (cs <= 0) {
+            return FunctionResult::error("Chunk sizes for ZARR Image are invalid: "
+                                         + AString::fromNumbers(m_chunkSizes));
+        }
+    }
     if (m_dataType == ZarrDataTypeEnum::UNKNOWN) {
         return FunctionResult::error("Data type is unknown.");
     }
+    m_elementSize = getElementSize(m_dataType);
+    if (m_elementSize <= 0) {
+        return FunctionResult::error("Data type is not supported: "
+                                     + ZarrDataTypeEnum::toGuiName(m_dataType));
+    }
     
     m_status = Status::INITIALIZATION_SUCCESSFUL;
 
@@ -206,7 +566,84 @@ ZarrImageReader::readDataErrorResult(const AString& errorMessage)
 }
 
 /**
- * Read data from the ZARR file
+ * Set the range of values that is mapped to the display range when
+ * data that is not unsigned 8-bit is read for display
+ * @param minimumValue
+ *    Value mapped to zero
+ * @param maximumValue
+ *    Value mapped to 255
+ */
+void
+ZarrImageReader::setDisplayRange(const double minimumValue,
+                                 const double maximumValue)
+{
+    CaretMutexLocker locker(&m_displayRangeMutex);
+    m_displayMinimumValue = minimumValue;
+    m_displayMaximumValue = maximumValue;
+    m_displayRangeValidFlag = true;
+}
+
+/**
+ * Compute the range of the finite values in the entire array.  All of the
+ * array's data is read so this is intended for small (low resolution) arrays.
+ * @param minimumValueOut
+ *    Output with the minimum value
+ * @param maximumValueOut
+ *    Output with the maximum value
+ * @return
+ *    Result of computing the range
+ */
+FunctionResult
+ZarrImageReader::computeDataRange(double& minimumValueOut,
+                                  double& maximumValueOut)
+{
+    minimumValueOut = 0.0;
+    maximumValueOut = 0.0;
+    
+    const std::vector<int64_t> dimOffsets(m_shapeSizes.size(), 0);
+    const FunctionResult checkResult(checkReadRegion(dimOffsets,
+                                                     m_shapeSizes));
+    if (checkResult.isError()) {
+        return checkResult;
+    }
+    
+    int64_t numElements(1);
+    for (const int64_t s : m_shapeSizes) {
+        numElements *= s;
+    }
+    std::vector<uint8_t> nativeData(numElements * m_elementSize);
+    const FunctionResult result(readRegion(dimOffsets,
+                                           m_shapeSizes,
+                                           nativeData.data()));
+    if (result.isError()) {
+        return result;
+    }
+    
+    double minimumValue(std::numeric_limits<double>::max());
+    double maximumValue(std::numeric_limits<double>::lowest());
+    callWithDataType(m_dataType,
+                     [&](auto nativeTypeValue) {
+        typedef decltype(nativeTypeValue) NativeType;
+        updateDataRange(reinterpret_cast<const NativeType*>(nativeData.data()),
+                        numElements,
+                        minimumValue,
+                        maximumValue);
+    });
+    if (minimumValue > maximumValue) {
+        return FunctionResult::error("Data contains no finite values");
+    }
+    
+    minimumValueOut = minimumValue;
+    maximumValueOut = maximumValue;
+    return FunctionResult::ok();
+}
+
+/**
+ * Read data from the ZARR file for display.  Data that is not unsigned 8-bit
+ * is read in its native type and converted in one step using the display range
+ * so that all regions are scaled alike.  The display range is set once when the
+ * file is opened (OMERO window or lowest resolution data); if it could not be
+ * determined, the range of the values in the region that is read is used.
  * @param dimOffset
  *    Starting offset for reading from each of the dimensions
  * @param dimLengths
@@ -217,74 +654,161 @@ ZarrImageReader::readDataErrorResult(const AString& errorMessage)
 FunctionResultValue<xt::xarray<uint8_t>*>
 ZarrImageReader::readData(const std::vector<int64_t>& dimOffsets,
                           const std::vector<int64_t>& dimLengths)
+{
+    const FunctionResult checkResult(checkReadRegion(dimOffsets,
+                                                     dimLengths));
+    if (checkResult.isError()) {
+        return readDataErrorResult(checkResult.getErrorMessage());
+    }
+    
+    xt::xarray<uint8_t>::shape_type shape;
+    for (const int64_t dl : dimLengths) {
+        shape.push_back(dl);
+    }
+    std::unique_ptr<xt::xarray<uint8_t>> arrayStorage(new xt::xarray<uint8_t>(shape));
+    const int64_t numElements(arrayStorage->size());
+    
+    if (m_dataType == ZarrDataTypeEnum::UINT_8) {
+        const FunctionResult result(readRegion(dimOffsets,
+                                               dimLengths,
+                                               arrayStorage->data()));
+        if (result.isError()) {
+            return readDataErrorResult(result.getErrorMessage());
+        }
+    }
+    else {
+        double minimumValue(0.0);
+        double maximumValue(0.0);
+        bool rangeValidFlag(false);
+        {
+            CaretMutexLocker locker(&m_displayRangeMutex);
+            minimumValue   = m_displayMinimumValue;
+            maximumValue   = m_displayMaximumValue;
+            rangeValidFlag = m_displayRangeValidFlag;
+        }
+        
+        std::vector<uint8_t> nativeData(numElements * m_elementSize);
+        const FunctionResult result(readRegion(dimOffsets,
+                                               dimLengths,
+                                               nativeData.data()));
+        if (result.isError()) {
+            return readDataErrorResult(result.getErrorMessage());
+        }
+        uint8_t* displayData(arrayStorage->data());
+        callWithDataType(m_dataType,
+                         [&](auto nativeTypeValue) {
+            typedef decltype(nativeTypeValue) NativeType;
+            if ( ! rangeValidFlag) {
+                /*
+                 * Never scan the whole array here, it may be a
+                 * high resolution level and would stall every read
+                 */
+                minimumValue = std::numeric_limits<double>::max();
+                maximumValue = std::numeric_limits<double>::lowest();
+                updateDataRange(reinterpret_cast<const NativeType*>(nativeData.data()),
+                                numElements,
+                                minimumValue,
+                                maximumValue);
+            }
+            convertToDisplay(reinterpret_cast<const NativeType*>(nativeData.data()),
+                             numElements,
+                             minimumValue,
+                             maximumValue,
+                             displayData);
+        });
+    }
+    
+    return FunctionResultValue<xt::xarray<uint8_t>*>(arrayStorage.release(),
+                                                     "",
+                                                     true);
+}
+
+/**
+ * Verify that the reader is initialized and that a region is within the array
+ * @param dimOffset
+ *    Starting offset for reading from each of the dimensions
+ * @param dimLengths
+ *    Lengths of data to read from each of the dimensions
+ * @return
+ *    Result of verification
+ */
+FunctionResult
+ZarrImageReader::checkReadRegion(const std::vector<int64_t>& dimOffsets,
+                                 const std::vector<int64_t>& dimLengths) const
 {
     switch (m_status) {
         case Status::INITIALIZATION_SUCCESSFUL:
             break;
         case Status::INITIALIZATION_FAILED:
-            return readDataErrorResult("ZarrImageReader initialized had failed");
+            return FunctionResult::error("ZarrImageReader initialized had failed");
             break;
         case Status::UNINITIALIZED:
-            return readDataErrorResult("ZarrImageReader has not been initialized");
+            return FunctionResult::error("ZarrImageReader has not been initialized");
             break;
     }
     
     CaretAssert(m_zarrayFile);
         
     if (dimOffsets.size() != m_shapeSizes.size()) {
-        return readDataErrorResult("Offsets are different size that ZARR Image shape sizes.");
+        return FunctionResult::error("Offsets are different size that ZARR Image shape sizes.");
     }
     if (dimLengths.size() != m_shapeSizes.size()) {
-        return readDataErrorResult("Lengths are different size that ZARR Image shape sizes.");
+        return FunctionResult::error("Lengths are different size that ZARR Image shape sizes.");
+    }
+    for (int32_t i = 0; i < static_cast<int32_t>(m_shapeSizes.size()); i++) {
+        if ((dimOffsets[i] < 0)
+            || (dimLengths[i] <= 0)
+            || ((dimOffsets[i] + dimLengths[i]) > m_shapeSizes[i])) {
+            return FunctionResult::error("Requested offsets "
+                                         + AString::fromNumbers(dimOffsets)
+                                         + " and lengths "
+                                         + AString::fromNumbers(dimLengths)
+                                         + " are outside ZARR Image shape sizes "
+                                         + AString::fromNumbers(m_shapeSizes));
+        }
     }
     
-    const QString msg("Driver type not supported: "
-                      + ZarrDriverTypeEnum::toGuiName(m_driverType));
-    FunctionResultValue<xt::xarray<uint8_t>*> result(NULL, msg, false);
+    return FunctionResult::ok();
+}
+
+/**
+ * Read a region of the ZARR file in the native data type
+ * @param dimOffset
+ *    Starting offset for reading from each of the dimensions
+ * @param dimLengths
+ *    Lengths of data to read from each of the dimensions
+ * @param dataOut
+ *    Output for the region's data, must be sized for the elements of the region
+ *    in the native data type
+ * @return
+ *    Result of reading
+ */
+FunctionResult
+ZarrImageReader::readRegion(const std::vector<int64_t>& dimOffsets,
+                            const std::vector<int64_t>& dimLengths,
+                            uint8_t* dataOut)
+{
     switch (m_driverType) {
         case ZarrDriverTypeEnum::INVALID:
             break;
         case ZarrDriverTypeEnum::LOCAL_FILE:
-            result = readLocalFile(m_zarrPath,
-                                   m_relativePath,
-                                   dimOffsets,
-                                   dimLengths);
+            return readLocalFile(m_zarrPath,
+                                 m_relativePath,
+                                 dimOffsets,
+                                 dimLengths,
+                                 dataOut);
             break;
         case ZarrDriverTypeEnum::LOCAL_ZIP_FILE:
+            return readZipFile(m_zarrPath,
+                               m_relativePath,
+                               dimOffsets,
+                               dimLengths,
+                               dataOut);
             break;
     }
     
-    if (result.isOk()) {
-        const xt::xarray<uint8_t>* dataPtr(result.getValue());
-        const int32_t numDataDims(dataPtr->dimension());
-        std::vector<int64_t> dataDimLengths;
-        for (int32_t i = 0; i < numDataDims; i++) {
-            dataDimLengths.push_back(dataPtr->shape(i));
-        }
-        CaretAssert(numDataDims == static_cast<int32_t>(dataDimLengths.size()));
-        const int32_t numDimLengths(dimLengths.size());
-        bool matchFlag(false);
-        if (numDataDims == numDimLengths) {
-            matchFlag = true;
-            for (int32_t i = 0; i < numDataDims; i++) {
-                if (dataDimLengths[i] != dimLengths[i]) {
-                    matchFlag = false;
-                    break;
-                }
-            }
-        }
-        if ( ! matchFlag) {
-            AString msg("Requested data dimensions: "
-                        + AString::fromNumbers(dimLengths)
-                        + " but read: "
-                        + AString::fromNumbers(dataDimLengths));
-            result = FunctionResultValue<xt::xarray<uint8_t>*>(NULL,
-                                                               msg,
-                                                               false);
-        }
-    }
-    
-    return result;
+    return FunctionResult::error("Driver type not supported: "
+                                 + ZarrDriverTypeEnum::toGuiName(m_driverType));
 }
 
 /**
@@ -297,79 +821,425 @@ ZarrImageReader::readData(const std::vector<int64_t>& dimOffsets,
  *    Starting offset for reading from each of the dimensions
  * @param dimLengths
  *    Lengths of data to read from each of the dimensions
+ * @param dataOut
+ *    Output for the data in the native data type
  * @return
- *    Result containing the data that was read
+ *    Result of reading
  */
-FunctionResultValue<xt::xarray<uint8_t>*>
+FunctionResult
 ZarrImageReader::readLocalFile(const AString& zarrPath,
                                const AString& relativePath,
                                const std::vector<int64_t>& dimOffsets,
-                               const std::vector<int64_t>& dimLengths)
+                               const std::vector<int64_t>& dimLengths,
+                               uint8_t* dataOut)
 {
+    const FunctionResult openResult(openLocalFileDataSet(zarrPath,
+                                                         relativePath));
+    if (openResult.isError()) {
+        return openResult;
+    }
+    
+    return readChunks(dimOffsets,
+                      dimLengths,
+                      dataOut);
+}
+
+/**
+ * Open the dataset in a local ZARR file if it has not been opened.
+ * The dataset remains open for the lifetime of this reader.
+ * @param zarrPath
+ *    Top level path (could be a directory, zip file, web address, etc.)
+ * @param relativePath
+ *    Path within the zarr path
+ * @return
+ *    Result of opening the dataset
+ */
+FunctionResult
+ZarrImageReader::openLocalFileDataSet(const AString& zarrPath,
+                                      const AString& relativePath)
+{
+    CaretMutexLocker locker(&m_dataSetMutex);
+    
+    if (m_dataSet) {
+        return FunctionResult::ok();
+    }
+    
+    /*
+     * Path to file
+     */
+    const std::string filePath(zarrPath.toStdString()
+                               + "/"
+                               + relativePath.toStdString());
     try {
-        /*
-         * Path to file
-         */
-        const std::string filePath(zarrPath.toStdString()
-                                   + "/"
-                                   + relativePath.toStdString());
         z5::filesystem::handle::File file(zarrPath.toStdString());
         
         /*
          * Open the data set
          */
-        std::unique_ptr<z5::Dataset> dataSet;
         try {
-            dataSet = z5::openDataset(file,
-                                      relativePath.toStdString());
+            m_dataSet = z5::openDataset(file,
+                                        relativePath.toStdString());
         }
         catch (const std::exception& re) {
             const AString msg("Opening dataset failed (z5::openDataset execption), path="
                               + AString(filePath)
                               + AString("  error: ")
                               + AString(re.what()));
-            return readDataErrorResult(msg);
+            return FunctionResult::error(msg);
         }
-        
-        if ( ! dataSet) {
-            return readDataErrorResult("Opening data set failed " + filePath);
+    }
+    catch (const std::exception& e) {
+        return FunctionResult::error("Exception was thrown by Z5: "
+                                     + AString(e.what()));
+    }
+    
+    if ( ! m_dataSet) {
+        return FunctionResult::error("Opening data set failed " + filePath);
+    }
+    
+    return FunctionResult::ok();
+}
+
+/**
+ * Read one chunk from the dataset in a local ZARR file
+ * @param chunkPosition
+ *    Position of the chunk in the grid of chunks
+ * @param chunkOut
+ *    Output containing the decompressed chunk
+ * @return
+ *    Empty string if successful, else an error message
+ */
+AString
+ZarrImageReader::readLocalFileChunk(const std::vector<int64_t>& chunkPosition,
+                                    ZarrChunkCache::Chunk& chunkOut) const
+{
+    CaretAssert(m_dataSet);
+    
+    const int32_t numDims(m_shapeSizes.size());
+    z5::types::ShapeType offset;
+    chunkOut.m_shape.resize(numDims);
+    for (int32_t d = 0; d < numDims; d++) {
+        const int64_t chunkOffset(chunkPosition[d] * m_chunkSizes[d]);
+        chunkOut.m_shape[d] = std::min(m_chunkSizes[d],
+                                       m_shapeSizes[d] - chunkOffset);
+        offset.push_back(chunkOffset);
+    }
+    
+    AString errorMessage("Data type not supported: "
+                         + ZarrDataTypeEnum::toGuiName(m_dataType));
+    callWithDataType(m_dataType,
+                     [&](auto nativeTypeValue) {
+        errorMessage = readSubarrayChunk(m_dataSet,
+                                         offset,
+                                         chunkOut.m_shape,
+                                         chunkOut.m_data,
+                                         nativeTypeValue);
+    });
+    
+    return errorMessage;
+}
+
+/**
+ * Read data from a ZARR stored in a zip file
+ * @param zarrPath
+ *    Path of zip file
+ * @param relativePath
+ *    Path within the zip file
+ * @param dimOffset
+ *    Starting offset for reading from each of the dimensions
+ * @param dimLengths
+ *    Lengths of data to read from each of the dimensions
+ * @param dataOut
+ *    Output for the data in the native data type
+ * @return
+ *    Result of reading
+ */
+FunctionResult
+ZarrImageReader::readZipFile(const AString& zarrPath,
+                             const AString& /*relativePath*/,
+                             const std::vector<int64_t>& dimOffsets,
+                             const std::vector<int64_t>& dimLengths,
+                             uint8_t* dataOut)
+{
+    {
+        CaretMutexLocker locker(&m_dataSetMutex);
+        if ( ! m_zipStore) {
+            if (m_zarrayFile->getRowColumnMajorOrderType() == ZarrRowColumnMajorOrderTypeEnum::COLUMN_MAJOR) {
+                return FunctionResult::error("Column major order is not supported for reading from zip file.");
+            }
+            FunctionResultValue<std::shared_ptr<ZarrZipStore>> storeResult(ZarrZipStore::getStore(zarrPath));
+            if (storeResult.isError()) {
+                return storeResult;
+            }
+            m_zipStore = storeResult.getValue();
         }
-        
-        /*
-         * Read all data from the file
-         */
-        z5::types::ShapeType offset;
-        for (const int64_t dimO : dimOffsets) {
-            offset.push_back(dimO);
+    }
+    CaretAssert(m_zipStore);
+    
+    return readChunks(dimOffsets,
+                      dimLengths,
+                      dataOut);
+}
+
+/**
+ * Read one chunk from a ZARR stored in a zip file.  The chunk's entry is read
+ * from the zip file, decompressed and converted to the byte order of this system.
+ * A chunk that is not in the zip file contains the fill value.
+ * @param chunkPosition
+ *    Position of the chunk in the grid of chunks
+ * @param chunkOut
+ *    Output containing the decompressed chunk
+ * @return
+ *    Empty string if successful, else an error message
+ */
+AString
+ZarrImageReader::readZipFileChunk(const std::vector<int64_t>& chunkPosition,
+                                  ZarrChunkCache::Chunk& chunkOut) const
+{
+    CaretAssert(m_zipStore);
+    CaretAssert(m_zarrayFile);
+    
+    const int32_t numDims(m_shapeSizes.size());
+    const AString separator(ZarrDimensionSeparatorEnum::toEncoding(m_zarrayFile->getDimensionSeparator()));
+    AString entryName(m_relativePath + "/");
+    std::vector<int64_t> chunkOffset(numDims);
+    int64_t numElements(1);
+    chunkOut.m_shape.resize(numDims);
+    for (int32_t d = 0; d < numDims; d++) {
+        if (d > 0) {
+            entryName.append(separator);
         }
-        
-        xt::xarray<int64_t>::shape_type shape;
-        for (const int64_t dl : dimLengths) {
-            shape.push_back(dl);
+        entryName.append(AString::number(chunkPosition[d]));
+        chunkOffset[d] = chunkPosition[d] * m_chunkSizes[d];
+        chunkOut.m_shape[d] = std::min(m_chunkSizes[d],
+                                       m_shapeSizes[d] - chunkOffset[d]);
+        numElements *= chunkOut.m_shape[d];
+    }
+    
+    if ( ! m_zipStore->hasEntry(entryName)) {
+        const std::vector<uint8_t>& fillValueBytes(m_zarrayFile->getFillValueBytes());
+        if (static_cast<int64_t>(fillValueBytes.size()) != m_elementSize) {
+            return ("Fill value is invalid for "
+                    + entryName);
         }
-        try {
-            const int32_t numThreads(std::thread::hardware_concurrency());
-            std::unique_ptr<xt::xarray<uint8_t>> arrayStorage(new xt::xarray<uint8_t>(shape));
-            z5::multiarray::readSubarray<uint8_t>(dataSet,
-                                                  *arrayStorage.get(),
-                                                  offset.begin(),
-                                                  numThreads);
-            return FunctionResultValue<xt::xarray<uint8_t>*>(arrayStorage.release(),
-                                                             "",
-                                                             true);
+        chunkOut.m_data.resize(numElements * m_elementSize);
+        uint8_t* fillData(chunkOut.m_data.data());
+        for (int64_t i = 0; i < numElements; i++) {
+            std::memcpy(fillData,
+                        fillValueBytes.data(),
+                        m_elementSize);
+            fillData += m_elementSize;
         }
-        catch(const std::exception& re) {
-            const AString msg("Z5::readSubarray exeception: "
-                              + AString(re.what()));
-            return readDataErrorResult(msg);
+        return "";
+    }
+    
+    std::vector<uint8_t> encodedData;
+    const FunctionResult readResult(m_zipStore->readEntry(entryName,
+                                                          encodedData));
+    if (readResult.isError()) {
+        return readResult.getErrorMessage();
+    }
+    
+    /*
+     * Chunks are always stored with the full chunk size, even at the edges of the array
+     */
+    ZarrChunkCache::Chunk fullChunk;
+    fullChunk.m_shape = m_chunkSizes;
+    int64_t numFullElements(1);
+    for (const int64_t cs : m_chunkSizes) {
+        numFullElements *= cs;
+    }
+    fullChunk.m_data.resize(numFullElements * m_elementSize);
+    const AString errorMessage(decompressChunk(m_zarrayFile->getCompressorType(),
+                                               encodedData,
+                                               fullChunk.m_data));
+    if ( ! errorMessage.isEmpty()) {
+        return (errorMessage
+                + " for "
+                + entryName);
+    }
+    
+    /*
+     * Chunk cache holds data in the byte order of this system
+     */
+    bool swapFlag(false);
+    switch (m_zarrayFile->getDataTypeByteOrder()) {
+        case ZarrDataTypeByteOrderEnum::ENDIAN_BIG:
+            swapFlag = ByteOrderEnum::isSystemLittleEndian();
+            break;
+        case ZarrDataTypeByteOrderEnum::ENDIAN_LITTLE:
+            swapFlag = ByteOrderEnum::isSystemBigEndian();
+            break;
+        case ZarrDataTypeByteOrderEnum::NOT_RELEVANT:
+        case ZarrDataTypeByteOrderEnum::UNKNOWN:
+            break;
+    }
+    if (swapFlag
+        && (m_elementSize > 1)) {
+        uint8_t* elementPtr(fullChunk.m_data.data());
+        for (int64_t i = 0; i < numFullElements; i++) {
+            std::reverse(elementPtr,
+                         elementPtr + m_elementSize);
+            elementPtr += m_elementSize;
         }
     }
-    catch (const std::exception& e) {
-        return readDataErrorResult("Exception was thrown by Z5: "
-                                   + AString(e.what()));
+    
+    if (numFullElements == numElements) {
+        chunkOut.m_data.swap(fullChunk.m_data);
     }
+    else {
+        chunkOut.m_data.resize(numElements * m_elementSize);
+        copyChunkToRegion(fullChunk,
+                          chunkOffset,
+                          chunkOffset,
+                          chunkOut.m_shape,
+                          m_elementSize,
+                          chunkOut.m_data.data());
+    }
+    return "";
+}
 
-    CaretAssert(0);
-    return readDataErrorResult("Should never get here");
+/**
+ * Read one chunk using the driver for this reader
+ * @param chunkPosition
+ *    Position of the chunk in the grid of chunks
+ * @param chunkOut
+ *    Output containing the decompressed chunk
+ * @return
+ *    Empty string if successful, else an error message
+ */
+AString
+ZarrImageReader::readChunk(const std::vector<int64_t>& chunkPosition,
+                           ZarrChunkCache::Chunk& chunkOut) const
+{
+    switch (m_driverType) {
+        case ZarrDriverTypeEnum::INVALID:
+            break;
+        case ZarrDriverTypeEnum::LOCAL_FILE:
+            return readLocalFileChunk(chunkPosition,
+                                      chunkOut);
+            break;
+        case ZarrDriverTypeEnum::LOCAL_ZIP_FILE:
+            return readZipFileChunk(chunkPosition,
+                                    chunkOut);
+            break;
+    }
+    return ("Driver type not supported: "
+            + ZarrDriverTypeEnum::toGuiName(m_driverType));
 }
 
+/**
+ * Read data from the chunks that overlap the requested region.  Chunks are taken
+ * from the chunk cache when available, others are decompressed in parallel and
+ * added to the cache.
+ * @param dimOffset
+ *    Starting offset for reading from each of the dimensions
+ * @param dimLengths
+ *    Lengths of data to read from each of the dimensions
+ * @param dataOut
+ *    Output for the data in the native data type
+ * @return
+ *    Result of reading
+ */
+FunctionResult
+ZarrImageReader::readChunks(const std::vector<int64_t>& dimOffsets,
+                            const std::vector<int64_t>& dimLengths,
+                            uint8_t* dataOut)
+{
+    const int32_t numDims(m_shapeSizes.size());
+    CaretAssert(static_cast<int32_t>(m_chunkSizes.size()) == numDims);
+    
+    /*
+     * Find the chunks that overlap the region
+     */
+    std::vector<int64_t> firstChunk(numDims), lastChunk(numDims), chunksPerDim(numDims);
+    for (int32_t d = 0; d < numDims; d++) {
+        chunksPerDim[d] = (m_shapeSizes[d] + m_chunkSizes[d] - 1) / m_chunkSizes[d];
+        firstChunk[d]   = dimOffsets[d] / m_chunkSizes[d];
+        lastChunk[d]    = (dimOffsets[d] + dimLengths[d] - 1) / m_chunkSizes[d];
+    }
+    std::vector<std::vector<int64_t>> chunkPositions;
+    std::vector<int64_t> chunkIndices;
+    std::vector<int64_t> position(firstChunk);
+    while (true) {
+        int64_t chunkIndex(0);
+        for (int32_t d = 0; d < numDims; d++) {
+            chunkIndex = (chunkIndex * chunksPerDim[d]) + position[d];
+        }
+        chunkPositions.push_back(position);
+        chunkIndices.push_back(chunkIndex);
+        
+        int32_t d(numDims - 1);
+        while (d >= 0) {
+            ++position[d];
+            if (position[d] <= lastChunk[d]) {
+                break;
+            }
+            position[d] = firstChunk[d];
+            --d;
+        }
+        if (d < 0) {
+            break;
+        }
+    }
+    
+    /*
+     * Get chunks from the cache
+     */
+    const int64_t numChunks(chunkPositions.size());
+    std::vector<std::shared_ptr<const ZarrChunkCache::Chunk>> chunks(numChunks);
+    std::vector<int64_t> missingChunks;
+    for (int64_t i = 0; i < numChunks; i++) {
+        chunks[i] = ZarrChunkCache::getChunk(m_chunkCacheOwnerIdentifier,
+                                             chunkIndices[i]);
+        if ( ! chunks[i]) {
+            missingChunks.push_back(i);
+        }
+    }
+    
+    /*
+     * Decompress chunks that are not in the cache
+     */
+    const int64_t numMissing(missingChunks.size());
+    std::vector<AString> errorMessages(numMissing);
+#pragma omp CARET_PARFOR schedule(dynamic)
+    for (int64_t m = 0; m < numMissing; m++) {
+        const int64_t i(missingChunks[m]);
+        std::shared_ptr<ZarrChunkCache::Chunk> chunk(new ZarrChunkCache::Chunk());
+        errorMessages[m] = readChunk(chunkPositions[i],
+                                     *chunk);
+        if (errorMessages[m].isEmpty()) {
+            chunks[i] = chunk;
+        }
+    }
+    for (int64_t m = 0; m < numMissing; m++) {
+        if ( ! errorMessages[m].isEmpty()) {
+            return FunctionResult::error(errorMessages[m]);
+        }
+    }
+    for (int64_t m = 0; m < numMissing; m++) {
+        const int64_t i(missingChunks[m]);
+        ZarrChunkCache::addChunk(m_chunkCacheOwnerIdentifier,
+                                 chunkIndices[i],
+                                 chunks[i]);
+    }
+    
+    /*
+     * Copy from the chunks into the output
+     */
+    std::vector<int64_t> chunkOffset(numDims);
+    for (int64_t i = 0; i < numChunks; i++) {
+        CaretAssert(chunks[i]);
+        for (int32_t d = 0; d < numDims; d++) {
+            chunkOffset[d] = chunkPositions[i][d] * m_chunkSizes[d];
+        }
+        copyChunkToRegion(*chunks[i],
+                          chunkOffset,
+                          dimOffsets,
+                          dimLengths,
+                          m_elementSize,
+                          dataOut);
+    }
+    
+    return FunctionResult::ok();
+}
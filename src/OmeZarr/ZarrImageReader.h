@@ -29,16 +29,23 @@
 
 #include <xtensor.hpp>
 
+#include "CaretMutex.h"
 #include "CaretObject.h"
 #include "FunctionResult.h"
+#include "ZarrChunkCache.h"
 #include "ZarrDataTypeEnum.h"
 #include "ZarrDriverTypeEnum.h"
 
+namespace z5 {
+    class Dataset;
+}
+
 namespace caret {
 
     class OmeAttrsV0p4JsonFile;
     class ZarrV2ArrayJsonFile;
     class ZarrV2GroupJsonFile;
+    class ZarrZipStore;
     
     class ZarrImageReader : public CaretObject {
         
@@ -62,6 +69,12 @@ namespace caret {
         FunctionResultValue<xt::xarray<uint8_t>*> readData(const std::vector<int64_t>& dimOffsets,
                                                            const std::vector<int64_t>& dimLengths);
         
+        FunctionResult computeDataRange(double& minimumValueOut,
+                                        double& maximumValueOut);
+        
+        void setDisplayRange(const double minimumValue,
+                             const double maximumValue);
+        
         // ADD_NEW_METHODS_HERE
 
         virtual AString toString() const;
@@ -73,12 +86,40 @@ namespace caret {
             UNINITIALIZED
         };
         
-        void copyHelperZarrImageReader(const ZarrImageReader& obj);
+        FunctionResult checkReadRegion(const std::vector<int64_t>& dimOffsets,
+                                       const std::vector<int64_t>& dimLengths) const;
+        
+        FunctionResult readRegion(const std::vector<int64_t>& dimOffsets,
+                                  const std::vector<int64_t>& dimLengths,
+                                  uint8_t* dataOut);
+        
+        FunctionResult readLocalFile(const AString& zarrPath,
+                                     const AString& relativePath,
+                                     const std::vector<int64_t>& dimOffsets,
+                                     const std::vector<int64_t>& dimLengths,
+                                     uint8_t* dataOut);
 
-        FunctionResultValue<xt::xarray<uint8_t>*> readLocalFile(const AString& zarrPath,
-                                                                const AString& relativePath,
-                                                                const std::vector<int64_t>& dimOffsets,
-                                                                const std::vector<int64_t>& dimLengths);
+        FunctionResult openLocalFileDataSet(const AString& zarrPath,
+                                            const AString& relativePath);
+        
+        AString readLocalFileChunk(const std::vector<int64_t>& chunkPosition,
+                                   ZarrChunkCache::Chunk& chunkOut) const;
+        
+        FunctionResult readZipFile(const AString& zarrPath,
+                                   const AString& relativePath,
+                                   const std::vector<int64_t>& dimOffsets,
+                                   const std::vector<int64_t>& dimLengths,
+                                   uint8_t* dataOut);
+        
+        AString readZipFileChunk(const std::vector<int64_t>& chunkPosition,
+                                 ZarrChunkCache::Chunk& chunkOut) const;
+        
+        AString readChunk(const std::vector<int64_t>& chunkPosition,
+                          ZarrChunkCache::Chunk& chunkOut) const;
+        
+        FunctionResult readChunks(const std::vector<int64_t>& dimOffsets,
+                                  const std::vector<int64_t>& dimLengths,
+                                  uint8_t* dataOut);
 
         FunctionResultValue<xt::xarray<uint8_t>*> readDataErrorResult(const AString& errorMessage);
         
@@ -98,6 +139,34 @@ namespace caret {
         /** data type*/
         ZarrDataTypeEnum::Enum m_dataType;
 
+        /** number of bytes in each element of the data type*/
+        int64_t m_elementSize = 0;
+
+        /** chunk dimensions*/
+        std::vector<int64_t> m_chunkSizes;
+        
+        /** dataset opened by first read and kept open for lifetime of reader */
+        std::unique_ptr<z5::Dataset> m_dataSet;
+        
+        /** zip file containing the dataset, for the zip driver */
+        std::shared_ptr<ZarrZipStore> m_zipStore;
+        
+        /** protects opening of the dataset */
+        CaretMutex m_dataSetMutex;
+        
+        /** values mapped to the display range for data that is not unsigned 8-bit */
+        double m_displayMinimumValue = 0.0;
+        
+        double m_displayMaximumValue = 0.0;
+        
+        bool m_displayRangeValidFlag = false;
+        
+        /** protects the display range */
+        CaretMutex m_displayRangeMutex;
+        
+        /** identifies this reader's chunks in the chunk cache */
+        const int64_t m_chunkCacheOwnerIdentifier;
+
         // ADD_NEW_MEMBERS_HERE
 
     };
@@ -32,6 +32,7 @@
 #include <nlohmann/json.hpp>
 
 #include "CaretAssert.h"
+#include "ZarrZipStore.h"
 
 using namespace caret;
 
@@ -215,27 +216,8 @@ ZarrJsonFileBase::readJsonFromFile(const ZarrDriverTypeEnum::Enum driverType,
                 const char* ptrStart(&jsonCharacters[0]);
                 const char* ptrEnd(&jsonCharacters[jsonCharacters.size()]);
                 
-                try {
-                    const nlohmann::json::parser_callback_t callbackFunction = nullptr;
-                    const bool allowExceptions = true;
-                    nlohmann::json jsonRead = nlohmann::json::parse(ptrStart,
-                                                                    ptrEnd,
-                                                                    callbackFunction,
-                                                                    allowExceptions);
-                    /*
-                     * Success, return the JSON that was read
-                     */
-                    const AString errorMessage("");
-                    const bool okFlag(true);
-                    return FunctionResultValue<nlohmann::json>(jsonRead,
-                                                               errorMessage,
-                                                               okFlag);
-                }
-                catch (const nlohmann::json::parse_error& e)
-                {
-                    return jsonError("Parse error: "
-                                     + AString(e.what()));
-                }
+                return parseJson(ptrStart,
+                                 ptrEnd);
             }
             catch (std::filesystem::filesystem_error& e) {
                 return jsonError("Filesystem error: "
@@ -244,9 +226,73 @@ ZarrJsonFileBase::readJsonFromFile(const ZarrDriverTypeEnum::Enum driverType,
         }
             break;
         case ZarrDriverTypeEnum::LOCAL_ZIP_FILE:
-            return jsonError("Zip files not supported yet.");
+        {
+            FunctionResultValue<std::shared_ptr<ZarrZipStore>> storeResult(ZarrZipStore::getStore(zarrPath));
+            if (storeResult.isError()) {
+                return jsonError(storeResult.getErrorMessage());
+            }
+            std::shared_ptr<ZarrZipStore> zipStore(storeResult.getValue());
+            CaretAssert(zipStore);
+            if ( ! zipStore->hasEntry(jsonFileRelativePath)) {
+                return jsonError("File does not exist in zip file");
+            }
+            
+            std::vector<uint8_t> jsonBytes;
+            const FunctionResult readResult(zipStore->readEntry(jsonFileRelativePath,
+                                                                jsonBytes));
+            if (readResult.isError()) {
+                return jsonError(readResult.getErrorMessage());
+            }
+            if (jsonBytes.empty()) {
+                return jsonError("File is empty (0 bytes).");
+            }
+            
+            const char* ptrStart(reinterpret_cast<const char*>(jsonBytes.data()));
+            const char* ptrEnd(ptrStart + jsonBytes.size());
+            
+            return parseJson(ptrStart,
+                             ptrEnd);
+        }
             break;
     }
+    
+    return jsonError("Driver type for reading JSON is invalid.");
+}
+
+/**
+ * Parse JSON from text
+ * @param ptrStart
+ *    Start of the text
+ * @param ptrEnd
+ *    One past end of the text
+ * @return
+ *    Function result with the JSON or error.
+ */
+FunctionResultValue<nlohmann::json>
+ZarrJsonFileBase::parseJson(const char* ptrStart,
+                            const char* ptrEnd) const
+{
+    try {
+        const nlohmann::json::parser_callback_t callbackFunction = nullptr;
+        const bool allowExceptions = true;
+        nlohmann::json jsonRead = nlohmann::json::parse(ptrStart,
+                                                        ptrEnd,
+                                                        callbackFunction,
+                                                        allowExceptions);
+        /*
+         * Success, return the JSON that was read
+         */
+        const AString errorMessage("");
+        const bool okFlag(true);
+        return FunctionResultValue<nlohmann::json>(jsonRead,
+                                                   errorMessage,
+                                                   okFlag);
+    }
+    catch (const nlohmann::json::parse_error& e)
+    {
+        return jsonError("Parse error: "
+                         + AString(e.what()));
+    }
 }
 
 /**
@@ -78,6 +78,9 @@ namespace caret {
                                                              const AString& zarrPath,
                                                              const AString& jsonFileRelativePath);
         
+        FunctionResultValue<nlohmann::json> parseJson(const char* ptrStart,
+                                                      const char* ptrEnd) const;
+        
         AString m_zarrPath;
         
         std::string m_jsonFilename;
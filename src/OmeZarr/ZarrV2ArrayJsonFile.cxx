@@ -32,6 +32,62 @@
 #include "CaretAssert.h"
 using namespace caret;
 
+namespace {
+    /**
+     * @return Bytes of a fill value converted to a native type
+     * @param fillValueJson
+     *    The fill value, null for zero
+     */
+    template <typename T>
+    std::vector<uint8_t> toFillValueBytes(const nlohmann::json& fillValueJson)
+    {
+        const T value(fillValueJson.is_number()
+                      ? fillValueJson.get<T>()
+                      : T(0));
+        const uint8_t* bytes(reinterpret_cast<const uint8_t*>(&value));
+        return std::vector<uint8_t>(bytes,
+                                    bytes + sizeof(T));
+    }
+    
+    /**
+     * @return Bytes of a fill value in the native data type, empty if data type is unknown.
+     * Integer fill values are converted without passing through floating point.
+     * @param dataType
+     *    The data type
+     * @param fillValueJson
+     *    The fill value, null for zero
+     */
+    std::vector<uint8_t> toFillValueBytes(const ZarrDataTypeEnum::Enum dataType,
+                                          const nlohmann::json& fillValueJson)
+    {
+        switch (dataType) {
+            case ZarrDataTypeEnum::UNKNOWN:
+                break;
+            case ZarrDataTypeEnum::INT_8:
+                return toFillValueBytes<int8_t>(fillValueJson);
+            case ZarrDataTypeEnum::UINT_8:
+                return toFillValueBytes<uint8_t>(fillValueJson);
+            case ZarrDataTypeEnum::INT_16:
+                return toFillValueBytes<int16_t>(fillValueJson);
+            case ZarrDataTypeEnum::UINT_16:
+                return toFillValueBytes<uint16_t>(fillValueJson);
+            case ZarrDataTypeEnum::INT_32:
+                return toFillValueBytes<int32_t>(fillValueJson);
+            case ZarrDataTypeEnum::UINT_32:
+                return toFillValueBytes<uint32_t>(fillValueJson);
+            case ZarrDataTypeEnum::INT_64:
+                return toFillValueBytes<int64_t>(fillValueJson);
+            case ZarrDataTypeEnum::UINT_64:
+                return toFillValueBytes<uint64_t>(fillValueJson);
+            case ZarrDataTypeEnum::FLOAT_32:
+                return toFillValueBytes<float>(fillValueJson);
+            case ZarrDataTypeEnum::FLOAT_64:
+                return toFillValueBytes<double>(fillValueJson);
+        }
+        return std::vector<uint8_t>();
+    }
+}
+
 
     
 /**
@@ -102,6 +158,8 @@ ZarrV2ArrayJsonFile::copyHelperZarrV2ArrayJsonFile(const ZarrV2ArrayJsonFile& ob
     
     m_fillValue = obj.m_fillValue;
     
+    m_fillValueBytes = obj.m_fillValueBytes;
+    
     m_dimensionSeparator = obj.m_dimensionSeparator;
     
     m_dataType  = obj.m_dataType;
@@ -132,6 +190,8 @@ ZarrV2ArrayJsonFile::clear()
     
     m_fillValue = -1;
     
+    m_fillValueBytes.clear();
+    
     m_dimensionSeparator = ZarrDimensionSeparatorEnum::DOT;
     
     m_dataType  = ZarrDataTypeEnum::UNKNOWN;
@@ -227,6 +287,16 @@ ZarrV2ArrayJsonFile::setFillValue(const float fillValue)
     m_fillValue = fillValue;
 }
 
+/**
+ * @return The fill value as one element of the native data type in the byte
+ * order of this system.  Empty if the data type is unknown.
+ */
+const std::vector<uint8_t>&
+ZarrV2ArrayJsonFile::getFillValueBytes() const
+{
+    return m_fillValueBytes;
+}
+
 /**
  * @return The separator for dimensions
  */
@@ -379,6 +449,8 @@ ZarrV2ArrayJsonFile::readContentFromJson(const nlohmann::json& json)
     
     AString errorMessage;
     
+    nlohmann::json fillValueJson;
+    
     for (auto& elem : jsonObject) {
         const std::string key(elem.first);
 
@@ -595,7 +667,7 @@ ZarrV2ArrayJsonFile::readContentFromJson(const nlohmann::json& json)
             }
             else if (elem.second.is_number()) {
                 setFillValue(elem.second.get<float>());
-                
+                fillValueJson = elem.second;
             }
             else if (elem.second.is_string()) {
                 const std::string fillString(elem.second);
@@ -664,6 +736,12 @@ ZarrV2ArrayJsonFile::readContentFromJson(const nlohmann::json& json)
         }
     }
 
+    /*
+     * Data type may follow fill value in the JSON
+     */
+    m_fillValueBytes = toFillValueBytes(getDataType(),
+                                        fillValueJson);
+    
     const bool debugFlag(false);
     if (debugFlag) {
         std::cout << ".zarray content: " << std::endl;
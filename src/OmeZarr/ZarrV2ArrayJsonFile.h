@@ -62,6 +62,8 @@ namespace caret {
         
         void setFillValue(const float fillValue);
         
+        const std::vector<uint8_t>& getFillValueBytes() const;
+        
         ZarrDimensionSeparatorEnum::Enum getDimensionSeparator() const;
         
         void setDimensionSeparator(const ZarrDimensionSeparatorEnum::Enum dimensionSeparator);
@@ -107,6 +109,9 @@ namespace caret {
         
         float m_fillValue = -1;
         
+        /** fill value as one element of the native data type in byte order of this system */
+        std::vector<uint8_t> m_fillValueBytes;
+        
         ZarrDimensionSeparatorEnum::Enum m_dimensionSeparator = ZarrDimensionSeparatorEnum::DOT;
         
         ZarrDataTypeEnum::Enum m_dataType = ZarrDataTypeEnum::UNKNOWN;
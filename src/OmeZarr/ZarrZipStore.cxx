@@ -0,0 +1,385 @@
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026 Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#define __ZARR_ZIP_STORE_DECLARE__
+#include "ZarrZipStore.h"
+#undef __ZARR_ZIP_STORE_DECLARE__
+
+#include <algorithm>
+
+#include <QDateTime>
+#include <QFileInfo>
+
+#include "quazip.h"
+#include "quazipfileinfo.h"
+
+#include "CaretAssert.h"
+
+using namespace caret;
+
+namespace
+{
+    /** stores of files that are no longer in use are removed when this is exceeded */
+    const int32_t MAX_CACHED_STORES = 4;
+
+    class StoreCacheEntry {
+    public:
+        AString m_path;
+        int64_t m_size;
+        QDateTime m_modified;
+        /** weak so that a store, and its open zip files, is destroyed when no longer used */
+        std::weak_ptr<ZarrZipStore> m_store;
+    };
+
+    CaretMutex s_storeCacheMutex;
+
+    /** most recently used at the back */
+    std::vector<StoreCacheEntry> s_storeCache;
+}
+
+/**
+ * \class caret::ZarrZipStore
+ * \brief Read-only access to a ZARR stored in a zip file
+ * \ingroup OmeZarr
+ *
+ * The zip file's central directory is indexed once when the store is
+ * created.  Entries (JSON files and chunks) are then read by seeking
+ * directly to them in the zip file, without extracting the zip file to disk.
+ * Reading is safe from multiple threads, each thread uses its own open
+ * copy of the zip file.
+ */
+
+/**
+ * Constructor.
+ * @param zipFileName
+ *    Name of the zip file
+ */
+ZarrZipStore::ZarrZipStore(const AString& zipFileName)
+: CaretObject(),
+m_zipFileName(zipFileName)
+{
+
+}
+
+/**
+ * Destructor.  Closes the zip files opened for reading by threads.
+ */
+ZarrZipStore::~ZarrZipStore()
+{
+    CaretMutexLocker locker(&m_availableZipsMutex);
+    for (auto& zip : m_availableZips) {
+        zip->close();
+    }
+    m_availableZips.clear();
+}
+
+/**
+ * Get the store for a zip file.  Stores are shared by all users of the same unmodified zip file
+ * and are destroyed, closing the zip file, when the last user releases the store.
+ * @param zipFileName
+ *    Name of the zip file
+ * @return
+ *    Result containing the store or an error
+ */
+FunctionResultValue<std::shared_ptr<ZarrZipStore>>
+ZarrZipStore::getStore(const AString& zipFileName)
+{
+    const QFileInfo fileInfo(zipFileName);
+    if ( ! fileInfo.exists()) {
+        return FunctionResultValue<std::shared_ptr<ZarrZipStore>>(std::shared_ptr<ZarrZipStore>(),
+                                                                  ("Zip file does not exist: " + zipFileName),
+                                                                  false);
+    }
+    const AString path(fileInfo.absoluteFilePath());
+    const int64_t size(fileInfo.size());
+    const QDateTime modified(fileInfo.lastModified());
+
+    CaretMutexLocker locker(&s_storeCacheMutex);
+    for (int32_t i = 0; i < static_cast<int32_t>(s_storeCache.size()); i++) {
+        if ((s_storeCache[i].m_path == path)
+            && (s_storeCache[i].m_size == size)
+            && (s_storeCache[i].m_modified == modified)) {
+            const StoreCacheEntry found(s_storeCache[i]);
+            s_storeCache.erase(s_storeCache.begin() + i);
+            std::shared_ptr<ZarrZipStore> foundStore(found.m_store.lock());
+            if (foundStore) {
+                s_storeCache.push_back(found);
+                return FunctionResultValue<std::shared_ptr<ZarrZipStore>>(foundStore);
+            }
+            --i;
+            continue;
+        }
+        if ((s_storeCache[i].m_path == path)
+            || s_storeCache[i].m_store.expired()) {
+            /*
+             * File changed, old index is useless, or store is no longer used
+             */
+            s_storeCache.erase(s_storeCache.begin() + i);
+            --i;
+        }
+    }
+
+    std::shared_ptr<ZarrZipStore> store(new ZarrZipStore(path));
+    const FunctionResult indexResult(store->indexEntries());
+    if (indexResult.isError()) {
+        return FunctionResultValue<std::shared_ptr<ZarrZipStore>>(std::shared_ptr<ZarrZipStore>(),
+                                                                  indexResult.getErrorMessage(),
+                                                                  false);
+    }
+
+    StoreCacheEntry newEntry;
+    newEntry.m_path     = path;
+    newEntry.m_size     = size;
+    newEntry.m_modified = modified;
+    newEntry.m_store    = store;
+    s_storeCache.push_back(newEntry);
+    if (static_cast<int32_t>(s_storeCache.size()) > MAX_CACHED_STORES) {
+        /*
+         * Anything still using it keeps its own reference
+         */
+        s_storeCache.erase(s_storeCache.begin());
+    }
+
+    return FunctionResultValue<std::shared_ptr<ZarrZipStore>>(store);
+}
+
+/**
+ * @return Name of the zip file
+ */
+AString
+ZarrZipStore::getZipFileName() const
+{
+    return m_zipFileName;
+}
+
+/**
+ * Read the zip file's central directory and record the location of each entry.
+ * The ZARR root is the shallowest directory containing a .zgroup file so that
+ * zip files containing the top level '.ome.zarr' directory are also supported.
+ * @return
+ *    Result of indexing
+ */
+FunctionResult
+ZarrZipStore::indexEntries()
+{
+    AString errorMessage;
+    QuaZip* zip(acquireZip(errorMessage));
+    if (zip == NULL) {
+        return FunctionResult::error(errorMessage);
+    }
+
+    std::map<AString, Entry> allEntries;
+    unzFile unz(zip->getUnzFile());
+    for (bool moreFlag = zip->goToFirstFile(); moreFlag; moreFlag = zip->goToNextFile()) {
+        QuaZipFileInfo64 info;
+        if ( ! zip->getCurrentFileInfo(&info)) {
+            errorMessage = ("Unable to get information for entry in zip file: " + m_zipFileName);
+            break;
+        }
+        if (info.name.endsWith('/')) {
+            continue;
+        }
+        Entry entry;
+        entry.m_centralDirectoryOffset = unzGetOffset64(unz);
+        entry.m_uncompressedSize       = info.uncompressedSize;
+        allEntries.insert(std::make_pair(AString(info.name),
+                                         entry));
+    }
+    if (errorMessage.isEmpty()
+        && (zip->getZipError() != UNZ_OK)) {
+        errorMessage = ("Error reading central directory of zip file: "
+                        + m_zipFileName
+                        + " code="
+                        + AString::number(zip->getZipError()));
+    }
+    releaseZip(zip);
+    if ( ! errorMessage.isEmpty()) {
+        return FunctionResult::error(errorMessage);
+    }
+
+    const AString groupName(".zgroup");
+    bool foundRootFlag(false);
+    for (const auto& nameEntry : allEntries) {
+        const AString& name(nameEntry.first);
+        if (name.endsWith(groupName)) {
+            const AString prefix(name.left(name.length() - groupName.length()));
+            if (prefix.isEmpty()
+                || prefix.endsWith('/')) {
+                if (( ! foundRootFlag)
+                    || (prefix.length() < m_rootPrefix.length())) {
+                    m_rootPrefix  = prefix;
+                    foundRootFlag = true;
+                }
+            }
+        }
+    }
+    if ( ! foundRootFlag) {
+        return FunctionResult::error("Zip file does not contain a ZARR (no .zgroup file): "
+                                     + m_zipFileName);
+    }
+
+    for (const auto& nameEntry : allEntries) {
+        if (nameEntry.first.startsWith(m_rootPrefix)) {
+            m_entries.insert(std::make_pair(nameEntry.first.mid(m_rootPrefix.length()),
+                                            nameEntry.second));
+        }
+    }
+
+    return FunctionResult::ok();
+}
+
+/**
+ * @return True if the store contains an entry at the given path
+ * @param relativePath
+ *    Path relative to the ZARR root
+ */
+bool
+ZarrZipStore::hasEntry(const AString& relativePath) const
+{
+    return (m_entries.find(relativePath) != m_entries.end());
+}
+
+/**
+ * Read and decompress (if the zip entry is compressed) an entry.  Safe to
+ * call from multiple threads.
+ * @param relativePath
+ *    Path relative to the ZARR root
+ * @param dataOut
+ *    Output containing the content of the entry
+ * @return
+ *    Result of reading
+ */
+FunctionResult
+ZarrZipStore::readEntry(const AString& relativePath,
+                        std::vector<uint8_t>& dataOut)
+{
+    const auto iter(m_entries.find(relativePath));
+    if (iter == m_entries.end()) {
+        return FunctionResult::error("Entry "
+                                     + relativePath
+                                     + " not found in zip file "
+                                     + m_zipFileName);
+    }
+    const Entry& entry(iter->second);
+
+    AString errorMessage;
+    QuaZip* zip(acquireZip(errorMessage));
+    if (zip == NULL) {
+        return FunctionResult::error(errorMessage);
+    }
+
+    unzFile unz(zip->getUnzFile());
+    if (unzSetOffset64(unz, entry.m_centralDirectoryOffset) != UNZ_OK) {
+        errorMessage = "Unable to seek to entry ";
+    }
+    else if (unzOpenCurrentFile(unz) != UNZ_OK) {
+        errorMessage = "Unable to open entry ";
+    }
+    else {
+        dataOut.resize(entry.m_uncompressedSize);
+        const uint64_t maxReadSize(1 << 30);
+        uint64_t numRead(0);
+        while (numRead < entry.m_uncompressedSize) {
+            const unsigned readSize(std::min(entry.m_uncompressedSize - numRead,
+                                             maxReadSize));
+            const int result(unzReadCurrentFile(unz,
+                                                dataOut.data() + numRead,
+                                                readSize));
+            if (result <= 0) {
+                errorMessage = "Error reading entry ";
+                break;
+            }
+            numRead += result;
+        }
+        if ((unzCloseCurrentFile(unz) != UNZ_OK)
+            && errorMessage.isEmpty()) {
+            errorMessage = "CRC error reading entry ";
+        }
+    }
+
+    releaseZip(zip);
+
+    if ( ! errorMessage.isEmpty()) {
+        return FunctionResult::error(errorMessage
+                                     + relativePath
+                                     + " in zip file "
+                                     + m_zipFileName);
+    }
+    return FunctionResult::ok();
+}
+
+/**
+ * Get an open zip file for exclusive use by the calling thread.  Must be
+ * returned with releaseZip().
+ * @param errorMessageOut
+ *    Contains error message if the zip file cannot be opened
+ * @return
+ *    Pointer to open zip file or NULL if error
+ */
+QuaZip*
+ZarrZipStore::acquireZip(AString& errorMessageOut)
+{
+    {
+        CaretMutexLocker locker(&m_availableZipsMutex);
+        if ( ! m_availableZips.empty()) {
+            QuaZip* zip(m_availableZips.back().release());
+            m_availableZips.pop_back();
+            return zip;
+        }
+    }
+
+    std::unique_ptr<QuaZip> zip(new QuaZip(m_zipFileName));
+    if ( ! zip->open(QuaZip::mdUnzip)) {
+        errorMessageOut = ("Unable to open zip file: "
+                           + m_zipFileName
+                           + " code="
+                           + AString::number(zip->getZipError()));
+        return NULL;
+    }
+    return zip.release();
+}
+
+/**
+ * Return a zip file obtained with acquireZip() so that it may be used by other threads
+ * @param zip
+ *    The zip file
+ */
+void
+ZarrZipStore::releaseZip(QuaZip* zip)
+{
+    CaretAssert(zip);
+    CaretMutexLocker locker(&m_availableZipsMutex);
+    m_availableZips.push_back(std::unique_ptr<QuaZip>(zip));
+}
+
+/**
+ * Get a description of this object's content.
+ * @return String describing this object's content.
+ */
+AString
+ZarrZipStore::toString() const
+{
+    AString txt("ZarrZipStore");
+    txt.appendWithNewLine("   Zip File: " + m_zipFileName);
+    txt.appendWithNewLine("   Root: " + m_rootPrefix);
+    txt.appendWithNewLine("   Entries: " + AString::number(m_entries.size()));
+    return txt;
+}
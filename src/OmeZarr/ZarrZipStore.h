@@ -0,0 +1,100 @@
+#ifndef __ZARR_ZIP_STORE_H__
+#define __ZARR_ZIP_STORE_H__
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026 Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+
+
+#include <cinttypes>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "CaretMutex.h"
+#include "CaretObject.h"
+#include "FunctionResult.h"
+
+class QuaZip;
+
+namespace caret {
+
+    class ZarrZipStore : public CaretObject {
+
+    public:
+        virtual ~ZarrZipStore();
+
+        ZarrZipStore(const ZarrZipStore&) = delete;
+
+        ZarrZipStore& operator=(const ZarrZipStore&) = delete;
+
+        static FunctionResultValue<std::shared_ptr<ZarrZipStore>> getStore(const AString& zipFileName);
+
+        AString getZipFileName() const;
+
+        bool hasEntry(const AString& relativePath) const;
+
+        FunctionResult readEntry(const AString& relativePath,
+                                 std::vector<uint8_t>& dataOut);
+
+        // ADD_NEW_METHODS_HERE
+
+        virtual AString toString() const;
+
+    private:
+        /** Location of an entry in the zip file's central directory */
+        class Entry {
+        public:
+            uint64_t m_centralDirectoryOffset;
+
+            uint64_t m_uncompressedSize;
+        };
+
+        ZarrZipStore(const AString& zipFileName);
+
+        FunctionResult indexEntries();
+
+        QuaZip* acquireZip(AString& errorMessageOut);
+
+        void releaseZip(QuaZip* zip);
+
+        const AString m_zipFileName;
+
+        /** Path of the ZARR root within the zip file, empty or ends with '/' */
+        AString m_rootPrefix;
+
+        /** Entries indexed by path, does not include the root prefix */
+        std::map<AString, Entry> m_entries;
+
+        /** Open zip files not in use by a thread, so each thread has its own unzip state */
+        std::vector<std::unique_ptr<QuaZip>> m_availableZips;
+
+        CaretMutex m_availableZipsMutex;
+
+        // ADD_NEW_MEMBERS_HERE
+
+    };
+
+#ifdef __ZARR_ZIP_STORE_DECLARE__
+    // <PLACE DECLARATIONS OF STATIC MEMBERS HERE>
+#endif // __ZARR_ZIP_STORE_DECLARE__
+
+} // namespace
+#endif  //__ZARR_ZIP_STORE_H__
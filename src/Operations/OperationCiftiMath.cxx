@@ -22,17 +22,248 @@
 #include "OperationException.h"
 
 #include "CaretAssert.h"
+#include "CaretBlockingQueue.h"
 #include "CaretLogger.h"
 #include "CaretMathExpression.h"
+#include "CaretOMP.h"
 #include "CiftiFile.h"
 #include "CiftiXML.h"
 #include "MultiDimIterator.h"
 
+#include <algorithm>
+#include <cstring>
+#include <exception>
 #include <iostream>
+#include <thread>
 
 using namespace caret;
 using namespace std;
 
+namespace
+{
+    //reading, evaluating, and writing blocks of rows each get their own thread, so that large on-disk inputs are limited by the slowest step instead of the sum
+    class CiftiMathPipeline
+    {
+        struct InputBlock
+        {
+            vector<vector<float> > m_varData;//one output row length per row, so each variable is contiguous across the block
+            vector<vector<int64_t> > m_rowIndices;
+        };
+        struct OutputBlock
+        {
+            vector<float> m_data;
+            vector<vector<int64_t> > m_rowIndices;
+        };
+        const CaretMathExpression& m_expr;
+        const vector<CiftiFile*>& m_varFiles;
+        const vector<vector<int64_t> >& m_selectInfo;
+        const vector<int64_t>& m_outDims;
+        CiftiFile* m_outFile;
+        bool m_nanfix;
+        float m_nanfixval;
+        int64_t m_rowLength, m_blockRows;
+        vector<InputBlock> m_inputBlocks;
+        vector<OutputBlock> m_outputBlocks;
+        CaretBlockingQueue<int> m_freeInputs, m_filledInputs, m_freeOutputs, m_filledOutputs;
+        exception_ptr m_readException, m_evalException, m_writeException;
+        void readBlocks();
+        void evaluateBlocks();
+        void writeBlocks();
+        void abortAll();
+    public:
+        CiftiMathPipeline(const CaretMathExpression& expr, const vector<CiftiFile*>& varFiles, const vector<vector<int64_t> >& selectInfo,
+                          const vector<int64_t>& outDims, CiftiFile* outFile, const bool& nanfix, const float& nanfixval);
+        void run();
+    };
+    
+    CiftiMathPipeline::CiftiMathPipeline(const CaretMathExpression& expr, const vector<CiftiFile*>& varFiles, const vector<vector<int64_t> >& selectInfo,
+                                         const vector<int64_t>& outDims, CiftiFile* outFile, const bool& nanfix, const float& nanfixval) :
+                                         m_expr(expr), m_varFiles(varFiles), m_selectInfo(selectInfo), m_outDims(outDims)
+    {
+        const int NUM_BLOCKS = 3;//one being read, one being evaluated, one being written
+        const int64_t BLOCK_BYTES = 1<<23;//8MiB per variable per block, large enough to amortize handoffs, small enough to not matter next to the files
+        m_outFile = outFile;
+        m_nanfix = nanfix;
+        m_nanfixval = nanfixval;
+        m_rowLength = outDims[0];
+        int64_t numRows = 1;
+        for (int i = 1; i < (int)outDims.size(); ++i)
+        {
+            numRows *= outDims[i];
+        }
+        m_blockRows = max(int64_t(1), min(numRows, BLOCK_BYTES / int64_t(m_rowLength * sizeof(float))));
+        m_inputBlocks.resize(NUM_BLOCKS);
+        m_outputBlocks.resize(NUM_BLOCKS);
+        for (int i = 0; i < NUM_BLOCKS; ++i)
+        {
+            m_inputBlocks[i].m_varData.resize(varFiles.size(), vector<float>(m_blockRows * m_rowLength));
+            m_outputBlocks[i].m_data.resize(m_blockRows * m_rowLength);
+            m_freeInputs.push(i);
+            m_freeOutputs.push(i);
+        }
+    }
+    
+    void CiftiMathPipeline::run()
+    {//reading stays on the calling thread, in case an input needs the main thread (xnat)
+        thread evalThread(&CiftiMathPipeline::evaluateBlocks, this);
+        thread writeThread(&CiftiMathPipeline::writeBlocks, this);
+        try
+        {
+            readBlocks();
+        } catch (...) {
+            m_readException = current_exception();
+            abortAll();
+        }
+        m_filledInputs.close();
+        evalThread.join();
+        writeThread.join();
+        if (m_readException) rethrow_exception(m_readException);
+        if (m_evalException) rethrow_exception(m_evalException);
+        if (m_writeException) rethrow_exception(m_writeException);
+    }
+    
+    void CiftiMathPipeline::abortAll()
+    {
+        m_freeInputs.abort();
+        m_filledInputs.abort();
+        m_freeOutputs.abort();
+        m_filledOutputs.abort();
+    }
+    
+    void CiftiMathPipeline::readBlocks()
+    {
+        int numVars = (int)m_varFiles.size();
+        vector<vector<float> > inputRows(numVars);//for select along row, and to carry the last row of each variable into the next block
+        vector<vector<int64_t> > loadedRow(numVars);//to detect and prevent rereading the same row
+        for (int v = 0; v < numVars; ++v)
+        {
+            inputRows[v].resize(m_varFiles[v]->getCiftiXML().getDimensionLength(CiftiXML::ALONG_ROW));
+            loadedRow[v].resize(m_varFiles[v]->getCiftiXML().getNumberOfDimensions() - 1, -1);//we always load a full row, so ignore first dim
+        }
+        MultiDimIterator<int64_t> iter(vector<int64_t>(m_outDims.begin() + 1, m_outDims.end()));
+        while (!iter.atEnd())
+        {
+            int slot = -1;
+            if (!m_freeInputs.pop(slot)) return;//another thread had an error
+            InputBlock& myBlock = m_inputBlocks[slot];
+            myBlock.m_rowIndices.clear();
+            for (int64_t r = 0; r < m_blockRows && !iter.atEnd(); ++r, ++iter)
+            {
+                myBlock.m_rowIndices.push_back(*iter);
+                for (int v = 0; v < numVars; ++v)//first, retrieve whichever rows are needed
+                {
+                    bool needToLoad = false;
+                    for (int dim = 0; dim < (int)loadedRow[v].size(); ++dim)
+                    {
+                        int64_t indexNeeded = -1;
+                        if (m_selectInfo[v][dim + 1] == -1)
+                        {
+                            CaretAssert(dim + 1 < (int)m_outDims.size());//"match to output index" can't work past output dimensionality
+                            indexNeeded = (*iter)[dim];//NOTE: iter also doesn't include the first dim
+                        } else {
+                            indexNeeded = m_selectInfo[v][dim + 1];
+                        }
+                        if (indexNeeded != loadedRow[v][dim])
+                        {
+                            needToLoad = true;
+                            loadedRow[v][dim] = indexNeeded;
+                        }
+                    }
+                    float* dest = myBlock.m_varData[v].data() + r * m_rowLength;
+                    if (m_selectInfo[v][0] == -1)//now we check for select along row
+                    {
+                        if (needToLoad)
+                        {
+                            m_varFiles[v]->getRow(dest, loadedRow[v]);
+                        } else if (r > 0) {//same row as the previous one in this block
+                            memcpy(dest, dest - m_rowLength, m_rowLength * sizeof(float));
+                        } else {
+                            memcpy(dest, inputRows[v].data(), m_rowLength * sizeof(float));
+                        }
+                    } else {//repeat the selected element along the row, so evaluation can treat it like any other variable
+                        if (needToLoad)
+                        {
+                            m_varFiles[v]->getRow(inputRows[v].data(), loadedRow[v]);
+                        }
+                        fill(dest, dest + m_rowLength, inputRows[v][m_selectInfo[v][0]]);
+                    }
+                }
+            }
+            int64_t lastRow = (int64_t)myBlock.m_rowIndices.size() - 1;
+            for (int v = 0; v < numVars; ++v)
+            {
+                if (m_selectInfo[v][0] == -1)
+                {
+                    memcpy(inputRows[v].data(), myBlock.m_varData[v].data() + lastRow * m_rowLength, m_rowLength * sizeof(float));
+                }
+            }
+            if (!m_filledInputs.push(slot)) return;
+        }
+    }
+    
+    void CiftiMathPipeline::evaluateBlocks()
+    {
+        const int64_t CHUNK_SIZE = 4096;//elements per parallel task, evaluateBlock does its own smaller blocking
+        int numVars = (int)m_varFiles.size();
+        try
+        {
+            int inSlot = -1, outSlot = -1;
+            while (m_filledInputs.pop(inSlot))
+            {
+                if (!m_freeOutputs.pop(outSlot)) break;
+                InputBlock& inBlock = m_inputBlocks[inSlot];
+                OutputBlock& outBlock = m_outputBlocks[outSlot];
+                int64_t numElems = (int64_t)inBlock.m_rowIndices.size() * m_rowLength;
+#pragma omp CARET_PARFOR schedule(dynamic)
+                for (int64_t start = 0; start < numElems; start += CHUNK_SIZE)
+                {
+                    int64_t thisCount = min(CHUNK_SIZE, numElems - start);
+                    vector<const float*> chunkPointers(numVars);
+                    for (int v = 0; v < numVars; ++v)
+                    {
+                        chunkPointers[v] = inBlock.m_varData[v].data() + start;
+                    }
+                    m_expr.evaluateBlock(chunkPointers, outBlock.m_data.data() + start, thisCount);
+                    if (m_nanfix)
+                    {
+                        for (int64_t i = start; i < start + thisCount; ++i)
+                        {
+                            if (outBlock.m_data[i] != outBlock.m_data[i]) outBlock.m_data[i] = m_nanfixval;
+                        }
+                    }
+                }
+                outBlock.m_rowIndices.swap(inBlock.m_rowIndices);
+                if (!m_freeInputs.push(inSlot)) break;
+                if (!m_filledOutputs.push(outSlot)) break;
+            }
+        } catch (...) {
+            m_evalException = current_exception();
+            abortAll();
+        }
+        m_filledOutputs.close();
+    }
+    
+    void CiftiMathPipeline::writeBlocks()
+    {
+        try
+        {
+            int slot = -1;
+            while (m_filledOutputs.pop(slot))
+            {
+                OutputBlock& myBlock = m_outputBlocks[slot];
+                for (int64_t r = 0; r < (int64_t)myBlock.m_rowIndices.size(); ++r)
+                {
+                    m_outFile->setRow(myBlock.m_data.data() + r * m_rowLength, myBlock.m_rowIndices[r]);
+                }
+                if (!m_freeOutputs.push(slot)) break;
+            }
+        } catch (...) {
+            m_writeException = current_exception();
+            abortAll();
+        }
+    }
+}
+
 AString OperationCiftiMath::getCommandSwitch()
 {
     return "-cifti-math";
@@ -267,57 +498,6 @@ void OperationCiftiMath::useParameters(OperationParameters* myParams, ProgressOb
     }
     if (outXML.getNumberOfDimensions() < 1) throw OperationException("output must have at least 1 dimension");
     myCiftiOut->setCiftiXML(outXML);
-    vector<float> values(numVars), scratchRow(outDims[0]);
-    vector<vector<float> > inputRows(numVars);
-    vector<vector<int64_t> > loadedRow(numVars);//to detect and prevent rereading the same row
-    for (int v = 0; v < numVars; ++v)
-    {
-        inputRows[v].resize(varCiftiFiles[v]->getCiftiXML().getDimensionLength(CiftiXML::ALONG_ROW));
-        loadedRow[v].resize(varCiftiFiles[v]->getCiftiXML().getNumberOfDimensions() - 1, -1);//we always load a full row, so ignore first dim
-    }
-    for (MultiDimIterator<int64_t> iter(vector<int64_t>(outDims.begin() + 1, outDims.end())); !iter.atEnd(); ++iter)
-    {
-        for (int v = 0; v < numVars; ++v)//first, retrieve whichever rows are needed
-        {
-            bool needToLoad = false;
-            for (int dim = 0; dim < (int)loadedRow[v].size(); ++dim)
-            {
-                int64_t indexNeeded = -1;
-                if (selectInfo[v][dim + 1] == -1)
-                {
-                    CaretAssert(dim + 1 < (int)outDims.size());//"match to output index" can't work past output dimensionality
-                    indexNeeded = (*iter)[dim];//NOTE: iter also doesn't include the first dim
-                } else {
-                    indexNeeded = selectInfo[v][dim + 1];
-                }
-                if (indexNeeded != loadedRow[v][dim])
-                {
-                    needToLoad = true;
-                    loadedRow[v][dim] = indexNeeded;
-                }
-            }
-            if (needToLoad)
-            {
-                varCiftiFiles[v]->getRow(inputRows[v].data(), loadedRow[v]);
-            }
-        }
-        for (int j = 0; j < outDims[0]; ++j)
-        {
-            for (int v = 0; v < numVars; ++v)//now we check for select along row
-            {
-                if (selectInfo[v][0] == -1)
-                {
-                    values[v] = inputRows[v][j];
-                } else {
-                    values[v] = inputRows[v][selectInfo[v][0]];
-                }
-            }
-            scratchRow[j] = (float)myExpr.evaluate(values);
-            if (nanfix && scratchRow[j] != scratchRow[j])
-            {
-                scratchRow[j] = nanfixval;
-            }
-        }
-        myCiftiOut->setRow(scratchRow.data(), *iter);
-    }
+    CiftiMathPipeline myPipeline(myExpr, varCiftiFiles, selectInfo, outDims, myCiftiOut, nanfix, nanfixval);
+    myPipeline.run();
 }
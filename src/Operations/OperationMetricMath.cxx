@@ -24,8 +24,10 @@
 #include "CaretAssert.h"
 #include "CaretLogger.h"
 #include "CaretMathExpression.h"
+#include "CaretOMP.h"
 #include "MetricFile.h"
 
+#include <algorithm>
 #include <iostream>
 
 using namespace caret;
@@ -181,7 +183,8 @@ void OperationMetricMath::useParameters(OperationParameters* myParams, ProgressO
     {
         throw OperationException("all -var options used -repeat, there is no file to get number of desired output columns from");
     }
-    vector<float> values(numVars), colScratch(numNodes);
+    const int64_t CHUNK_SIZE = 4096;//elements per parallel task, evaluateBlock does its own smaller blocking
+    vector<float> colScratch(numNodes);
     vector<const float*> columnPointers(numVars);
     myMetricOut->setNumberOfNodesAndColumns(numNodes, numColumns);
     myMetricOut->setStructure(myStructure);
@@ -197,16 +200,22 @@ void OperationMetricMath::useParameters(OperationParameters* myParams, ProgressO
                 columnPointers[v] = varMetrics[v]->getValuePointerForColumn(metricColumns[v]);
             }
         }
-        for (int i = 0; i < numNodes; ++i)
+#pragma omp CARET_PARFOR schedule(dynamic)
+        for (int64_t start = 0; start < numNodes; start += CHUNK_SIZE)
         {
+            int64_t thisCount = min(CHUNK_SIZE, numNodes - start);
+            vector<const float*> chunkPointers(numVars);
             for (int v = 0; v < numVars; ++v)
             {
-                values[v] = columnPointers[v][i];
+                chunkPointers[v] = columnPointers[v] + start;
             }
-            colScratch[i] = (float)myExpr.evaluate(values);
-            if (nanfix && colScratch[i] != colScratch[i])
+            myExpr.evaluateBlock(chunkPointers, colScratch.data() + start, thisCount);
+            if (nanfix)
             {
-                colScratch[i] = nanfixval;
+                for (int64_t i = start; i < start + thisCount; ++i)
+                {
+                    if (colScratch[i] != colScratch[i]) colScratch[i] = nanfixval;
+                }
             }
         }
         myMetricOut->setValuesForColumn(j, colScratch.data());
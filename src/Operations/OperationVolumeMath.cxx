@@ -24,8 +24,10 @@
 #include "CaretAssert.h"
 #include "CaretLogger.h"
 #include "CaretMathExpression.h"
+#include "CaretOMP.h"
 #include "VolumeFile.h"
 
+#include <algorithm>
 #include <iostream>
 
 using namespace caret;
@@ -200,7 +202,8 @@ void OperationVolumeMath::useParameters(OperationParameters* myParams, ProgressO
         throw OperationException("all -var options used -repeat, there is no file to get number of desired output subvolumes from");
     }
     int64_t frameSize = outDims[0] * outDims[1] * outDims[2];
-    vector<float> values(numVars), outFrame(frameSize);
+    const int64_t CHUNK_SIZE = 4096;//elements per parallel task, evaluateBlock does its own smaller blocking
+    vector<float> outFrame(frameSize);
     vector<const float*> inputFrames(numVars);
     if (toClone != NULL)
     {//don't take volume type from the selected volume, because we don't check for or copy label tables, nor do we want to (might be changing all the label keys, splitting label by roi...)
@@ -220,18 +223,23 @@ void OperationVolumeMath::useParameters(OperationParameters* myParams, ProgressO
                 inputFrames[v] = varVolumes[v]->getFrame(varSubvolumes[v]);
             }
         }
-        for (int64_t i = 0; i < frameSize; ++i)
+#pragma omp CARET_PARFOR schedule(dynamic)
+        for (int64_t start = 0; start < frameSize; start += CHUNK_SIZE)
         {
+            int64_t thisCount = min(CHUNK_SIZE, frameSize - start);
+            vector<const float*> chunkPointers(numVars);
             for (int v = 0; v < numVars; ++v)
             {
-                values[v] = inputFrames[v][i];
+                chunkPointers[v] = inputFrames[v] + start;
             }
-            float tempf = (float)myExpr.evaluate(values);
-            if (nanfix && tempf != tempf)
+            myExpr.evaluateBlock(chunkPointers, outFrame.data() + start, thisCount);
+            if (nanfix)
             {
-                tempf = nanfixval;
+                for (int64_t i = start; i < start + thisCount; ++i)
+                {
+                    if (outFrame[i] != outFrame[i]) outFrame[i] = nanfixval;
+                }
             }
-            outFrame[i] = tempf;
         }
         myVolOut->setFrame(outFrame.data(), s);
     }
@@ -39,6 +39,7 @@ namespace caret {
         bool m_volumeScale = false, m_ciftiScale = false;
         float m_volumeMin = -1.0f, m_volumeMax = -1.0f;//these values won't get used, but don't leave them uninitialized
         float m_ciftiMin = -1.0f, m_ciftiMax = -1.0f;
+        AString m_smoothingWeightCacheDirectory;//-smoothing-weight-cache, empty means surface smoothing weights are always computed and never saved
         
         void applyOptions(CiftiFile* output)
         {
@@ -408,6 +408,20 @@ Palette::getPaletteColor(
     }
 }
 
+/**
+ * @return Scalars of the palette's control points, the color changes or
+ * starts interpolating to a different color at each of them.
+ */
+std::vector<float>
+Palette::getColorBreakpointScalars() const
+{
+    std::vector<float> scalars;
+    for (const PaletteScalarAndColor* psac : this->paletteScalars) {
+        scalars.push_back(psac->getScalar());
+    }
+    return scalars;
+}
+
 /**
  * Set this object has been modified.
  *
@@ -416,6 +430,7 @@ void
 Palette::setModified()
 {
     this->modifiedFlag = true;
+    invalidateLookupTables();
 }
 
 /**
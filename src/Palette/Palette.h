@@ -101,6 +101,8 @@ namespace caret {
                                      const bool interpolateColorFlag,
                                      float rgbaOut[4]) const override;
 
+        virtual std::vector<float> getColorBreakpointScalars() const override;
+        
         void setModified();
         
         void clearModified();
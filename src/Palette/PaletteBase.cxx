@@ -24,6 +24,7 @@
 #undef __PALETTE_BASE_DECLARE__
 
 #include "CaretAssert.h"
+#include "PaletteLookupTable.h"
 using namespace caret;
 
 
@@ -98,7 +99,43 @@ PaletteBase::operator=(const PaletteBase& obj)
 void 
 PaletteBase::copyHelperPaletteBase(const PaletteBase& /*obj*/)
 {
+    /* lookup tables refer to the palette that created them so they are not copied */
+    invalidateLookupTables();
+}
+
+/**
+ * Get a lookup table for quickly coloring many normalized values with this
+ * palette.  The table is created the first time it is requested and is
+ * replaced after the palette is modified.
+ *
+ * @param interpolateColorFlag
+ *    Interpolation of palette colors
+ * @return
+ *    The lookup table.  It must not be used after this palette is destroyed.
+ */
+std::shared_ptr<const PaletteLookupTable>
+PaletteBase::getLookupTable(const bool interpolateColorFlag) const
+{
+    CaretMutexLocker locker(&m_lookupTablesMutex);
+    
+    std::shared_ptr<const PaletteLookupTable>& lookupTable(m_lookupTables[interpolateColorFlag ? 1 : 0]);
+    if ( ! lookupTable) {
+        lookupTable.reset(new PaletteLookupTable(this,
+                                                 interpolateColorFlag));
+    }
+    return lookupTable;
+}
+
+/**
+ * Invalidate the lookup tables, called by subclasses when colors in the palette change.
+ */
+void
+PaletteBase::invalidateLookupTables()
+{
+    CaretMutexLocker locker(&m_lookupTablesMutex);
     
+    m_lookupTables[0].reset();
+    m_lookupTables[1].reset();
 }
 
 /**
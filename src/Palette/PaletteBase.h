@@ -24,13 +24,16 @@
 
 
 #include <memory>
+#include <vector>
 
+#include "CaretMutex.h"
 #include "CaretObject.h"
 #include "PaletteDesignTypeEnum.h"
 
 
 namespace caret {
     class Palette;
+    class PaletteLookupTable;
     class PaletteNew;
 
     class PaletteBase : public CaretObject {
@@ -52,6 +55,14 @@ namespace caret {
                                      const bool interpolateColorFlag,
                                      float rgbaOut[4]) const = 0;
 
+        /**
+         * @return Scalars at which the palette's color is not linear, such as the
+         * scalars of the palette's control points.
+         */
+        virtual std::vector<float> getColorBreakpointScalars() const = 0;
+        
+        std::shared_ptr<const PaletteLookupTable> getLookupTable(const bool interpolateColorFlag) const;
+        
         virtual AString getName() const = 0;
         
         virtual const PaletteBase* getInvertedPalette() const = 0;
@@ -72,11 +83,19 @@ namespace caret {
 
         virtual AString toString() const;
         
+    protected:
+        void invalidateLookupTables();
+        
     private:
         void copyHelperPaletteBase(const PaletteBase& obj);
 
         const PaletteDesignTypeEnum::Enum m_paletteDesignType;
         
+        /** Lookup tables for coloring without [0] and with [1] interpolation, created when first requested */
+        mutable std::shared_ptr<const PaletteLookupTable> m_lookupTables[2];
+        
+        mutable CaretMutex m_lookupTablesMutex;
+        
         // ADD_NEW_MEMBERS_HERE
 
     };
@@ -0,0 +1,118 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026 Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#define __PALETTE_LOOKUP_TABLE_DECLARE__
+#include "PaletteLookupTable.h"
+#undef __PALETTE_LOOKUP_TABLE_DECLARE__
+
+#include <algorithm>
+#include <cmath>
+
+#include "CaretAssert.h"
+
+using namespace caret;
+
+
+    
+/**
+ * \class caret::PaletteLookupTable 
+ * \brief Lookup table with the colors of a palette at fixed resolution
+ * \ingroup Palette
+ *
+ * The normalized values from -1 to 1 are divided into bins.  The palette's
+ * color is linear (or constant) across a bin that does not contain any of
+ * the palette's breakpoints so the color in the bin is interpolated from the
+ * colors at the bin's edges.  The few bins that contain a breakpoint
+ * get their colors from the palette, so colors are identical to those
+ * from the palette.
+ */
+
+/**
+ * Constructor.
+ * @param palette
+ *    The palette.  The table must not be used after the palette is destroyed.
+ * @param interpolateColorFlag
+ *    Interpolation of palette colors
+ */
+PaletteLookupTable::PaletteLookupTable(const PaletteBase* palette,
+                                       const bool interpolateColorFlag)
+: CaretObject(),
+m_palette(palette),
+m_interpolateColorFlag(interpolateColorFlag)
+{
+    CaretAssert(palette);
+    
+    const float binWidth(2.0f / NUMBER_OF_BINS);
+    m_edgeRGBA.resize((NUMBER_OF_BINS + 1) * 4);
+    for (int32_t i = 0; i <= NUMBER_OF_BINS; i++) {
+        const float value((i == NUMBER_OF_BINS)
+                          ? 1.0f
+                          : (-1.0f + i * binWidth));
+        m_palette->getPaletteColor(value,
+                                   m_interpolateColorFlag,
+                                   &m_edgeRGBA[i * 4]);
+    }
+    
+    /*
+     * A breakpoint on or very near an edge marks the bins on both
+     * sides of the edge so that rounding when the bin is found
+     * cannot use a color from the wrong side of the breakpoint.
+     */
+    m_exactBinFlags.resize(NUMBER_OF_BINS, 0);
+    const float tolerance(binWidth * 0.001f);
+    const std::vector<float> breakpoints(m_palette->getColorBreakpointScalars());
+    for (const float scalar : breakpoints) {
+        if ( ! std::isfinite(scalar)) {
+            continue;
+        }
+        const int32_t firstBin(static_cast<int32_t>(std::floor((scalar - tolerance + 1.0f) / binWidth)));
+        const int32_t lastBin(static_cast<int32_t>(std::floor((scalar + tolerance + 1.0f) / binWidth)));
+        for (int32_t iBin = std::max(firstBin, 0); iBin <= std::min(lastBin, NUMBER_OF_BINS - 1); iBin++) {
+            m_exactBinFlags[iBin] = 1;
+        }
+    }
+}
+
+/**
+ * Destructor.
+ */
+PaletteLookupTable::~PaletteLookupTable()
+{
+}
+
+/**
+ * @return True if colors are interpolated.
+ */
+bool
+PaletteLookupTable::isInterpolateColor() const
+{
+    return m_interpolateColorFlag;
+}
+
+/**
+ * Get a description of this object's content.
+ * @return String describing this object's content.
+ */
+AString 
+PaletteLookupTable::toString() const
+{
+    return "PaletteLookupTable";
+}
+
@@ -0,0 +1,118 @@
+#ifndef __PALETTE_LOOKUP_TABLE_H__
+#define __PALETTE_LOOKUP_TABLE_H__
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026 Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+
+
+#include <cstdint>
+#include <vector>
+
+#include "CaretObject.h"
+#include "PaletteBase.h"
+
+namespace caret {
+
+    class PaletteLookupTable : public CaretObject {
+        
+    public:
+        PaletteLookupTable(const PaletteBase* palette,
+                           const bool interpolateColorFlag);
+        
+        virtual ~PaletteLookupTable();
+        
+        PaletteLookupTable(const PaletteLookupTable&) = delete;
+
+        PaletteLookupTable& operator=(const PaletteLookupTable&) = delete;
+        
+        /**
+         * Get the color for a normalized value.  Produces the same color as
+         * PaletteBase::getPaletteColor() with this table's interpolation.
+         *
+         * @param normalizedValue
+         *    The normalized value, values outside [-1, 1] receive the color at -1 or 1.
+         * @param rgbaOut
+         *    Output containing the color.
+         */
+        inline void getPaletteColor(const float normalizedValue,
+                                    float rgbaOut[4]) const {
+            float position = (normalizedValue + 1.0f) * (NUMBER_OF_BINS * 0.5f);
+            if ( ! (position > 0.0f)) {
+                /* also handles NaN */
+                position = 0.0f;
+            }
+            if (position >= NUMBER_OF_BINS) {
+                const float* rgba = &m_edgeRGBA[NUMBER_OF_BINS * 4];
+                rgbaOut[0] = rgba[0];
+                rgbaOut[1] = rgba[1];
+                rgbaOut[2] = rgba[2];
+                rgbaOut[3] = rgba[3];
+                return;
+            }
+            const int32_t binIndex = static_cast<int32_t>(position);
+            if (m_exactBinFlags[binIndex]) {
+                m_palette->getPaletteColor(((normalizedValue > -1.0f) ? normalizedValue : -1.0f),
+                                           m_interpolateColorFlag,
+                                           rgbaOut);
+                return;
+            }
+            const float weight = position - binIndex;
+            const float* rgbaLow = &m_edgeRGBA[binIndex * 4];
+            const float* rgbaHigh = rgbaLow + 4;
+            for (int32_t i = 0; i < 4; i++) {
+                rgbaOut[i] = rgbaLow[i] + weight * (rgbaHigh[i] - rgbaLow[i]);
+            }
+        }
+        
+        bool isInterpolateColor() const;
+        
+        /** Number of bins covering the normalized values from -1 to 1 */
+        static const int32_t NUMBER_OF_BINS = 4096;
+        
+        // ADD_NEW_METHODS_HERE
+
+        virtual AString toString() const;
+        
+    private:
+        /** Palette for bins that need an exact color, it owns this table */
+        const PaletteBase* m_palette;
+        
+        const bool m_interpolateColorFlag;
+        
+        /** RGBA at the edges of the bins, (NUMBER_OF_BINS + 1) * 4 elements */
+        std::vector<float> m_edgeRGBA;
+        
+        /**
+         * Non-zero for a bin that contains a breakpoint of the palette, its color is
+         * not linear across the bin so the palette is used to get the color.
+         */
+        std::vector<uint8_t> m_exactBinFlags;
+        
+        // ADD_NEW_MEMBERS_HERE
+
+    };
+    
+#ifdef __PALETTE_LOOKUP_TABLE_DECLARE__
+    // <PLACE DECLARATIONS OF STATIC MEMBERS HERE>
+#endif // __PALETTE_LOOKUP_TABLE_DECLARE__
+
+} // namespace
+#endif  //__PALETTE_LOOKUP_TABLE_H__
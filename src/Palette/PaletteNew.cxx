@@ -99,6 +99,7 @@ void PaletteNew::updateRanges(std::vector<ScalarColor> posRange, const float zer
     copyColor(m_zeroColor, zeroColor);
     
     m_convertedToPalette.reset();
+    invalidateLookupTables();
 }
 
 void PaletteNew::setName(const AString& name)
@@ -136,6 +137,23 @@ void PaletteNew::getPaletteColor(const float scalar,
     rgbaOut[3] = 1.0;
 }
 
+vector<float> PaletteNew::getColorBreakpointScalars() const
+{//zero color is used between the small values that getPaletteColor tests against
+    vector<float> ret;
+    vector<ScalarColor> posRange = getPosRange(), negRange = getNegRange();
+    for (size_t i = 0; i < negRange.size(); ++i)
+    {
+        ret.push_back(negRange[i].scalar);
+    }
+    ret.push_back(-0.00001f);
+    ret.push_back(0.00001f);
+    for (size_t i = 0; i < posRange.size(); ++i)
+    {
+        ret.push_back(posRange[i].scalar);
+    }
+    return ret;
+}
+
 PaletteNew::PaletteRange::PaletteRange(const vector<ScalarColor> controlPoints)
 {
     CaretAssert(controlPoints.size() > 1);
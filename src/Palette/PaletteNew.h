@@ -98,6 +98,8 @@ namespace caret {
                                      const bool interpolateColorFlag,
                                      float rgbaOut[4]) const override;
         
+        virtual std::vector<float> getColorBreakpointScalars() const override;
+        
 
         virtual AString getName() const override { return m_name; }
         
@@ -0,0 +1,156 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+#include "Base64Test.h"
+
+#include "Base64.h"
+
+#include <cstdlib>
+#include <cstring>
+
+using namespace caret;
+using namespace std;
+
+Base64Test::Base64Test(const AString& identifier) : TestInterface(identifier)
+{
+}
+
+namespace
+{
+    const char BASE64_ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    
+    int decodeChar(const unsigned char c)
+    {//'=' decodes to 0 like in Base64, its meaning is handled by the caller
+        if (c == '=') return 0;
+        const char* found = (c == '\0') ? NULL : strchr(BASE64_ALPHABET, c);
+        if (found == NULL) return -1;
+        return found - BASE64_ALPHABET;
+    }
+    
+    int decodeGroup(const unsigned char* in, unsigned char* out)
+    {//one group of 4 characters, returns number of valid bytes, 0 if any character is invalid
+        int d[4];
+        for (int i = 0; i < 4; ++i)
+        {
+            d[i] = decodeChar(in[i]);
+            if (d[i] < 0) return 0;
+        }
+        out[0] = (unsigned char)((d[0] << 2) | (d[1] >> 4));
+        out[1] = (unsigned char)((d[1] << 4) | (d[2] >> 2));
+        out[2] = (unsigned char)((d[2] << 6) | d[3]);
+        if (in[2] == '=') return 1;
+        if (in[3] == '=') return 2;
+        return 3;
+    }
+    
+    vector<unsigned char> referenceDecode(const vector<unsigned char>& encoded, const uint64_t& length, const uint64_t& maxInputLength)
+    {//one group at a time, the way Base64::decode worked before decoding whole groups with a single test
+        vector<unsigned char> ret;
+        unsigned char group[3];
+        for (uint64_t pos = 0; maxInputLength != 0 ? pos < maxInputLength : ret.size() < length; pos += 4)
+        {
+            int len = decodeGroup(encoded.data() + pos, group);
+            if (maxInputLength == 0 && length - ret.size() < 3 && len > 2) len = 2;//the last partial group is counted as at most 2 bytes, even if only 1 was requested
+            ret.insert(ret.end(), group, group + len);
+            if (len < 3) break;
+        }
+        return ret;
+    }
+    
+    vector<unsigned char> encode(const vector<unsigned char>& data)
+    {
+        vector<unsigned char> ret((data.size() + 2) / 3 * 4 + 4, '\0');//the extra group is for reading past the end of malformed input
+        ret.resize(Base64::encode(data.data(), data.size(), ret.data()));
+        ret.resize(ret.size() + 4, '\0');
+        return ret;
+    }
+}
+
+void Base64Test::checkDecode(const vector<unsigned char>& encoded, const uint64_t& length, const uint64_t& maxInputLength, const AString& descrip)
+{
+    vector<unsigned char> expected = referenceDecode(encoded, length, maxInputLength);
+    vector<unsigned char> decoded(encoded.size() / 4 * 3 + 3);
+    uint64_t decodedLength = Base64::decode(encoded.data(), length, decoded.data(), maxInputLength);
+    if (decodedLength != expected.size())
+    {
+        setFailed(descrip + " decoded " + AString::number(decodedLength) + " bytes, expected " + AString::number(expected.size()));
+        return;
+    }
+    uint64_t compareLength = expected.size();
+    if (maxInputLength == 0 && compareLength > length) compareLength = length;//the decoder never writes more than the requested bytes
+    if (compareLength > 0 && memcmp(decoded.data(), expected.data(), compareLength) != 0)
+    {
+        setFailed(descrip + " decoded bytes differ from the reference decoder");
+    }
+}
+
+void Base64Test::execute()
+{
+    for (int length = 0; length < 200; ++length)
+    {//lengths that are and aren't multiples of 3, so all padding cases are used
+        vector<unsigned char> data(length);
+        for (int i = 0; i < length; ++i)
+        {
+            data[i] = (unsigned char)(rand() & 0xFF);
+        }
+        vector<unsigned char> encoded = encode(data);
+        const uint64_t encodedLength = encoded.size() - 4;
+        if (encodedLength != (uint64_t)(length + 2) / 3 * 4)
+        {
+            setFailed("encoding " + AString::number(length) + " bytes gave " + AString::number(encodedLength) + " characters");
+            continue;
+        }
+        vector<unsigned char> decoded(length + 3);
+        uint64_t decodedLength = Base64::decode(encoded.data(), length, decoded.data());
+        if (decodedLength != (uint64_t)length || (length > 0 && memcmp(decoded.data(), data.data(), length) != 0))
+        {
+            setFailed("round trip of " + AString::number(length) + " bytes by output length failed");
+        }
+        if (length > 0)
+        {
+            decodedLength = Base64::decode(encoded.data(), 0, decoded.data(), encodedLength);
+            if (decodedLength != (uint64_t)length || memcmp(decoded.data(), data.data(), length) != 0)
+            {
+                setFailed("round trip of " + AString::number(length) + " bytes by input length failed");
+            }
+        }
+    }
+    const unsigned char badChars[] = { '!', ' ', '\n', '=', '-', 0x80, 0xFF, '\0' };
+    for (int length = 58; length <= 60; ++length)
+    {//replace each character in turn, in every group position and in the padding
+        vector<unsigned char> data(length);
+        for (int i = 0; i < length; ++i)
+        {
+            data[i] = (unsigned char)(rand() & 0xFF);
+        }
+        const vector<unsigned char> encoded = encode(data);
+        const uint64_t encodedLength = encoded.size() - 4;
+        for (uint64_t pos = 0; pos < encodedLength; ++pos)
+        {
+            for (int bad = 0; bad < (int)sizeof(badChars); ++bad)
+            {
+                vector<unsigned char> malformed = encoded;
+                malformed[pos] = badChars[bad];
+                const AString descrip("malformed input of length " + AString::number(length) + " with character " + AString::number(badChars[bad]) + " at " + AString::number(pos));
+                checkDecode(malformed, length, 0, descrip + ", by output length,");
+                checkDecode(malformed, 0, encodedLength, descrip + ", by input length,");
+            }
+        }
+    }
+}
@@ -0,0 +1,215 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+#include "BrainParallelReadTest.h"
+
+#include "Brain.h"
+#include "CaretDataFile.h"
+#include "EventDataFileRead.h"
+#include "EventManager.h"
+#include "EventSpecFileReadDataFiles.h"
+#include "MetricFile.h"
+#include "SessionManager.h"
+#include "SpecFile.h"
+#include "SurfaceFile.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+
+#include <vector>
+
+using namespace caret;
+using namespace std;
+
+BrainParallelReadTest::BrainParallelReadTest(const AString& identifier) : TestInterface(identifier)
+{
+}
+
+namespace
+{
+    const int32_t NUM_NODES = 2000;
+    
+    struct TestFile
+    {
+        AString m_fileName;
+        int32_t m_numColumns;//0 for a corrupt file, -1 for a missing file
+    };
+    
+    void writeMetric(const AString& fileName, const int32_t numColumns)
+    {
+        MetricFile myMetric;
+        myMetric.setNumberOfNodesAndColumns(NUM_NODES, numColumns);
+        myMetric.setStructure(StructureEnum::CORTEX_LEFT);
+        vector<float> values(NUM_NODES);
+        for (int32_t col = 0; col < numColumns; ++col)
+        {
+            for (int32_t node = 0; node < NUM_NODES; ++node)
+            {
+                values[node] = numColumns * 1000.0f + col + node * 0.001f;
+            }
+            myMetric.setValuesForColumn(col, values.data());
+        }
+        myMetric.writeFile(fileName);
+    }
+    
+    void writeSurface(const AString& fileName)
+    {
+        SurfaceFile mySurface;
+        mySurface.setNumberOfNodesAndTriangles(NUM_NODES, NUM_NODES - 2);
+        mySurface.setStructure(StructureEnum::CORTEX_LEFT);
+        mySurface.setSurfaceType(SurfaceTypeEnum::ANATOMICAL);
+        for (int32_t node = 0; node < NUM_NODES; ++node)
+        {
+            mySurface.setCoordinate(node, node % 50, node / 50, (node % 7) * 0.5f);
+        }
+        for (int32_t tri = 0; tri < NUM_NODES - 2; ++tri)
+        {
+            mySurface.setTriangle(tri, tri, tri + 1, tri + 2);
+        }
+        mySurface.writeFile(fileName);
+    }
+    
+    vector<CaretDataFile*> getMetricFiles(Brain* brain)
+    {
+        return brain->getAllDataFilesWithDataFileType(DataFileTypeEnum::METRIC);
+    }
+}
+
+void BrainParallelReadTest::execute()
+{
+    const AString directory = QDir::tempPath() + "/brainParallelReadTest_" + AString::number(QCoreApplication::applicationPid());
+    if (!QDir().mkpath(directory))
+    {
+        setFailed("failed to create temporary directory '" + directory + "'");
+        return;
+    }
+    
+    /*
+     * Sizes are not in spec file order, so the workers finish in a different
+     * order than the files are added, and the corrupt and missing files are
+     * read again when they are added to report their errors.  The
+     * surface is read on a worker thread too, and is added first since
+     * the metric files need it.
+     */
+    const AString surfaceFileName = directory + "/surface.surf.gii";
+    writeSurface(surfaceFileName);
+    vector<TestFile> testFiles;
+    testFiles.push_back({ directory + "/a_small.func.gii", 1 });
+    testFiles.push_back({ directory + "/b_large.func.gii", 12 });
+    testFiles.push_back({ directory + "/c_corrupt.func.gii", 0 });
+    testFiles.push_back({ directory + "/d_medium.func.gii", 5 });
+    testFiles.push_back({ directory + "/e_missing.func.gii", -1 });
+    testFiles.push_back({ directory + "/f_larger.func.gii", 20 });
+    SpecFile specFile;
+    specFile.setFileName(directory + "/test.spec");
+    specFile.addDataFile(DataFileTypeEnum::SURFACE, StructureEnum::CORTEX_LEFT, surfaceFileName, true, false, true);
+    for (const TestFile& testFile : testFiles)
+    {
+        if (testFile.m_numColumns > 0)
+        {
+            writeMetric(testFile.m_fileName, testFile.m_numColumns);
+        } else if (testFile.m_numColumns == 0) {
+            QFile corrupt(testFile.m_fileName);
+            if (!corrupt.open(QIODevice::WriteOnly) || corrupt.write("<?xml version=\"1.0\"?>\n<GIFTI") < 0)
+            {
+                setFailed("failed to write temporary file '" + testFile.m_fileName + "'");
+            }
+        }
+        specFile.addDataFile(DataFileTypeEnum::METRIC, StructureEnum::CORTEX_LEFT, testFile.m_fileName, true, false, true);
+    }
+    
+    /*
+     * The spec file is loaded with the parallel reading, and the
+     * same files are read one at a time into another brain
+     */
+    Brain* parallelBrain = new Brain(SessionManager::get()->getCaretPreferences());
+    Brain* serialBrain = new Brain(SessionManager::get()->getCaretPreferences());
+    if (!failed())
+    {
+        EventSpecFileReadDataFiles specFileEvent(parallelBrain, &specFile);
+        EventManager::get()->sendEvent(specFileEvent.getPointer());
+        
+        EventDataFileRead readEvent(serialBrain);
+        readEvent.addDataFile(StructureEnum::CORTEX_LEFT, DataFileTypeEnum::SURFACE, surfaceFileName);
+        for (const TestFile& testFile : testFiles)
+        {
+            readEvent.addDataFile(StructureEnum::CORTEX_LEFT, DataFileTypeEnum::METRIC, testFile.m_fileName);
+        }
+        EventManager::get()->sendEvent(readEvent.getPointer());
+        
+        if (specFileEvent.getErrorMessage() != readEvent.getErrorMessage())
+        {
+            setFailed("errors from parallel reading differ from reading one file at a time:\n"
+                      + specFileEvent.getErrorMessage() + "\nversus\n" + readEvent.getErrorMessage());
+        }
+        if (readEvent.getErrorMessage().isEmpty())
+        {
+            setFailed("reading the corrupt and missing files did not report errors");
+        }
+        
+        if (parallelBrain->getAllDataFilesWithDataFileType(DataFileTypeEnum::SURFACE).size() != 1
+            || serialBrain->getAllDataFilesWithDataFileType(DataFileTypeEnum::SURFACE).size() != 1)
+        {
+            setFailed("the surface was not loaded by both parallel reading and reading one at a time");
+        }
+        vector<CaretDataFile*> parallelFiles = getMetricFiles(parallelBrain), serialFiles = getMetricFiles(serialBrain);
+        if (parallelFiles.size() != serialFiles.size() || parallelFiles.size() != 4)
+        {
+            setFailed("parallel reading loaded " + AString::number(parallelFiles.size()) + " metric files, reading one at a time loaded " +
+                      AString::number(serialFiles.size()) + ", expected 4");
+        } else {
+            for (size_t i = 0; i < parallelFiles.size(); ++i)
+            {
+                if (parallelFiles[i]->getFileName() != serialFiles[i]->getFileName())
+                {
+                    setFailed("file " + AString::number(i) + " is '" + parallelFiles[i]->getFileName() + "' from parallel reading, but '" +
+                              serialFiles[i]->getFileName() + "' from reading one at a time");
+                    continue;
+                }
+                const MetricFile* parallelMetric = dynamic_cast<const MetricFile*>(parallelFiles[i]);
+                const MetricFile* serialMetric = dynamic_cast<const MetricFile*>(serialFiles[i]);
+                if (parallelMetric == NULL || serialMetric == NULL
+                    || parallelMetric->getNumberOfColumns() != serialMetric->getNumberOfColumns()
+                    || parallelMetric->getNumberOfNodes() != serialMetric->getNumberOfNodes())
+                {
+                    setFailed("file '" + parallelFiles[i]->getFileName() + "' has different dimensions from parallel reading");
+                    continue;
+                }
+                for (int32_t col = 0; col < parallelMetric->getNumberOfColumns(); ++col)
+                {
+                    const float* parallelValues = parallelMetric->getValuePointerForColumn(col);
+                    const float* serialValues = serialMetric->getValuePointerForColumn(col);
+                    for (int32_t node = 0; node < NUM_NODES; ++node)
+                    {
+                        if (parallelValues[node] != serialValues[node])
+                        {
+                            setFailed("file '" + parallelFiles[i]->getFileName() + "' has different data from parallel reading");
+                            col = parallelMetric->getNumberOfColumns();
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    delete parallelBrain;
+    delete serialBrain;
+    QDir(directory).removeRecursively();
+}
@@ -20,13 +20,92 @@
 
 #include "CiftiFileTest.h"
 #include "CiftiFile.h"
+#include "CiftiScalarsMap.h"
+#include "CiftiSeriesMap.h"
+#include "DataFileException.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+
+#include <vector>
+
 using namespace caret;
+using namespace std;
+
+namespace
+{
+    const int64_t SYNTH_ROW_LENGTH = 37, SYNTH_NUM_ROWS = 23;
+    
+    float syntheticValue(const int64_t& row, const int64_t& col)
+    {
+        return row * 1000.0f + col * 0.25f + 0.1f;
+    }
+    
+    AString syntheticFileName(const AString& tag)
+    {
+        return QDir::tempPath() + "/ciftiFileTest_" + AString::number(QCoreApplication::applicationPid()) + "_" + tag + ".dscalar.nii";
+    }
+    
+    //small 2D float32 file that doesn't need the wb_files data set
+    void writeSyntheticFile(const AString& fileName, const CiftiFile::ENDIAN& endian)
+    {
+        CiftiXML myXML;
+        myXML.setNumberOfDimensions(2);
+        myXML.setMap(CiftiXML::ALONG_ROW, CiftiSeriesMap(SYNTH_ROW_LENGTH));
+        myXML.setMap(CiftiXML::ALONG_COLUMN, CiftiScalarsMap(SYNTH_NUM_ROWS));
+        CiftiFile writer;
+        writer.setCiftiXML(myXML, false);
+        vector<float> row(SYNTH_ROW_LENGTH);
+        for (int64_t i = 0; i < SYNTH_NUM_ROWS; ++i)
+        {
+            for (int64_t j = 0; j < SYNTH_ROW_LENGTH; ++j)
+            {
+                row[j] = syntheticValue(i, j);
+            }
+            writer.setRow(row.data(), i);
+        }
+        writer.writeFile(fileName, CiftiVersion(), endian);
+    }
+    
+    //returns empty string on success
+    AString compareGetColumns(const CiftiFile& toTest)
+    {
+        const int64_t ranges[][2] = { { 0, 1 }, { 5, 7 }, { 3, 30 }, { 0, SYNTH_ROW_LENGTH }, { SYNTH_ROW_LENGTH - 1, 1 }, { 20, SYNTH_ROW_LENGTH - 20 } };//both strip read styles, and ranges ending at the last column
+        vector<float> columns(SYNTH_ROW_LENGTH * SYNTH_NUM_ROWS), single(SYNTH_NUM_ROWS);
+        for (int r = 0; r < (int)(sizeof(ranges) / sizeof(ranges[0])); ++r)
+        {
+            const int64_t start = ranges[r][0], count = ranges[r][1];
+            toTest.getColumns(columns.data(), start, count);
+            for (int64_t c = 0; c < count; ++c)
+            {
+                toTest.getColumn(single.data(), start + c);
+                for (int64_t i = 0; i < SYNTH_NUM_ROWS; ++i)
+                {
+                    if (columns[c * SYNTH_NUM_ROWS + i] != single[i] || single[i] != syntheticValue(i, start + c))
+                    {
+                        return "getColumns(" + AString::number(start) + ", " + AString::number(count) + ") differs from getColumn(" + AString::number(start + c) + ") at row " + AString::number(i);
+                    }
+                }
+            }
+        }
+        return "";
+    }
+}
+
 CiftiFileTest::CiftiFileTest(const AString &identifier) : TestInterface(identifier)
 {
 }
 
 void CiftiFileTest::execute()
 {
+    if (getIdentifier() == "ciftiimpl")
+    {//tests on generated files, so they can run without the wb_files data set
+        testTruncatedFile();
+        if(this->failed()) return;
+        testGetColumns();
+        return;
+    }
     testObjectCreateDestroy();
     if(this->failed()) return;
     testCiftiRead();
@@ -199,3 +278,74 @@ void CiftiFileTest::testCiftiReadWriteOnDisk()
     delete [] testRow;
 }
 
+
+void CiftiFileTest::testTruncatedFile()
+{
+    std::cout << "Testing Cifti reading of truncated file." << std::endl;
+    AString fileName = syntheticFileName("truncated");
+    writeSyntheticFile(fileName, CiftiFile::NATIVE);
+    {
+        CiftiFile intact(fileName);
+        const float* lastRow = intact.getRowPointer(SYNTH_NUM_ROWS - 1);
+        if (lastRow == NULL)
+        {
+            setFailed("native float32 cifti file was not memory mapped");
+        } else if (lastRow[SYNTH_ROW_LENGTH - 1] != syntheticValue(SYNTH_NUM_ROWS - 1, SYNTH_ROW_LENGTH - 1)) {
+            setFailed("memory mapped cifti file has wrong data in last row");
+        }
+    }
+    QFile toTruncate(fileName);
+    if (!toTruncate.resize(toTruncate.size() - SYNTH_ROW_LENGTH * sizeof(float) * 2 - 5))
+    {
+        setFailed("failed to truncate temporary cifti file '" + fileName + "'");
+        QFile::remove(fileName);
+        return;
+    }
+    bool threw = false;
+    try
+    {
+        CiftiFile truncated(fileName);
+        vector<float> row(SYNTH_ROW_LENGTH);
+        truncated.getRow(row.data(), SYNTH_NUM_ROWS - 1);//the last row is missing, so this must throw rather than read past the end of a mapping
+    } catch (DataFileException&) {
+        threw = true;
+    }
+    if (!threw)
+    {
+        setFailed("reading a truncated cifti file did not throw");
+    }
+    QFile::remove(fileName);
+}
+
+void CiftiFileTest::testGetColumns()
+{
+    std::cout << "Testing Cifti getColumns against getColumn." << std::endl;
+    AString littleName = syntheticFileName("little"), bigName = syntheticFileName("big");
+    writeSyntheticFile(littleName, CiftiFile::LITTLE);
+    writeSyntheticFile(bigName, CiftiFile::BIG);
+    {
+        CiftiFile littleFile(littleName), bigFile(bigName);
+        //only the native endian file gets mapped, the swapped one uses plain on-disk reads
+        const CiftiFile* mappedFile = &littleFile, *onDiskFile = &bigFile;
+        if (littleFile.getRowPointer(0) == NULL)
+        {
+            mappedFile = &bigFile;
+            onDiskFile = &littleFile;
+        }
+        if (mappedFile->getRowPointer(0) == NULL || onDiskFile->getRowPointer(0) != NULL)
+        {
+            setFailed("expected exactly one of the little and big endian cifti files to be memory mapped");
+        } else {
+            AString result = compareGetColumns(*mappedFile);
+            if (result != "") setFailed("memory mapped: " + result);
+            result = compareGetColumns(*onDiskFile);
+            if (result != "") setFailed("on disk: " + result);
+            CiftiFile inMemory(littleName);
+            inMemory.convertToInMemory();
+            result = compareGetColumns(inMemory);
+            if (result != "") setFailed("in memory: " + result);
+        }
+    }
+    QFile::remove(littleName);
+    QFile::remove(bigName);
+}
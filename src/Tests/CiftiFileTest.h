@@ -32,6 +32,8 @@ public:
     void testCiftiRead();
     void testCiftiReadWriteInMemory();
     void testCiftiReadWriteOnDisk();
+    void testTruncatedFile();
+    void testGetColumns();
 };
 
 } // namespace caret
@@ -113,6 +113,27 @@ void DotTest::checkVal(const float& correct, const float& test, const AString& d
     if (!(abs(test - correct) < TOLER_ABS + TOLER_RATIO * abs(correct))) setFailed(descrip + " got " + AString::number(test) + ", expected " + AString::number(correct));
 }//use "not less than" in order to catch NaNs
 
+void DotTest::checkTile(const vector<vector<float> >& rows, const AString& descrip)
+{//compare the 4x4 tile kernel against individual dot products with the same implementation
+    CaretAssert(rows.size() == 8);
+    const float* tileA[4], * tileB[4];
+    for (int i = 0; i < 4; ++i)
+    {
+        tileA[i] = rows[i].data();
+        tileB[i] = rows[i + 4].data();
+    }
+    const int length = (int)rows[0].size() - 3;//odd length, to exercise the remainder loops
+    double tileOut[16];
+    dsdot4x4(tileA, tileB, length, tileOut);
+    for (int i = 0; i < 4; ++i)
+    {
+        for (int j = 0; j < 4; ++j)
+        {
+            checkVal(dsdot(tileA[i], tileB[j], length), tileOut[4 * i + j], descrip + " tile element " + AString::number(i) + ", " + AString::number(j));
+        }
+    }
+}
+
 void DotTest::execute()
 {
     dot_flags impl_in_use = dot_set_impl(DOT_NAIVE);
@@ -134,6 +155,12 @@ void DotTest::execute()
     const float midsnr_naive = correlate(midsnrA, midsnrB);
     const float highsnr_naive = correlate(highsnrA, highsnrB);
     const float cross_snr_naive = correlate(lowsnrA, highsnrB);
+    vector<vector<float> > tileRows(8);
+    for (int i = 0; i < 8; ++i)
+    {
+        tileRows[i] = randVector01(1000);
+    }
+    checkTile(tileRows, "naive");
     //sse2
     impl_in_use = dot_set_impl(DOT_SSE2);
     if (impl_in_use == DOT_SSE2)
@@ -144,6 +171,7 @@ void DotTest::execute()
         checkVal(midsnr_naive, correlate(midsnrA, midsnrB), "sse2 mid snr correlation");
         checkVal(highsnr_naive, correlate(highsnrA, highsnrB), "sse2 high snr correlation");
         checkVal(cross_snr_naive, correlate(lowsnrA, highsnrB), "sse2 cross snr correlation");
+        checkTile(tileRows, "sse2");
     } else {
         cout << "skipping SSE2, not supported" << endl;
     }
@@ -157,6 +185,7 @@ void DotTest::execute()
         checkVal(midsnr_naive, correlate(midsnrA, midsnrB), "avx mid snr correlation");
         checkVal(highsnr_naive, correlate(highsnrA, highsnrB), "avx high snr correlation");
         checkVal(cross_snr_naive, correlate(lowsnrA, highsnrB), "avx cross snr correlation");
+        checkTile(tileRows, "avx");
     } else {
         cout << "skipping AVX, not supported" << endl;
     }
@@ -170,6 +199,7 @@ void DotTest::execute()
         checkVal(midsnr_naive, correlate(midsnrA, midsnrB), "avxfma mid snr correlation");
         checkVal(highsnr_naive, correlate(highsnrA, highsnrB), "avxfma high snr correlation");
         checkVal(cross_snr_naive, correlate(lowsnrA, highsnrB), "avxfma cross snr correlation");
+        checkTile(tileRows, "avxfma");
     } else {
         cout << "skipping AVXFMA, not supported" << endl;
     }
@@ -183,6 +213,7 @@ void DotTest::execute()
         checkVal(midsnr_naive, correlate(midsnrA, midsnrB), "avx512 mid snr correlation");
         checkVal(highsnr_naive, correlate(highsnrA, highsnrB), "avx512 high snr correlation");
         checkVal(cross_snr_naive, correlate(lowsnrA, highsnrB), "avx512 cross snr correlation");
+        checkTile(tileRows, "avx512");
     } else {
         cout << "skipping AVX512, not supported" << endl;
     }
@@ -196,6 +227,7 @@ void DotTest::execute()
         checkVal(midsnr_naive, correlate(midsnrA, midsnrB), "avx512fma mid snr correlation");
         checkVal(highsnr_naive, correlate(highsnrA, highsnrB), "avx512fma high snr correlation");
         checkVal(cross_snr_naive, correlate(lowsnrA, highsnrB), "avx512fma cross snr correlation");
+        checkTile(tileRows, "avx512fma");
     } else {
         cout << "skipping AVX512FMA, not supported" << endl;
     }
@@ -22,6 +22,7 @@
 #include "GeodesicHelper.h"
 #include "SurfaceFile.h"
 
+#include <algorithm>
 #include <cstdlib>
 
 using namespace caret;
@@ -49,6 +50,20 @@ namespace
             }
         }
     }
+    
+    void checkNeighborhoods(GeodesicHelperTest* theTest, const AString& condition, const vector<int32_t>& firstNodes, const vector<float>& firstDists,
+                            const vector<int32_t>& secondNodes, const vector<float>& secondDists)
+    {//batched neighborhoods aren't sorted by distance, so compare them by node
+        vector<pair<int32_t, float> > first, second;
+        for (size_t i = 0; i < firstNodes.size(); ++i) first.push_back(make_pair(firstNodes[i], firstDists[i]));
+        for (size_t i = 0; i < secondNodes.size(); ++i) second.push_back(make_pair(secondNodes[i], secondDists[i]));
+        sort(first.begin(), first.end());
+        sort(second.begin(), second.end());
+        if (first != second)
+        {
+            theTest->setFailed(condition + ", found different neighborhoods");
+        }
+    }
 }
 
 void GeodesicHelperTest::execute()
@@ -96,4 +111,20 @@ void GeodesicHelperTest::execute()
         checkNodeLists(this, "Comparing normal to quarter areas, getPathFollowingData", nodesNorm, nodesQuarter);
         checkNodeLists(this, "Comparing normal to quad areas, getPathFollowingData", nodesNorm, nodesQuad);
     }
+    vector<int32_t> roots;
+    for (int i = 0; i < TEST_SAMPLES; ++i)
+    {
+        roots.push_back(rand() % numNodes);
+    }
+    vector<vector<int32_t> > batchNodes;
+    vector<vector<float> > batchDists;
+    for (int smooth = 0; !failed() && smooth < 2; ++smooth)
+    {
+        GeodesicHelper::getNodesToGeoDist(quarterHelpBase, roots, 10.0f, batchNodes, batchDists, smooth != 0);
+        for (int i = 0; !failed() && i < TEST_SAMPLES; ++i)
+        {
+            quarterHelp->getNodesToGeoDist(roots[i], 10.0f, nodesQuarter, distsQuarter, smooth != 0);
+            checkNeighborhoods(this, "Comparing batched to single root, getNodesToGeoDist", batchNodes[i], batchDists[i], nodesQuarter, distsQuarter);
+        }
+    }
 }
@@ -0,0 +1,275 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+#include "GzipSeekIndexTest.h"
+
+#include "CaretOMP.h"
+#include "CaretPointer.h"
+#include "DataFileException.h"
+#include "GzipSeekIndex.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include "zlib.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace caret;
+using namespace std;
+
+GzipSeekIndexTest::GzipSeekIndexTest(const AString& identifier) : TestInterface(identifier)
+{
+}
+
+namespace
+{
+    const int64_t MEBIBYTE = 1<<20;
+    const int64_t POINT_SPACING = 4 * MEBIBYTE;//minimum uncompressed distance between access points in GzipSeekIndex
+    
+    uint32_t nextRandom(uint32_t& state)
+    {
+        state = state * 1664525u + 1013904223u;
+        return state >> 8;
+    }
+    
+    //mix of literal runs and back-references, so deflate makes many blocks of different kinds
+    vector<char> makeData(const int64_t& size, uint32_t seed)
+    {
+        vector<char> ret(size);
+        int64_t i = 0;
+        while (i < size)
+        {
+            int64_t runLength = min(size - i, int64_t(16 + nextRandom(seed) % 1024));
+            if (i > 4096 && nextRandom(seed) % 4 != 0)
+            {
+                int64_t distance = 1 + nextRandom(seed) % 4096;
+                for (int64_t j = 0; j < runLength; ++j)
+                {
+                    ret[i + j] = ret[i + j - distance];//can overlap, like deflate
+                }
+            } else {
+                for (int64_t j = 0; j < runLength; ++j)
+                {
+                    ret[i + j] = (char)(nextRandom(seed) & 63);
+                }
+            }
+            i += runLength;
+        }
+        return ret;
+    }
+    
+    AString tempFileName(const AString& tag)
+    {
+        return QDir::tempPath() + "/gzipSeekIndexTest_" + AString::number(QCoreApplication::applicationPid()) + "_" + tag + ".gz";
+    }
+    
+    //each element of members is written as a separate gzip member, like pigz or cat would make
+    bool writeGzip(const AString& fileName, const vector<vector<char> >& members)
+    {
+        for (size_t m = 0; m < members.size(); ++m)
+        {
+            gzFile myFile = gzopen(fileName.toLocal8Bit().constData(), (m == 0 ? "wb6" : "ab6"));
+            if (myFile == NULL) return false;
+            int64_t written = 0;
+            while (written < (int64_t)members[m].size())
+            {
+                int toWrite = (int)min(int64_t(MEBIBYTE), (int64_t)members[m].size() - written);
+                if (gzwrite(myFile, members[m].data() + written, toWrite) != toWrite)
+                {
+                    gzclose(myFile);
+                    return false;
+                }
+                written += toWrite;
+            }
+            if (gzclose(myFile) != Z_OK) return false;
+        }
+        return true;
+    }
+    
+    //the plain sequential zlib reading that the index replaces
+    vector<char> gzreadAll(const AString& fileName)
+    {
+        vector<char> ret;
+        gzFile myFile = gzopen(fileName.toLocal8Bit().constData(), "rb");
+        if (myFile == NULL) return ret;
+        vector<char> buffer(MEBIBYTE);
+        int got;
+        while ((got = gzread(myFile, buffer.data(), (unsigned)buffer.size())) > 0)
+        {
+            ret.insert(ret.end(), buffer.begin(), buffer.begin() + got);
+        }
+        gzclose(myFile);
+        return ret;
+    }
+    
+    //returns empty string on success
+    AString checkRead(GzipSeekIndex* index, const vector<char>& reference, const int64_t& position, const int64_t& count)
+    {
+        vector<char> buffer(max(count, int64_t(1)));
+        int64_t got = index->readAt(position, buffer.data(), count);
+        int64_t expected = max(int64_t(0), min(count, (int64_t)reference.size() - position));
+        if (got != expected)
+        {
+            return "readAt(" + AString::number(position) + ", " + AString::number(count) + ") returned " + AString::number(got) + ", expected " + AString::number(expected);
+        }
+        if (got > 0 && memcmp(buffer.data(), reference.data() + position, got) != 0)
+        {
+            return "readAt(" + AString::number(position) + ", " + AString::number(count) + ") differs from gzread";
+        }
+        return "";
+    }
+}
+
+void GzipSeekIndexTest::checkFile(const AString& fileName, const vector<char>& expected, const AString& descrip)
+{
+    vector<char> reference = gzreadAll(fileName);
+    if (reference != expected)
+    {
+        setFailed(descrip + ": gzread of test file doesn't match the data written");
+        return;
+    }
+    const int64_t size = (int64_t)reference.size();
+    {//concurrent readers on a new index, so they race to add the access points
+        CaretPointer<GzipSeekIndex> index = GzipSeekIndex::getIndex(fileName);
+        if (index.getPointer() == NULL)
+        {
+            setFailed(descrip + ": getIndex returned NULL");
+            return;
+        }
+        const int NUM_READS = 64;
+        vector<AString> errors(NUM_READS);
+#pragma omp CARET_PARFOR schedule(dynamic)
+        for (int i = 0; i < NUM_READS; ++i)
+        {
+            uint32_t seed = 1000 + i;
+            int64_t position = nextRandom(seed) % size, count = 1 + nextRandom(seed) % (MEBIBYTE / 4);
+            try
+            {
+                errors[i] = checkRead(index.getPointer(), reference, position, count);
+            } catch (CaretException& e) {
+                errors[i] = "readAt threw: " + e.whatString();
+            }
+        }
+        for (int i = 0; i < NUM_READS; ++i)
+        {
+            if (errors[i] != "")
+            {
+                setFailed(descrip + ", concurrent: " + errors[i]);
+                return;
+            }
+        }
+    }
+    CaretPointer<GzipSeekIndex> index = GzipSeekIndex::getIndex(fileName);//shares the points found above
+    vector<int64_t> positions, counts;
+    const int64_t SEQUENTIAL_CHUNK = 1000003;//odd size, so reads don't line up with deflate blocks or access points
+    for (int64_t position = 0; position < size; position += SEQUENTIAL_CHUNK)
+    {
+        positions.push_back(position);
+        counts.push_back(SEQUENTIAL_CHUNK);
+    }
+    uint32_t seed = 42;
+    for (int i = 0; i < 200; ++i)
+    {
+        positions.push_back(nextRandom(seed) % size);
+        counts.push_back(1 + nextRandom(seed) % (64 * 1024));
+    }
+    for (int64_t pointPos = POINT_SPACING; pointPos < size; pointPos += POINT_SPACING)
+    {//access points are at the first deflate block boundary after each multiple of the spacing
+        positions.push_back(pointPos - 1000);
+        counts.push_back(MEBIBYTE);
+    }
+    positions.push_back(0);//longer than two spacings, so it is split at the access points and inflated in parallel
+    counts.push_back(size);
+    positions.push_back(size - 10);//end of data
+    counts.push_back(100);
+    positions.push_back(size + 5);
+    counts.push_back(10);
+    for (size_t i = 0; i < positions.size(); ++i)
+    {
+        AString result = checkRead(index.getPointer(), reference, positions[i], counts[i]);
+        if (result != "")
+        {
+            setFailed(descrip + ": " + result);
+            return;
+        }
+    }
+}
+
+void GzipSeekIndexTest::checkTruncated(const AString& fileName, const int64_t& expectedSize)
+{
+    CaretPointer<GzipSeekIndex> index = GzipSeekIndex::getIndex(fileName);
+    if (index.getPointer() == NULL)
+    {
+        setFailed("getIndex returned NULL for truncated file");
+        return;
+    }
+    vector<char> buffer(expectedSize);
+    bool threw = false;
+    try
+    {
+        index->readAt(0, buffer.data(), expectedSize);
+    } catch (DataFileException&) {
+        threw = true;
+    }
+    if (!threw) setFailed("reading past the end of a truncated gzip file did not throw");
+}
+
+void GzipSeekIndexTest::execute()
+{
+    vector<vector<char> > single(1, makeData(5 * POINT_SPACING + 12345, 1));
+    AString singleName = tempFileName("single");
+    if (!writeGzip(singleName, single))
+    {
+        setFailed("failed to write temporary file '" + singleName + "'");
+        return;
+    }
+    checkFile(singleName, single[0], "single member");
+    
+    QFile singleFile(singleName);
+    AString truncatedName = tempFileName("truncated");
+    if (!singleFile.copy(truncatedName) || !QFile(truncatedName).resize(singleFile.size() / 2))
+    {
+        setFailed("failed to write temporary file '" + truncatedName + "'");
+    } else {
+        checkTruncated(truncatedName, (int64_t)single[0].size());
+    }
+    QFile::remove(truncatedName);
+    QFile::remove(singleName);
+    
+    vector<vector<char> > members;//member boundaries both near and far from access points
+    members.push_back(makeData(POINT_SPACING - 7, 2));
+    members.push_back(makeData(POINT_SPACING + 3 * MEBIBYTE + 13, 3));
+    members.push_back(makeData(MEBIBYTE / 2 + 1, 4));
+    members.push_back(makeData(2 * POINT_SPACING + 1, 5));
+    vector<char> joined;
+    for (size_t m = 0; m < members.size(); ++m)
+    {
+        joined.insert(joined.end(), members[m].begin(), members[m].end());
+    }
+    AString multiName = tempFileName("multi");
+    if (!writeGzip(multiName, members))
+    {
+        setFailed("failed to write temporary file '" + multiName + "'");
+        return;
+    }
+    checkFile(multiName, joined, "multiple members");
+    QFile::remove(multiName);
+}
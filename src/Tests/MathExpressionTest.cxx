@@ -55,4 +55,38 @@ void MathExpressionTest::execute()
     {
         setFailed("output value incorrect, expected " + AString::number(correctresult) + ", got " + AString::number(testresult));
     }
+    const int numElems = 1000;//more than one evaluation block, and not a multiple of it
+    vector<float> xvals(numElems), yipvals(numElems);
+    for (int i = 0; i < numElems; ++i)
+    {
+        xvals[i] = (i % 37) * 0.25f - 4.0f;
+        yipvals[i] = ((i % 5 == 0) ? xvals[i] : (i % 23) * -0.5f + 3.0f);//include some equal values for the comparison operators
+    }
+    const char* blockExprs[] = { "x ^ 3 * (clamp(yip, -1, 2) + 2) - mod(x, yip) / yip", "x >= yip || !(x == yip) && min(x, yip) < 0.5", "asinh(x) + round(yip) * sinc(x) - atan2(x, yip)" };
+    for (int e = 0; e < 3; ++e)
+    {
+        CaretMathExpression blockExpr(blockExprs[e]);
+        vector<const float*> arrays(2);
+        if (blockExpr.getVarNames()[0] == "x")
+        {
+            arrays[0] = xvals.data();
+            arrays[1] = yipvals.data();
+        } else {
+            arrays[0] = yipvals.data();
+            arrays[1] = xvals.data();
+        }
+        vector<float> blockResult(numElems);
+        blockExpr.evaluateBlock(arrays, blockResult.data(), numElems);
+        for (int i = 0; i < numElems; ++i)
+        {
+            vars[0] = arrays[0][i];
+            vars[1] = arrays[1][i];
+            float single = (float)blockExpr.evaluate(vars);
+            if (single != blockResult[i] && !(single != single && blockResult[i] != blockResult[i]))
+            {
+                setFailed("evaluateBlock disagrees with evaluate for '" + AString(blockExprs[e]) + "' at element " + AString::number(i));
+                break;
+            }
+        }
+    }
 }
@@ -0,0 +1,357 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+#include "MetricSmoothingTest.h"
+
+#include "MetricFile.h"
+#include "MetricSmoothingObject.h"
+#include "SurfaceFile.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+using namespace caret;
+using namespace std;
+
+MetricSmoothingTest::MetricSmoothingTest(const AString& identifier) : TestInterface(identifier)
+{
+}
+
+namespace
+{
+    const float KERNEL = 2.0f;
+    
+    //bumpy grid, so the weights differ between nodes
+    void makeGrid(SurfaceFile& mySurf, const int32_t& numX, const int32_t& numY, const float& bump)
+    {
+        const int32_t numNodes = numX * numY, numTris = (numX - 1) * (numY - 1) * 2;
+        mySurf.setNumberOfNodesAndTriangles(numNodes, numTris);
+        mySurf.setStructure(StructureEnum::CORTEX_LEFT);
+        for (int32_t i = 0; i < numNodes; ++i)
+        {
+            const int32_t x = i % numX, y = i / numX;
+            mySurf.setCoordinate(i, (float)x, (float)y, bump * sin(x * 0.7f) * cos(y * 0.4f));
+        }
+        int32_t tri = 0;
+        for (int32_t y = 0; y < numY - 1; ++y)
+        {
+            for (int32_t x = 0; x < numX - 1; ++x)
+            {
+                const int32_t base = y * numX + x;
+                mySurf.setTriangle(tri++, base, base + 1, base + numX);
+                mySurf.setTriangle(tri++, base + 1, base + numX + 1, base + numX);
+            }
+        }
+    }
+    
+    void makeData(MetricFile& myMetric, const int32_t& numNodes, const int32_t& numColumns)
+    {
+        myMetric.setNumberOfNodesAndColumns(numNodes, numColumns);
+        myMetric.setStructure(StructureEnum::CORTEX_LEFT);
+        vector<float> values(numNodes);
+        for (int32_t col = 0; col < numColumns; ++col)
+        {
+            for (int32_t i = 0; i < numNodes; ++i)
+            {
+                values[i] = (((i * 7919 + col * 104729) % 1000) < 150 ? 0.0f : sin(i * 0.37f + col) * 10.0f + col);//some zeros for fixZeros
+            }
+            myMetric.setValuesForColumn(col, values.data());
+        }
+    }
+    
+    void makeRoi(MetricFile& myRoi, const int32_t& numNodes)
+    {
+        myRoi.setNumberOfNodesAndColumns(numNodes, 1);
+        myRoi.setStructure(StructureEnum::CORTEX_LEFT);
+        vector<float> values(numNodes);
+        for (int32_t i = 0; i < numNodes; ++i)
+        {
+            values[i] = ((i % 11) < 8 ? 1.0f : 0.0f);
+        }
+        myRoi.setValuesForColumn(0, values.data());
+    }
+    
+    //bit-identical, the weights must be exactly the same
+    bool sameData(const MetricFile& first, const MetricFile& second, const float& scale = 1.0f)
+    {
+        if (first.getNumberOfNodes() != second.getNumberOfNodes() || first.getNumberOfColumns() != second.getNumberOfColumns()) return false;
+        const int32_t numNodes = first.getNumberOfNodes();
+        vector<float> scaled(numNodes);
+        for (int32_t col = 0; col < first.getNumberOfColumns(); ++col)
+        {
+            const float* firstData = first.getValuePointerForColumn(col);
+            for (int32_t i = 0; i < numNodes; ++i)
+            {
+                scaled[i] = firstData[i] * scale;
+            }
+            if (memcmp(scaled.data(), second.getValuePointerForColumn(col), numNodes * sizeof(float)) != 0) return false;
+        }
+        return true;
+    }
+    
+    QStringList cacheFiles(const AString& directory)
+    {
+        return QDir(directory).entryList(QStringList() << "*.weights", QDir::Files);
+    }
+    
+    QByteArray readAll(const AString& fileName)
+    {
+        QFile myFile(fileName);
+        if (!myFile.open(QIODevice::ReadOnly)) return QByteArray();
+        return myFile.readAll();
+    }
+    
+    bool writeAll(const AString& fileName, const QByteArray& contents)
+    {
+        QFile myFile(fileName);
+        if (!myFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+        return myFile.write(contents) == contents.size();
+    }
+}
+
+void MetricSmoothingTest::execute()
+{
+    if (getIdentifier() == "smoothcache")
+    {
+        testWeightCache();
+    }
+    if (getIdentifier() == "smoothpanel")
+    {
+        testPanels();
+    }
+}
+
+void MetricSmoothingTest::testWeightCache()
+{
+    const AString directory = QDir::tempPath() + "/metricSmoothingTest_" + AString::number(QCoreApplication::applicationPid());
+    const AString otherDirectory = directory + "_other";
+    QDir(directory).removeRecursively();
+    QDir(otherDirectory).removeRecursively();
+    SurfaceFile mySurf, otherSurf, movedSurf;
+    makeGrid(mySurf, 30, 30, 2.0f);
+    makeGrid(otherSurf, 20, 25, 2.0f);
+    makeGrid(movedSurf, 30, 30, 2.5f);
+    const int32_t numNodes = mySurf.getNumberOfNodes();
+    MetricFile myData, myRoi, reference, result;
+    makeData(myData, numNodes, 3);
+    makeRoi(myRoi, numNodes);
+    const MetricSmoothingObject::Method methods[] = { MetricSmoothingObject::GEO_GAUSS_AREA, MetricSmoothingObject::GEO_GAUSS_EQUAL, MetricSmoothingObject::GEO_GAUSS };
+    const char* methodNames[] = { "GEO_GAUSS_AREA", "GEO_GAUSS_EQUAL", "GEO_GAUSS" };
+    int expectedFiles = 0;
+    for (int m = 0; m < 3; ++m)
+    {
+        for (int useRoi = 0; useRoi < 2; ++useRoi)
+        {
+            const MetricFile* roiPtr = (useRoi != 0 ? &myRoi : NULL);
+            const AString condition = AString(methodNames[m]) + (useRoi != 0 ? " with roi" : "");
+            MetricSmoothingObject(&mySurf, KERNEL, roiPtr, methods[m]).smoothMetric(&myData, &reference);
+            MetricSmoothingObject(&mySurf, KERNEL, roiPtr, methods[m], NULL, directory).smoothMetric(&myData, &result);//computes and saves
+            ++expectedFiles;
+            if (cacheFiles(directory).size() != expectedFiles)
+            {
+                setFailed(condition + ", cache file was not written");
+            }
+            if (!sameData(reference, result))
+            {
+                setFailed(condition + ", smoothing while writing the cache differs from smoothing without it");
+            }
+            MetricSmoothingObject(&mySurf, KERNEL, roiPtr, methods[m], NULL, directory).smoothMetric(&myData, &result);//loads
+            if (!sameData(reference, result))
+            {
+                setFailed(condition + ", smoothing with cached weights differs from computed weights");
+            }
+        }
+    }
+    if (failed()) return;
+    
+    //the remaining checks use one cache file in an empty directory
+    QDir(directory).removeRecursively();
+    MetricSmoothingObject(&mySurf, KERNEL).smoothMetric(&myData, &reference);
+    MetricSmoothingObject(&mySurf, KERNEL, NULL, MetricSmoothingObject::GEO_GAUSS_AREA, NULL, directory).smoothMetric(&myData, &result);
+    QStringList names = cacheFiles(directory);
+    if (names.size() != 1)
+    {
+        setFailed("expected one cache file, found " + AString::number(names.size()));
+        return;
+    }
+    const AString cacheName = directory + "/" + names[0];
+    const QByteArray goodCache = readAll(cacheName);
+    
+    //make sure the cache is really used: doubling the stored weights (but not their sums) exactly doubles the output
+    {
+        QByteArray doubled = goodCache;
+        int32_t headerNodes = 0;
+        int64_t numWeights = 0;
+        memcpy(&headerNodes, doubled.constData() + 12, sizeof(int32_t));
+        memcpy(&numWeights, doubled.constData() + 16, sizeof(int64_t));
+        if (headerNodes != numNodes || doubled.size() != 64 + (numNodes + 1) * 8 + numNodes * 4 + numWeights * 8)
+        {
+            setFailed("cache file has an unexpected layout");
+            return;
+        }
+        float* weights = (float*)(doubled.data() + doubled.size() - numWeights * 4);
+        for (int64_t i = 0; i < numWeights; ++i)
+        {
+            weights[i] *= 2.0f;
+        }
+        writeAll(cacheName, doubled);
+        MetricSmoothingObject(&mySurf, KERNEL, NULL, MetricSmoothingObject::GEO_GAUSS_AREA, NULL, directory).smoothMetric(&myData, &result);
+        if (!sameData(reference, result, 2.0f))
+        {
+            setFailed("modified cache file was not used");
+        }
+        writeAll(cacheName, goodCache);
+    }
+    
+    //a different surface must get its own cache file, not use the existing one
+    {
+        MetricFile movedReference;
+        MetricSmoothingObject(&movedSurf, KERNEL).smoothMetric(&myData, &movedReference);
+        MetricSmoothingObject(&movedSurf, KERNEL, NULL, MetricSmoothingObject::GEO_GAUSS_AREA, NULL, directory).smoothMetric(&myData, &result);
+        if (cacheFiles(directory).size() != 2)
+        {
+            setFailed("changed surface did not get a new cache file");
+        }
+        if (!sameData(movedReference, result))
+        {
+            setFailed("smoothing a changed surface with a cache directory differs from computed weights");
+        }
+        if (readAll(cacheName) != goodCache)
+        {
+            setFailed("changed surface modified the cache file of the original surface");
+        }
+    }
+    
+    //a cache file made for another surface, under this surface's name, must be rejected and replaced
+    {
+        MetricFile otherData;
+        makeData(otherData, otherSurf.getNumberOfNodes(), 1);
+        MetricSmoothingObject(&otherSurf, KERNEL, NULL, MetricSmoothingObject::GEO_GAUSS_AREA, NULL, otherDirectory).smoothMetric(&otherData, &result);
+        QStringList otherNames = cacheFiles(otherDirectory);
+        if (otherNames.size() != 1)
+        {
+            setFailed("cache file for other surface was not written");
+        } else {
+            writeAll(cacheName, readAll(otherDirectory + "/" + otherNames[0]));
+            MetricSmoothingObject(&mySurf, KERNEL, NULL, MetricSmoothingObject::GEO_GAUSS_AREA, NULL, directory).smoothMetric(&myData, &result);
+            if (!sameData(reference, result))
+            {
+                setFailed("smoothing with a stale cache file differs from computed weights");
+            }
+            if (readAll(cacheName) != goodCache)
+            {
+                setFailed("stale cache file was not replaced");
+            }
+        }
+    }
+    
+    //truncated cache files, including one shorter than the header
+    const int64_t cacheSize = goodCache.size();
+    const int64_t truncatedSizes[] = { cacheSize / 2, cacheSize - 1, 10, 0 };
+    for (int t = 0; t < 4; ++t)
+    {
+        writeAll(cacheName, goodCache.left(truncatedSizes[t]));
+        MetricSmoothingObject(&mySurf, KERNEL, NULL, MetricSmoothingObject::GEO_GAUSS_AREA, NULL, directory).smoothMetric(&myData, &result);
+        if (!sameData(reference, result))
+        {
+            setFailed("smoothing with a cache file truncated to " + AString::number(truncatedSizes[t]) + " bytes differs from computed weights");
+        }
+        if (readAll(cacheName) != goodCache)
+        {
+            setFailed("cache file truncated to " + AString::number(truncatedSizes[t]) + " bytes was not replaced");
+        }
+    }
+    
+    //a corrupt node index must be rejected
+    {
+        QByteArray corrupt = goodCache;
+        const int32_t badNode = numNodes + 5;
+        memcpy(corrupt.data() + 64 + (numNodes + 1) * 8 + numNodes * 4, &badNode, sizeof(int32_t));
+        writeAll(cacheName, corrupt);
+        MetricSmoothingObject(&mySurf, KERNEL, NULL, MetricSmoothingObject::GEO_GAUSS_AREA, NULL, directory).smoothMetric(&myData, &result);
+        if (!sameData(reference, result))
+        {
+            setFailed("smoothing with a corrupt cache file differs from computed weights");
+        }
+    }
+    QDir(directory).removeRecursively();
+    QDir(otherDirectory).removeRecursively();
+}
+
+void MetricSmoothingTest::testPanels()
+{
+    SurfaceFile mySurf;
+    makeGrid(mySurf, 30, 30, 2.0f);
+    const int32_t numNodes = mySurf.getNumberOfNodes();
+    const int32_t NUM_COLUMNS = 37;//not a multiple of the panel width, so the last panel is partial
+    MetricFile myData, myRoi, panelOut, columnOut;
+    makeData(myData, numNodes, NUM_COLUMNS);
+    myRoi.setNumberOfNodesAndColumns(numNodes, 2);//roi in the second column, so the roi column index is used
+    {
+        MetricFile roiColumn;
+        makeRoi(roiColumn, numNodes);
+        vector<float> ones(numNodes, 1.0f);
+        myRoi.setValuesForColumn(0, ones.data());
+        myRoi.setValuesForColumn(1, roiColumn.getValuePointerForColumn(0));
+    }
+    const float TOLERANCE = 1e-5f * 50.0f;//the operations are the same, but multiply-adds may be fused differently, data is up to about 50
+    const int columnRanges[][3] = { { 0, NUM_COLUMNS, 0 }, { 2, 33, 3 }, { 5, 16, 0 }, { NUM_COLUMNS - 1, 1, 7 }, { 4, 17, 1 } };//first, count, first output
+    const MetricSmoothingObject::Method methods[] = { MetricSmoothingObject::GEO_GAUSS_AREA, MetricSmoothingObject::GEO_GAUSS_EQUAL, MetricSmoothingObject::GEO_GAUSS };
+    const char* methodNames[] = { "GEO_GAUSS_AREA", "GEO_GAUSS_EQUAL", "GEO_GAUSS" };
+    for (int m = 0; m < 3; ++m)
+    {
+        MetricSmoothingObject mySmooth(&mySurf, KERNEL, NULL, methods[m]);
+        for (int useRoi = 0; useRoi < 2; ++useRoi)
+        {
+            const MetricFile* roiPtr = (useRoi != 0 ? &myRoi : NULL);
+            for (int fixZeros = 0; fixZeros < 2; ++fixZeros)
+            {
+                for (int r = 0; r < (int)(sizeof(columnRanges) / sizeof(columnRanges[0])); ++r)
+                {
+                    const int first = columnRanges[r][0], count = columnRanges[r][1], firstOut = columnRanges[r][2];
+                    const AString condition = AString(methodNames[m]) + (useRoi != 0 ? " with roi" : "") + (fixZeros != 0 ? " with fixZeros" : "") +
+                                              ", columns " + AString::number(first) + " to " + AString::number(first + count - 1);
+                    panelOut.setNumberOfNodesAndColumns(numNodes, firstOut + count);
+                    columnOut.setNumberOfNodesAndColumns(numNodes, firstOut + count);
+                    mySmooth.smoothColumns(&myData, first, count, &panelOut, firstOut, roiPtr, 1, fixZeros != 0);
+                    for (int c = 0; c < count; ++c)
+                    {
+                        mySmooth.smoothColumn(&myData, first + c, &columnOut, firstOut + c, roiPtr, 1, fixZeros != 0);
+                        const float* panelData = panelOut.getValuePointerForColumn(firstOut + c);
+                        const float* columnData = columnOut.getValuePointerForColumn(firstOut + c);
+                        for (int32_t i = 0; i < numNodes; ++i)
+                        {
+                            if (!(abs(panelData[i] - columnData[i]) <= TOLERANCE))
+                            {
+                                setFailed(condition + ", smoothColumns differs from smoothColumn for column " + AString::number(first + c) + " at node " + AString::number(i));
+                                c = count;
+                                break;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
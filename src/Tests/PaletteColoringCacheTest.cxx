@@ -0,0 +1,124 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+#include "PaletteColoringCacheTest.h"
+
+#include "FastStatistics.h"
+#include "NodeAndVoxelColoring.h"
+#include "PaletteColorMapping.h"
+#include "PaletteColoringCache.h"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <utility>
+#include <vector>
+
+using namespace caret;
+using namespace std;
+
+PaletteColoringCacheTest::PaletteColoringCacheTest(const AString& identifier) : TestInterface(identifier)
+{
+}
+
+namespace
+{
+    const int64_t NUM_SCALARS = 100000;
+    
+    float randomValue(uint32_t& state)
+    {
+        state = state * 1664525u + 1013904223u;
+        return (state >> 8) / float(1 << 24) * 20.0f - 10.0f;
+    }
+    
+    vector<float> makeValues(uint32_t seed)
+    {
+        vector<float> ret(NUM_SCALARS);
+        for (int64_t i = 0; i < NUM_SCALARS; ++i)
+        {
+            ret[i] = randomValue(seed);
+        }
+        for (int64_t i = 0; i < NUM_SCALARS; i += 997)
+        {//some of each kind of non-finite value, and exact zeros
+            ret[i] = numeric_limits<float>::quiet_NaN();
+            ret[i + 1] = numeric_limits<float>::infinity();
+            ret[i + 2] = -numeric_limits<float>::infinity();
+            ret[i + 3] = 0.0f;
+        }
+        return ret;
+    }
+}
+
+void PaletteColoringCacheTest::checkThresholdSteps(const PaletteThresholdTestEnum::Enum thresholdTest, const AString& descrip)
+{
+    vector<float> scalars = makeValues(1), thresholds = makeValues(2);
+    FastStatistics statistics(scalars.data(), NUM_SCALARS);
+    PaletteColorMapping paletteColorMapping;
+    paletteColorMapping.setScaleMode(PaletteScaleModeEnum::MODE_USER_SCALE);
+    paletteColorMapping.setThresholdType(PaletteThresholdTypeEnum::THRESHOLD_TYPE_NORMAL);
+    paletteColorMapping.setThresholdTest(thresholdTest);
+    paletteColorMapping.setThresholdNormalMinimum(-1.0f);
+    paletteColorMapping.setThresholdNormalMaximum(1.0f);
+    
+    /*
+     * Small steps of the minimum, the maximum, and both, which
+     * only recolor the scalars between the old and new thresholds,
+     * jumps that change more than a quarter of the scalars and
+     * recolor everything, and a step that changes nothing
+     */
+    vector<pair<float, float> > steps;
+    for (int i = 1; i <= 10; ++i) steps.push_back(make_pair(-1.0f - 0.05f * i, 1.0f));
+    for (int i = 1; i <= 10; ++i) steps.push_back(make_pair(-1.5f, 1.0f + 0.05f * i));
+    for (int i = 1; i <= 10; ++i) steps.push_back(make_pair(-1.5f + 0.1f * i, 1.5f - 0.1f * i));
+    steps.push_back(make_pair(-0.5f, 0.5f));
+    steps.push_back(make_pair(-8.0f, 8.0f));
+    steps.push_back(make_pair(-7.9f, 8.05f));
+    steps.push_back(make_pair(2.0f, 3.0f));
+    steps.push_back(make_pair(2.0f, 3.0f));
+    steps.push_back(make_pair(-numeric_limits<float>::infinity(), 3.0f));
+    steps.push_back(make_pair(-numeric_limits<float>::infinity(), 3.1f));
+    steps.push_back(make_pair(-10.0f, 3.1f));
+    
+    PaletteColoringCache coloringCache;
+    vector<uint8_t> cachedRGBA(NUM_SCALARS * 4), fullRGBA(NUM_SCALARS * 4);
+    for (int i = -1; i < (int)steps.size(); ++i)
+    {
+        if (i >= 0)
+        {
+            paletteColorMapping.setThresholdNormalMinimum(steps[i].first);
+            paletteColorMapping.setThresholdNormalMaximum(steps[i].second);
+        }
+        NodeAndVoxelColoring::colorScalarsWithPalette(&statistics, &paletteColorMapping, scalars.data(), &paletteColorMapping, thresholds.data(),
+                                                      NUM_SCALARS, cachedRGBA.data(), false, &coloringCache);
+        NodeAndVoxelColoring::colorScalarsWithPalette(&statistics, &paletteColorMapping, scalars.data(), &paletteColorMapping, thresholds.data(),
+                                                      NUM_SCALARS, fullRGBA.data(), false, NULL);
+        if (memcmp(cachedRGBA.data(), fullRGBA.data(), NUM_SCALARS * 4) != 0)
+        {
+            AString stepDescrip = (i < 0 ? AString("initial coloring") : "threshold step to [" + AString::number(steps[i].first) + ", " + AString::number(steps[i].second) + "]");
+            setFailed(descrip + ": cached coloring differs from full coloring after " + stepDescrip);
+            return;
+        }
+    }
+}
+
+void PaletteColoringCacheTest::execute()
+{
+    checkThresholdSteps(PaletteThresholdTestEnum::THRESHOLD_TEST_SHOW_INSIDE, "show inside");
+    checkThresholdSteps(PaletteThresholdTestEnum::THRESHOLD_TEST_SHOW_OUTSIDE, "show outside");
+}
@@ -0,0 +1,93 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+#include "PaletteTest.h"
+
+#include "CaretPointer.h"
+#include "Palette.h"
+#include "PaletteFile.h"
+#include "PaletteLookupTable.h"
+#include "PaletteNew.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+using namespace caret;
+using namespace std;
+
+PaletteTest::PaletteTest(const AString& identifier) : TestInterface(identifier)
+{
+}
+
+void PaletteTest::checkLookupTable(const PaletteBase* palette, const bool& interpolate, const AString& descrip)
+{//the table must give the palette's own color for any value, including at and around breakpoints and bin edges
+    const float TOLER = 0.00001f;
+    shared_ptr<const PaletteLookupTable> myTable = palette->getLookupTable(interpolate);
+    vector<float> values = palette->getColorBreakpointScalars();
+    const int NUM_RANDOM = 100000;
+    for (int i = 0; i < NUM_RANDOM; ++i)
+    {
+        values.push_back(((float)rand()) / RAND_MAX * 2.4f - 1.2f);//also outside [-1, 1], which gets the end colors
+    }
+    for (int i = 0; i <= PaletteLookupTable::NUMBER_OF_BINS; ++i)
+    {
+        float edge = -1.0f + i * (2.0f / PaletteLookupTable::NUMBER_OF_BINS);
+        values.push_back(edge);
+        values.push_back(nextafterf(edge, -2.0f));
+        values.push_back(nextafterf(edge, 2.0f));
+    }
+    const int numValues = (int)values.size();
+    for (int i = 0; i < numValues; ++i)
+    {
+        if (!isfinite(values[i])) continue;
+        float tableRGBA[4], paletteRGBA[4];
+        myTable->getPaletteColor(values[i], tableRGBA);
+        palette->getPaletteColor(max(-1.0f, min(1.0f, values[i])), interpolate, paletteRGBA);
+        for (int j = 0; j < 4; ++j)
+        {
+            if (!(abs(tableRGBA[j] - paletteRGBA[j]) <= TOLER))
+            {
+                setFailed(descrip + (interpolate ? " interpolated" : "") + " lookup table color differs from palette at value " + AString::number(values[i], 'g', 9) +
+                          ", component " + AString::number(j) + ": " + AString::number(tableRGBA[j]) + " vs " + AString::number(paletteRGBA[j]));
+                return;//one value is enough to show the problem
+            }
+        }
+    }
+}
+
+void PaletteTest::execute()
+{
+    PaletteFile myPaletteFile;//default palettes
+    const int32_t numPalettes = myPaletteFile.getNumberOfPalettes();
+    if (numPalettes == 0) setFailed("palette file has no default palettes");
+    for (int32_t i = 0; i < numPalettes; ++i)
+    {
+        const Palette* myPalette = myPaletteFile.getPalette(i);
+        checkLookupTable(myPalette, false, myPalette->getName());
+        checkLookupTable(myPalette, true, myPalette->getName());
+        AString importNotes;
+        CaretPointer<PaletteNew> myPaletteNew(PaletteNew::createFromPalette(myPalette, importNotes));
+        if (myPaletteNew.getPointer() != NULL)
+        {//also has a zero band as a breakpoint
+            checkLookupTable(myPaletteNew.getPointer(), false, myPalette->getName() + " converted to new palette");
+            checkLookupTable(myPaletteNew.getPointer(), true, myPalette->getName() + " converted to new palette");
+        }
+    }
+}
@@ -0,0 +1,108 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "PointLocatorTest.h"
+
+#include "CaretPointLocator.h"
+#include "MathFunctions.h"
+
+#include <cstdlib>
+
+using namespace caret;
+using namespace std;
+
+PointLocatorTest::PointLocatorTest(const AString& identifier) : TestInterface(identifier)
+{
+}
+
+void PointLocatorTest::execute()
+{
+    const int NUM_POINTS = 20000;
+    const int NUM_TARGETS = 2000;
+    const int NUM_DUPLICATES = 500;
+    const float RANGE = 10.0f;
+    vector<float> points(NUM_POINTS * 3), targets(NUM_TARGETS * 3);
+    for (int i = 0; i < NUM_POINTS * 3; ++i)
+    {
+        points[i] = (rand() % 20001) / 100.0f - 100.0f;
+    }
+    for (int i = 1; i < NUM_DUPLICATES; ++i)//identical points must not be split forever
+    {
+        points[i * 3] = points[0];
+        points[i * 3 + 1] = points[1];
+        points[i * 3 + 2] = points[2];
+    }
+    for (int i = 0; i < NUM_TARGETS * 3; ++i)
+    {
+        targets[i] = (rand() % 24001) / 100.0f - 120.0f;//some targets are outside the bounding box of the points
+    }
+    CaretPointLocator bulkLocator(points.data(), NUM_POINTS);//built by bulk load
+    float minBounds[3] = { -1.0f, -1.0f, -1.0f }, maxBounds[3] = { 1.0f, 1.0f, 1.0f };
+    CaretPointLocator incrementalLocator(minBounds, maxBounds);
+    incrementalLocator.addPointSet(points.data(), NUM_POINTS);//built by adding one point at a time
+    vector<LocatorInfo> batchInfo;
+    vector<int64_t> batchClosest = bulkLocator.closestPointBatch(targets.data(), NUM_TARGETS, &batchInfo);
+    vector<int64_t> batchLimited = bulkLocator.closestPointLimitedBatch(targets.data(), NUM_TARGETS, RANGE);
+    vector<vector<LocatorInfo> > batchInRange = bulkLocator.pointsInRangeBatch(targets.data(), NUM_TARGETS, RANGE);
+    if ((int)batchClosest.size() != NUM_TARGETS || (int)batchInfo.size() != NUM_TARGETS || (int)batchLimited.size() != NUM_TARGETS || (int)batchInRange.size() != NUM_TARGETS)
+    {
+        setFailed("batch query returned wrong number of results");
+        return;
+    }
+    for (int i = 0; i < NUM_TARGETS; ++i)
+    {
+        const float* target = targets.data() + i * 3;
+        float bestDist2 = -1.0f;
+        int inRangeCount = 0;
+        for (int j = 0; j < NUM_POINTS; ++j)
+        {
+            float dist2 = MathFunctions::distanceSquared3D(points.data() + j * 3, target);
+            if (bestDist2 < 0.0f || dist2 < bestDist2) bestDist2 = dist2;
+            if (dist2 <= RANGE * RANGE) ++inRangeCount;
+        }
+        int64_t single = bulkLocator.closestPoint(target);
+        int64_t incremental = incrementalLocator.closestPoint(target);
+        if (single < 0 || MathFunctions::distanceSquared3D(points.data() + single * 3, target) != bestDist2)
+        {
+            setFailed("bulk loaded closest point is wrong for target " + AString::number(i));
+        }
+        if (incremental < 0 || MathFunctions::distanceSquared3D(points.data() + incremental * 3, target) != bestDist2)
+        {
+            setFailed("incrementally built closest point is wrong for target " + AString::number(i));
+        }
+        if (batchClosest[i] != single || batchInfo[i].index != single)
+        {
+            setFailed("batch closest point doesn't match single query for target " + AString::number(i));
+        }
+        if (batchLimited[i] != bulkLocator.closestPointLimited(target, RANGE))
+        {
+            setFailed("batch limited closest point doesn't match single query for target " + AString::number(i));
+        }
+        if ((batchLimited[i] == -1) != (bestDist2 > RANGE * RANGE))
+        {
+            setFailed("batch limited closest point has wrong range test for target " + AString::number(i));
+        }
+        if ((int)batchInRange[i].size() != inRangeCount)
+        {
+            setFailed("batch points in range found " + AString::number(batchInRange[i].size()) + " points instead of " +
+                      AString::number(inRangeCount) + " for target " + AString::number(i));
+        }
+    }
+}
@@ -0,0 +1,224 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+#include "RibbonWeightsTest.h"
+
+#include "CaretException.h"
+#include "RibbonMappingHelper.h"
+#include "SurfaceFile.h"
+#include "VolumeSpace.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+using namespace caret;
+using namespace std;
+
+RibbonWeightsTest::RibbonWeightsTest(const AString& identifier) : TestInterface(identifier)
+{
+}
+
+namespace
+{
+    const int32_t GRID_SIZE = 12;
+    const int NUM_FRAMES = 21;//not a multiple of the frames applied per pass
+    
+    //grid surface at a bumpy height, inner and outer surfaces only differ in height
+    void makeSurface(SurfaceFile& mySurf, const float& height)
+    {
+        const int32_t numNodes = GRID_SIZE * GRID_SIZE, numTris = (GRID_SIZE - 1) * (GRID_SIZE - 1) * 2;
+        mySurf.setNumberOfNodesAndTriangles(numNodes, numTris);
+        mySurf.setStructure(StructureEnum::CORTEX_LEFT);
+        for (int32_t i = 0; i < numNodes; ++i)
+        {
+            const int32_t x = i % GRID_SIZE, y = i / GRID_SIZE;
+            mySurf.setCoordinate(i, 1.0f + x * 1.3f, 1.0f + y * 1.3f, height + 0.8f * sin(x * 0.9f) * cos(y * 0.6f));
+        }
+        int32_t tri = 0;
+        for (int32_t y = 0; y < GRID_SIZE - 1; ++y)
+        {
+            for (int32_t x = 0; x < GRID_SIZE - 1; ++x)
+            {
+                const int32_t base = y * GRID_SIZE + x;
+                mySurf.setTriangle(tri++, base, base + 1, base + GRID_SIZE);
+                mySurf.setTriangle(tri++, base + 1, base + GRID_SIZE + 1, base + GRID_SIZE);
+            }
+        }
+    }
+    
+    bool sameMatrix(const RibbonWeightMatrix& first, const RibbonWeightMatrix& second)
+    {
+        return first.m_dims[0] == second.m_dims[0] && first.m_dims[1] == second.m_dims[1] && first.m_dims[2] == second.m_dims[2] &&
+               first.m_rowStart == second.m_rowStart && first.m_voxels == second.m_voxels && first.m_weights == second.m_weights &&
+               first.m_weightSums == second.m_weightSums;
+    }
+    
+    QByteArray readAll(const AString& fileName)
+    {
+        QFile myFile(fileName);
+        if (!myFile.open(QIODevice::ReadOnly)) return QByteArray();
+        return myFile.readAll();
+    }
+    
+    bool writeAll(const AString& fileName, const QByteArray& contents)
+    {
+        QFile myFile(fileName);
+        if (!myFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+        return myFile.write(contents) == contents.size();
+    }
+}
+
+void RibbonWeightsTest::execute()
+{
+    const int64_t dims[3] = { 20, 20, 9 };
+    const float sform[12] = { 1.0f, 0.0f, 0.0f, 0.0f,
+                              0.0f, 1.0f, 0.0f, 0.0f,
+                              0.0f, 0.0f, 1.0f, 0.0f };
+    const VolumeSpace mySpace(dims, sform);
+    const int64_t frameSize = dims[0] * dims[1] * dims[2];
+    SurfaceFile innerSurf, outerSurf;
+    makeSurface(innerSurf, 2.2f);
+    makeSurface(outerSurf, 5.1f);
+    const int64_t numNodes = innerSurf.getNumberOfNodes();
+    vector<vector<VoxelWeight> > weightLists;
+    RibbonMappingHelper::computeWeightsRibbon(weightLists, mySpace, &innerSurf, &outerSurf);
+    
+    vector<vector<float> > frameData(NUM_FRAMES, vector<float>(frameSize));
+    vector<const float*> frames(NUM_FRAMES);
+    float maxAbs = 0.0f;
+    for (int f = 0; f < NUM_FRAMES; ++f)
+    {
+        for (int64_t v = 0; v < frameSize; ++v)
+        {
+            frameData[f][v] = sin(v * 0.13f + f) * 20.0f + f;
+            maxAbs = max(maxAbs, abs(frameData[f][v]));
+        }
+        frames[f] = frameData[f].data();
+    }
+    
+    //weighted averages straight from the per-vertex weight lists, the way mapping worked before the compressed rows
+    vector<float> direct(NUM_FRAMES * numNodes);
+    int64_t numWithWeights = 0;
+    for (int64_t node = 0; node < numNodes; ++node)
+    {
+        if (!weightLists[node].empty()) ++numWithWeights;
+        for (int f = 0; f < NUM_FRAMES; ++f)
+        {
+            float accum = 0.0f, totalWeight = 0.0f;
+            for (const VoxelWeight& thisWeight : weightLists[node])
+            {
+                accum += thisWeight.weight * frames[f][thisWeight.ijk[0] + dims[0] * (thisWeight.ijk[1] + dims[1] * thisWeight.ijk[2])];
+                totalWeight += thisWeight.weight;
+            }
+            direct[f * numNodes + node] = (totalWeight != 0.0f ? accum / totalWeight : 0.0f);
+        }
+    }
+    if (numWithWeights == 0)
+    {
+        setFailed("ribbon mapping of synthetic surfaces found no voxels");
+        return;
+    }
+    
+    RibbonWeightMatrix computed;
+    computed.setFromLists(weightLists, dims);
+    vector<float> computedOut(NUM_FRAMES * numNodes), readOut(NUM_FRAMES * numNodes);
+    computed.applyToFrames(frames.data(), NUM_FRAMES, computedOut.data());
+    const float tolerance = 1e-5f * maxAbs;//same operations in the same order, but multiply-adds may be fused differently
+    for (int64_t i = 0; i < NUM_FRAMES * numNodes; ++i)
+    {
+        if (!(abs(computedOut[i] - direct[i]) <= tolerance))
+        {
+            setFailed("compressed row weights give different mapping than the weight lists, frame " + AString::number(i / numNodes) + ", vertex " + AString::number(i % numNodes));
+            break;
+        }
+    }
+    
+    const AString fileName = QDir::tempPath() + "/ribbonWeightsTest_" + AString::number(QCoreApplication::applicationPid()) + ".weights";
+    const AString key = "0123456789abcdef0123456789abcdef01234567";
+    computed.writeFile(fileName, key);
+    RibbonWeightMatrix readBack;
+    if (!readBack.readFile(fileName, key, numNodes, dims))
+    {
+        setFailed("failed to read back ribbon weights file");
+    } else {
+        if (!sameMatrix(computed, readBack))
+        {
+            setFailed("ribbon weights read back differ from the weights written");
+        }
+        readBack.applyToFrames(frames.data(), NUM_FRAMES, readOut.data());
+        if (memcmp(computedOut.data(), readOut.data(), computedOut.size() * sizeof(float)) != 0)
+        {
+            setFailed("ribbon weights read back give different mapping than the computed weights");
+        }
+    }
+    
+    //anything that doesn't match the inputs must be rejected
+    const int64_t otherDims[3] = { 20, 20, 10 };
+    RibbonWeightMatrix rejected;
+    if (rejected.readFile(fileName, "fedcba9876543210fedcba9876543210fedcba98", numNodes, dims))
+    {
+        setFailed("ribbon weights file with a different key was accepted");
+    }
+    if (rejected.readFile(fileName, key, numNodes + 1, dims))
+    {
+        setFailed("ribbon weights file with a different number of vertices was accepted");
+    }
+    if (rejected.readFile(fileName, key, numNodes, otherDims))
+    {
+        setFailed("ribbon weights file with different volume dimensions was accepted");
+    }
+    const QByteArray goodFile = readAll(fileName);
+    const int64_t fileSize = goodFile.size();
+    const int64_t truncatedSizes[] = { fileSize - 1, fileSize / 2, 100 };//the last is shorter than the header
+    for (int t = 0; t < 3; ++t)
+    {
+        writeAll(fileName, goodFile.left(truncatedSizes[t]));
+        if (rejected.readFile(fileName, key, numNodes, dims))
+        {
+            setFailed("ribbon weights file truncated to " + AString::number(truncatedSizes[t]) + " bytes was accepted");
+        }
+    }
+    QByteArray corrupt = goodFile;
+    const int64_t badVoxel = frameSize;
+    memcpy(corrupt.data() + 128 + (numNodes + 1) * sizeof(int64_t), &badVoxel, sizeof(int64_t));//first voxel index
+    writeAll(fileName, corrupt);
+    if (rejected.readFile(fileName, key, numNodes, dims))
+    {
+        setFailed("ribbon weights file with an out of range voxel was accepted");
+    }
+    QFile::remove(fileName);
+    
+    //failing to write the file only warns
+    const AString badFileName = QDir::tempPath() + "/ribbonWeightsTest_" + AString::number(QCoreApplication::applicationPid()) + "_missing/sub/test.weights";
+    try
+    {
+        computed.writeFile(badFileName, key);
+    } catch (CaretException& e) {
+        setFailed("failing to write ribbon weights file threw: " + e.whatString());
+    }
+    if (QFile::exists(badFileName))
+    {
+        setFailed("ribbon weights file was written to a directory that doesn't exist");
+    }
+}
@@ -0,0 +1,173 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+#include "SurfaceResamplingTest.h"
+
+#include "SurfaceFile.h"
+#include "SurfaceResamplingHelper.h"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <vector>
+
+using namespace caret;
+using namespace std;
+
+SurfaceResamplingTest::SurfaceResamplingTest(const AString& identifier) : TestInterface(identifier)
+{
+}
+
+namespace
+{
+    //subdivided icosahedron with radius 100, rotated so that two spheres don't share vertex positions
+    void makeSphere(SurfaceFile& mySurf, const int& subdivisions, const float& rotation)
+    {
+        const float phi = (1.0f + sqrt(5.0f)) / 2.0f;
+        vector<float> coords = { -1, phi, 0,  1, phi, 0,  -1, -phi, 0,  1, -phi, 0,
+                                 0, -1, phi,  0, 1, phi,  0, -1, -phi,  0, 1, -phi,
+                                 phi, 0, -1,  phi, 0, 1,  -phi, 0, -1,  -phi, 0, 1 };
+        vector<int32_t> tris = { 0, 11, 5,  0, 5, 1,  0, 1, 7,  0, 7, 10,  0, 10, 11,
+                                 1, 5, 9,  5, 11, 4,  11, 10, 2,  10, 7, 6,  7, 1, 8,
+                                 3, 9, 4,  3, 4, 2,  3, 2, 6,  3, 6, 8,  3, 8, 9,
+                                 4, 9, 5,  2, 4, 11,  6, 2, 10,  8, 6, 7,  9, 8, 1 };
+        for (int s = 0; s < subdivisions; ++s)
+        {
+            map<pair<int32_t, int32_t>, int32_t> midpoints;
+            auto getMidpoint = [&](int32_t a, int32_t b) -> int32_t
+            {
+                pair<int32_t, int32_t> edge(min(a, b), max(a, b));
+                auto iter = midpoints.find(edge);
+                if (iter != midpoints.end()) return iter->second;
+                int32_t newNode = (int32_t)(coords.size() / 3);
+                for (int i = 0; i < 3; ++i) coords.push_back((coords[a * 3 + i] + coords[b * 3 + i]) * 0.5f);
+                midpoints[edge] = newNode;
+                return newNode;
+            };
+            vector<int32_t> newTris;
+            for (size_t t = 0; t < tris.size(); t += 3)
+            {
+                int32_t a = tris[t], b = tris[t + 1], c = tris[t + 2];
+                int32_t ab = getMidpoint(a, b), bc = getMidpoint(b, c), ca = getMidpoint(c, a);
+                int32_t quad[12] = { a, ab, ca,  b, bc, ab,  c, ca, bc,  ab, bc, ca };
+                newTris.insert(newTris.end(), quad, quad + 12);
+            }
+            tris.swap(newTris);
+        }
+        const int32_t numNodes = (int32_t)(coords.size() / 3), numTris = (int32_t)(tris.size() / 3);
+        mySurf.setNumberOfNodesAndTriangles(numNodes, numTris);
+        mySurf.setStructure(StructureEnum::CORTEX_LEFT);
+        mySurf.setSurfaceType(SurfaceTypeEnum::SPHERICAL);
+        const float cosRot = cos(rotation), sinRot = sin(rotation);
+        for (int32_t i = 0; i < numNodes; ++i)
+        {
+            float x = coords[i * 3], y = coords[i * 3 + 1], z = coords[i * 3 + 2];
+            float length = sqrt(x * x + y * y + z * z);
+            x *= 100.0f / length;
+            y *= 100.0f / length;
+            z *= 100.0f / length;
+            const float rotX = cosRot * x - sinRot * z, rotZ = sinRot * x + cosRot * z;//rotate about y, then tilt about x
+            mySurf.setCoordinate(i, rotX, cosRot * y - sinRot * rotZ, sinRot * y + cosRot * rotZ);
+        }
+        for (int32_t t = 0; t < numTris; ++t)
+        {
+            mySurf.setTriangle(t, tris[t * 3], tris[t * 3 + 1], tris[t * 3 + 2]);
+        }
+    }
+}
+
+void SurfaceResamplingTest::execute()
+{
+    SurfaceFile currentSphere, newSphere;
+    makeSphere(currentSphere, 3, 0.0f);
+    makeSphere(newSphere, 2, 0.37f);
+    const int32_t numCurrent = currentSphere.getNumberOfNodes(), numNew = newSphere.getNumberOfNodes();
+    vector<float> currentAreas, newAreas;
+    currentSphere.computeNodeAreas(currentAreas);
+    newSphere.computeNodeAreas(newAreas);
+    vector<float> roi(numCurrent);
+    const float* currentCoords = currentSphere.getCoordinateData();
+    for (int32_t i = 0; i < numCurrent; ++i)
+    {
+        roi[i] = (currentCoords[i * 3 + 2] < 40.0f ? 1.0f : 0.0f);//leaves a cap of new vertices with no weights
+    }
+    const int NUM_COLUMNS = 37;//two full blocks of columns plus a partial one
+    vector<vector<float> > inputData(NUM_COLUMNS, vector<float>(numCurrent));
+    vector<const float*> inputs(NUM_COLUMNS);
+    for (int c = 0; c < NUM_COLUMNS; ++c)
+    {
+        for (int32_t i = 0; i < numCurrent; ++i)
+        {
+            inputData[c][i] = sin(i * 0.29f + c * 1.7f) * 25.0f + c;
+        }
+        inputs[c] = inputData[c].data();
+    }
+    vector<vector<float> > columnsOut(NUM_COLUMNS, vector<float>(numNew));
+    vector<float*> outputs(NUM_COLUMNS);
+    for (int c = 0; c < NUM_COLUMNS; ++c)
+    {
+        outputs[c] = columnsOut[c].data();
+    }
+    vector<float> singleOut(numNew);
+    const int columnCounts[] = { NUM_COLUMNS, 1, 16, 17 };
+    const float invalidVals[] = { 0.0f, -7.5f, numeric_limits<float>::quiet_NaN() };
+    for (int method = 0; method < 2; ++method)
+    {
+        for (int useRoi = 0; useRoi < 2; ++useRoi)
+        {
+            const float* roiPtr = (useRoi != 0 ? roi.data() : NULL);
+            const AString condition = AString(method == 0 ? "ADAP_BARY_AREA" : "BARYCENTRIC") + (useRoi != 0 ? " with roi" : "");
+            SurfaceResamplingHelper myHelp((method == 0 ? SurfaceResamplingMethodEnum::ADAP_BARY_AREA : SurfaceResamplingMethodEnum::BARYCENTRIC),
+                                           &currentSphere, &newSphere, currentAreas.data(), newAreas.data(), roiPtr);
+            if (useRoi != 0)
+            {
+                vector<float> validRoi(numNew);
+                myHelp.getResampleValidROI(validRoi.data());
+                int32_t numInvalid = 0;
+                for (int32_t i = 0; i < numNew; ++i)
+                {
+                    if (!(validRoi[i] > 0.0f)) ++numInvalid;
+                }
+                if (numInvalid == 0)
+                {
+                    setFailed(condition + ", roi did not leave any vertices without data");
+                }
+            }
+            for (int v = 0; v < 3; ++v)
+            {
+                for (int n = 0; n < 4; ++n)
+                {
+                    const int numColumns = columnCounts[n];
+                    myHelp.resampleNormalColumns(inputs.data(), outputs.data(), numColumns, invalidVals[v]);
+                    for (int c = 0; c < numColumns; ++c)
+                    {
+                        myHelp.resampleNormal(inputs[c], singleOut.data(), invalidVals[v]);
+                        if (memcmp(singleOut.data(), outputs[c], numNew * sizeof(float)) != 0)
+                        {//same arithmetic, so the results must be identical, including the NaN invalid values
+                            setFailed(condition + ", invalid value " + AString::number(invalidVals[v]) + ", " + AString::number(numColumns) +
+                                      " columns, resampleNormalColumns differs from resampleNormal for column " + AString::number(c));
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,147 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+#include "TopologyHelperBenchmark.h"
+#include "CaretPointer.h"
+#include "ElapsedTimer.h"
+#include "SurfaceFile.h"
+#include "TopologyHelper.h"
+
+#include <iostream>
+
+using namespace caret;
+using namespace std;
+
+namespace
+{
+    struct ReferenceNodeInfo
+    {//the per-node layout TopologyHelperBase used before compressed rows
+        vector<int32_t> m_neighbors, m_edges, m_tiles, m_whichVertex;
+    };
+    
+    void buildReference(const SurfaceFile& mySurf, vector<ReferenceNodeInfo>& nodeInfo)
+    {
+        int32_t numNodes = mySurf.getNumberOfNodes(), numTris = mySurf.getNumberOfTriangles();
+        nodeInfo.clear();
+        nodeInfo.resize(numNodes);
+        for (int32_t i = 0; i < numTris; ++i)
+        {
+            const int32_t* thisTri = mySurf.getTriangle(i);
+            for (int k = 0; k < 3; ++k)
+            {
+                nodeInfo[thisTri[k]].m_tiles.push_back(i);
+                nodeInfo[thisTri[k]].m_whichVertex.push_back(k);
+            }
+        }
+        CaretArray<int32_t> scratch(numNodes, -1);
+        int32_t numEdges = 0;
+        for (int32_t i = 0; i < numNodes; ++i)
+        {
+            const vector<int32_t>& myTiles = nodeInfo[i].m_tiles;
+            for (int j = 0; j < (int)myTiles.size(); ++j)
+            {
+                const int32_t* thisTri = mySurf.getTriangle(myTiles[j]);
+                for (int k = 0; k < 3; ++k)
+                {
+                    int32_t neighbor = thisTri[k];
+                    if (neighbor > i && scratch[neighbor] != i)//each edge is added by its lower numbered node
+                    {
+                        scratch[neighbor] = i;
+                        nodeInfo[i].m_neighbors.push_back(neighbor);
+                        nodeInfo[i].m_edges.push_back(numEdges);
+                        nodeInfo[neighbor].m_neighbors.push_back(i);
+                        nodeInfo[neighbor].m_edges.push_back(numEdges);
+                        ++numEdges;
+                    }
+                }
+            }
+        }
+    }
+}
+
+TopologyHelperBenchmark::TopologyHelperBenchmark(const AString& identifier): TestInterface(identifier)
+{
+}
+
+void TopologyHelperBenchmark::execute()
+{
+    SurfaceFile mySurf;
+    mySurf.readFile(m_default_path + "/gifti/Human.PALS_B12.LEFT_AVG_B1-12.FIDUCIAL_FLIRT.clean.73730.surf.gii");
+    const int32_t numNodes = mySurf.getNumberOfNodes();
+    const int BUILD_REPEATS = 5, ITERATE_PASSES = 50;
+    ElapsedTimer myTimer;
+    vector<ReferenceNodeInfo> refInfo;
+    myTimer.start();
+    for (int i = 0; i < BUILD_REPEATS; ++i)
+    {
+        buildReference(mySurf, refInfo);
+    }
+    double refBuild = myTimer.getElapsedTimeMilliseconds() / BUILD_REPEATS;
+    CaretPointer<TopologyHelperBase> myBase;
+    myTimer.start();
+    for (int i = 0; i < BUILD_REPEATS; ++i)
+    {
+        myBase.grabNew(new TopologyHelperBase(&mySurf));
+    }
+    double csrBuild = myTimer.getElapsedTimeMilliseconds() / BUILD_REPEATS;
+    TopologyHelper myHelp(myBase);
+    int64_t refSum = 0, csrSum = 0;
+    myTimer.start();
+    for (int pass = 0; pass < ITERATE_PASSES; ++pass)
+    {
+        for (int32_t i = 0; i < numNodes; ++i)
+        {
+            const vector<int32_t>& neighbors = refInfo[i].m_neighbors;
+            int numNeigh = (int)neighbors.size();
+            for (int j = 0; j < numNeigh; ++j)
+            {
+                refSum += neighbors[j];
+            }
+        }
+    }
+    double refIterate = myTimer.getElapsedTimeMilliseconds() / ITERATE_PASSES;
+    myTimer.start();
+    for (int pass = 0; pass < ITERATE_PASSES; ++pass)
+    {
+        for (int32_t i = 0; i < numNodes; ++i)
+        {
+            const CaretSpan<int32_t> neighbors = myHelp.getNodeNeighbors(i);
+            int numNeigh = (int)neighbors.size();
+            for (int j = 0; j < numNeigh; ++j)
+            {
+                csrSum += neighbors[j];
+            }
+        }
+    }
+    double csrIterate = myTimer.getElapsedTimeMilliseconds() / ITERATE_PASSES;
+    cout << "topology construction, per-node vectors: " << refBuild << " ms, compressed rows: " << csrBuild << " ms" << endl;
+    cout << "neighbor iteration pass, per-node vectors: " << refIterate << " ms, compressed rows: " << csrIterate << " ms" << endl;
+    if (refSum != csrSum)
+    {
+        setFailed("neighbor sums differ, per-node vectors: " + AString::number(refSum) + ", compressed rows: " + AString::number(csrSum));
+    }
+    for (int32_t i = 0; i < numNodes; ++i)
+    {
+        if ((int)refInfo[i].m_neighbors.size() != myHelp.getNodeNumberOfNeighbors(i) || refInfo[i].m_tiles.size() != myHelp.getNodeTiles(i).size())
+        {
+            setFailed("neighbor or tile count differs at node " + AString::number(i));
+            break;
+        }
+    }
+}
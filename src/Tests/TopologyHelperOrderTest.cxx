@@ -0,0 +1,278 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+#include "TopologyHelperOrderTest.h"
+#include "CaretAssert.h"
+#include "CaretPointer.h"
+#include "SurfaceFile.h"
+#include "TopologyHelper.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+using namespace caret;
+using namespace std;
+
+namespace
+{
+    class ReferenceTopology
+    {//the per-node layout and neighbor order of TopologyHelperBase before compressed rows, with the same edge numbering
+        void processTileNeighbor(CaretArray<int32_t>& scratch, const int32_t& root, const int32_t& neighbor, const int32_t& thirdNode, const int32_t& tile, const int32_t& tileEdge, const bool& reversed)
+        {
+            if (scratch[neighbor] == -1)
+            {
+                int32_t myEdge = (int32_t)m_edgeInfo.size();
+                m_edgeInfo.push_back(TopologyEdgeInfo(root, neighbor, thirdNode, tile, tileEdge, reversed));
+                m_nodeInfo[root].m_neighbors.push_back(neighbor);
+                m_nodeInfo[root].m_edges.push_back(myEdge);
+                m_nodeInfo[neighbor].m_neighbors.push_back(root);
+                m_nodeInfo[neighbor].m_edges.push_back(myEdge);
+                scratch[neighbor] = myEdge;
+                m_tileInfo[tile].edges[tileEdge].edge = myEdge;
+            } else {
+                m_edgeInfo[scratch[neighbor]].addTile(thirdNode, tile, tileEdge, reversed);
+                m_tileInfo[tile].edges[tileEdge].edge = scratch[neighbor];
+            }
+            m_tileInfo[tile].edges[tileEdge].reversed = reversed;
+        }
+
+        int32_t findTileEdge(const int32_t& tile, const int32_t& node, const int32_t& other) const
+        {
+            for (int i = 0; i < 3; ++i)
+            {
+                const TopologyEdgeInfo& thisEdge = m_edgeInfo[m_tileInfo[tile].edges[i].edge];
+                if ((thisEdge.node1 == node && thisEdge.node2 == other) || (thisEdge.node1 == other && thisEdge.node2 == node))
+                {
+                    return m_tileInfo[tile].edges[i].edge;
+                }
+            }
+            return -1;
+        }
+
+        void sortNeighbors(const int32_t& node, CaretArray<int32_t>& nodeScratch, CaretArray<int32_t>& tileScratch)
+        {
+            NodeInfo& myNodeInfo = m_nodeInfo[node];
+            int numNeigh = (int)myNodeInfo.m_neighbors.size();
+            if (numNeigh == 0) return;
+            int firstIndex = 0;
+            for (int i = 0; i < numNeigh; ++i)
+            {//start at a boundary edge that is oriented with its tile, if there is one
+                const TopologyEdgeInfo& thisEdge = m_edgeInfo[myNodeInfo.m_edges[i]];
+                if (thisEdge.numTiles == 1)
+                {
+                    firstIndex = i;
+                    if ((thisEdge.node1 == node) != thisEdge.tiles[0].edgeReversed) break;
+                }
+            }
+            vector<int32_t> tempNeigh, tempEdges, tempTiles;
+            int32_t nextNode = myNodeInfo.m_neighbors[firstIndex];
+            int32_t nextEdge = myNodeInfo.m_edges[firstIndex];
+            int tileToUse = 0;
+            if (m_edgeInfo[nextEdge].numTiles > 1 && m_edgeInfo[nextEdge].tiles[0].edgeReversed != (m_edgeInfo[nextEdge].node1 == nextNode))
+            {
+                tileToUse = 1;
+            }
+            bool foundNext = true;
+            do
+            {
+                int32_t nextTile = m_edgeInfo[nextEdge].tiles[tileToUse].tile;
+                int32_t node3 = m_edgeInfo[nextEdge].tiles[tileToUse].node3;
+                nextEdge = findTileEdge(nextTile, node, node3);
+                CaretAssert(nextEdge != -1);
+                tempNeigh.push_back(nextNode);
+                tempEdges.push_back(nextEdge);
+                nodeScratch[nextNode] = 0;
+                tempTiles.push_back(nextTile);
+                nextNode = node3;
+                tileScratch[nextTile] = 0;
+                tileToUse = 0;
+                if (tileScratch[m_edgeInfo[nextEdge].tiles[0].tile] == 0 && m_edgeInfo[nextEdge].numTiles > 1) tileToUse = 1;
+                if (tileScratch[m_edgeInfo[nextEdge].tiles[tileToUse].tile] == 0) foundNext = false;
+            } while (foundNext);
+            for (int i = 0; i < numNeigh; ++i)
+            {//neighbors that are gap-separated or on the third tile of an edge go at the end, in their unsorted order
+                if (nodeScratch[myNodeInfo.m_neighbors[i]] == 0)
+                {
+                    nodeScratch[myNodeInfo.m_neighbors[i]] = -1;
+                } else {
+                    tempNeigh.push_back(myNodeInfo.m_neighbors[i]);
+                    tempEdges.push_back(myNodeInfo.m_edges[i]);
+                }
+            }
+            for (int i = 0; i < (int)myNodeInfo.m_tiles.size(); ++i)
+            {
+                if (tileScratch[myNodeInfo.m_tiles[i]] == 0)
+                {
+                    tileScratch[myNodeInfo.m_tiles[i]] = -1;
+                } else {
+                    tempTiles.push_back(myNodeInfo.m_tiles[i]);
+                }
+            }
+            myNodeInfo.m_neighbors = tempNeigh;
+            myNodeInfo.m_edges = tempEdges;
+            myNodeInfo.m_tiles = tempTiles;
+        }
+    public:
+        struct NodeInfo
+        {
+            vector<int32_t> m_neighbors, m_edges, m_tiles, m_whichVertex;
+        };
+        vector<NodeInfo> m_nodeInfo;
+        vector<TopologyEdgeInfo> m_edgeInfo;
+        vector<TopologyTileInfo> m_tileInfo;
+
+        ReferenceTopology(const SurfaceFile& mySurf, const bool& sortFlag)
+        {
+            int32_t numNodes = mySurf.getNumberOfNodes(), numTris = mySurf.getNumberOfTriangles();
+            m_nodeInfo.resize(numNodes);
+            m_tileInfo.resize(numTris);
+            for (int32_t i = 0; i < numTris; ++i)
+            {
+                const int32_t* thisTri = mySurf.getTriangle(i);
+                for (int k = 0; k < 3; ++k)
+                {
+                    m_nodeInfo[thisTri[k]].m_tiles.push_back(i);
+                    m_nodeInfo[thisTri[k]].m_whichVertex.push_back(k);
+                }
+            }
+            CaretArray<int32_t> scratch(numNodes, -1);
+            for (int32_t i = 0; i < numNodes; ++i)
+            {
+                for (int j = 0; j < (int)m_nodeInfo[i].m_tiles.size(); ++j)
+                {
+                    int32_t myTile = m_nodeInfo[i].m_tiles[j];
+                    const int32_t* thisTri = mySurf.getTriangle(myTile);
+                    int32_t myVert = m_nodeInfo[i].m_whichVertex[j];
+                    int32_t next = thisTri[(myVert + 1) % 3], prev = thisTri[(myVert + 2) % 3];
+                    if (next > i) processTileNeighbor(scratch, i, next, prev, myTile, myVert, false);
+                    if (prev > i) processTileNeighbor(scratch, i, prev, next, myTile, (myVert + 2) % 3, true);
+                }
+                for (int j = 0; j < (int)m_nodeInfo[i].m_neighbors.size(); ++j)
+                {
+                    scratch[m_nodeInfo[i].m_neighbors[j]] = -1;
+                }
+            }
+            if (sortFlag)
+            {
+                CaretArray<int32_t> scratch2(numTris, -1);
+                for (int32_t i = 0; i < numNodes; ++i)
+                {
+                    sortNeighbors(i, scratch, scratch2);
+                }
+            }
+        }
+    };
+
+    bool sameOrder(const CaretSpan<int32_t>& test, const vector<int32_t>& reference)
+    {
+        return test.size() == reference.size() && equal(test.begin(), test.end(), reference.begin());
+    }
+
+    vector<int32_t> shuffledIndices(const int32_t& count)
+    {
+        vector<int32_t> ret(count);
+        for (int32_t i = 0; i < count; ++i)
+        {
+            ret[i] = i;
+        }
+        for (int32_t i = count - 1; i > 0; --i)
+        {
+            swap(ret[i], ret[rand() % (i + 1)]);
+        }
+        return ret;
+    }
+    
+    void makeGrid(SurfaceFile& mySurf, const int32_t& numX, const int32_t& numY, const bool& wrap, const bool& addFin)
+    {//consistently oriented triangles on a grid, a torus when wrapped, with node numbers, triangle order and first vertices shuffled
+        int32_t cellsX = wrap ? numX : numX - 1, cellsY = wrap ? numY : numY - 1;
+        int32_t numNodes = numX * numY + (addFin ? 1 : 0);
+        vector<int32_t> permute = shuffledIndices(numNodes);
+        vector<int32_t> triangles;
+        for (int32_t y = 0; y < cellsY; ++y)
+        {
+            for (int32_t x = 0; x < cellsX; ++x)
+            {
+                int32_t a = x + y * numX, b = (x + 1) % numX + y * numX, c = x + ((y + 1) % numY) * numX, d = (x + 1) % numX + ((y + 1) % numY) * numX;
+                triangles.push_back(a); triangles.push_back(b); triangles.push_back(d);
+                triangles.push_back(a); triangles.push_back(d); triangles.push_back(c);
+            }
+        }
+        if (addFin)
+        {//a third triangle on an interior edge, so the sorting also has neighbors it can't reach
+            int32_t a = 1 + numX, d = 2 + 2 * numX;
+            triangles.push_back(a); triangles.push_back(d); triangles.push_back(numX * numY);
+        }
+        int32_t numTris = (int32_t)triangles.size() / 3;
+        vector<int32_t> triOrder = shuffledIndices(numTris);
+        mySurf.setNumberOfNodesAndTriangles(numNodes, numTris);
+        for (int32_t i = 0; i < numNodes; ++i)
+        {
+            mySurf.setCoordinate(permute[i], (float)(i % numX), (float)(i / numX), 0.0f);
+        }
+        for (int32_t i = 0; i < numTris; ++i)
+        {
+            const int32_t* thisTri = triangles.data() + triOrder[i] * 3;
+            int rotate = rand() % 3;//rotating the vertices keeps the orientation
+            mySurf.setTriangle(i, permute[thisTri[rotate]], permute[thisTri[(rotate + 1) % 3]], permute[thisTri[(rotate + 2) % 3]]);
+        }
+    }
+}
+
+TopologyHelperOrderTest::TopologyHelperOrderTest(const AString& identifier): TestInterface(identifier)
+{
+}
+
+void TopologyHelperOrderTest::checkSurface(const SurfaceFile& mySurf, const AString& descrip)
+{
+    const int32_t numNodes = mySurf.getNumberOfNodes();
+    for (int sorted = 0; sorted < 2; ++sorted)
+    {
+        const AString orderName = descrip + (sorted ? " sorted" : " unsorted");
+        ReferenceTopology reference(mySurf, sorted != 0);
+        TopologyHelper myHelp(CaretPointer<TopologyHelperBase>(new TopologyHelperBase(&mySurf, sorted != 0)));
+        for (int32_t i = 0; i < numNodes; ++i)
+        {
+            const ReferenceTopology::NodeInfo& refInfo = reference.m_nodeInfo[i];
+            if (!sameOrder(myHelp.getNodeNeighbors(i), refInfo.m_neighbors))
+            {
+                setFailed(orderName + " neighbors differ from the per-node layout at node " + AString::number(i));
+                break;//one node is enough to show the problem
+            }
+            if (!sameOrder(myHelp.getNodeEdges(i), refInfo.m_edges))
+            {
+                setFailed(orderName + " edges differ from the per-node layout at node " + AString::number(i));
+                break;
+            }
+            if (!sameOrder(myHelp.getNodeTiles(i), refInfo.m_tiles))
+            {
+                setFailed(orderName + " tiles differ from the per-node layout at node " + AString::number(i));
+                break;
+            }
+        }
+    }
+}
+
+void TopologyHelperOrderTest::execute()
+{
+    SurfaceFile closedSurf, openSurf;
+    makeGrid(closedSurf, 20, 15, true, false);
+    makeGrid(openSurf, 20, 15, false, true);
+    checkSurface(closedSurf, "closed surface");
+    checkSurface(openSurf, "open surface");
+}
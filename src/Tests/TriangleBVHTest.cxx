@@ -0,0 +1,145 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "TriangleBVHTest.h"
+
+#include "CaretTriangleBVH.h"
+
+#include <cmath>
+#include <cstdlib>
+
+using namespace caret;
+using namespace std;
+
+namespace
+{
+    bool bruteForceHit(const float* v0, const float* v1, const float* v2, const float origin[3], const float direction[3], double& distOut)
+    {
+        double edge1[3], edge2[3], toOrigin[3];
+        for (int j = 0; j < 3; ++j)
+        {
+            edge1[j] = (double)v1[j] - v0[j];
+            edge2[j] = (double)v2[j] - v0[j];
+            toOrigin[j] = (double)origin[j] - v0[j];
+        }
+        double p[3] = { direction[1] * edge2[2] - direction[2] * edge2[1], direction[2] * edge2[0] - direction[0] * edge2[2], direction[0] * edge2[1] - direction[1] * edge2[0] };
+        double det = edge1[0] * p[0] + edge1[1] * p[1] + edge1[2] * p[2];
+        if (det == 0.0) return false;
+        double u = (toOrigin[0] * p[0] + toOrigin[1] * p[1] + toOrigin[2] * p[2]) / det;
+        if (u < 0.0 || u > 1.0) return false;
+        double q[3] = { toOrigin[1] * edge1[2] - toOrigin[2] * edge1[1], toOrigin[2] * edge1[0] - toOrigin[0] * edge1[2], toOrigin[0] * edge1[1] - toOrigin[1] * edge1[0] };
+        double v = (direction[0] * q[0] + direction[1] * q[1] + direction[2] * q[2]) / det;
+        if (v < 0.0 || u + v > 1.0) return false;
+        distOut = (edge2[0] * q[0] + edge2[1] * q[1] + edge2[2] * q[2]) / det;
+        return distOut >= 0.0;
+    }
+}
+
+TriangleBVHTest::TriangleBVHTest(const AString& identifier) : TestInterface(identifier)
+{
+}
+
+void TriangleBVHTest::execute()
+{
+    const int NUM_LAT = 60, NUM_LON = 120;
+    const int NUM_RAYS = 2000;
+    const float RADIUS = 50.0f, MAX_DIST = 3.0f;
+    vector<float> coords;
+    vector<int32_t> triangles;
+    for (int i = 0; i <= NUM_LAT; ++i)//sphere, so that rays hit the mesh twice
+    {
+        for (int j = 0; j < NUM_LON; ++j)
+        {
+            double theta = M_PI * i / NUM_LAT, phi = 2.0 * M_PI * j / NUM_LON;
+            coords.push_back(RADIUS * sin(theta) * cos(phi) + (rand() % 101) / 1000.0f);
+            coords.push_back(RADIUS * sin(theta) * sin(phi));
+            coords.push_back(RADIUS * cos(theta));
+        }
+    }
+    for (int i = 0; i < NUM_LAT; ++i)
+    {
+        for (int j = 0; j < NUM_LON; ++j)
+        {
+            int32_t a = i * NUM_LON + j, b = i * NUM_LON + (j + 1) % NUM_LON;
+            int32_t quad[6] = { a, b, b + NUM_LON, a, b + NUM_LON, a + NUM_LON };
+            triangles.insert(triangles.end(), quad, quad + 6);
+        }
+    }
+    const int numCoords = coords.size() / 3, numTriangles = triangles.size() / 3;
+    CaretTriangleBVH bvh(coords.data(), numCoords, triangles.data(), numTriangles);
+    for (int i = 0; i < NUM_RAYS; ++i)
+    {
+        float origin[3], direction[3];
+        for (int j = 0; j < 3; ++j)
+        {
+            origin[j] = (rand() % 20001) / 100.0f - 100.0f;
+            direction[j] = (rand() % 2001) / 1000.0f - 1.0f;
+        }
+        if (i % 3 == 0) direction[0] = 0.0f;//axis-parallel rays have infinite inverse direction components
+        double bestDist = -1.0;
+        int bestTriangle = -1, inRangeCount = 0;
+        for (int t = 0; t < numTriangles; ++t)
+        {
+            const int32_t* tri = triangles.data() + t * 3;
+            double dist;
+            if (bruteForceHit(coords.data() + tri[0] * 3, coords.data() + tri[1] * 3, coords.data() + tri[2] * 3, origin, direction, dist))
+            {
+                if (bestTriangle < 0 || dist < bestDist)
+                {
+                    bestDist = dist;
+                    bestTriangle = t;
+                }
+                if (dist <= MAX_DIST) ++inRangeCount;
+            }
+        }
+        TriangleRayHit hit;
+        bool found = bvh.closestHit(origin, direction, hit);
+        if (found != (bestTriangle >= 0))
+        {
+            setFailed("closest hit disagrees with brute force about hitting the mesh for ray " + AString::number(i));
+            continue;
+        }
+        if (found)
+        {
+            if (abs(hit.distance - bestDist) > 1e-4 * max(1.0, bestDist))
+            {
+                setFailed("closest hit distance is wrong for ray " + AString::number(i));
+            }
+            float weightSum = hit.barycentric[0] + hit.barycentric[1] + hit.barycentric[2];
+            if (abs(weightSum - 1.0f) > 1e-5f)
+            {
+                setFailed("barycentric weights don't sum to 1 for ray " + AString::number(i));
+            }
+        }
+        vector<TriangleRayHit> allHits = bvh.allHits(origin, direction, MAX_DIST);
+        if ((int)allHits.size() != inRangeCount)
+        {
+            setFailed("all hits found " + AString::number(allHits.size()) + " hits instead of " +
+                      AString::number(inRangeCount) + " for ray " + AString::number(i));
+        }
+        for (int j = 1; j < (int)allHits.size(); ++j)
+        {
+            if (allHits[j].distance < allHits[j - 1].distance)
+            {
+                setFailed("all hits are not sorted by distance for ray " + AString::number(i));
+            }
+        }
+    }
+}
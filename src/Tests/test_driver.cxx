@@ -33,20 +33,32 @@
 #include "CaretException.h"
 
 //tests
+#include "Base64Test.h"
+#include "BrainParallelReadTest.h"
 #include "CiftiFileTest.h"
 #include "DotTest.h"
 #include "GeodesicHelperTest.h"
+#include "GzipSeekIndexTest.h"
 #include "HttpTest.h"
 #include "HeapTest.h"
 #include "LookupTest.h"
 #include "MathExpressionTest.h"
+#include "MetricSmoothingTest.h"
 #include "NiftiTest.h"
+#include "PaletteColoringCacheTest.h"
+#include "PaletteTest.h"
+#include "PointLocatorTest.h"
 #include "PointerTest.h"
 #include "ProgressTest.h"
 #include "QuatTest.h"
+#include "RibbonWeightsTest.h"
 #include "StatisticsTest.h"
+#include "SurfaceResamplingTest.h"
 #include "TimerTest.h"
+#include "TopologyHelperBenchmark.h"
+#include "TopologyHelperOrderTest.h"
 #include "TopologyHelperTest.h"
+#include "TriangleBVHTest.h"
 #include "VolumeFileTest.h"
 #include "XnatTest.h"
 
@@ -69,21 +81,35 @@ int main(int argc, char** argv)
         caret_global_commandLine_init(argc, argv);
         SessionManager::createSessionManager(ApplicationTypeEnum::APPLICATION_TYPE_COMMAND_LINE);
         vector<TestInterface*> mytests;
+        mytests.push_back(new Base64Test("base64"));
+        mytests.push_back(new BrainParallelReadTest("brainread"));
         mytests.push_back(new CiftiFileTest("ciftifile"));
+        mytests.push_back(new CiftiFileTest("ciftiimpl"));
         mytests.push_back(new DotTest("dotsimd"));
         mytests.push_back(new GeodesicHelperTest("geohelp"));
+        mytests.push_back(new GzipSeekIndexTest("gzipseek"));
         mytests.push_back(new HeapTest("heap"));
         mytests.push_back(new HttpTest("http"));
         mytests.push_back(new LookupTest("lookup"));
         mytests.push_back(new MathExpressionTest("mathexpression"));
+        mytests.push_back(new MetricSmoothingTest("smoothcache"));
+        mytests.push_back(new MetricSmoothingTest("smoothpanel"));
         mytests.push_back(new NiftiFileTest("niftifile"));
         mytests.push_back(new NiftiHeaderTest("niftiheader"));
+        mytests.push_back(new PaletteColoringCacheTest("palettecache"));
+        mytests.push_back(new PaletteTest("palette"));
         mytests.push_back(new PointerTest("pointer"));
+        mytests.push_back(new PointLocatorTest("pointlocator"));
         mytests.push_back(new ProgressTest("progress"));
         mytests.push_back(new QuatTest("quaternion"));
+        mytests.push_back(new RibbonWeightsTest("ribbonweights"));
         mytests.push_back(new StatisticsTest("statistics"));
+        mytests.push_back(new SurfaceResamplingTest("resamplecolumns"));
         mytests.push_back(new TimerTest("timer"));
+        mytests.push_back(new TopologyHelperBenchmark("topobench"));
+        mytests.push_back(new TopologyHelperOrderTest("topoorder"));
         mytests.push_back(new TopologyHelperTest("topohelp"));
+        mytests.push_back(new TriangleBVHTest("trianglebvh"));
         mytests.push_back(new VolumeFileTest("volumefile"));
         mytests.push_back(new XnatTest("xnat"));
         if (argc < 2)
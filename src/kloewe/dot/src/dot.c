@@ -14,6 +14,8 @@
 extern float  sdot  (const float  *a, const float  *b, int n);
 extern double ddot  (const double *a, const double *b, int n);
 extern double dsdot (const float  *a, const float  *b, int n);
+extern void   dsdot4x4 (const float *const *a, const float *const *b,
+                        int n, double *out);
 
 /*----------------------------------------------------------------------------
   Global Variables
@@ -21,6 +23,7 @@ extern double dsdot (const float  *a, const float  *b, int n);
 sdot_func  *sdot_ptr  = &sdot_select;
 ddot_func  *ddot_ptr  = &ddot_select;
 dsdot_func *dsdot_ptr = &dsdot_select;
+dsdot4x4_func *dsdot4x4_ptr = &dsdot4x4_select;
 
 /*----------------------------------------------------------------------------
   Functions
@@ -41,14 +44,21 @@ double dsdot_select (const float *a, const float *b, int n) {
   return (*dsdot_ptr)(a,b,n);
 }
 
+void dsdot4x4_select (const float *const *a, const float *const *b,
+                      int n, double *out) {
+  dot_set_impl(DOT_AUTO);
+  (*dsdot4x4_ptr)(a,b,n,out);
+}
+
 dot_flags dot_set_impl (dot_flags impl) {
 
   // forcibly select the naive implementations if the architecture
   // is anything other than x86_64
   #ifndef ARCH_IS_X86_64
-  sdot_ptr  = &sdot_naive;
-  ddot_ptr  = &ddot_naive;
-  dsdot_ptr = &dsdot_naive;
+  sdot_ptr     = &sdot_naive;
+  ddot_ptr     = &ddot_naive;
+  dsdot_ptr    = &dsdot_naive;
+  dsdot4x4_ptr = &dsdot4x4_naive;
   return DOT_NAIVE;
   // note that the cpuinfo functions are currently only being made
   // available if the architecture is x86_64 (see top of file)
@@ -59,17 +69,19 @@ dot_flags dot_set_impl (dot_flags impl) {
      #ifndef DOT_NOFMA
     case DOT_AVX512FMA :
       if (hasAVX512f() && hasFMA3()) {
-        sdot_ptr  = &sdot_avx512fma;
-        ddot_ptr  = &ddot_avx512fma;
-        dsdot_ptr = &dsdot_avx512fma;
+        sdot_ptr     = &sdot_avx512fma;
+        ddot_ptr     = &ddot_avx512fma;
+        dsdot_ptr    = &dsdot_avx512fma;
+        dsdot4x4_ptr = &dsdot4x4_avx512fma;
         return DOT_AVX512FMA;
       }
      #endif
     case DOT_AVX512 :
       if (hasAVX512f()) {
-        sdot_ptr  = &sdot_avx512;
-        ddot_ptr  = &ddot_avx512;
-        dsdot_ptr = &dsdot_avx512;
+        sdot_ptr     = &sdot_avx512;
+        ddot_ptr     = &ddot_avx512;
+        dsdot_ptr    = &dsdot_avx512;
+        dsdot4x4_ptr = &dsdot4x4_avx512;
         return DOT_AVX512;
       }
     #endif
@@ -78,30 +90,34 @@ dot_flags dot_set_impl (dot_flags impl) {
     // implementations and are thus only used if explicitly requested.
     case DOT_AVXFMA :
       if ((impl == DOT_AVXFMA) && hasAVX() && hasFMA3()) {
-        sdot_ptr  = &sdot_avxfma;
-        ddot_ptr  = &ddot_avxfma;
-        dsdot_ptr = &dsdot_avxfma;
+        sdot_ptr     = &sdot_avxfma;
+        ddot_ptr     = &ddot_avxfma;
+        dsdot_ptr    = &dsdot_avxfma;
+        dsdot4x4_ptr = &dsdot4x4_avxfma;
         return DOT_AVXFMA;
       }
     #endif
     case DOT_AVX :
       if (hasAVX()) {
-        sdot_ptr  = &sdot_avx;
-        ddot_ptr  = &ddot_avx;
-        dsdot_ptr = &dsdot_avx;
+        sdot_ptr     = &sdot_avx;
+        ddot_ptr     = &ddot_avx;
+        dsdot_ptr    = &dsdot_avx;
+        dsdot4x4_ptr = &dsdot4x4_avx;
         return DOT_AVX;
       }
     case DOT_SSE2 :
       if (hasSSE2()) {
-        sdot_ptr  = &sdot_sse2;
-        ddot_ptr  = &ddot_sse2;
-        dsdot_ptr = &dsdot_sse2;
+        sdot_ptr     = &sdot_sse2;
+        ddot_ptr     = &ddot_sse2;
+        dsdot_ptr    = &dsdot_sse2;
+        dsdot4x4_ptr = &dsdot4x4_sse2;
         return DOT_SSE2;
       }
     case DOT_NAIVE :
-      sdot_ptr  = &sdot_naive;
-      ddot_ptr  = &ddot_naive;
-      dsdot_ptr = &dsdot_naive;
+      sdot_ptr     = &sdot_naive;
+      ddot_ptr     = &ddot_naive;
+      dsdot_ptr    = &dsdot_naive;
+      dsdot4x4_ptr = &dsdot4x4_naive;
       return DOT_NAIVE;
     default :
       return dot_set_impl(DOT_AUTO);
@@ -43,6 +43,8 @@ typedef enum {
 typedef float  (sdot_func)    (const float  *a, const float  *b, int n);
 typedef double (ddot_func)    (const double *a, const double *b, int n);
 typedef double (dsdot_func)   (const float  *a, const float  *b, int n);
+typedef void   (dsdot4x4_func)(const float *const *a, const float *const *b,
+                               int n, double *out);
 
 /*----------------------------------------------------------------------------
   Global Variables
@@ -50,6 +52,7 @@ typedef double (dsdot_func)   (const float  *a, const float  *b, int n);
 extern sdot_func  *sdot_ptr;
 extern ddot_func  *ddot_ptr;
 extern dsdot_func *dsdot_ptr;
+extern dsdot4x4_func *dsdot4x4_ptr;
 
 /*----------------------------------------------------------------------------
   Function Prototypes
@@ -58,6 +61,18 @@ inline float  sdot            (const float  *a, const float  *b, int n);
 inline double ddot            (const double *a, const double *b, int n);
 inline double dsdot           (const float  *a, const float  *b, int n);
 
+/* dsdot4x4
+ * --------
+ * compute a 4x4 block of dot products, out[4*i+j] = dot(a[i], b[j]), with
+ * all 8 vectors of length n; each loaded element of b is used for 4 products
+ * and each loaded element of a for 2 (SSE2, AVX) or 4 (AVX-512) products,
+ * instead of 1 each for dsdot, which makes this much cheaper than 16 dsdot
+ * calls when many rows have to be multiplied with each other (e.g.,
+ * correlation matrices)
+ */
+inline void   dsdot4x4        (const float *const *a, const float *const *b,
+                               int n, double *out);
+
 /* dot_set_impl
  * ------------
  * specify the set of implementations that is used
@@ -85,33 +100,47 @@ extern dot_flags dot_set_impl (dot_flags impl);
 extern float  sdot_select     (const float  *a, const float  *b, int n);
 extern double ddot_select     (const double *a, const double *b, int n);
 extern double dsdot_select    (const float  *a, const float  *b, int n);
+extern void   dsdot4x4_select (const float *const *a, const float *const *b,
+                               int n, double *out);
 
 extern float  sdot_naive      (const float  *a, const float  *b, int n);
 extern double ddot_naive      (const double *a, const double *b, int n);
 extern double dsdot_naive     (const float  *a, const float  *b, int n);
+extern void   dsdot4x4_naive  (const float *const *a, const float *const *b,
+                               int n, double *out);
 
 #ifdef ARCH_IS_X86_64
 extern float  sdot_sse2       (const float  *a, const float  *b, int n);
 extern double ddot_sse2       (const double *a, const double *b, int n);
 extern double dsdot_sse2      (const float  *a, const float  *b, int n);
+extern void   dsdot4x4_sse2   (const float *const *a, const float *const *b,
+                               int n, double *out);
 
 extern float  sdot_avx        (const float  *a, const float  *b, int n);
 extern double ddot_avx        (const double *a, const double *b, int n);
 extern double dsdot_avx       (const float  *a, const float  *b, int n);
+extern void   dsdot4x4_avx    (const float *const *a, const float *const *b,
+                               int n, double *out);
 
 # ifndef DOT_NOFMA
 extern float  sdot_avxfma     (const float  *a, const float  *b, int n);
 extern double ddot_avxfma     (const double *a, const double *b, int n);
 extern double dsdot_avxfma    (const float  *a, const float  *b, int n);
+extern void   dsdot4x4_avxfma (const float *const *a, const float *const *b,
+                               int n, double *out);
 # endif
 # ifndef DOT_NOAVX512
 extern float  sdot_avx512     (const float  *a, const float  *b, int n);
 extern double ddot_avx512     (const double *a, const double *b, int n);
 extern double dsdot_avx512    (const float  *a, const float  *b, int n);
+extern void   dsdot4x4_avx512 (const float *const *a, const float *const *b,
+                               int n, double *out);
 #  ifndef DOT_NOFMA
 extern float  sdot_avx512fma  (const float  *a, const float  *b, int n);
 extern double ddot_avx512fma  (const double *a, const double *b, int n);
 extern double dsdot_avx512fma (const float  *a, const float  *b, int n);
+extern void   dsdot4x4_avx512fma (const float *const *a,
+                                  const float *const *b, int n, double *out);
 #  endif
 # endif
 #endif
@@ -132,6 +161,11 @@ inline double dsdot (const float *a, const float *b, int n) {
   return (*dsdot_ptr)(a,b,n);
 }
 
+inline void dsdot4x4 (const float *const *a, const float *const *b,
+                      int n, double *out) {
+  (*dsdot4x4_ptr)(a,b,n,out);
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -12,8 +12,12 @@
 extern float  sdot_avxfma  (const float  *a, const float  *b, int n);
 extern double ddot_avxfma  (const double *a, const double *b, int n);
 extern double dsdot_avxfma (const float  *a, const float  *b, int n);
+extern void   dsdot4x4_avxfma (const float *const *a, const float *const *b,
+                               int n, double *out);
 #else
 extern float  sdot_avx     (const float  *a, const float  *b, int n);
 extern double ddot_avx     (const double *a, const double *b, int n);
 extern double dsdot_avx    (const float  *a, const float  *b, int n);
+extern void   dsdot4x4_avx    (const float *const *a, const float *const *b,
+                               int n, double *out);
 #endif
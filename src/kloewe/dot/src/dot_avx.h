@@ -25,10 +25,14 @@
 inline float  sdot_avxfma  (const float  *a, const float  *b, int n);
 inline double ddot_avxfma  (const double *a, const double *b, int n);
 inline double dsdot_avxfma (const float  *a, const float  *b, int n);
+inline void   dsdot4x4_avxfma (const float *const *a, const float *const *b,
+                               int n, double *out);
 #else
 inline float  sdot_avx     (const float  *a, const float  *b, int n);
 inline double ddot_avx     (const double *a, const double *b, int n);
 inline double dsdot_avx    (const float  *a, const float  *b, int n);
+inline void   dsdot4x4_avx    (const float *const *a, const float *const *b,
+                               int n, double *out);
 #endif
 
 /*----------------------------------------------------------------------------
@@ -198,4 +202,56 @@ inline double dsdot_avx    (const float *a, const float *b, int n)
   return s;
 }  // dsdot_avx()
 
+/*--------------------------------------------------------------------------*/
+
+// --- 4x4 block of dot products (input: single; intermediate and output:
+//     double), out[4*i+j] = dot(a[i], b[j])
+#ifdef __FMA__
+inline void dsdot4x4_avxfma (const float *const *a, const float *const *b,
+                             int n, double *out)
+#else
+inline void dsdot4x4_avx    (const float *const *a, const float *const *b,
+                             int n, double *out)
+#endif
+{
+  // 8 accumulators per pass fit in the 16 ymm registers together with the
+  // loaded operands, so compute the 4x4 block as two 4x2 blocks
+  for (int jp = 0; jp < 4; jp += 2) {
+    __m256d s[4][2];
+    for (int i = 0; i < 4; i++) {
+      s[i][0] = _mm256_setzero_pd();
+      s[i][1] = _mm256_setzero_pd();
+    }
+
+    // in each iteration, add 4 products to each of the 8 blocks of sums
+    for (int k = 0, nq = 4*(n/4); k < nq; k += 4) {
+      __m256d b0 = _mm256_cvtps_pd(_mm_loadu_ps(b[jp]+k));
+      __m256d b1 = _mm256_cvtps_pd(_mm_loadu_ps(b[jp+1]+k));
+      for (int i = 0; i < 4; i++) {
+        __m256d ai = _mm256_cvtps_pd(_mm_loadu_ps(a[i]+k));
+        #ifdef __FMA__
+        s[i][0] = _mm256_fmadd_pd(ai, b0, s[i][0]);
+        s[i][1] = _mm256_fmadd_pd(ai, b1, s[i][1]);
+        #else
+        s[i][0] = _mm256_add_pd(_mm256_mul_pd(ai, b0), s[i][0]);
+        s[i][1] = _mm256_add_pd(_mm256_mul_pd(ai, b1), s[i][1]);
+        #endif
+      }
+    }
+
+    // compute horizontal sums and add the remaining products
+    for (int i = 0; i < 4; i++) {
+      for (int j = 0; j < 2; j++) {
+        __m128d sh = _mm_add_pd(_mm256_extractf128_pd(s[i][j], 0),
+                                _mm256_extractf128_pd(s[i][j], 1));
+        sh = _mm_add_pd(sh, _mm_shuffle_pd(sh, sh, 1));
+        double t = _mm_cvtsd_f64(sh);
+        for (int k = 4*(n/4); k < n; k++)
+          t += (double)a[i][k] * b[jp+j][k];
+        out[4*i+jp+j] = t;
+      }
+    }
+  }
+}  // dsdot4x4_avx()
+
 #endif // DOT_AVX_H
@@ -19,10 +19,14 @@
 inline float  sdot_avx512fma  (const float  *a, const float  *b, int n);
 inline double ddot_avx512fma  (const double *a, const double *b, int n);
 inline double dsdot_avx512fma (const float  *a, const float  *b, int n);
+inline void   dsdot4x4_avx512fma (const float *const *a,
+                                  const float *const *b, int n, double *out);
 #else
 inline float  sdot_avx512     (const float  *a, const float  *b, int n);
 inline double ddot_avx512     (const double *a, const double *b, int n);
 inline double dsdot_avx512    (const float  *a, const float  *b, int n);
+inline void   dsdot4x4_avx512    (const float *const *a,
+                                  const float *const *b, int n, double *out);
 #endif
 
 /*----------------------------------------------------------------------------
@@ -121,4 +125,49 @@ inline double dsdot_avx512    (const float *a, const float *b, int n)
   return s;
 }  // dsdot_avx512()
 
+/*--------------------------------------------------------------------------*/
+
+// --- 4x4 block of dot products (input: single; intermediate and output:
+//     double), out[4*i+j] = dot(a[i], b[j])
+#ifdef __FMA__
+inline void dsdot4x4_avx512fma (const float *const *a, const float *const *b,
+                                int n, double *out)
+#else
+inline void dsdot4x4_avx512    (const float *const *a, const float *const *b,
+                                int n, double *out)
+#endif
+{
+  // 16 accumulators plus the loaded operands fit in the 32 zmm registers
+  __m512d s[4][4];
+  for (int i = 0; i < 4; i++)
+    for (int j = 0; j < 4; j++)
+      s[i][j] = _mm512_setzero_pd();
+
+  // in each iteration, add 8 products to each of the 16 blocks of sums
+  for (int k = 0, nq = 8*(n/8); k < nq; k += 8) {
+    __m512d bj[4];
+    for (int j = 0; j < 4; j++)
+      bj[j] = _mm512_cvtps_pd(_mm256_loadu_ps(b[j]+k));
+    for (int i = 0; i < 4; i++) {
+      __m512d ai = _mm512_cvtps_pd(_mm256_loadu_ps(a[i]+k));
+      for (int j = 0; j < 4; j++)
+        #ifdef __FMA__
+        s[i][j] = _mm512_fmadd_pd(ai, bj[j], s[i][j]);
+        #else
+        s[i][j] = _mm512_add_pd(_mm512_mul_pd(ai, bj[j]), s[i][j]);
+        #endif
+    }
+  }
+
+  // compute horizontal sums and add the remaining products
+  for (int i = 0; i < 4; i++) {
+    for (int j = 0; j < 4; j++) {
+      double t = _mm512_reduce_add_pd(s[i][j]);
+      for (int k = 8*(n/8); k < n; k++)
+        t += (double)a[i][k] * b[j][k];
+      out[4*i+j] = t;
+    }
+  }
+}  // dsdot4x4_avx512()
+
 #endif // DOT_AVX512_H
@@ -11,3 +11,5 @@
 extern float  sdot_naive  (const float  *a, const float  *b, int n);
 extern double ddot_naive  (const double *a, const double *b, int n);
 extern double dsdot_naive (const float  *a, const float  *b, int n);
+extern void   dsdot4x4_naive (const float *const *a, const float *const *b,
+                              int n, double *out);
@@ -12,6 +12,8 @@
 inline float  sdot_naive  (const float  *a, const float  *b, int n);
 inline double ddot_naive  (const double *a, const double *b, int n);
 inline double dsdot_naive (const float  *a, const float  *b, int n);
+inline void   dsdot4x4_naive (const float *const *a, const float *const *b,
+                              int n, double *out);
 
 /*----------------------------------------------------------------------------
   Inline Functions
@@ -60,4 +62,23 @@ inline double dsdot_naive (const float *a, const float *b, int n)
   return sum;
 }  // dsdot_naive()
 
+/*--------------------------------------------------------------------------*/
+
+// --- 4x4 block of dot products (input: single; intermediate and output:
+//     double), out[4*i+j] = dot(a[i], b[j])
+inline void dsdot4x4_naive (const float *const *a, const float *const *b,
+                            int n, double *out)
+{
+  double sum[16] = { 0 };
+  for (int k = 0; k < n; k++) {
+    for (int i = 0; i < 4; i++) {
+      double ai = a[i][k];
+      for (int j = 0; j < 4; j++)
+        sum[4*i+j] += ai * b[j][k];
+    }
+  }
+  for (int m = 0; m < 16; m++)
+    out[m] = sum[m];
+}  // dsdot4x4_naive()
+
 #endif // DOT_NAIVE_H
@@ -32,6 +32,8 @@
 inline float  sdot_sse2  (const float  *a, const float  *b, int n);
 inline double ddot_sse2  (const double *a, const double *b, int n);
 inline double dsdot_sse2 (const float  *a, const float  *b, int n);
+inline void   dsdot4x4_sse2 (const float *const *a, const float *const *b,
+                             int n, double *out);
 
 /*----------------------------------------------------------------------------
   Inline Functions
@@ -181,4 +183,48 @@ inline double dsdot_sse2 (const float *a, const float *b, int n)
   return s;
 }  // dsdot_sse2()
 
+/*--------------------------------------------------------------------------*/
+
+// --- 4x4 block of dot products (input: single; intermediate and output:
+//     double), out[4*i+j] = dot(a[i], b[j])
+inline void dsdot4x4_sse2 (const float *const *a, const float *const *b,
+                           int n, double *out)
+{
+  // 8 accumulators per pass fit in the 16 xmm registers together with the
+  // loaded operands, so compute the 4x4 block as two 4x2 blocks
+  for (int jp = 0; jp < 4; jp += 2) {
+    __m128d s[4][2];
+    for (int i = 0; i < 4; i++) {
+      s[i][0] = _mm_setzero_pd();
+      s[i][1] = _mm_setzero_pd();
+    }
+
+    // in each iteration, convert 4 floats of each row to 2x2 doubles
+    for (int k = 0, nq = 4*(n/4); k < nq; k += 4) {
+      __m128 bf0 = _mm_loadu_ps(b[jp]+k), bf1 = _mm_loadu_ps(b[jp+1]+k);
+      __m128d b0l = _mm_cvtps_pd(bf0), b0h = _mm_cvtps_pd(_mm_movehl_ps(bf0, bf0));
+      __m128d b1l = _mm_cvtps_pd(bf1), b1h = _mm_cvtps_pd(_mm_movehl_ps(bf1, bf1));
+      for (int i = 0; i < 4; i++) {
+        __m128 af = _mm_loadu_ps(a[i]+k);
+        __m128d al = _mm_cvtps_pd(af), ah = _mm_cvtps_pd(_mm_movehl_ps(af, af));
+        s[i][0] = _mm_add_pd(s[i][0],
+                    _mm_add_pd(_mm_mul_pd(al, b0l), _mm_mul_pd(ah, b0h)));
+        s[i][1] = _mm_add_pd(s[i][1],
+                    _mm_add_pd(_mm_mul_pd(al, b1l), _mm_mul_pd(ah, b1h)));
+      }
+    }
+
+    // compute horizontal sums and add the remaining products
+    for (int i = 0; i < 4; i++) {
+      for (int j = 0; j < 2; j++) {
+        __m128d sh = _mm_add_pd(s[i][j], _mm_shuffle_pd(s[i][j], s[i][j], 1));
+        double t = _mm_cvtsd_f64(sh);
+        for (int k = 4*(n/4); k < n; k++)
+          t += (double)a[i][k] * b[jp+j][k];
+        out[4*i+jp+j] = t;
+      }
+    }
+  }
+}  // dsdot4x4_sse2()
+
 #endif // DOT_SSE2_H